@@ -101,6 +101,12 @@ public:
         return false;
     }
 
+    // Fold in the result of an operator which has seen the values following the ones seen by this one
+    bool combine(const MinMaxAggregateOperator& other)
+    {
+        return other.m_result && accumulate(*other.m_result);
+    }
+
     bool is_null() const
     {
         return !m_result;
@@ -178,6 +184,23 @@ public:
         return false;
     }
 
+    // Fold in the sum of 'count' values which has been computed elsewhere
+    void accumulate_sum(ResultType sum, size_t count)
+    {
+        if constexpr (std::is_integral_v<ResultType> && std::is_signed_v<ResultType>) {
+            m_result = std::make_unsigned_t<ResultType>(m_result) + sum;
+        }
+        else {
+            m_result += sum;
+        }
+        m_count += count;
+    }
+
+    void combine(const Sum& other)
+    {
+        accumulate_sum(other.m_result, other.m_count);
+    }
+
     bool is_null() const
     {
         return false;
@@ -113,6 +113,13 @@ public:
     /// Calls do_translate().
     char* translate(ref_type ref) const noexcept;
 
+    /// Get the address of the array at the specified 'ref' without accessing
+    /// its memory, for passing hints about the memory to util::madvise().
+    /// Returns nullptr if the address is not known that way, which is the case
+    /// for refs outside the file, refs close to the end of a mapping and refs
+    /// into encrypted files.
+    const char* translate_for_hint(ref_type ref) const noexcept;
+
     /// Returns true if, and only if the object at the specified 'ref'
     /// is in the immutable part of the memory managed by this
     /// allocator. The method by which some objects become part of the
@@ -565,6 +572,19 @@ inline char* Allocator::translate_critical(RefTranslation* ref_translation_ptr,
     realm::util::terminate("Invalid ref translation entry", __FILE__, __LINE__, txl.cookie, 0x1234567890, ref, idx);
 }
 
+inline const char* Allocator::translate_for_hint(ref_type ref) const noexcept
+{
+    auto ptr = m_ref_translation_ptr.load(std::memory_order_acquire);
+    if (!ptr || !is_read_only(ref))
+        return nullptr;
+    size_t idx = get_section_index(ref);
+    RefTranslation& txl = ptr[idx];
+    size_t offset = ref - get_section_base(idx);
+    if (txl.encrypted_mapping || offset >= txl.lowest_possible_xover_offset.load(std::memory_order_relaxed))
+        return nullptr;
+    return txl.mapping_addr + offset;
+}
+
 inline char* Allocator::translate(ref_type ref) const noexcept
 {
     if (auto ptr = m_ref_translation_ptr.load(std::memory_order_acquire); REALM_LIKELY(ptr)) {
@@ -257,37 +257,90 @@ SlabAlloc::FreeBlock* SlabAlloc::get_next_block_if_mergeable(SlabAlloc::FreeBloc
     return block_after(bb);
 }
 
-SlabAlloc::FreeList SlabAlloc::find(int size)
+size_t SlabAlloc::bin_index(int size) noexcept
 {
-    FreeList retval;
-    retval.it = m_block_map.lower_bound(size);
-    if (retval.it != m_block_map.end()) {
-        retval.size = retval.it->first;
-    }
-    else {
-        retval.size = 0;
+    REALM_ASSERT_DEBUG(size > 0 && (size & 0x7) == 0);
+    if (size < small_block_limit)
+        return size_t(size) >> 3;
+    int power = log2(size_t(size));
+    size_t sub_bin = (size_t(size) >> (power - 2)) & (large_bins_per_power - 1);
+    return num_small_bins + (power - 10) * large_bins_per_power + sub_bin;
+}
+
+int SlabAlloc::bin_min_size(size_t bin) noexcept
+{
+    if (bin < num_small_bins)
+        return int(bin << 3);
+    size_t power = (bin - num_small_bins) / large_bins_per_power + 10;
+    size_t sub_bin = (bin - num_small_bins) % large_bins_per_power;
+    return int((size_t(1) << power) + (sub_bin << (power - 2)));
+}
+
+size_t SlabAlloc::find_non_empty_bin(size_t bin) const noexcept
+{
+    size_t word = bin / bits_per_bin_mask;
+    if (word >= num_bin_masks)
+        return npos;
+    size_t mask = m_non_empty_bins[word] & (~size_t(0) << (bin % bits_per_bin_mask));
+    while (mask == 0) {
+        if (++word == num_bin_masks)
+            return npos;
+        mask = m_non_empty_bins[word];
     }
-    return retval;
+    return word * bits_per_bin_mask + ctz(mask);
 }
 
-SlabAlloc::FreeList SlabAlloc::find_larger(FreeList hint, int size)
+SlabAlloc::FreeBlock* SlabAlloc::find_block(int size)
 {
+    // A block must either fit exactly or be large enough to be split. Small bins
+    // hold blocks of a single size, so the first block of the bin for 'size'
+    // always fits if there is one.
     int needed_size = size + sizeof(BetweenBlocks) + sizeof(FreeBlock);
-    while (hint.it != m_block_map.end() && hint.it->first < needed_size)
-        ++hint.it;
-    if (hint.it == m_block_map.end())
-        hint.size = 0; // indicate "not found"
-    return hint;
+    size_t exact_bin = bin_index(size);
+    if (FreeBlock* header = m_free_bins[exact_bin]) {
+        int header_size = size_from_block(header);
+        if (header_size == size || header_size >= needed_size)
+            return pop_freelist_entry(exact_bin);
+    }
+
+    // Otherwise all blocks from the first bin with a minimum size of at least
+    // 'needed_size' will do
+    size_t first_bin = bin_index(needed_size);
+    if (bin_min_size(first_bin) < needed_size)
+        ++first_bin;
+    size_t bin = find_non_empty_bin(first_bin);
+    if (bin != npos)
+        return pop_freelist_entry(bin);
+
+    // Before growing the slab area, look for a fit among the blocks in the bins
+    // below that, which may be of any size from 'size' upwards
+    for (bin = exact_bin; bin < first_bin; ++bin) {
+        FreeBlock* header = m_free_bins[bin];
+        if (!header)
+            continue;
+        FreeBlock* entry = header;
+        do {
+            if (size_from_block(entry) >= size) {
+                remove_freelist_entry(entry);
+                return entry;
+            }
+            entry = entry->next;
+        } while (entry != header);
+    }
+    return nullptr;
 }
 
-SlabAlloc::FreeBlock* SlabAlloc::pop_freelist_entry(FreeList list)
+SlabAlloc::FreeBlock* SlabAlloc::pop_freelist_entry(size_t bin)
 {
-    FreeBlock* retval = list.it->second;
+    FreeBlock* retval = m_free_bins[bin];
     FreeBlock* header = retval->next;
-    if (header == retval)
-        m_block_map.erase(list.it);
-    else
-        list.it->second = header;
+    if (header == retval) {
+        m_free_bins[bin] = nullptr;
+        m_non_empty_bins[bin / bits_per_bin_mask] &= ~(size_t(1) << (bin % bits_per_bin_mask));
+    }
+    else {
+        m_free_bins[bin] = header;
+    }
     retval->unlink();
     return retval;
 }
@@ -303,36 +356,28 @@ void SlabAlloc::FreeBlock::unlink()
 
 void SlabAlloc::remove_freelist_entry(FreeBlock* entry)
 {
-    int size = bb_before(entry)->block_after_size;
-    auto it = m_block_map.find(size);
-    REALM_ASSERT_EX(it != m_block_map.end(), get_file_path_for_assertions());
-    auto header = it->second;
-    if (header == entry) {
-        header = entry->next;
-        if (header == entry)
-            m_block_map.erase(it);
-        else
-            it->second = header;
+    size_t bin = bin_index(size_from_block(entry));
+    REALM_ASSERT_EX(m_free_bins[bin], get_file_path_for_assertions());
+    if (m_free_bins[bin] == entry) {
+        pop_freelist_entry(bin);
+        return;
     }
     entry->unlink();
 }
 
 void SlabAlloc::push_freelist_entry(FreeBlock* entry)
 {
-    int size = bb_before(entry)->block_after_size;
-    FreeBlock* header;
-    auto it = m_block_map.find(size);
-    if (it != m_block_map.end()) {
-        header = it->second;
-        it->second = entry;
+    size_t bin = bin_index(size_from_block(entry));
+    FreeBlock* header = m_free_bins[bin];
+    m_free_bins[bin] = entry;
+    if (header) {
         entry->next = header;
         entry->prev = header->prev;
         entry->prev->next = entry;
         entry->next->prev = entry;
     }
     else {
-        header = nullptr;
-        m_block_map[size] = entry;
+        m_non_empty_bins[bin / bits_per_bin_mask] |= size_t(1) << (bin % bits_per_bin_mask);
         entry->next = entry->prev = entry;
     }
 }
@@ -364,19 +409,9 @@ void SlabAlloc::mark_allocated(FreeBlock* entry)
 
 SlabAlloc::FreeBlock* SlabAlloc::allocate_block(int size)
 {
-    FreeList list = find(size);
-    if (list.found_exact(size)) {
-        return pop_freelist_entry(list);
-    }
-    // no exact matches.
-    list = find_larger(list, size);
-    FreeBlock* block;
-    if (list.found_something()) {
-        block = pop_freelist_entry(list);
-    }
-    else {
+    FreeBlock* block = find_block(size);
+    if (!block)
         block = grow_slab(size);
-    }
     FreeBlock* remaining = break_block(block, size);
     if (remaining)
         push_freelist_entry(remaining);
@@ -401,7 +436,8 @@ SlabAlloc::FreeBlock* SlabAlloc::slab_to_entry(const Slab& slab, ref_type ref_st
 
 void SlabAlloc::clear_freelists()
 {
-    m_block_map.clear();
+    std::fill(std::begin(m_free_bins), std::end(m_free_bins), nullptr);
+    std::fill(std::begin(m_non_empty_bins), std::end(m_non_empty_bins), 0);
 }
 
 void SlabAlloc::rebuild_freelists_from_slab()
@@ -664,6 +700,17 @@ int SlabAlloc::get_committed_file_format_version() noexcept
     return file_format_version;
 }
 
+bool SlabAlloc::depends_on_journal() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mapping_mutex);
+        if (m_mappings.size())
+            util::encryption_read_barrier(m_mappings[0].primary_mapping, 0, sizeof(Header));
+    }
+    const Header& header = *reinterpret_cast<const Header*>(m_data);
+    return (header.m_flags & SlabAlloc::flags_Journal) != 0;
+}
+
 bool SlabAlloc::is_file_on_streaming_form(const Header& header)
 {
     // LIMITATION: Only come here if we've already had a read barrier for the affected part of the file
@@ -1182,6 +1229,17 @@ inline bool randomly_false_in_debug(bool x)
   * The old one is held in a waiting area until it is no longer relevant because no
     live transaction can refer to it any more.
  */
+void SlabAlloc::advise_mapping(const util::File::Map<char>& mapping) noexcept
+{
+    // The memory of an encrypted mapping is filled by decryption, not by the kernel
+    if (m_cfg.encryption_key)
+        return;
+    if (m_cfg.access_advice != util::MemoryAdvice::Normal)
+        util::madvise(mapping.get_addr(), mapping.get_size(), m_cfg.access_advice);
+    if (m_cfg.huge_pages)
+        util::madvise(mapping.get_addr(), mapping.get_size(), util::MemoryAdvice::HugePages);
+}
+
 void SlabAlloc::update_reader_view(size_t file_size)
 {
     std::lock_guard<std::mutex> lock(m_mapping_mutex);
@@ -1271,6 +1329,11 @@ void SlabAlloc::update_reader_view(size_t file_size)
         }
 
         std::move(new_mappings.begin(), new_mappings.end(), std::back_inserter(m_mappings));
+
+        // The last of the old mappings may have been extended or replaced
+        for (size_t k = (old_num_mappings > 0 ? old_num_mappings - 1 : 0); k < m_mappings.size(); ++k) {
+            advise_mapping(m_mappings[k].primary_mapping);
+        }
     }
 
     m_baseline.store(file_size, std::memory_order_relaxed);
@@ -29,6 +29,7 @@
 #include <realm/util/checked_mutex.hpp>
 #include <realm/util/features.h>
 #include <realm/util/file.hpp>
+#include <realm/util/file_mapper.hpp>
 #include <realm/util/thread.hpp>
 #include <realm/alloc.hpp>
 #include <realm/version_id.hpp>
@@ -106,6 +107,12 @@ public:
     /// \var Config::clear_file_on_error
     /// If the file being opened is not a valid Realm file (possibly due to a
     /// decryption failure), reinitialize it as if clear_file was set.
+    ///
+    /// \var Config::access_advice
+    /// Passed to util::madvise() for every mapping of the file.
+    ///
+    /// \var Config::huge_pages
+    /// Ask for the mappings of the file to be backed by huge pages.
     struct Config {
         const char* encryption_key = nullptr;
         bool is_shared = false;
@@ -116,6 +123,8 @@ public:
         bool clear_file = false;
         bool clear_file_on_error = false;
         bool disable_sync = false;
+        util::MemoryAdvice access_advice = util::MemoryAdvice::Normal;
+        bool huge_pages = false;
     };
 
     struct Retry {};
@@ -194,6 +203,11 @@ public:
     /// transaction.
     int get_committed_file_format_version() noexcept;
 
+    /// True if the file header is marked as not referencing the newest version,
+    /// which must then be recovered from the commit journal (see
+    /// DBOptions::commit_journal).
+    bool depends_on_journal() noexcept;
+
     bool is_file_on_streaming_form() const
     {
         const Header& header = *reinterpret_cast<const Header*>(m_data);
@@ -323,6 +337,8 @@ public:
     /// by get_mapping_version() below. The mapping version changes whenever a
     /// ref->ptr translation changes, and is used by Group to enforce re-translation.
     void update_reader_view(size_t file_size);
+    /// Pass the access pattern and huge page hints from the configuration on to the kernel
+    void advise_mapping(const util::File::Map<char>& mapping) noexcept;
     void purge_old_mappings(uint64_t oldest_live_version, uint64_t youngest_live_version);
     void init_mapping_management(uint64_t currently_live_version);
 
@@ -497,23 +513,27 @@ private:
     };
 
     Config m_cfg;
-    using FreeListMap = std::map<int, FreeBlock*>; // log(N) addressing for larger blocks
-    FreeListMap m_block_map;
-
-    // abstract notion of a freelist - used to hide whether a freelist
-    // is residing in the small blocks or the large blocks structures.
-    struct FreeList {
-        int size = 0; // size of every element in the list, 0 if not found
-        FreeListMap::iterator it;
-        bool found_something()
-        {
-            return size != 0;
-        }
-        bool found_exact(int sz)
-        {
-            return size == sz;
-        }
-    };
+
+    // Free blocks are kept in circular lists binned by size. Blocks smaller than
+    // small_block_limit have a bin for each size (a multiple of 8). Larger blocks
+    // are binned by the position of their most significant bit, with each power of
+    // two split into 4 bins, so a block in a large bin is at most 25% larger than
+    // the smallest size of its bin. A bitmap of the non-empty bins lets allocation
+    // find the first bin with large enough blocks with a few bit operations.
+    static constexpr int small_block_limit = 1024;
+    static constexpr size_t num_small_bins = small_block_limit / 8;
+    static constexpr size_t large_bins_per_power = 4;
+    static constexpr size_t num_bins = num_small_bins + (31 - 10) * large_bins_per_power;
+    static constexpr size_t bits_per_bin_mask = sizeof(size_t) * 8;
+    static constexpr size_t num_bin_masks = (num_bins + bits_per_bin_mask - 1) / bits_per_bin_mask;
+    FreeBlock* m_free_bins[num_bins] = {};
+    size_t m_non_empty_bins[num_bin_masks] = {};
+
+    static size_t bin_index(int size) noexcept;
+    // the smallest size of a block in bin 'bin'
+    static int bin_min_size(size_t bin) noexcept;
+    // the first non-empty bin at or after 'bin', or npos
+    size_t find_non_empty_bin(size_t bin) const noexcept;
 
     // simple helper functions for accessing/navigating blocks and betweenblocks (TM)
     BetweenBlocks* bb_before(FreeBlock* entry) const
@@ -558,9 +578,9 @@ private:
     void free_block(ref_type ref, FreeBlock* addr);
 
     // Searching/manipulating freelists
-    FreeList find(int size);
-    FreeList find_larger(FreeList hint, int size);
-    FreeBlock* pop_freelist_entry(FreeList list);
+    // returns a free block of at least 'size' bytes, or nullptr
+    FreeBlock* find_block(int size);
+    FreeBlock* pop_freelist_entry(size_t bin);
     void push_freelist_entry(FreeBlock* entry);
     void remove_freelist_entry(FreeBlock* element);
     void rebuild_freelists_from_slab();
@@ -585,6 +605,7 @@ private:
     // Values of each used bit in m_flags
     enum {
         flags_SelectBit = 1,
+        flags_Journal = 2,
     };
 
     // 24 bytes
@@ -594,7 +615,8 @@ private:
         uint8_t m_mnemonic[4];    // "T-DB"
         uint8_t m_file_format[2]; // See `library_file_format`
         uint8_t m_reserved;
-        // bit 0 of m_flags is used to select between the two top refs.
+        // bit 0 of m_flags is used to select between the two top refs, and
+        // bit 1 is set while later versions may only be in the commit journal.
         uint8_t m_flags;
     };
 
@@ -26,11 +26,13 @@
 #include <realm/array_key.hpp>
 #include <realm/impl/array_writer.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cstring> // std::memcpy
 #include <iomanip>
 #include <limits>
 #include <tuple>
+#include <vector>
 
 #ifdef REALM_DEBUG
 #include <iostream>
@@ -42,6 +44,10 @@
 #pragma warning(disable : 4127) // Condition is constant warning
 #endif
 
+#ifdef REALM_COMPILER_AVX
+#include <immintrin.h>
+#endif
+
 
 // Header format (8 bytes):
 // ------------------------
@@ -71,6 +77,7 @@
 //        0    |  number of bits      |  ceil(width * size / 8)
 //        1    |  number of bytes     |  width * size
 //        2    |  ignored             |  size
+//        3    |  ignored (packed)    |  8 * size
 //
 //  5: 'width_ndx' (3 bits)
 //
@@ -87,6 +94,14 @@
 // 'checksum' (not yet implemented) is the checksum of the array
 // including the header.
 //
+// Packed arrays only occur in the file (from file format version 25). Their 'size' is the number of 64-bit
+// words in the payload, which starts with a base and a step, followed by the
+// number of elements in the lower 32 bits and the number of bits per element
+// in the upper 32 bits of the third word. Then follows the unsigned
+// difference between each element and `base + ndx * step`, using that number
+// of bits, in consecutive 64-bit words with the first element in the least
+// significant bits.
+//
 //
 // Inner node of B+-tree:
 // ----------------------
@@ -213,6 +228,10 @@ size_t Array::bit_width(int64_t v)
 void Array::init_from_mem(MemRef mem) noexcept
 {
     char* header = Node::init_from_mem(mem);
+    // The size of a packed array is in its payload, see write_packed()
+    m_is_packed = get_wtype_from_header(header) == wtype_Packed;
+    if (REALM_UNLIKELY(m_is_packed))
+        m_size = size_t(reinterpret_cast<const uint64_t*>(m_data)[2] & 0xffffffff);
     // Parse header
     m_is_inner_bptree_node = get_is_inner_bptree_node_from_header(header);
     m_has_refs = get_hasrefs_from_header(header);
@@ -277,6 +296,151 @@ void Array::destroy_children(size_t offset) noexcept
 }
 
 
+namespace {
+
+// Random access to the elements of a packed array
+class PackedReader {
+public:
+    explicit PackedReader(const char* header) noexcept
+    {
+        const uint64_t* payload = reinterpret_cast<const uint64_t*>(NodeHeader::get_data_from_header(header));
+        m_base = payload[0];
+        m_step = payload[1];
+        m_size = size_t(payload[2] & 0xffffffff);
+        m_width = size_t(payload[2] >> 32);
+        m_mask = m_width == 64 ? ~uint64_t(0) : (uint64_t(1) << m_width) - 1;
+        m_words = payload + 3;
+    }
+
+    size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    int64_t get(size_t ndx) const noexcept
+    {
+        uint64_t residual = 0;
+        if (m_width != 0) {
+            size_t bit = ndx * m_width;
+            size_t shift = bit & 63;
+            const uint64_t* p = m_words + (bit >> 6);
+            residual = p[0] >> shift;
+            if (shift + m_width > 64)
+                residual |= p[1] << (64 - shift);
+            residual &= m_mask;
+        }
+        return int64_t(m_base + ndx * m_step + residual);
+    }
+
+private:
+    uint64_t m_base;
+    uint64_t m_step;
+    size_t m_size;
+    size_t m_width;
+    uint64_t m_mask;
+    const uint64_t* m_words;
+};
+
+template <size_t w>
+void unpack_into(const PackedReader& reader, char* data) noexcept
+{
+    size_t size = reader.size();
+    for (size_t i = 0; i < size; ++i)
+        set_direct<w>(data, i, reader.get(i));
+}
+
+template <bool upper>
+size_t packed_bound(const PackedReader& reader, int64_t value) noexcept
+{
+    size_t lo = 0, hi = reader.size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int64_t v = reader.get(mid);
+        if (upper ? v <= value : v < value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+size_t bits_needed(uint64_t value) noexcept
+{
+    size_t bits = 0;
+    while (value) {
+        ++bits;
+        value >>= 1;
+    }
+    return bits;
+}
+
+} // anonymous namespace
+
+int64_t Array::get_packed(const char* header, size_t ndx) noexcept
+{
+    return PackedReader(header).get(ndx);
+}
+
+int64_t Array::get_packed(size_t ndx) const noexcept
+{
+    return PackedReader(get_header()).get(ndx);
+}
+
+void Array::get_chunk_packed(size_t ndx, int64_t res[8]) const noexcept
+{
+    REALM_ASSERT_3(ndx, <, m_size);
+    PackedReader reader(get_header());
+    for (size_t i = 0; i < 8; ++i)
+        res[i] = ndx + i < m_size ? reader.get(ndx + i) : 0;
+}
+
+template <class cond>
+bool Array::find_packed(int64_t value, size_t start, size_t end, size_t baseindex, QueryStateBase* state) const
+{
+    return ArrayWithFind(*this).find_packed<cond>(value, start, end, baseindex, state);
+}
+
+struct Array::PackedVTable : Array::VTable {
+    PackedVTable()
+    {
+        getter = &Array::get_packed;
+        setter = nullptr; // Packed arrays are decoded before they are modified
+        chunk_getter = &Array::get_chunk_packed;
+        finder[cond_Equal] = &Array::find_packed<Equal>;
+        finder[cond_NotEqual] = &Array::find_packed<NotEqual>;
+        finder[cond_Greater] = &Array::find_packed<Greater>;
+        finder[cond_Less] = &Array::find_packed<Less>;
+    }
+    static const PackedVTable vtable;
+};
+
+const Array::PackedVTable Array::PackedVTable::vtable;
+
+void Array::unpack()
+{
+    // Decode into a regular array using the smallest width that can hold all the elements. Packed arrays only occur
+    // in the file, so the original is always read-only.
+    REALM_ASSERT_DEBUG(m_alloc.is_read_only(m_ref));
+    PackedReader reader(get_header());
+    size_t size = reader.size();
+    int64_t lo = 0, hi = 0;
+    for (size_t i = 0; i < size; ++i) {
+        int64_t v = reader.get(i);
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+    }
+    size_t width = std::max(bit_width(lo), bit_width(hi));
+    int64_t widest = bit_width(lo) < width ? hi : lo;
+    MemRef mem = create(type_Normal, m_context_flag, wtype_Bits, size, widest, m_alloc); // Throws
+    REALM_TEMPEX(unpack_into, width, (reader, get_data_from_header(mem.get_addr())));
+
+    ref_type old_ref = m_ref;
+    char* old_header = get_header();
+    init_from_mem(mem);
+    update_parent(); // Throws
+    m_alloc.free_(old_ref, old_header);
+}
+
 ref_type Array::do_write_shallow(_impl::ArrayWriterBase& out) const
 {
     // Write flat array
@@ -314,6 +478,164 @@ ref_type Array::do_write_deep(_impl::ArrayWriterBase& out, bool only_if_modified
 }
 
 
+ref_type Array::write_deep(ref_type ref, Allocator& alloc, _impl::ArrayWriterBase& out, bool only_if_modified,
+                           ChildWriter write_child)
+{
+    if (only_if_modified && alloc.is_read_only(ref))
+        return ref;
+
+    Array array(alloc);
+    array.init_from_ref(ref);
+    REALM_ASSERT(array.m_has_refs);
+
+    // Temp array for updated refs
+    Array new_array(Allocator::get_default());
+    Type type = array.m_is_inner_bptree_node ? type_InnerBptreeNode : type_HasRefs;
+    new_array.create(type, array.m_context_flag); // Throws
+    _impl::ShallowArrayDestroyGuard dg(&new_array);
+
+    size_t n = array.size();
+    for (size_t i = 0; i < n; ++i) {
+        int_fast64_t value = array.get(i);
+        bool is_ref = (value != 0 && (value & 1) == 0);
+        if (is_ref)
+            value = from_ref(write_child(i, to_ref(value))); // Throws
+        new_array.add(value);                                // Throws
+    }
+
+    return new_array.do_write_shallow(out); // Throws
+}
+
+ref_type Array::write_with_ref_width(ref_type ref, Allocator& alloc, _impl::ArrayWriterBase& out, size_t ref_width)
+{
+    Array array(alloc);
+    array.init_from_ref(ref);
+    if (!array.m_has_refs)
+        return array.do_write_shallow(out); // Throws
+
+    Array new_array(Allocator::get_default());
+    Type type = array.m_is_inner_bptree_node ? type_InnerBptreeNode : type_HasRefs;
+    new_array.create(type, array.m_context_flag); // Throws
+    _impl::ShallowArrayDestroyGuard dg(&new_array);
+    // The largest value of the width
+    new_array.ensure_minimum_width(int_fast64_t(uint64_t(-1) >> (65 - ref_width))); // Throws
+
+    size_t n = array.size();
+    for (size_t i = 0; i < n; ++i) {
+        int_fast64_t value = array.get(i);
+        bool is_ref = (value != 0 && (value & 1) == 0);
+        if (is_ref)
+            value = from_ref(write_with_ref_width(to_ref(value), alloc, out, ref_width)); // Throws
+        new_array.add(value);                                                            // Throws
+    }
+    REALM_ASSERT_DEBUG(new_array.m_width >= ref_width);
+    return new_array.do_write_shallow(out); // Throws
+}
+
+auto Array::get_write_sizes(ref_type ref, Allocator& alloc) -> WriteSizes
+{
+    Array array(alloc);
+    array.init_from_ref(ref);
+    WriteSizes sizes;
+    if (!array.m_has_refs) {
+        sizes.fill(array.get_byte_size());
+        return sizes;
+    }
+
+    sizes.fill(0);
+    size_t value_width = 0;
+    size_t n = array.size();
+    for (size_t i = 0; i < n; ++i) {
+        int_fast64_t value = array.get(i);
+        if (value != 0 && (value & 1) == 0) {
+            WriteSizes child_sizes = get_write_sizes(to_ref(value), alloc);
+            for (size_t k = 0; k < sizes.size(); ++k)
+                sizes[k] += child_sizes[k];
+        }
+        else {
+            value_width = std::max(value_width, bit_width(value));
+        }
+    }
+    for (size_t k = 0; k < sizes.size(); ++k)
+        sizes[k] += calc_aligned_byte_size(n, int(std::max(value_width, size_t(8) << k)));
+    return sizes;
+}
+
+ref_type Array::write_packed(ref_type ref, Allocator& alloc, _impl::ArrayWriterBase& out, bool only_if_modified)
+{
+    if (only_if_modified && alloc.is_read_only(ref))
+        return ref;
+
+    Array array(alloc);
+    array.init_from_ref(ref);
+    REALM_ASSERT(!array.m_has_refs);
+
+    size_t size = array.size();
+    if (size < 2)
+        return array.do_write_shallow(out); // Throws
+
+    std::vector<int64_t> values(size);
+    for (size_t i = 0; i < size; ++i)
+        values[i] = array.get(i);
+    auto [min, max] = std::minmax_element(values.begin(), values.end());
+
+    // Frame of reference
+    uint64_t base = uint64_t(*min);
+    uint64_t step = 0;
+    size_t width = bits_needed(uint64_t(*max) - uint64_t(*min));
+
+    // Linear progression through the first and the last element. The residuals are computed with signed
+    // arithmetic, so this is only tried when they cannot overflow.
+    constexpr int64_t limit = int64_t(1) << 61;
+    if (width > 0 && *min > -limit && *max < limit) {
+        int64_t s = (values[size - 1] - values[0]) / int64_t(size - 1);
+        if (s != 0) {
+            int64_t r_min = values[0], r_max = values[0];
+            for (size_t i = 1; i < size; ++i) {
+                int64_t r = values[i] - int64_t(i) * s;
+                r_min = std::min(r_min, r);
+                r_max = std::max(r_max, r);
+            }
+            size_t linear_width = bits_needed(uint64_t(r_max) - uint64_t(r_min));
+            if (linear_width < width) {
+                base = uint64_t(r_min);
+                step = uint64_t(s);
+                width = linear_width;
+            }
+        }
+    }
+
+    size_t num_words = 3 + (size * width + 63) / 64;
+    size_t byte_size = header_size + num_words * 8;
+    if (byte_size >= array.get_byte_size())
+        return array.do_write_shallow(out); // Throws
+
+    std::vector<uint64_t> buffer(1 + num_words, 0);
+    char* header = reinterpret_cast<char*>(buffer.data());
+    init_header(header, false, false, array.m_context_flag, wtype_Packed, 0, num_words, byte_size);
+    uint64_t* payload = buffer.data() + 1;
+    payload[0] = base;
+    payload[1] = step;
+    payload[2] = uint64_t(size) | uint64_t(width) << 32;
+    if (width > 0) {
+        uint64_t* words = payload + 3;
+        for (size_t i = 0; i < size; ++i) {
+            uint64_t residual = uint64_t(values[i]) - base - uint64_t(i) * step;
+            size_t bit = i * width;
+            size_t shift = bit & 63;
+            words[bit >> 6] |= residual << shift;
+            if (shift + width > 64)
+                words[(bit >> 6) + 1] |= residual >> (64 - shift);
+        }
+    }
+
+    uint32_t dummy_checksum = 0x41414141UL;                                // "AAAA" in ASCII
+    ref_type new_ref = out.write_array(header, byte_size, dummy_checksum); // Throws
+    REALM_ASSERT_3(new_ref % 8, ==, 0);                                    // 8-byte alignment
+    return new_ref;
+}
+
+
 void Array::move(size_t begin, size_t end, size_t dest_begin)
 {
     REALM_ASSERT_3(begin, <=, end);
@@ -349,6 +671,7 @@ void Array::move(size_t begin, size_t end, size_t dest_begin)
 
 void Array::move(Array& dst, size_t ndx)
 {
+    ensure_unpacked(); // Throws
     size_t dest_begin = dst.m_size;
     size_t nb_to_move = m_size - ndx;
     dst.copy_on_write();
@@ -428,6 +751,7 @@ size_t Array::blob_size() const noexcept
 void Array::insert(size_t ndx, int_fast64_t value)
 {
     REALM_ASSERT_DEBUG(ndx <= m_size);
+    ensure_unpacked(); // Throws
 
     const auto old_width = m_width;
     const auto old_size = m_size;
@@ -532,6 +856,7 @@ void Array::truncate_and_destroy_children(size_t new_size)
 
 void Array::do_ensure_minimum_width(int_fast64_t value)
 {
+    REALM_ASSERT_DEBUG(!m_is_packed);
 
     // Make room for the new value
     const size_t width = bit_width(value);
@@ -550,8 +875,159 @@ void Array::do_ensure_minimum_width(int_fast64_t value)
     }
 }
 
+#ifdef REALM_COMPILER_AVX
+namespace {
+
+// Sum, minimum and maximum of 'count' whole 256 or 512 bit vectors of 8, 16, 32 or 64 bit elements starting at
+// 'data'. The callers must check sseavx<2>() or sseavx<512>() first.
+
+template <size_t w>
+REALM_TARGET_AVX2 int64_t sum_avx2(const char* data, size_t count)
+{
+    const __m256i* p = reinterpret_cast<const __m256i*>(data);
+    __m256i sum = _mm256_setzero_si256();
+    for (size_t i = 0; i < count; ++i) {
+        __m256i v = _mm256_loadu_si256(p + i);
+        if constexpr (w == 8) {
+            // Flip the sign bits to sum the bytes as unsigned into 64 bit lanes, and subtract the bias afterwards
+            v = _mm256_xor_si256(v, _mm256_set1_epi8(char(0x80)));
+            sum = _mm256_add_epi64(sum, _mm256_sad_epu8(v, _mm256_setzero_si256()));
+        }
+        else if constexpr (w == 16) {
+            __m256i pairs = _mm256_madd_epi16(v, _mm256_set1_epi16(1));
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(pairs)));
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(pairs, 1)));
+        }
+        else if constexpr (w == 32) {
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+        }
+        else {
+            sum = _mm256_add_epi64(sum, v);
+        }
+    }
+
+    alignas(sizeof(__m256i)) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+    uint64_t s = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    if constexpr (w == 8)
+        s -= uint64_t(count) * sizeof(__m256i) * 0x80;
+    return int64_t(s);
+}
+
+// GCC 12 reports most of the AVX-512 intrinsics as using uninitialized variables when they are inlined
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+
+template <size_t w>
+REALM_TARGET_AVX512 int64_t sum_avx512(const char* data, size_t count)
+{
+    __m512i sum = _mm512_setzero_si512();
+    for (size_t i = 0; i < count; ++i) {
+        __m512i v = _mm512_loadu_si512(data + i * sizeof(__m512i));
+        if constexpr (w == 8) {
+            v = _mm512_xor_si512(v, _mm512_set1_epi8(char(0x80)));
+            sum = _mm512_add_epi64(sum, _mm512_sad_epu8(v, _mm512_setzero_si512()));
+        }
+        else if constexpr (w == 16) {
+            __m512i pairs = _mm512_madd_epi16(v, _mm512_set1_epi16(1));
+            sum = _mm512_add_epi64(sum, _mm512_srai_epi64(_mm512_slli_epi64(pairs, 32), 32));
+            sum = _mm512_add_epi64(sum, _mm512_srai_epi64(pairs, 32));
+        }
+        else if constexpr (w == 32) {
+            // Sign extend the low and high half of each 64 bit lane
+            sum = _mm512_add_epi64(sum, _mm512_srai_epi64(_mm512_slli_epi64(v, 32), 32));
+            sum = _mm512_add_epi64(sum, _mm512_srai_epi64(v, 32));
+        }
+        else {
+            sum = _mm512_add_epi64(sum, v);
+        }
+    }
+
+    alignas(sizeof(__m512i)) uint64_t lanes[8];
+    _mm512_store_si512(lanes, sum);
+    uint64_t s = 0;
+    for (uint64_t lane : lanes)
+        s += lane;
+    if constexpr (w == 8)
+        s -= uint64_t(count) * sizeof(__m512i) * 0x80;
+    return int64_t(s);
+}
+
+template <bool max, size_t w>
+REALM_TARGET_AVX2 int64_t minmax_avx2(const char* data, size_t count)
+{
+    const __m256i* p = reinterpret_cast<const __m256i*>(data);
+    __m256i m = _mm256_loadu_si256(p);
+    for (size_t i = 1; i < count; ++i) {
+        __m256i v = _mm256_loadu_si256(p + i);
+        if constexpr (w == 8)
+            m = max ? _mm256_max_epi8(m, v) : _mm256_min_epi8(m, v);
+        else if constexpr (w == 16)
+            m = max ? _mm256_max_epi16(m, v) : _mm256_min_epi16(m, v);
+        else if constexpr (w == 32)
+            m = max ? _mm256_max_epi32(m, v) : _mm256_min_epi32(m, v);
+        else // There's no 64 bit min/max before AVX-512
+            m = _mm256_blendv_epi8(m, v, max ? _mm256_cmpgt_epi64(v, m) : _mm256_cmpgt_epi64(m, v));
+    }
+
+    alignas(sizeof(__m256i)) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), m);
+    int64_t result = get_direct<w>(reinterpret_cast<const char*>(lanes), 0);
+    for (size_t i = 1; i < sizeof(__m256i) * 8 / w; ++i) {
+        int64_t v = get_direct<w>(reinterpret_cast<const char*>(lanes), i);
+        result = max ? std::max(result, v) : std::min(result, v);
+    }
+    return result;
+}
+
+template <bool max, size_t w>
+REALM_TARGET_AVX512 int64_t minmax_avx512(const char* data, size_t count)
+{
+    __m512i m = _mm512_loadu_si512(data);
+    for (size_t i = 1; i < count; ++i) {
+        __m512i v = _mm512_loadu_si512(data + i * sizeof(__m512i));
+        if constexpr (w == 8)
+            m = max ? _mm512_max_epi8(m, v) : _mm512_min_epi8(m, v);
+        else if constexpr (w == 16)
+            m = max ? _mm512_max_epi16(m, v) : _mm512_min_epi16(m, v);
+        else if constexpr (w == 32)
+            m = max ? _mm512_max_epi32(m, v) : _mm512_min_epi32(m, v);
+        else
+            m = max ? _mm512_max_epi64(m, v) : _mm512_min_epi64(m, v);
+    }
+
+    alignas(sizeof(__m512i)) int64_t lanes[8];
+    _mm512_store_si512(lanes, m);
+    int64_t result = get_direct<w>(reinterpret_cast<const char*>(lanes), 0);
+    for (size_t i = 1; i < sizeof(__m512i) * 8 / w; ++i) {
+        int64_t v = get_direct<w>(reinterpret_cast<const char*>(lanes), i);
+        result = max ? std::max(result, v) : std::min(result, v);
+    }
+    return result;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+} // anonymous namespace
+#endif // REALM_COMPILER_AVX
+
 int64_t Array::sum(size_t start, size_t end) const
 {
+    if (REALM_UNLIKELY(m_is_packed)) {
+        if (end == size_t(-1))
+            end = m_size;
+        PackedReader reader(get_header());
+        int64_t s = 0;
+        for (size_t i = start; i < end; ++i)
+            s += reader.get(i);
+        return s;
+    }
     REALM_TEMPEX(return sum, m_width, (start, end));
 }
 
@@ -622,6 +1098,20 @@ int64_t Array::sum(size_t start, size_t end) const
         start += sizeof(int64_t) * 8 / no0(w) * chunks;
     }
 
+#ifdef REALM_COMPILER_AVX
+    if constexpr (w >= 8) {
+        if (sseavx<2>()) {
+            size_t vector_size = sseavx<512>() ? sizeof(__m512i) : sizeof(__m256i);
+            size_t count = (end - start) * w / 8 / vector_size;
+            if (count > 0) {
+                const char* data = m_data + start * w / 8;
+                s += sseavx<512>() ? sum_avx512<w>(data, count) : sum_avx2<w>(data, count);
+                start += count * vector_size * 8 / w;
+            }
+        }
+    }
+#endif
+
 #ifdef REALM_COMPILER_SSE
     if (sseavx<42>()) {
         // 2000 items summed 500000 times, 8/16/32 bits, miliseconds:
@@ -718,8 +1208,99 @@ int64_t Array::sum(size_t start, size_t end) const
     return s;
 }
 
+bool Array::minimum(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
+{
+    if (REALM_UNLIKELY(m_is_packed))
+        return minmax_packed<false>(result, start, end, return_ndx);
+    REALM_TEMPEX2(return minmax, false, m_width, (result, start, end, return_ndx));
+}
+
+bool Array::maximum(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
+{
+    if (REALM_UNLIKELY(m_is_packed))
+        return minmax_packed<true>(result, start, end, return_ndx);
+    REALM_TEMPEX2(return minmax, true, m_width, (result, start, end, return_ndx));
+}
+
+template <bool max, size_t w>
+bool Array::minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
+{
+    if (end == size_t(-1))
+        end = m_size;
+    REALM_ASSERT_EX(end <= m_size && start <= end, start, end, m_size);
+
+    if (start == end)
+        return false;
+
+    int64_t m = get<w>(start);
+    size_t i = start + 1;
+
+#ifdef REALM_COMPILER_AVX
+    if constexpr (w >= 8) {
+        if (sseavx<2>()) {
+            size_t vector_size = sseavx<512>() ? sizeof(__m512i) : sizeof(__m256i);
+            size_t count = (end - i) * w / 8 / vector_size;
+            if (count > 0) {
+                const char* data = m_data + i * w / 8;
+                int64_t v = sseavx<512>() ? minmax_avx512<max, w>(data, count) : minmax_avx2<max, w>(data, count);
+                m = max ? std::max(m, v) : std::min(m, v);
+                i += count * vector_size * 8 / w;
+            }
+        }
+    }
+#endif
+
+    // Nothing can beat the lower or upper bound of the width, which for the small widths is likely to be found early
+    constexpr int64_t bound = max ? ubound_for_width(w) : lbound_for_width(w);
+    for (; i < end && m != bound; ++i) {
+        int64_t v = get<w>(i);
+        if (max ? v > m : v < m)
+            m = v;
+    }
+
+    result = m;
+    if (return_ndx)
+        *return_ndx = find_first(m, start, end);
+    return true;
+}
+
+template <bool max>
+bool Array::minmax_packed(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
+{
+    if (end == size_t(-1))
+        end = m_size;
+    if (start == end)
+        return false;
+
+    PackedReader reader(get_header());
+    size_t m_ndx = start;
+    int64_t m = reader.get(start);
+    for (size_t i = start + 1; i < end; ++i) {
+        int64_t v = reader.get(i);
+        if (max ? v > m : v < m) {
+            m = v;
+            m_ndx = i;
+        }
+    }
+
+    result = m;
+    if (return_ndx)
+        *return_ndx = m_ndx;
+    return true;
+}
+
 size_t Array::count(int64_t value) const noexcept
 {
+    if (REALM_UNLIKELY(m_is_packed)) {
+        PackedReader reader(get_header());
+        size_t value_count = 0;
+        for (size_t i = 0; i < m_size; ++i) {
+            if (reader.get(i) == value)
+                ++value_count;
+        }
+        return value_count;
+    }
+
     const uint64_t* next = reinterpret_cast<uint64_t*>(m_data);
     size_t value_count = 0;
     const size_t end = m_size;
@@ -924,6 +1505,19 @@ size_t Array::calc_aligned_byte_size(size_t size, int width)
 MemRef Array::clone(MemRef mem, Allocator& alloc, Allocator& target_alloc)
 {
     const char* header = mem.get_addr();
+    if (get_wtype_from_header(header) == wtype_Packed) {
+        // The clone is a regular array
+        Array array(alloc);
+        array.init_from_mem(mem);
+        Array new_array(target_alloc);
+        new_array.create(type_Normal, array.m_context_flag); // Throws
+        _impl::ShallowArrayDestroyGuard dg(&new_array);
+        for (size_t i = 0, size = array.size(); i < size; ++i)
+            new_array.add(array.get(i)); // Throws
+        dg.release();
+        return new_array.get_mem();
+    }
+
     if (!get_hasrefs_from_header(header)) {
         // This array has no subarrays, so we can make a byte-for-byte
         // copy, which is more efficient.
@@ -1058,6 +1652,15 @@ const typename Array::VTableForWidth<width>::PopulatedVTable Array::VTableForWid
 
 void Array::update_width_cache_from_header() noexcept
 {
+    if (REALM_UNLIKELY(m_is_packed)) {
+        // Any value may occur
+        m_lbound = std::numeric_limits<int64_t>::min();
+        m_ubound = std::numeric_limits<int64_t>::max();
+        m_width = 0;
+        m_vtable = &PackedVTable::vtable;
+        m_getter = m_vtable->getter;
+        return;
+    }
     auto width = get_width_from_header(get_header());
     m_lbound = lbound_for_width(width);
     m_ubound = ubound_for_width(width);
@@ -1263,11 +1866,15 @@ void Array::verify() const
 
 size_t Array::lower_bound_int(int64_t value) const noexcept
 {
+    if (REALM_UNLIKELY(m_is_packed))
+        return packed_bound<false>(PackedReader(get_header()), value);
     REALM_TEMPEX(return lower_bound, m_width, (m_data, m_size, value));
 }
 
 size_t Array::upper_bound_int(int64_t value) const noexcept
 {
+    if (REALM_UNLIKELY(m_is_packed))
+        return packed_bound<true>(PackedReader(get_header()), value);
     REALM_TEMPEX(return upper_bound, m_width, (m_data, m_size, value));
 }
 
@@ -1280,6 +1887,8 @@ size_t Array::find_first(int64_t value, size_t start, size_t end) const
 
 int_fast64_t Array::get(const char* header, size_t ndx) noexcept
 {
+    if (REALM_UNLIKELY(get_wtype_from_header(header) == wtype_Packed))
+        return get_packed(header, ndx);
     const char* data = get_data_from_header(header);
     uint_least8_t width = get_width_from_header(header);
     return get_direct(data, width, ndx);
@@ -1288,6 +1897,8 @@ int_fast64_t Array::get(const char* header, size_t ndx) noexcept
 
 std::pair<int64_t, int64_t> Array::get_two(const char* header, size_t ndx) noexcept
 {
+    if (REALM_UNLIKELY(get_wtype_from_header(header) == wtype_Packed))
+        return std::make_pair(get_packed(header, ndx), get_packed(header, ndx + 1));
     const char* data = get_data_from_header(header);
     uint_least8_t width = get_width_from_header(header);
     std::pair<int64_t, int64_t> p = ::get_two(data, width, ndx);
@@ -23,6 +23,9 @@
 #include <realm/query_state.hpp>
 #include <realm/column_fwd.hpp>
 #include <realm/array_direct.hpp>
+#include <realm/util/function_ref.hpp>
+
+#include <array>
 
 namespace realm {
 
@@ -196,8 +199,20 @@ public:
     int64_t front() const noexcept;
     int64_t back() const noexcept;
 
+    void copy_on_write()
+    {
+        ensure_unpacked();     // Throws
+        Node::copy_on_write(); // Throws
+    }
+    void copy_on_write(size_t min_size)
+    {
+        ensure_unpacked();             // Throws
+        Node::copy_on_write(min_size); // Throws
+    }
+
     void alloc(size_t init_size, size_t new_width)
     {
+        ensure_unpacked(); // Throws
         REALM_ASSERT_3(m_width, ==, get_width_from_header(get_header()));
         REALM_ASSERT_3(m_size, ==, get_size_from_header(get_header()));
         Node::alloc(init_size, new_width);
@@ -329,6 +344,12 @@ public:
         return sum(start, end);
     }
 
+    /// Find the lowest (highest) value in the range [start, end), and if
+    /// `return_ndx` is given, the index of its first occurrence. Returns
+    /// false if the range is empty.
+    bool minimum(int64_t& result, size_t start = 0, size_t end = size_t(-1), size_t* return_ndx = nullptr) const;
+    bool maximum(int64_t& result, size_t start = 0, size_t end = size_t(-1), size_t* return_ndx = nullptr) const;
+
     /// This information is guaranteed to be cached in the array accessor.
     bool is_inner_bptree_node() const noexcept;
 
@@ -385,6 +406,41 @@ public:
     /// cases where you do not already have an array accessor available.
     static ref_type write(ref_type, Allocator&, _impl::ArrayWriterBase&, bool only_if_modified);
 
+    using ChildWriter = util::FunctionRef<ref_type(size_t ndx, ref_type child_ref)>;
+
+    /// Same as static write(), but the subarrays are written by calling
+    /// `write_child` with their index in this array and their ref, which must
+    /// return the ref of the written subarray.
+    static ref_type write_deep(ref_type, Allocator&, _impl::ArrayWriterBase&, bool only_if_modified,
+                               ChildWriter write_child);
+
+    /// Same as static write() with `only_if_modified` set to false, but every
+    /// array with refs is written with a width of at least `ref_width` bits
+    /// (8, 16, 32 or 64), which must be enough for any ref in the output. This
+    /// makes the number of bytes written independent of where in the output
+    /// the subarrays end up, so it can be computed up front with
+    /// get_write_sizes().
+    static ref_type write_with_ref_width(ref_type, Allocator&, _impl::ArrayWriterBase&, size_t ref_width);
+
+    /// The number of bytes written by write_with_ref_width() for each ref
+    /// width, starting with 8 bits at index 0.
+    using WriteSizes = std::array<size_t, 4>;
+    static WriteSizes get_write_sizes(ref_type, Allocator&);
+
+    /// Same as static write() for an array of plain integers (no refs), but
+    /// the array is written in the packed encoding (NodeHeader::wtype_Packed)
+    /// if that takes up less space. The packed encoding stores each element as
+    /// its difference from `base + ndx * step`, using as few bits as needed
+    /// for the largest difference. `step` is zero (frame of reference) unless
+    /// a linear progression fits the data better, as is typical for sorted
+    /// data such as increasing ids and timestamps.
+    ///
+    /// An accessor attached to a packed array decodes the elements as they
+    /// are read, and the array is decoded into a regular one when it is
+    /// modified. Only integer arrays which are never read through anything
+    /// but Array accessors or get(const char*, size_t) may be written packed.
+    static ref_type write_packed(ref_type, Allocator&, _impl::ArrayWriterBase&, bool only_if_modified);
+
     size_t find_first(int64_t value, size_t begin = 0, size_t end = size_t(-1)) const;
 
     // Wrappers for backwards compatibility and for simple use without
@@ -485,6 +541,11 @@ private:
     template <size_t w>
     int64_t sum(size_t start, size_t end) const;
 
+    template <bool max, size_t w>
+    bool minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx) const;
+    template <bool max>
+    bool minmax_packed(int64_t& result, size_t start, size_t end, size_t* return_ndx) const;
+
 protected:
     /// It is an error to specify a non-zero value unless the width
     /// type is wtype_Bits. It is also an error to specify a non-zero
@@ -539,8 +600,23 @@ protected:
     bool m_is_inner_bptree_node; // This array is an inner node of B+-tree.
     bool m_has_refs;             // Elements whose first bit is zero are refs to subarrays.
     bool m_context_flag;         // Meaning depends on context.
+    bool m_is_packed = false;    // Attached to a packed array, see write_packed().
 
 private:
+    struct PackedVTable;
+
+    void ensure_unpacked()
+    {
+        if (REALM_UNLIKELY(m_is_packed))
+            unpack(); // Throws
+    }
+    void unpack();
+    static int64_t get_packed(const char* header, size_t ndx) noexcept;
+    int64_t get_packed(size_t ndx) const noexcept;
+    void get_chunk_packed(size_t ndx, int64_t res[8]) const noexcept;
+    template <class cond>
+    bool find_packed(int64_t value, size_t start, size_t end, size_t baseindex, QueryStateBase* state) const;
+
     ref_type do_write_shallow(_impl::ArrayWriterBase&) const;
     ref_type do_write_deep(_impl::ArrayWriterBase&, bool only_if_modified) const;
 
@@ -943,7 +1019,9 @@ inline size_t Array::get_byte_size() const noexcept
 {
     const char* header = get_header_from_data(m_data);
     WidthType wtype = Node::get_wtype_from_header(header);
-    size_t num_bytes = NodeHeader::calc_byte_size(wtype, m_size, m_width);
+    // The size of a packed array in its header is the number of words in its payload
+    size_t size = m_is_packed ? get_size_from_header(header) : m_size;
+    size_t num_bytes = NodeHeader::calc_byte_size(wtype, size, m_width);
 
     REALM_ASSERT_7(m_alloc.is_read_only(m_ref), ==, true, ||, num_bytes, <=, get_capacity_from_header(header));
 
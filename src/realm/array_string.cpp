@@ -151,11 +151,10 @@ void ArrayString::set(size_t ndx, StringData value)
             static_cast<ArrayBigBlobs*>(m_arr)->set_string(ndx, value);
             break;
         case Type::enum_strings: {
-            size_t sz = m_string_enum_values->size();
-            size_t res = m_string_enum_values->find_first(value, 0, sz);
+            size_t res = find_enum_index(value);
             if (res == realm::not_found) {
+                res = m_string_enum_values->size();
                 m_string_enum_values->add(value);
-                res = sz;
             }
             static_cast<Array*>(m_arr)->set(ndx, res);
             break;
@@ -314,10 +313,9 @@ size_t ArrayString::find_first(StringData value, size_t begin, size_t end) const
             break;
         }
         case Type::enum_strings: {
-            size_t sz = m_string_enum_values->size();
-            size_t res = m_string_enum_values->find_first(value, 0, sz);
+            size_t res = find_enum_index(value);
             if (res != realm::not_found) {
-                return static_cast<Array*>(m_arr)->find_first(res, begin, end);
+                return find_first_enum_index(res, begin, end);
             }
             break;
         }
@@ -111,6 +111,41 @@ public:
 
     size_t lower_bound(StringData value);
 
+    /// True if the leaf stores indexes into a list of the unique values in
+    /// the column, which is shared by all leaves of the column. See
+    /// Table::enumerate_string_column(). The following functions may only be
+    /// called on such leaves.
+    bool is_enumerated() const noexcept
+    {
+        return m_type == Type::enum_strings;
+    }
+    /// Number of entries in the list of unique values
+    size_t get_enum_count() const
+    {
+        return m_string_enum_values->size();
+    }
+    /// The string at position `enum_ndx` in the list of unique values
+    StringData get_enum_value(size_t enum_ndx) const
+    {
+        return m_string_enum_values->get(enum_ndx);
+    }
+    /// Position of `value` in the list of unique values, or not_found
+    size_t find_enum_index(StringData value) const noexcept
+    {
+        return m_string_enum_values->find_first(value, 0, m_string_enum_values->size());
+    }
+    /// Position in the list of unique values of the string at `ndx`
+    size_t get_enum_index(size_t ndx) const noexcept
+    {
+        return size_t(m_arr->get(ndx));
+    }
+    /// First string in [begin, end) whose position in the list of unique
+    /// values is `enum_ndx`
+    size_t find_first_enum_index(size_t enum_ndx, size_t begin, size_t end) const noexcept
+    {
+        return m_arr->find_first(int64_t(enum_ndx), begin, end);
+    }
+
     /// Get the specified element without the cost of constructing an
     /// array instance. If an array instance is already available, or
     /// you need to get multiple values, then this method will be
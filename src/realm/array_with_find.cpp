@@ -18,6 +18,10 @@
 
 #include <realm/array_with_find.hpp>
 
+#ifdef REALM_COMPILER_AVX
+#include <immintrin.h>
+#endif
+
 namespace realm {
 
 void ArrayWithFind::find_all(IntegerColumn* result, int64_t value, size_t col_offset, size_t begin, size_t end) const
@@ -29,6 +33,10 @@ void ArrayWithFind::find_all(IntegerColumn* result, int64_t value, size_t col_of
         end = m_array.m_size;
 
     QueryStateFindAll state(*result);
+    if (REALM_UNLIKELY(m_array.m_is_packed)) {
+        find_packed<Equal>(value, begin, end, col_offset, &state);
+        return;
+    }
     REALM_TEMPEX2(find_optimized, Equal, m_array.m_width, (value, begin, end, col_offset, &state));
 
     return;
@@ -79,5 +87,263 @@ size_t ArrayWithFind::first_set_bit64(int64_t v) const
     return first_set_bit(v1) + 32;
 }
 
+#ifdef REALM_COMPILER_AVX
+namespace {
+
+// Report the matches of a vector compare to the query state. Element 'ndx + n' matched if bit 'n * stride' (or for
+// elements of less than a byte, any bit within the element) of 'mask' is set.
+template <size_t stride>
+inline bool report_matches(uint64_t mask, size_t ndx, QueryStateBase* state)
+{
+    while (mask) {
+        if (!state->match(ndx + size_t(ctz(size_t(mask))) / stride))
+            return false;
+        mask &= mask - 1;
+    }
+    return true;
+}
+
+// Elements of less than a byte are unsigned and are compared with the usual bithacks, but for a whole vector at a
+// time. 'high' has the uppermost bit of each element set, 'low' all other bits. The result has the uppermost bit of
+// each matching element set.
+
+// Uppermost bit of each element set if a >= b
+REALM_TARGET_AVX2 inline __m256i greater_equal_avx2(__m256i a, __m256i b, __m256i high, __m256i low)
+{
+    // The low bits are compared by subtracting them with the uppermost bit set, so the subtraction can't borrow
+    // from the next element
+    __m256i low_ge = _mm256_sub_epi64(_mm256_or_si256(a, high), _mm256_and_si256(b, low));
+    return _mm256_or_si256(_mm256_andnot_si256(b, a), _mm256_andnot_si256(_mm256_xor_si256(a, b), low_ge));
+}
+
+template <class cond>
+REALM_TARGET_AVX2 inline __m256i match_fields_avx2(__m256i a, __m256i v, __m256i high, __m256i low)
+{
+    if constexpr (std::is_same_v<cond, Equal> || std::is_same_v<cond, NotEqual>) {
+        __m256i x = _mm256_xor_si256(a, v);
+        __m256i non_zero = _mm256_or_si256(_mm256_add_epi64(_mm256_and_si256(x, low), low), x);
+        if constexpr (std::is_same_v<cond, Equal>)
+            return _mm256_andnot_si256(non_zero, high);
+        else
+            return _mm256_and_si256(non_zero, high);
+    }
+    else if constexpr (std::is_same_v<cond, Greater>) {
+        return _mm256_andnot_si256(greater_equal_avx2(v, a, high, low), high);
+    }
+    else {
+        return _mm256_andnot_si256(greater_equal_avx2(a, v, high, low), high);
+    }
+}
+
+REALM_TARGET_AVX512 inline __m512i greater_equal_avx512(__m512i a, __m512i b, __m512i high, __m512i low)
+{
+    __m512i low_ge = _mm512_sub_epi64(_mm512_or_si512(a, high), _mm512_and_si512(b, low));
+    return _mm512_ternarylogic_epi64(a, b, low_ge, 0xb2); // (a & ~b) | (~(a ^ b) & low_ge)
+}
+
+template <class cond>
+REALM_TARGET_AVX512 inline __m512i match_fields_avx512(__m512i a, __m512i v, __m512i high, __m512i low)
+{
+    if constexpr (std::is_same_v<cond, Equal> || std::is_same_v<cond, NotEqual>) {
+        __m512i x = _mm512_xor_si512(a, v);
+        __m512i non_zero = _mm512_or_si512(_mm512_add_epi64(_mm512_and_si512(x, low), low), x);
+        if constexpr (std::is_same_v<cond, Equal>)
+            return _mm512_ternarylogic_epi64(non_zero, high, high, 0x0c); // ~non_zero & high
+        else
+            return _mm512_and_si512(non_zero, high);
+    }
+    else if constexpr (std::is_same_v<cond, Greater>) {
+        return _mm512_ternarylogic_epi64(greater_equal_avx512(v, a, high, low), high, high, 0x0c);
+    }
+    else {
+        return _mm512_ternarylogic_epi64(greater_equal_avx512(a, v, high, low), high, high, 0x0c);
+    }
+}
+
+} // anonymous namespace
+
+template <class cond, size_t width>
+REALM_TARGET_AVX2 bool ArrayWithFind::find_avx2(int64_t value, size_t start, size_t end, size_t baseindex,
+                                                QueryStateBase* state) const
+{
+    char* const data = m_array.m_data;
+    char* const a = static_cast<char*>(round_up(data + (start * width + 7) / 8, sizeof(__m256i)));
+    char* const b = static_cast<char*>(round_down(data + end * width / 8, sizeof(__m256i)));
+    if (b <= a)
+        return compare<cond, width>(value, start, end, baseindex, state);
+
+    // Elements before the first and after the last aligned vector
+    if (!compare<cond, width>(value, start, (a - data) * 8 / width, baseindex, state))
+        return false;
+
+    if constexpr (width < 8) {
+        const uint64_t ones = ~0ULL / ((1ULL << width) - 1); // lowermost bit of each element set
+        const __m256i v = _mm256_set1_epi64x(int64_t(ones * uint64_t(value)));
+        const __m256i high = _mm256_set1_epi64x(int64_t(ones << (width - 1)));
+        const __m256i low = _mm256_set1_epi64x(int64_t(~(ones << (width - 1))));
+        alignas(sizeof(__m256i)) uint64_t words[4];
+        for (char* p = a; p < b; p += sizeof(__m256i)) {
+            __m256i m = match_fields_avx2<cond>(_mm256_load_si256(reinterpret_cast<__m256i*>(p)), v, high, low);
+            if (_mm256_testz_si256(m, m))
+                continue;
+            _mm256_store_si256(reinterpret_cast<__m256i*>(words), m);
+            size_t ndx = (p - data) * 8 / width + baseindex;
+            for (size_t i = 0; i < 4; ++i) {
+                if (!report_matches<width>(words[i], ndx + i * 64 / width, state))
+                    return false;
+            }
+        }
+    }
+    else {
+        __m256i v;
+        if constexpr (width == 8)
+            v = _mm256_set1_epi8(static_cast<char>(value));
+        else if constexpr (width == 16)
+            v = _mm256_set1_epi16(static_cast<short>(value));
+        else if constexpr (width == 32)
+            v = _mm256_set1_epi32(static_cast<int>(value));
+        else
+            v = _mm256_set1_epi64x(value);
+
+        for (char* p = a; p < b; p += sizeof(__m256i)) {
+            __m256i chunk = _mm256_load_si256(reinterpret_cast<__m256i*>(p));
+            __m256i c;
+            if constexpr (std::is_same_v<cond, Equal> || std::is_same_v<cond, NotEqual>) {
+                if constexpr (width == 8)
+                    c = _mm256_cmpeq_epi8(chunk, v);
+                else if constexpr (width == 16)
+                    c = _mm256_cmpeq_epi16(chunk, v);
+                else if constexpr (width == 32)
+                    c = _mm256_cmpeq_epi32(chunk, v);
+                else
+                    c = _mm256_cmpeq_epi64(chunk, v);
+            }
+            else {
+                // There's only greater-than, so less-than is done with the operands swapped
+                __m256i lhs = std::is_same_v<cond, Greater> ? chunk : v;
+                __m256i rhs = std::is_same_v<cond, Greater> ? v : chunk;
+                if constexpr (width == 8)
+                    c = _mm256_cmpgt_epi8(lhs, rhs);
+                else if constexpr (width == 16)
+                    c = _mm256_cmpgt_epi16(lhs, rhs);
+                else if constexpr (width == 32)
+                    c = _mm256_cmpgt_epi32(lhs, rhs);
+                else
+                    c = _mm256_cmpgt_epi64(lhs, rhs);
+            }
+
+            // One bit per element, except for 16 bit elements which get one for each byte
+            uint32_t mask;
+            uint32_t all;
+            if constexpr (width == 8 || width == 16) {
+                mask = uint32_t(_mm256_movemask_epi8(c));
+                all = width == 8 ? 0xffffffff : 0x55555555;
+                mask &= all;
+            }
+            else if constexpr (width == 32) {
+                mask = uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(c)));
+                all = 0xff;
+            }
+            else {
+                mask = uint32_t(_mm256_movemask_pd(_mm256_castsi256_pd(c)));
+                all = 0xf;
+            }
+            if constexpr (std::is_same_v<cond, NotEqual>)
+                mask = ~mask & all;
+
+            size_t ndx = (p - data) * 8 / width + baseindex;
+            if (!report_matches<width == 16 ? 2 : 1>(mask, ndx, state))
+                return false;
+        }
+    }
+
+    return compare<cond, width>(value, (b - data) * 8 / width, end, baseindex, state);
+}
+
+template <class cond, size_t width>
+REALM_TARGET_AVX512 bool ArrayWithFind::find_avx512(int64_t value, size_t start, size_t end, size_t baseindex,
+                                                    QueryStateBase* state) const
+{
+    char* const data = m_array.m_data;
+    char* const a = static_cast<char*>(round_up(data + (start * width + 7) / 8, sizeof(__m512i)));
+    char* const b = static_cast<char*>(round_down(data + end * width / 8, sizeof(__m512i)));
+    if (b <= a)
+        return compare<cond, width>(value, start, end, baseindex, state);
+
+    if (!compare<cond, width>(value, start, (a - data) * 8 / width, baseindex, state))
+        return false;
+
+    if constexpr (width < 8) {
+        const uint64_t ones = ~0ULL / ((1ULL << width) - 1);
+        const __m512i v = _mm512_set1_epi64(int64_t(ones * uint64_t(value)));
+        const __m512i high = _mm512_set1_epi64(int64_t(ones << (width - 1)));
+        const __m512i low = _mm512_set1_epi64(int64_t(~(ones << (width - 1))));
+        alignas(sizeof(__m512i)) uint64_t words[8];
+        for (char* p = a; p < b; p += sizeof(__m512i)) {
+            __m512i m = match_fields_avx512<cond>(_mm512_load_si512(p), v, high, low);
+            // Bit i is set if any element in the i'th 64 bit word matched
+            unsigned words_matched = _mm512_test_epi64_mask(m, m);
+            if (words_matched == 0)
+                continue;
+            _mm512_store_si512(words, m);
+            size_t ndx = (p - data) * 8 / width + baseindex;
+            for (; words_matched; words_matched &= words_matched - 1) {
+                size_t i = ctz(words_matched);
+                if (!report_matches<width>(words[i], ndx + i * 64 / width, state))
+                    return false;
+            }
+        }
+    }
+    else {
+        constexpr int predicate = std::is_same_v<cond, Equal>      ? _MM_CMPINT_EQ
+                                  : std::is_same_v<cond, NotEqual> ? _MM_CMPINT_NE
+                                  : std::is_same_v<cond, Greater>  ? _MM_CMPINT_NLE
+                                                                   : _MM_CMPINT_LT;
+        for (char* p = a; p < b; p += sizeof(__m512i)) {
+            __m512i chunk = _mm512_load_si512(p);
+            uint64_t mask;
+            if constexpr (width == 8)
+                mask = _mm512_cmp_epi8_mask(chunk, _mm512_set1_epi8(static_cast<char>(value)), predicate);
+            else if constexpr (width == 16)
+                mask = _mm512_cmp_epi16_mask(chunk, _mm512_set1_epi16(static_cast<short>(value)), predicate);
+            else if constexpr (width == 32)
+                mask = _mm512_cmp_epi32_mask(chunk, _mm512_set1_epi32(static_cast<int>(value)), predicate);
+            else
+                mask = _mm512_cmp_epi64_mask(chunk, _mm512_set1_epi64(value), predicate);
+
+            size_t ndx = (p - data) * 8 / width + baseindex;
+            if (!report_matches<1>(mask, ndx, state))
+                return false;
+        }
+    }
+
+    return compare<cond, width>(value, (b - data) * 8 / width, end, baseindex, state);
+}
+
+#define REALM_INSTANTIATE_FIND_AVX(cond)                                                                             \
+    template bool ArrayWithFind::find_avx2<cond, 1>(int64_t, size_t, size_t, size_t, QueryStateBase*) const;         \
+    template bool ArrayWithFind::find_avx2<cond, 2>(int64_t, size_t, size_t, size_t, QueryStateBase*) const;         \
+    template bool ArrayWithFind::find_avx2<cond, 4>(int64_t, size_t, size_t, size_t, QueryStateBase*) const;         \
+    template bool ArrayWithFind::find_avx2<cond, 8>(int64_t, size_t, size_t, size_t, QueryStateBase*) const;         \
+    template bool ArrayWithFind::find_avx2<cond, 16>(int64_t, size_t, size_t, size_t, QueryStateBase*) const;        \
+    template bool ArrayWithFind::find_avx2<cond, 32>(int64_t, size_t, size_t, size_t, QueryStateBase*) const;        \
+    template bool ArrayWithFind::find_avx2<cond, 64>(int64_t, size_t, size_t, size_t, QueryStateBase*) const;        \
+    template bool ArrayWithFind::find_avx512<cond, 1>(int64_t, size_t, size_t, size_t, QueryStateBase*) const;       \
+    template bool ArrayWithFind::find_avx512<cond, 2>(int64_t, size_t, size_t, size_t, QueryStateBase*) const;       \
+    template bool ArrayWithFind::find_avx512<cond, 4>(int64_t, size_t, size_t, size_t, QueryStateBase*) const;       \
+    template bool ArrayWithFind::find_avx512<cond, 8>(int64_t, size_t, size_t, size_t, QueryStateBase*) const;       \
+    template bool ArrayWithFind::find_avx512<cond, 16>(int64_t, size_t, size_t, size_t, QueryStateBase*) const;      \
+    template bool ArrayWithFind::find_avx512<cond, 32>(int64_t, size_t, size_t, size_t, QueryStateBase*) const;      \
+    template bool ArrayWithFind::find_avx512<cond, 64>(int64_t, size_t, size_t, size_t, QueryStateBase*) const;
+
+REALM_INSTANTIATE_FIND_AVX(Equal)
+REALM_INSTANTIATE_FIND_AVX(NotEqual)
+REALM_INSTANTIATE_FIND_AVX(Greater)
+REALM_INSTANTIATE_FIND_AVX(Less)
+
+#undef REALM_INSTANTIATE_FIND_AVX
+
+#endif // REALM_COMPILER_AVX
+
 
 } // namespace realm
@@ -131,6 +131,18 @@ public:
 
 #endif
 
+// AVX2 and AVX-512 find for the four functions Equal/NotEqual/Less/Greater, for all bit widths. These are compiled
+// for their instruction set in array_with_find.cpp, so the caller must check sseavx<2>() or sseavx<512>() first.
+#ifdef REALM_COMPILER_AVX
+    template <class cond, size_t width>
+    REALM_TARGET_AVX2 bool find_avx2(int64_t value, size_t start, size_t end, size_t baseindex,
+                                     QueryStateBase* state) const;
+
+    template <class cond, size_t width>
+    REALM_TARGET_AVX512 bool find_avx512(int64_t value, size_t start, size_t end, size_t baseindex,
+                                         QueryStateBase* state) const;
+#endif
+
     template <size_t width>
     inline bool test_zero(uint64_t value) const; // Tests value for 0-elements
 
@@ -158,6 +170,10 @@ public:
     template <class cond, size_t bitwidth>
     bool find_optimized(int64_t value, size_t start, size_t end, size_t baseindex, QueryStateBase* state) const;
 
+    // Element by element search of a packed array, see Array::write_packed()
+    template <class cond>
+    bool find_packed(int64_t value, size_t start, size_t end, size_t baseindex, QueryStateBase* state) const;
+
 private:
     const Array& m_array;
 
@@ -324,6 +340,19 @@ bool ArrayWithFind::find_optimized(int64_t value, size_t start, size_t end, size
     // finder cannot handle this bitwidth
     REALM_ASSERT_3(m_array.m_width, !=, 0);
 
+#if defined(REALM_COMPILER_AVX)
+    // The AVX kernels search whole 256 or 512 bit vectors and leave the elements before and after them to
+    // compare(), so only use them if there are a few vectors worth of payload.
+    if constexpr (bitwidth != 0 && is_any_v<cond, Equal, NotEqual, Greater, Less>) {
+        if ((end - start2) * bitwidth >= 1024) {
+            if (sseavx<512>())
+                return find_avx512<cond, bitwidth>(value, start2, end, baseindex, state);
+            if (sseavx<2>())
+                return find_avx2<cond, bitwidth>(value, start2, end, baseindex, state);
+        }
+    }
+#endif
+
 #if defined(REALM_COMPILER_SSE)
     // Only use SSE if payload is at least one SSE chunk (128 bits) in size. Also note taht SSE doesn't support
     // Less-than comparison for 64-bit values.
@@ -638,9 +667,28 @@ inline bool ArrayWithFind::compare_equality(int64_t value, size_t start, size_t
 // There exists a couple of find() functions that take more or less template arguments. Always call the one that
 // takes as most as possible to get best performance.
 
+template <class cond>
+bool ArrayWithFind::find_packed(int64_t value, size_t start, size_t end, size_t baseindex,
+                                QueryStateBase* state) const
+{
+    if (end == npos)
+        end = m_array.m_size;
+    cond c;
+    for (; start < end; ++start) {
+        int64_t v = m_array.get(start);
+        if (c(v, value)) {
+            if (!state->match(start + baseindex, v))
+                return false;
+        }
+    }
+    return true;
+}
+
 template <class cond>
 bool ArrayWithFind::find(int64_t value, size_t start, size_t end, size_t baseindex, QueryStateBase* state) const
 {
+    if (REALM_UNLIKELY(m_array.m_is_packed))
+        return find_packed<cond>(value, start, end, baseindex, state);
     REALM_TEMPEX2(return find_optimized, cond, m_array.m_width, (value, start, end, baseindex, state));
 }
 
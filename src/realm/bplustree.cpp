@@ -104,6 +104,7 @@ public:
     void bptree_access(size_t n, AccessFunc) override;
     size_t bptree_erase(size_t n, EraseFunc) override;
     bool bptree_traverse(TraverseFunc) override;
+    size_t bptree_partition_point(size_t offset, PartitionFunc) override;
     void verify() const override;
 
     // Other modifiers
@@ -168,6 +169,12 @@ private:
     {
         return (child_ndx) > 0 ? size_t(m_offsets.get(child_ndx - 1)) : 0;
     }
+    size_t get_child_offset(size_t child_ndx) const
+    {
+        return m_offsets.is_attached() ? get_bp_node_offset(child_ndx) : child_ndx * get_elems_per_child();
+    }
+    // Call 'func' for the first element of the subtree of child 'child_ndx'
+    bool first_element_before(size_t child_ndx, size_t offset, PartitionFunc func);
 };
 } // namespace realm
 
@@ -222,6 +229,20 @@ bool BPlusTreeLeaf::bptree_traverse(TraverseFunc func)
     return func(this, 0) == IteratorControl::Stop;
 }
 
+size_t BPlusTreeLeaf::bptree_partition_point(size_t offset, PartitionFunc func)
+{
+    size_t lo = 0;
+    size_t hi = get_node_size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (func(this, mid, offset))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return offset + lo;
+}
+
 template <>
 void BPlusTree<int64_t>::split_root()
 {
@@ -514,6 +535,56 @@ bool BPlusTreeInner::bptree_traverse(TraverseFunc func)
     return false;
 }
 
+bool BPlusTreeInner::first_element_before(size_t child_ndx, size_t offset, PartitionFunc func)
+{
+    size_t child_offset = offset + get_child_offset(child_ndx);
+    ref_type child_ref = get_bp_node_ref(child_ndx);
+    char* child_header = m_alloc.translate(child_ref);
+    MemRef mem(child_header, child_ref, m_alloc);
+    bool child_is_leaf = !Array::get_is_inner_bptree_node_from_header(child_header);
+    if (child_is_leaf) {
+        auto leaf = cache_leaf(mem, child_ndx, child_offset);
+        return func(leaf, 0, child_offset);
+    }
+    BPlusTreeInner node(m_tree);
+    node.set_parent(this, child_ndx + 1);
+    node.init_from_mem(mem);
+    node.set_offset(child_offset);
+    return node.first_element_before(0, child_offset, func);
+}
+
+size_t BPlusTreeInner::bptree_partition_point(size_t offset, PartitionFunc func)
+{
+    // The position is in the last child whose first element comes before it,
+    // or in the first child if there is none. It may be right after the last
+    // element of that child, which the child then returns.
+    size_t lo = 1;
+    size_t hi = get_node_size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (first_element_before(mid, offset, func))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    size_t child_ndx = lo - 1;
+    size_t child_offset = offset + get_child_offset(child_ndx);
+
+    ref_type child_ref = get_bp_node_ref(child_ndx);
+    char* child_header = m_alloc.translate(child_ref);
+    MemRef mem(child_header, child_ref, m_alloc);
+    bool child_is_leaf = !Array::get_is_inner_bptree_node_from_header(child_header);
+    if (child_is_leaf) {
+        auto leaf = cache_leaf(mem, child_ndx, child_offset);
+        return leaf->bptree_partition_point(child_offset, func);
+    }
+    BPlusTreeInner node(m_tree);
+    node.set_parent(this, child_ndx + 1);
+    node.init_from_mem(mem);
+    node.set_offset(child_offset);
+    return node.bptree_partition_point(child_offset, func);
+}
+
 void BPlusTreeInner::move(BPlusTreeNode* new_node, size_t ndx, int64_t adj)
 {
     BPlusTreeInner* dst(static_cast<BPlusTreeInner*>(new_node));
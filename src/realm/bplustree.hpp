@@ -52,6 +52,10 @@ public:
     // Function to be called for all leaves in the tree until the function
     // returns 'IteratorControl::Stop'. 'offset' gives index of the first element in the leaf.
     using TraverseFunc = util::FunctionRef<IteratorControl(BPlusTreeNode*, size_t offset)>;
+    // Tells if element 'ndx' of a leaf comes before the position searched for
+    // by bptree_partition_point(). 'offset' gives index of the first element
+    // in the leaf.
+    using PartitionFunc = util::FunctionRef<bool(BPlusTreeNode*, size_t ndx, size_t offset)>;
 
     BPlusTreeNode(BPlusTreeBase* tree)
         : m_tree(tree)
@@ -86,6 +90,10 @@ public:
     virtual void bptree_access(size_t n, AccessFunc) = 0;
     virtual size_t bptree_erase(size_t n, EraseFunc) = 0;
     virtual bool bptree_traverse(TraverseFunc) = 0;
+    // Position of the first element for which 'func' returns false, where
+    // 'func' must return true for all elements before it. 'offset' gives
+    // index of the first element in this node.
+    virtual size_t bptree_partition_point(size_t offset, PartitionFunc) = 0;
 
     // Move elements over in new node, starting with element at position 'ndx'.
     // If this is an inner node, the index offsets should be adjusted with 'adj'
@@ -118,6 +126,7 @@ public:
     void bptree_access(size_t n, AccessFunc) override;
     size_t bptree_erase(size_t n, EraseFunc) override;
     bool bptree_traverse(TraverseFunc) override;
+    size_t bptree_partition_point(size_t offset, PartitionFunc) override;
 };
 
 /*****************************************************************************/
@@ -514,6 +523,21 @@ public:
         return result;
     }
 
+    /// Position of the first element for which `pred(ndx, value)` returns
+    /// false, where it must return true for all elements before it, as for
+    /// std::partition_point(). This takes a single walk from the root to a
+    /// leaf, which is faster than a binary search using get().
+    template <typename Pred>
+    size_t partition_point(Pred&& pred) const
+    {
+        auto func = [&pred](BPlusTreeNode* node, size_t ndx, size_t offset) {
+            LeafNode* leaf = static_cast<LeafNode*>(node);
+            return bool(pred(offset + ndx, leaf->get(ndx)));
+        };
+
+        return m_root->bptree_partition_point(0, func);
+    }
+
     template <typename Func>
     void find_all(T value, Func&& callback) const noexcept
     {
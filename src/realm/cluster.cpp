@@ -65,6 +65,17 @@ void FieldValues::insert(ColKey k, Mixed val, bool is_default)
     m_values.insert(it, {k, val, is_default});
 }
 
+FieldValues ClusterRows::get_field_values(size_t i) const
+{
+    FieldValues field_values;
+    for (auto col_key : col_keys) {
+        Mixed value = get(col_key.get_index().val, i);
+        if (!value.is_null())
+            field_values.insert(col_key, value);
+    }
+    return field_values;
+}
+
 /******************************* ClusterNode *********************************/
 
 void ClusterNode::IteratorState::clear()
@@ -440,6 +451,138 @@ void Cluster::insert_row(size_t ndx, RowKey row_key, const FieldValues& init_val
     m_tree_top.m_owner->for_each_and_every_column(insert_in_column);
 }
 
+template <class T>
+inline void Cluster::do_append_rows(size_t ndx, ColKey col, const ClusterRows& rows, size_t begin, size_t count,
+                                    bool nullable)
+{
+    using U = typename util::RemoveOptional<typename T::value_type>::type;
+
+    T arr(m_alloc);
+    auto col_ndx = col.get_index();
+    arr.set_parent(this, col_ndx.val + s_first_col_index);
+    set_spec<T>(arr, col_ndx);
+    arr.init_from_parent();
+    for (size_t i = 0; i < count; ++i) {
+        Mixed init_val = rows.get(col_ndx.val, begin + i);
+        if (init_val.is_null()) {
+            arr.insert(ndx + i, T::default_value(nullable));
+        }
+        else {
+            arr.insert(ndx + i, init_val.get<U>());
+        }
+    }
+}
+
+size_t Cluster::append_rows(const ClusterRows& rows, size_t begin)
+{
+    size_t sz = node_size();
+    size_t count = std::min(cluster_node_size - sz, rows.keys.size() - begin);
+    if (count == 0)
+        return 0;
+
+    // Ensure the cluster array is big enough to hold 64 bit values.
+    copy_on_write(m_size * 8);
+
+    int64_t offset = get_offset();
+    if (!m_keys.is_attached()) {
+        // The compact form can only be kept if the keys follow the last one without gaps
+        for (size_t i = 0; i < count; ++i) {
+            if (rows.keys[begin + i].value - offset != int64_t(sz + i)) {
+                ensure_general_form();
+                break;
+            }
+        }
+    }
+    if (m_keys.is_attached()) {
+        for (size_t i = 0; i < count; ++i)
+            m_keys.insert(sz + i, rows.keys[begin + i].value - offset);
+    }
+    else {
+        Array::set(s_key_ref_or_size_index, Array::get(s_key_ref_or_size_index) + 2 * count); // Size is tagged
+    }
+
+    // Each column is filled in one go, except the ones which need backlinks in other tables
+    auto append_to_column = [&](ColKey col_key) {
+        auto col_ndx = col_key.get_index();
+        auto attr = col_key.get_attrs();
+        auto type = col_key.get_type();
+        if (attr.test(col_attr_Collection)) {
+            ArrayRef arr(m_alloc);
+            arr.set_parent(this, col_ndx.val + s_first_col_index);
+            arr.init_from_parent();
+            for (size_t i = 0; i < count; ++i)
+                arr.insert(sz + i, 0);
+            return IteratorControl::AdvanceToNext;
+        }
+
+        bool nullable = attr.test(col_attr_Nullable);
+        switch (type) {
+            case col_type_Int:
+                if (nullable) {
+                    do_append_rows<ArrayIntNull>(sz, col_key, rows, begin, count, nullable);
+                }
+                else {
+                    do_append_rows<ArrayInteger>(sz, col_key, rows, begin, count, nullable);
+                }
+                break;
+            case col_type_Bool:
+                do_append_rows<ArrayBoolNull>(sz, col_key, rows, begin, count, nullable);
+                break;
+            case col_type_Float:
+                do_append_rows<ArrayFloatNull>(sz, col_key, rows, begin, count, nullable);
+                break;
+            case col_type_Double:
+                do_append_rows<ArrayDoubleNull>(sz, col_key, rows, begin, count, nullable);
+                break;
+            case col_type_String:
+                do_append_rows<ArrayString>(sz, col_key, rows, begin, count, nullable);
+                break;
+            case col_type_Binary:
+                do_append_rows<ArrayBinary>(sz, col_key, rows, begin, count, nullable);
+                break;
+            case col_type_Timestamp:
+                do_append_rows<ArrayTimestamp>(sz, col_key, rows, begin, count, nullable);
+                break;
+            case col_type_Decimal:
+                do_append_rows<ArrayDecimal128>(sz, col_key, rows, begin, count, nullable);
+                break;
+            case col_type_ObjectId:
+                do_append_rows<ArrayObjectIdNull>(sz, col_key, rows, begin, count, nullable);
+                break;
+            case col_type_UUID:
+                do_append_rows<ArrayUUIDNull>(sz, col_key, rows, begin, count, nullable);
+                break;
+            case col_type_Mixed:
+                for (size_t i = 0; i < count; ++i)
+                    do_insert_mixed(sz + i, col_key, rows.get(col_ndx.val, begin + i), rows.keys[begin + i]);
+                break;
+            case col_type_Link:
+                for (size_t i = 0; i < count; ++i)
+                    do_insert_key(sz + i, col_key, rows.get(col_ndx.val, begin + i), rows.keys[begin + i]);
+                break;
+            case col_type_TypedLink:
+                for (size_t i = 0; i < count; ++i)
+                    do_insert_link(sz + i, col_key, rows.get(col_ndx.val, begin + i), rows.keys[begin + i]);
+                break;
+            case col_type_BackLink: {
+                ArrayBacklink arr(m_alloc);
+                arr.set_parent(this, col_ndx.val + s_first_col_index);
+                arr.init_from_parent();
+                for (size_t i = 0; i < count; ++i)
+                    arr.insert(sz + i, 0);
+                break;
+            }
+            default:
+                REALM_ASSERT(false);
+                break;
+        }
+        return IteratorControl::AdvanceToNext;
+    };
+    m_tree_top.m_owner->for_each_and_every_column(append_to_column);
+
+    return count;
+}
+
 template <class T>
 inline void Cluster::do_move(size_t ndx, ColKey col_key, Cluster* to)
 {
@@ -706,8 +849,10 @@ ref_type Cluster::insert(RowKey row_key, const FieldValues& init_values, Cluster
         state.index = ndx;
     }
     else {
-        // Split leaf node
-        Cluster new_leaf(0, m_alloc, m_tree_top);
+        // Split leaf node. The offset of the new leaf is needed for the keys of backlinks
+        // added for the initial values
+        uint64_t new_leaf_offset = get_offset() + (ndx == sz ? row_key.value : uint64_t(current_key_value));
+        Cluster new_leaf(new_leaf_offset, m_alloc, m_tree_top);
         new_leaf.create();
         if (ndx == sz) {
             new_leaf.insert_row(0, RowKey(0), init_values); // Throws
@@ -1044,6 +1189,22 @@ void Cluster::upgrade_string_to_enum(ColKey col_key, ArrayString& keys)
     Array::destroy_deep(ref, m_alloc);
 }
 
+void Cluster::downgrade_enum_to_string(ColKey col_key, const ArrayString& keys)
+{
+    auto col_ndx = col_key.get_index();
+    ArrayString values(m_alloc);
+    values.create();
+    Array indexes(m_alloc);
+    ref_type ref = Array::get_as_ref(col_ndx.val + s_first_col_index);
+    indexes.init_from_ref(ref);
+    size_t sz = indexes.size();
+    for (size_t i = 0; i < sz; i++) {
+        values.add(keys.get(size_t(indexes.get(i))));
+    }
+    Array::set(col_ndx.val + s_first_col_index, values.get_ref());
+    indexes.destroy();
+}
+
 void Cluster::init_leaf(ColKey col_key, ArrayPayload* leaf) const
 {
     auto col_ndx = col_key.get_index();
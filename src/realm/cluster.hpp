@@ -25,6 +25,7 @@
 #include <realm/array_unsigned.hpp>
 #include <realm/data_type.hpp>
 #include <realm/column_type_traits.hpp>
+#include <realm/util/span.hpp>
 
 namespace realm {
 
@@ -75,6 +76,33 @@ private:
     std::vector<FieldValue> m_values;
 };
 
+/// The values of one column for each of the objects created by
+/// Table::create_objects().
+struct ColumnValues {
+    ColKey col_key;
+    util::Span<const Mixed> values;
+};
+
+/// New objects inserted by ClusterTree::insert_rows(). The object with key
+/// `keys[i]` gets the value at index `rows[i]` of each column given a value.
+struct ClusterRows {
+    /// The keys of the objects in ascending order
+    std::vector<ObjKey> keys;
+    std::vector<size_t> rows;
+    /// The values of each column, indexed by the leaf index of the column, or
+    /// null for columns which get their default values
+    std::vector<const Mixed*> values;
+    /// The columns given values, in the order of their leaf indexes
+    std::vector<ColKey> col_keys;
+
+    Mixed get(size_t col_ndx, size_t i) const noexcept
+    {
+        const Mixed* col_values = values[col_ndx];
+        return col_values ? col_values[rows[i]] : Mixed();
+    }
+    FieldValues get_field_values(size_t i) const;
+};
+
 class ClusterNode : public Array {
 public:
     struct RowKey {
@@ -173,6 +201,10 @@ public:
     /// Create a new object identified by 'key' and update 'state' accordingly
     /// Return reference to new node created (if any)
     virtual ref_type insert(RowKey k, const FieldValues& init_values, State& state) = 0;
+    /// Append the objects of 'rows' from index 'begin' to the last leaf of this
+    /// subtree, as many as it has room for. Their keys must be greater than the
+    /// key of any object in the tree. Return the number of objects appended.
+    virtual size_t append_rows(const ClusterRows& rows, size_t begin) = 0;
     /// Locate object identified by 'key' and update 'state' accordingly
     void get(ObjKey key, State& state) const;
     /// Locate object identified by 'key' and update 'state' accordingly
@@ -308,12 +340,14 @@ public:
         return size() - s_first_col_index;
     }
     ref_type insert(RowKey k, const FieldValues& init_values, State& state) override;
+    size_t append_rows(const ClusterRows& rows, size_t begin) override;
     bool try_get(RowKey k, State& state) const noexcept override;
     ObjKey get(size_t, State& state) const override;
     size_t get_ndx(RowKey key, size_t ndx) const noexcept override;
     size_t erase(RowKey k, CascadeState& state) override;
     void nullify_incoming_links(RowKey key, CascadeState& state) override;
     void upgrade_string_to_enum(ColKey col, ArrayString& keys);
+    void downgrade_enum_to_string(ColKey col, const ArrayString& keys);
 
     void init_leaf(ColKey col, ArrayPayload* leaf) const;
     void add_leaf(ColKey col, ref_type ref);
@@ -344,6 +378,8 @@ private:
     template <class T>
     void do_insert_row(size_t ndx, ColKey col, Mixed init_val, bool nullable);
     template <class T>
+    void do_append_rows(size_t ndx, ColKey col, const ClusterRows& rows, size_t begin, size_t count, bool nullable);
+    template <class T>
     void do_move(size_t ndx, ColKey col, Cluster* to);
     template <class T>
     void do_erase(size_t ndx, ColKey col);
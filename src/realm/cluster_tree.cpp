@@ -95,6 +95,7 @@ public:
     void remove_column(ColKey col) override;
     size_t nb_columns() const override;
     ref_type insert(RowKey k, const FieldValues& init_values, State& state) override;
+    size_t append_rows(const ClusterRows& rows, size_t begin) override;
     bool try_get(RowKey k, State& state) const noexcept override;
     ObjKey get(size_t ndx, State& state) const override;
     size_t get_ndx(RowKey key, size_t ndx) const noexcept override;
@@ -121,6 +122,8 @@ public:
     void dump_objects(int64_t key_offset, std::string lead) const override;
 
 private:
+    friend class ClusterTree;
+
     static constexpr size_t s_key_ref_index = 0;
     static constexpr size_t s_sub_tree_depth_index = 1;
     static constexpr size_t s_sub_tree_size = 2;
@@ -340,6 +343,17 @@ ref_type ClusterNodeInner::insert(RowKey row_key, const FieldValues& init_values
     });
 }
 
+size_t ClusterNodeInner::append_rows(const ClusterRows& rows, size_t begin)
+{
+    // The keys are greater than all others, so the last child is found
+    RowKey row_key(rows.keys[begin].value - get_offset());
+    return recurse<size_t>(row_key, [this, &rows, begin](ClusterNode* node, ChildInfo&) {
+        size_t count = node->append_rows(rows, begin);
+        set_tree_size(get_tree_size() + count);
+        return count;
+    });
+}
+
 bool ClusterNodeInner::try_get(RowKey key, ClusterNode::State& state) const noexcept
 {
     ChildInfo child_info;
@@ -846,7 +860,7 @@ void ClusterTree::clear(CascadeState& state)
     m_size = 0;
 }
 
-void ClusterTree::enumerate_string_column(ColKey col_key)
+bool ClusterTree::enumerate_string_column(ColKey col_key, size_t max_unique_values)
 {
     Allocator& alloc = get_alloc();
 
@@ -854,7 +868,7 @@ void ClusterTree::enumerate_string_column(ColKey col_key)
     ArrayString leaf(alloc);
     keys.create();
 
-    auto collect_strings = [col_key, &leaf, &keys](const Cluster* cluster) {
+    auto collect_strings = [col_key, max_unique_values, &leaf, &keys](const Cluster* cluster) {
         cluster->init_leaf(col_key, &leaf);
         size_t sz = leaf.size();
         size_t key_size = keys.size();
@@ -862,6 +876,8 @@ void ClusterTree::enumerate_string_column(ColKey col_key)
             auto v = leaf.get(i);
             size_t pos = keys.lower_bound(v);
             if (pos == key_size || keys.get(pos) != v) {
+                if (key_size == max_unique_values)
+                    return IteratorControl::Stop;
                 keys.insert(pos, v); // Throws
                 key_size++;
             }
@@ -875,7 +891,10 @@ void ClusterTree::enumerate_string_column(ColKey col_key)
     };
 
     // Populate 'keys' array
-    traverse(collect_strings);
+    if (traverse(collect_strings)) {
+        keys.destroy();
+        return false;
+    }
 
     // Store key strings in spec
     size_t spec_ndx = m_owner->colkey2spec_ndx(col_key);
@@ -883,6 +902,27 @@ void ClusterTree::enumerate_string_column(ColKey col_key)
 
     // Replace column in all clusters
     update(upgrade);
+    return true;
+}
+
+void ClusterTree::unenumerate_string_column(ColKey col_key)
+{
+    size_t spec_ndx = m_owner->colkey2spec_ndx(col_key);
+    Spec& spec = const_cast<Spec&>(m_owner->m_spec);
+
+    ArrayParent* parent;
+    ArrayString keys(get_alloc());
+    keys.init_from_ref(spec.get_enumkeys_ref(spec_ndx, parent));
+
+    auto downgrade = [col_key, &keys](Cluster* cluster) {
+        cluster->downgrade_enum_to_string(col_key, keys);
+    };
+
+    // Replace column in all clusters before the key strings are released
+    update(downgrade);
+    spec.downgrade_enum_to_string(spec_ndx);
+
+    bump_storage_version();
 }
 
 void ClusterTree::replace_root(std::unique_ptr<ClusterNode> new_root)
@@ -950,6 +990,29 @@ Obj ClusterTree::insert(ObjKey k, const FieldValues& init_values)
     return Obj(get_table_ref(), state.mem, k, state.index);
 }
 
+void ClusterTree::insert_rows(const ClusterRows& rows)
+{
+    int64_t last_key_value = m_size ? get_last_key_value() : -1;
+    size_t num_rows = rows.keys.size();
+    size_t i = 0;
+    while (i < num_rows) {
+        // Inserting the first object splits the last leaf if it is full
+        ObjKey k = rows.keys[i];
+        ClusterNode::State state;
+        insert_fast(k, rows.get_field_values(i), state);
+        ++i;
+        if (k.value > last_key_value && i < num_rows) {
+            // All the remaining objects go after the last one, so they fill the last leaf
+            size_t count = m_root->append_rows(rows, i);
+            m_size += count;
+            i += count;
+        }
+    }
+
+    bump_content_version();
+    bump_storage_version();
+}
+
 bool ClusterTree::is_valid(ObjKey k) const noexcept
 {
     if (m_size == 0)
@@ -1040,6 +1103,28 @@ bool ClusterTree::traverse(TraverseFunction func) const
     }
 }
 
+std::vector<ClusterTree::LeafPosition> ClusterTree::get_leaf_positions() const
+{
+    std::vector<LeafPosition> positions;
+    traverse([&positions](const Cluster* cluster) {
+        positions.push_back({cluster->get_ref(), cluster->get_offset()});
+        return IteratorControl::AdvanceToNext;
+    });
+    return positions;
+}
+
+bool ClusterTree::traverse(TraverseFunction func, const LeafPosition* begin, const LeafPosition* end) const
+{
+    for (auto it = begin; it != end; ++it) {
+        Cluster leaf(it->offset, m_alloc, *this);
+        leaf.init(MemRef(m_alloc.translate(it->ref), it->ref, m_alloc));
+        if (func(&leaf) == IteratorControl::Stop) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void ClusterTree::update(UpdateFunction func)
 {
     if (m_root->is_leaf()) {
@@ -1060,6 +1145,25 @@ void ClusterTree::set_spec(ArrayPayload& arr, ColKey::Idx col_ndx) const
     }
 }
 
+ref_type ClusterTree::write_packed(ref_type ref, Allocator& alloc, _impl::ArrayWriterBase& out,
+                                   const std::vector<bool>& packed_columns)
+{
+    bool only_if_modified = true;
+    bool is_inner = Array::get_is_inner_bptree_node_from_header(alloc.translate(ref));
+    return Array::write_deep(ref, alloc, out, only_if_modified, [&](size_t ndx, ref_type child_ref) {
+        if (is_inner) {
+            if (ndx >= ClusterNodeInner::s_first_node_index)
+                return write_packed(child_ref, alloc, out, packed_columns); // Throws
+        }
+        else if (ndx >= Cluster::s_first_col_index) {
+            size_t leaf_ndx = ndx - Cluster::s_first_col_index;
+            if (leaf_ndx < packed_columns.size() && packed_columns[leaf_ndx])
+                return Array::write_packed(child_ref, alloc, out, only_if_modified); // Throws
+        }
+        return Array::write(child_ref, alloc, out, only_if_modified); // Throws
+    });
+}
+
 TableRef ClusterTree::get_table_ref() const
 {
     REALM_ASSERT(m_owner != nullptr);
@@ -1083,6 +1187,87 @@ void ClusterTree::verify() const
 #endif
 }
 
+void ClusterTree::prefetch(ColKey col_key, util::MemoryAdvice advice) const
+{
+    if (!is_attached())
+        return;
+
+    // Adjacent arrays are advised in one call, as a table may consist of millions of arrays
+    std::vector<std::pair<const char*, const char*>> ranges;
+    auto advise = [&] {
+        std::sort(ranges.begin(), ranges.end());
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        for (auto& range : ranges) {
+            if (begin && range.first <= end + util::page_size()) {
+                end = std::max(end, range.second);
+                continue;
+            }
+            if (begin)
+                util::madvise(begin, end - begin, advice);
+            begin = range.first;
+            end = range.second;
+        }
+        if (begin)
+            util::madvise(begin, end - begin, advice);
+        ranges.clear();
+    };
+
+    // The tree is walked one level at a time, so that the operating system gets to read all the arrays of a
+    // level at once. The size of an array is only known once its header has been read, so the headers are
+    // advised first. Each ref is paired with whether it refers to a node of the cluster tree itself.
+    std::vector<std::pair<ref_type, bool>> level{{m_root->get_ref(), true}};
+    std::vector<std::pair<ref_type, bool>> next_level;
+    while (!level.empty()) {
+        for (auto& [ref, is_node] : level) {
+            if (auto addr = m_alloc.translate_for_hint(ref))
+                ranges.emplace_back(addr, addr + NodeHeader::header_size);
+        }
+        advise();
+        for (auto& [ref, is_node] : level) {
+            if (auto addr = m_alloc.translate_for_hint(ref))
+                ranges.emplace_back(addr, addr + NodeHeader::get_byte_size_from_header(addr));
+        }
+        advise();
+
+        next_level.clear();
+        for (auto& [ref, is_node] : level) {
+            Array arr(m_alloc);
+            arr.init_from_ref(ref); // Decrypts the array if the file is encrypted
+            if (!arr.has_refs())
+                continue;
+            auto add_child = [&](size_t ndx, bool child_is_node) {
+                RefOrTagged rot = arr.get_as_ref_or_tagged(ndx);
+                if (rot.is_ref() && rot.get_as_ref())
+                    next_level.emplace_back(rot.get_as_ref(), child_is_node);
+            };
+            size_t sz = arr.size();
+            if (!is_node) {
+                for (size_t i = 0; i < sz; ++i)
+                    add_child(i, false);
+            }
+            else if (arr.is_inner_bptree_node()) {
+                add_child(ClusterNodeInner::s_key_ref_index, false);
+                for (size_t i = ClusterNodeInner::s_first_node_index; i < sz; ++i)
+                    add_child(i, true);
+            }
+            else {
+                add_child(Cluster::s_key_ref_or_size_index, false);
+                if (col_key) {
+                    size_t ndx = Cluster::s_first_col_index + col_key.get_index().val;
+                    if (ndx < sz)
+                        add_child(ndx, false);
+                }
+                else {
+                    for (size_t i = Cluster::s_first_col_index; i < sz; ++i)
+                        add_child(i, false);
+                }
+            }
+        }
+        std::swap(level, next_level);
+    }
+}
+
 void ClusterTree::nullify_incoming_links(ObjKey obj_key, CascadeState& state)
 {
     REALM_ASSERT(state.m_group);
@@ -21,6 +21,7 @@
 
 #include <realm/cluster.hpp>
 #include <realm/obj.hpp>
+#include <realm/util/file_mapper.hpp>
 #include <realm/util/function_ref.hpp>
 
 namespace realm {
@@ -129,6 +130,8 @@ public:
 
     // Create and return object
     Obj insert(ObjKey k, const FieldValues& values);
+    // Create objects without updating search indexes or replicating the values
+    void insert_rows(const ClusterRows& rows);
 
     // Lookup and return object
     Obj get(ObjKey k) const
@@ -153,7 +156,10 @@ public:
     }
 
     void clear(CascadeState&);
-    void enumerate_string_column(ColKey col_key);
+    // Returns false and leaves the column unchanged if it holds more than `max_unique_values` different strings
+    bool enumerate_string_column(ColKey col_key, size_t max_unique_values = realm::npos);
+    // Stores the strings of an enumerated column directly in the leaves again
+    void unenumerate_string_column(ColKey col_key);
 
     const Table* get_owning_table() const noexcept
     {
@@ -177,11 +183,28 @@ public:
     // Visit all leaves and call the supplied function. Stop when function returns IteratorControl::Stop.
     // Not allowed to modify the tree
     bool traverse(TraverseFunction func) const;
+    // Location of a leaf, sufficient for creating an accessor for it
+    struct LeafPosition {
+        ref_type ref;
+        uint64_t offset;
+    };
+    // Collect the positions of all leaves in key order
+    std::vector<LeafPosition> get_leaf_positions() const;
+    // Visit the leaves in the range [begin, end) of positions obtained from get_leaf_positions(). Only
+    // local accessors are used, so disjoint ranges may be visited concurrently from different threads
+    // as long as the tree is not modified.
+    bool traverse(TraverseFunction func, const LeafPosition* begin, const LeafPosition* end) const;
     // Visit all leaves and call the supplied function. The function can modify the leaf.
     void update(UpdateFunction func);
 
     void set_spec(ArrayPayload& arr, ColKey::Idx col_ndx) const;
 
+    /// Write the cluster tree at `ref` like Array::write() does, but write the
+    /// leaves of the columns whose leaf index is set in `packed_columns` with
+    /// Array::write_packed().
+    static ref_type write_packed(ref_type ref, Allocator& alloc, _impl::ArrayWriterBase& out,
+                                 const std::vector<bool>& packed_columns);
+
     virtual std::unique_ptr<ClusterNode> get_root_from_parent();
 
     void dump_objects()
@@ -190,6 +213,11 @@ public:
     }
     void verify() const;
 
+    /// Pass `advice` to util::madvise() for the nodes of the tree and the
+    /// leaves of the column `col_key`, or of all columns if `col_key` is not
+    /// set. See Transaction::prefetch().
+    void prefetch(ColKey col_key, util::MemoryAdvice advice) const;
+
 protected:
     friend class Obj;
     friend class Cluster;
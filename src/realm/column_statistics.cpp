@@ -0,0 +1,220 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/column_statistics.hpp>
+
+#include <realm/array.hpp>
+#include <realm/impl/destroy_guard.hpp>
+#include <realm/table.hpp>
+#include <realm/zone_map.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+
+using namespace realm;
+
+namespace {
+
+constexpr size_t header_size = 6;
+
+bool keys_are_ordered(DataType type)
+{
+    return type == type_Bool || ZoneMap::type_supported(type);
+}
+
+} // anonymous namespace
+
+std::optional<int64_t> ColumnStatistics::get_key(Mixed value) const
+{
+    if (value.is_null())
+        return {};
+    if (!m_ordered)
+        return int64_t(value.hash());
+    if (value.is_type(type_Bool))
+        return int64_t(value.get<bool>());
+    if (!ZoneMap::type_supported(value.get_type()))
+        return {};
+    return ZoneMap::encode(value);
+}
+
+ColumnStatistics ColumnStatistics::collect(const Table& table, ColKey col_key)
+{
+    ColumnStatistics stats;
+    stats.m_table_size = table.size();
+    stats.m_ordered = keys_are_ordered(DataType(col_key.get_type()));
+    stats.m_sample_size = std::min(stats.m_table_size, max_sample_size);
+
+    // One object is sampled from each of sample_size equally large ranges of positions, so that values which
+    // correlate with the key order are sampled from all of it. The position within the range is random, so that
+    // values which repeat with some period are not sampled in step with it. The generator is seeded the same way
+    // every time, so that the same content gives the same statistics.
+    std::minstd_rand random;
+    std::vector<int64_t> keys;
+    keys.reserve(stats.m_sample_size);
+    for (size_t i = 0; i < stats.m_sample_size; ++i) {
+        size_t begin = size_t(double(i) * stats.m_table_size / stats.m_sample_size);
+        size_t end = size_t(double(i + 1) * stats.m_table_size / stats.m_sample_size);
+        size_t ndx = begin + random() % (end - begin);
+        Mixed value = table.get_object(ndx).get_any(col_key);
+        if (auto key = stats.get_key(value))
+            keys.push_back(*key);
+        else
+            ++stats.m_null_count;
+    }
+    if (keys.empty())
+        return stats;
+
+    std::map<int64_t, size_t> counts;
+    for (auto key : keys)
+        ++counts[key];
+
+    // Estimate the number of distinct values in the table from the number of values seen once and the number of
+    // values seen more than once (the GEE estimator). Values seen more than once are likely to be all there is,
+    // while each value seen once stands for sqrt(table size / sample size) values.
+    size_t seen_once = 0;
+    for (auto& [key, count] : counts) {
+        if (count == 1)
+            ++seen_once;
+    }
+    double scale = std::sqrt(double(stats.m_table_size) / stats.m_sample_size);
+    stats.m_distinct_count = size_t(scale * seen_once) + (counts.size() - seen_once);
+
+    // The values occurring much more often than the others are estimated by their own frequency
+    std::vector<std::pair<int64_t, size_t>> common_values;
+    for (auto& [key, count] : counts) {
+        if (count > 1 && count * max_histogram_buckets * 2 > keys.size())
+            common_values.emplace_back(key, count);
+    }
+    std::sort(common_values.begin(), common_values.end(), [](auto& a, auto& b) {
+        return a.second > b.second;
+    });
+    if (common_values.size() > max_common_values)
+        common_values.resize(max_common_values);
+    stats.m_common_values = std::move(common_values);
+
+    if (stats.m_ordered && keys.size() > 1) {
+        std::sort(keys.begin(), keys.end());
+        size_t buckets = std::min(max_histogram_buckets, keys.size() - 1);
+        for (size_t i = 0; i <= buckets; ++i) {
+            stats.m_histogram.push_back(keys[i * (keys.size() - 1) / buckets]);
+        }
+    }
+    return stats;
+}
+
+ColumnStatistics ColumnStatistics::read(ref_type ref, Allocator& alloc)
+{
+    Array arr(alloc);
+    arr.init_from_ref(ref);
+    ColumnStatistics stats;
+    stats.m_table_size = size_t(arr.get(0));
+    stats.m_sample_size = size_t(arr.get(1));
+    stats.m_null_count = size_t(arr.get(2));
+    stats.m_distinct_count = size_t(arr.get(3));
+    stats.m_ordered = arr.get(4) != 0;
+    size_t num_common_values = size_t(arr.get(5));
+    size_t ndx = header_size;
+    for (size_t i = 0; i < num_common_values; ++i, ndx += 2) {
+        stats.m_common_values.emplace_back(arr.get(ndx), size_t(arr.get(ndx + 1)));
+    }
+    for (; ndx < arr.size(); ++ndx) {
+        stats.m_histogram.push_back(arr.get(ndx));
+    }
+    return stats;
+}
+
+ref_type ColumnStatistics::write(Allocator& alloc) const
+{
+    Array arr(alloc);
+    arr.create(Array::type_Normal); // Throws
+    _impl::ShallowArrayDestroyGuard dg(&arr);
+    arr.add(int64_t(m_table_size));           // Throws
+    arr.add(int64_t(m_sample_size));          // Throws
+    arr.add(int64_t(m_null_count));           // Throws
+    arr.add(int64_t(m_distinct_count));       // Throws
+    arr.add(int64_t(m_ordered));              // Throws
+    arr.add(int64_t(m_common_values.size())); // Throws
+    for (auto& [key, count] : m_common_values) {
+        arr.add(key);            // Throws
+        arr.add(int64_t(count)); // Throws
+    }
+    for (auto bound : m_histogram) {
+        arr.add(bound); // Throws
+    }
+    dg.release();
+    return arr.get_ref();
+}
+
+double ColumnStatistics::equal_fraction(Mixed value) const
+{
+    auto key = get_key(value);
+    if (!key)
+        return null_fraction();
+    size_t common_count = 0;
+    for (auto& [common_key, count] : m_common_values) {
+        if (common_key == *key)
+            return double(count) / m_sample_size;
+        common_count += count;
+    }
+    // The other values are assumed to be equally frequent
+    size_t other_values = m_distinct_count > m_common_values.size() ? m_distinct_count - m_common_values.size() : 0;
+    if (other_values == 0)
+        return 0;
+    size_t other_count = m_sample_size - m_null_count - common_count;
+    return double(other_count) / m_sample_size / other_values;
+}
+
+double ColumnStatistics::position_in_histogram(int64_t key) const
+{
+    if (key <= m_histogram.front())
+        return 0;
+    if (key >= m_histogram.back())
+        return 1;
+    size_t buckets = m_histogram.size() - 1;
+    // The first bound above the key
+    size_t upper = std::upper_bound(m_histogram.begin(), m_histogram.end(), key) - m_histogram.begin();
+    double lo = double(m_histogram[upper - 1]);
+    double hi = double(m_histogram[upper]);
+    double within = (double(key) - lo) / (hi - lo);
+    return (double(upper - 1) + within) / buckets;
+}
+
+std::optional<double> ColumnStatistics::range_fraction(Mixed from, Mixed to) const
+{
+    if (!m_ordered)
+        return {};
+    if (m_histogram.empty())
+        return m_null_count == m_sample_size ? std::make_optional(0.0) : std::nullopt;
+    double lower = 0;
+    double upper = 1;
+    if (!from.is_null()) {
+        auto key = get_key(from);
+        if (!key)
+            return {};
+        lower = position_in_histogram(*key);
+    }
+    if (!to.is_null()) {
+        auto key = get_key(to);
+        if (!key)
+            return {};
+        upper = position_in_histogram(*key);
+    }
+    return std::max(upper - lower, 0.0) * (1.0 - null_fraction());
+}
@@ -0,0 +1,154 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_COLUMN_STATISTICS_HPP
+#define REALM_COLUMN_STATISTICS_HPP
+
+#include <realm/alloc.hpp>
+#include <realm/keys.hpp>
+#include <realm/mixed.hpp>
+#include <realm/query_conditions.hpp>
+
+#include <optional>
+#include <vector>
+
+/*
+ColumnStatistics describe the values of a column from a sample of at most max_sample_size of its objects, one from
+each of as many equally large ranges of positions. The query engine uses them to estimate the fraction of the objects
+which match a condition before it looks at any of them.
+
+Each sampled value is represented by an integer key. Int, Bool, Timestamp, Float and Double values are represented
+as by ZoneMap::encode() (Bool as 0 and 1), so the keys order like the values, and an equi-depth histogram of the keys
+estimates range conditions. Other values are represented by their hash, which only supports equality. NaN counts
+as null.
+
+They are stored in a single integer array:
+
+    0: number of objects in the table when the sample was taken
+    1: number of objects sampled
+    2: number of sampled nulls
+    3: estimated number of distinct values in the table
+    4: 1 if the keys order like the values
+    5: number of common values (n)
+    6 .. 6 + 2n: key and sampled count of each common value
+    6 + 2n ..: histogram bounds, ascending (none if the keys are not ordered)
+*/
+
+namespace realm {
+
+class Table;
+
+class ColumnStatistics {
+public:
+    static constexpr size_t max_sample_size = 1000;
+    static constexpr size_t max_histogram_buckets = 32;
+    static constexpr size_t max_common_values = 8;
+
+    static bool type_supported(DataType type)
+    {
+        return type == type_Int || type == type_Bool || type == type_String || type == type_Timestamp ||
+               type == type_Float || type == type_Double || type == type_ObjectId || type == type_UUID;
+    }
+
+    /// Sample the values of the column `col_key` of `table`.
+    static ColumnStatistics collect(const Table& table, ColKey col_key);
+    static ColumnStatistics read(ref_type ref, Allocator& alloc);
+    ref_type write(Allocator& alloc) const;
+
+    /// Number of objects in the table when the sample was taken.
+    size_t table_size() const noexcept
+    {
+        return m_table_size;
+    }
+    size_t sample_size() const noexcept
+    {
+        return m_sample_size;
+    }
+    /// Estimated number of different non-null values in the table.
+    size_t distinct_count() const noexcept
+    {
+        return m_distinct_count;
+    }
+    double null_fraction() const noexcept
+    {
+        return m_sample_size ? double(m_null_count) / m_sample_size : 0;
+    }
+
+    /// True if the table has grown or shrunk by more than a quarter since the sample was taken.
+    bool is_stale(size_t table_size) const noexcept
+    {
+        size_t diff = table_size > m_table_size ? table_size - m_table_size : m_table_size - table_size;
+        return diff > m_table_size / 4;
+    }
+
+    /// The estimated fraction of the objects with a value v for which TConditionFunction()(v, value) is true, or
+    /// none if it cannot be estimated. Only Equal and NotEqual, and Greater, GreaterEqual, Less and LessEqual for
+    /// columns whose keys are ordered, are estimated.
+    template <class TConditionFunction>
+    std::optional<double> estimate(Mixed value) const;
+    /// The estimated fraction of the objects with a value in [from, to].
+    std::optional<double> estimate_between(Mixed from, Mixed to) const;
+
+private:
+    std::optional<int64_t> get_key(Mixed value) const;
+    double equal_fraction(Mixed value) const;
+    // Fraction of the sampled non-null values below `key` according to the histogram
+    double position_in_histogram(int64_t key) const;
+    std::optional<double> range_fraction(Mixed from, Mixed to) const;
+
+    size_t m_table_size = 0;
+    size_t m_sample_size = 0;
+    size_t m_null_count = 0;
+    size_t m_distinct_count = 0;
+    bool m_ordered = false;
+    std::vector<std::pair<int64_t, size_t>> m_common_values;
+    std::vector<int64_t> m_histogram;
+};
+
+template <class TConditionFunction>
+std::optional<double> ColumnStatistics::estimate(Mixed value) const
+{
+    if (m_sample_size == 0)
+        return {};
+    if constexpr (std::is_same_v<TConditionFunction, Equal>) {
+        return equal_fraction(value);
+    }
+    else if constexpr (std::is_same_v<TConditionFunction, NotEqual>) {
+        return 1.0 - equal_fraction(value);
+    }
+    else if constexpr (is_any_v<TConditionFunction, Greater, GreaterEqual>) {
+        return value.is_null() ? std::nullopt : range_fraction(value, Mixed());
+    }
+    else if constexpr (is_any_v<TConditionFunction, Less, LessEqual>) {
+        return value.is_null() ? std::nullopt : range_fraction(Mixed(), value);
+    }
+    else {
+        return {};
+    }
+}
+
+inline std::optional<double> ColumnStatistics::estimate_between(Mixed from, Mixed to) const
+{
+    if (m_sample_size == 0)
+        return {};
+    return range_fraction(from, to);
+}
+
+} // namespace realm
+
+#endif // REALM_COLUMN_STATISTICS_HPP
@@ -0,0 +1,245 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/commit_journal.hpp>
+
+#include <realm/disable_sync_to_disk.hpp>
+#include <realm/util/assert.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+
+using namespace realm;
+using namespace realm::util;
+
+namespace {
+
+constexpr uint64_t record_magic = 0x4c4e524a4d4c5552ULL; // "RULMJRNL" in little endian
+
+struct RunHeader {
+    uint64_t ref;
+    uint64_t size;
+};
+
+uint32_t checksum(uint32_t crc, const char* data, size_t size)
+{
+    // crc32() takes the size as an uInt
+    while (size > 0) {
+        uInt chunk = uInt(std::min<size_t>(size, 1 << 30));
+        crc = uint32_t(crc32(crc, reinterpret_cast<const Bytef*>(data), chunk));
+        data += chunk;
+        size -= chunk;
+    }
+    return crc;
+}
+
+std::string journal_path(const std::string& realm_path, int index)
+{
+    return realm_path + ".journal." + std::to_string(index);
+}
+
+} // anonymous namespace
+
+struct CommitJournal::RecordHeader {
+    uint64_t magic;
+    uint64_t version;
+    uint64_t prev_top_ref;
+    uint64_t top_ref;
+    uint64_t logical_file_size;
+    uint32_t file_format_version;
+    uint32_t checksum; // Of the header with this field set to zero, and the body
+    uint64_t body_size;
+};
+
+void CommitJournal::Record::add(ref_type ref, const char* data, size_t size)
+{
+    if (m_buffer.empty())
+        m_buffer.resize(sizeof(RecordHeader));
+    if (m_last_run) {
+        RunHeader run;
+        memcpy(&run, m_buffer.data() + m_last_run, sizeof run);
+        if (run.ref + run.size == ref) {
+            run.size += size;
+            memcpy(m_buffer.data() + m_last_run, &run, sizeof run);
+            m_buffer.insert(m_buffer.end(), data, data + size);
+            return;
+        }
+    }
+    RunHeader run{uint64_t(ref), uint64_t(size)};
+    m_last_run = m_buffer.size();
+    m_buffer.insert(m_buffer.end(), reinterpret_cast<const char*>(&run), reinterpret_cast<const char*>(&run + 1));
+    m_buffer.insert(m_buffer.end(), data, data + size);
+}
+
+void CommitJournal::Record::finish(uint64_t version, ref_type prev_top_ref, ref_type top_ref,
+                                   size_t logical_file_size, int file_format_version)
+{
+    if (m_buffer.empty())
+        m_buffer.resize(sizeof(RecordHeader));
+    RecordHeader header;
+    header.magic = record_magic;
+    header.version = version;
+    header.prev_top_ref = uint64_t(prev_top_ref);
+    header.top_ref = uint64_t(top_ref);
+    header.logical_file_size = uint64_t(logical_file_size);
+    header.file_format_version = uint32_t(file_format_version);
+    header.checksum = 0;
+    header.body_size = uint64_t(m_buffer.size() - sizeof(RecordHeader));
+    uint32_t crc = checksum(0, reinterpret_cast<const char*>(&header), sizeof header);
+    header.checksum = checksum(crc, m_buffer.data() + sizeof header, m_buffer.size() - sizeof header);
+    memcpy(m_buffer.data(), &header, sizeof header);
+    m_last_run = 0;
+}
+
+void CommitJournal::Record::clear() noexcept
+{
+    m_buffer.clear();
+    m_last_run = 0;
+}
+
+CommitJournal::CommitJournal(const std::string& realm_path)
+{
+    for (int i = 0; i < 2; ++i)
+        m_files[i].open(journal_path(realm_path, i), File::access_ReadWrite, File::create_Auto, 0); // Throws
+}
+
+void CommitJournal::append(int index, uint64_t offset, const Record& record)
+{
+    REALM_ASSERT(index == 0 || index == 1);
+    m_files[index].write(File::SizeType(offset), record.data(), record.size()); // Throws
+}
+
+void CommitJournal::sync(int index)
+{
+    if (!get_disable_sync_to_disk())
+        m_files[index].sync(); // Throws
+}
+
+void CommitJournal::clear(int index)
+{
+    // Truncation is enough, as a record is only valid if its checksum matches
+    m_files[index].resize(0); // Throws
+    sync(index);              // Throws
+}
+
+bool CommitJournal::is_empty(int index)
+{
+    return m_files[index].get_size() == 0; // Throws
+}
+
+bool CommitJournal::read_record(int index, uint64_t offset, std::vector<char>& buffer)
+{
+    File& file = m_files[index];
+    uint64_t file_size = uint64_t(file.get_size()); // Throws
+    RecordHeader header;
+    if (offset + sizeof header > file_size)
+        return false;
+    if (file.read(File::SizeType(offset), reinterpret_cast<char*>(&header), sizeof header) < sizeof header)
+        return false;
+    if (header.magic != record_magic || header.body_size > file_size - offset - sizeof header)
+        return false;
+    buffer.resize(sizeof header + size_t(header.body_size));
+    if (file.read(File::SizeType(offset + sizeof header), buffer.data() + sizeof header, size_t(header.body_size)) <
+        header.body_size)
+        return false;
+    uint32_t expected = header.checksum;
+    header.checksum = 0;
+    uint32_t crc = checksum(0, reinterpret_cast<const char*>(&header), sizeof header);
+    if (checksum(crc, buffer.data() + sizeof header, size_t(header.body_size)) != expected)
+        return false;
+    header.checksum = expected;
+    memcpy(buffer.data(), &header, sizeof header);
+    return true;
+}
+
+void CommitJournal::for_each_record(int index, std::vector<char>& buffer,
+                                    FunctionRef<void(const RecordHeader&, uint64_t offset)> fn)
+{
+    // A record which is incomplete or was overwritten only partially ends the
+    // journal, as nothing after it can have been synchronized.
+    uint64_t offset = 0;
+    while (read_record(index, offset, buffer)) {
+        RecordHeader header;
+        memcpy(&header, buffer.data(), sizeof header);
+        fn(header, offset);
+        offset += sizeof header + header.body_size;
+    }
+}
+
+size_t CommitJournal::recover(uint64_t version, ref_type top_ref, File& realm_file, RecoveredVersion& last)
+{
+    struct Entry {
+        uint64_t version;
+        uint64_t prev_top_ref;
+        int index;
+        uint64_t offset;
+    };
+    std::vector<Entry> entries;
+    std::vector<char> buffer;
+    for (int i = 0; i < 2; ++i) {
+        for_each_record(i, buffer, [&](const RecordHeader& header, uint64_t offset) {
+            if (header.version > version)
+                entries.push_back({header.version, header.prev_top_ref, i, offset});
+        });
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.version < b.version;
+    });
+
+    size_t num_recovered = 0;
+    uint64_t next_version = version + 1;
+    uint64_t prev_top_ref = uint64_t(top_ref);
+    for (auto& entry : entries) {
+        if (entry.version > next_version)
+            break;
+        // A journal which could not be emptied may hold stale records of a
+        // version which was made again on top of a different one
+        if (entry.version < next_version || entry.prev_top_ref != prev_top_ref)
+            continue;
+        bool complete = read_record(entry.index, entry.offset, buffer); // Throws
+        REALM_ASSERT(complete);
+        RecordHeader header;
+        memcpy(&header, buffer.data(), sizeof header);
+        if (uint64_t(realm_file.get_size()) < header.logical_file_size)
+            realm_file.resize(File::SizeType(header.logical_file_size)); // Throws
+        const char* p = buffer.data() + sizeof header;
+        const char* end = p + header.body_size;
+        while (p < end) {
+            RunHeader run;
+            memcpy(&run, p, sizeof run);
+            p += sizeof run;
+            realm_file.write(File::SizeType(run.ref), p, size_t(run.size)); // Throws
+            p += run.size;
+        }
+        last.version = header.version;
+        last.top_ref = ref_type(header.top_ref);
+        last.logical_file_size = size_t(header.logical_file_size);
+        last.file_format_version = int(header.file_format_version);
+        prev_top_ref = header.top_ref;
+        ++next_version;
+        ++num_recovered;
+    }
+    return num_recovered;
+}
+
+void CommitJournal::remove_files(const std::string& realm_path)
+{
+    for (int i = 0; i < 2; ++i)
+        File::try_remove(journal_path(realm_path, i));
+}
@@ -0,0 +1,122 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_COMMIT_JOURNAL_HPP
+#define REALM_COMMIT_JOURNAL_HPP
+
+#include <realm/alloc.hpp>
+#include <realm/util/file.hpp>
+#include <realm/util/function_ref.hpp>
+
+#include <string>
+#include <vector>
+
+/*
+With a commit journal (see DBOptions::commit_journal), a commit does not synchronize the parts of the Realm file it
+has written, nor does it update the file header. Instead the arrays written by the commit are appended to a journal
+file as a single record, and only the journal is synchronized:
+
+    record header: magic, version, top ref of the previous version, top ref, logical file size,
+                   file format version, body size, checksum
+    body:          (ref, size, bytes) for each run of adjacent arrays written by the commit
+
+There are two journal files. New records are appended to the active one. A checkpoint makes the other one active,
+commits the newest version recorded in the previous one to the file header (which synchronizes the entire Realm
+file), and then empties the previous journal.
+
+When a session begins, the records following the version referenced by the file header are written to the Realm
+file again, and the last of them is committed to the header. A version is recovered only if the records of all
+versions since the one referenced by the header are complete, and each of them was made on top of the previous one.
+A commit only writes to space which is not reachable from the previous version, so the Realm file always holds a
+consistent snapshot of the version recovered, no matter which parts of later commits reached the disk.
+*/
+
+namespace realm {
+
+class CommitJournal {
+public:
+    /// The changes made to the Realm file by a commit.
+    class Record {
+    public:
+        /// Add an array written at `ref`. Adjacent arrays are merged.
+        void add(ref_type ref, const char* data, size_t size);
+        /// Complete the record. No arrays can be added after this.
+        void finish(uint64_t version, ref_type prev_top_ref, ref_type top_ref, size_t logical_file_size,
+                    int file_format_version);
+        void clear() noexcept;
+
+        const char* data() const noexcept
+        {
+            return m_buffer.data();
+        }
+        size_t size() const noexcept
+        {
+            return m_buffer.size();
+        }
+
+    private:
+        std::vector<char> m_buffer;
+        size_t m_last_run = 0; // Offset of the header of the last run in m_buffer, or 0 if none
+    };
+
+    /// Open (creating them if needed) the two journal files of the Realm file
+    /// at `realm_path`.
+    explicit CommitJournal(const std::string& realm_path);
+
+    /// Append a record to the journal file `index` at `offset`.
+    void append(int index, uint64_t offset, const Record& record);
+    /// Synchronize the journal file `index` to disk.
+    void sync(int index);
+    /// Discard all records of the journal file `index`.
+    void clear(int index);
+    bool is_empty(int index);
+
+    struct RecoveredVersion {
+        uint64_t version;
+        ref_type top_ref;
+        size_t logical_file_size;
+        int file_format_version;
+    };
+
+    /// Write the records of the versions following `version`, whose top ref
+    /// is `top_ref`, to `realm_file` in order, stopping at the first version
+    /// which is missing or incomplete. Returns the number of versions
+    /// recovered, and the last of them in `last`. The file header is not
+    /// updated.
+    size_t recover(uint64_t version, ref_type top_ref, util::File& realm_file, RecoveredVersion& last);
+
+    /// Remove the journal files of the Realm file at `realm_path`, if they
+    /// exist.
+    static void remove_files(const std::string& realm_path);
+
+private:
+    struct RecordHeader;
+    util::File m_files[2];
+
+    // Call `fn` for each complete record in the journal file `index`, with
+    // its body read into `buffer`
+    void for_each_record(int index, std::vector<char>& buffer,
+                         util::FunctionRef<void(const RecordHeader&, uint64_t offset)> fn);
+    // Read the record at `offset` of the journal file `index` into `buffer`,
+    // returning false if it is not complete
+    bool read_record(int index, uint64_t offset, std::vector<char>& buffer);
+};
+
+} // namespace realm
+
+#endif // REALM_COMMIT_JOURNAL_HPP
@@ -32,6 +32,8 @@
 #include <chrono>
 #include <condition_variable>
 
+#include <realm/commit_journal.hpp>
+#include <realm/db_metrics.hpp>
 #include <realm/disable_sync_to_disk.hpp>
 #include <realm/group_writer.hpp>
 #include <realm/impl/simulated_failure.hpp>
@@ -39,9 +41,11 @@
 #include <realm/util/errno.hpp>
 #include <realm/util/features.h>
 #include <realm/util/file_mapper.hpp>
+#include <realm/util/io_uring_writer.hpp>
 #include <realm/util/safe_int_ops.hpp>
 #include <realm/util/scope_exit.hpp>
 #include <realm/util/thread.hpp>
+#include <realm/util/thread_pool.hpp>
 #include <realm/util/to_string.hpp>
 
 #ifndef _WIN32
@@ -80,22 +84,35 @@ namespace {
 //         with a lock.
 // 13      New impl of VersionList and added mutex for it (former RingBuffer)
 // 14      Added field for tracking ongoing encrypted writes
-const uint_fast16_t g_shared_info_version = 14;
+// 15      Added mutex and fields for group commit
+// 16      Added fields for the commit journal
+// 17      Read locks are taken without the versionlist mutex, using atomic
+//         counts and a pin count in each VersionList entry
+const uint_fast16_t g_shared_info_version = 17;
 
 
 struct VersionList {
     // the VersionList is an array of ReadCount structures.
     // it is placed in the "lock-file" and accessed via memory mapping
+    //
+    // Entries are added and freed by writers holding the versionlist mutex,
+    // but read locks are taken and released without it. To take a read lock,
+    // a reader first pins the entry, which prevents it from being freed, then
+    // validates that it still holds the wanted version, and increments the
+    // count for the type of lock. purge_versions() only frees an entry after
+    // having marked it as being freed, which makes further attempts to pin it
+    // fail.
     struct ReadCount {
-        uint64_t version;
+        std::atomic<uint64_t> version;
         uint64_t filesize;
         uint64_t current_top;
-        uint32_t count_live;
-        uint32_t count_frozen;
-        uint32_t count_full;
+        std::atomic<uint32_t> count_live;
+        std::atomic<uint32_t> count_frozen;
+        std::atomic<uint32_t> count_full;
+        std::atomic<uint32_t> pins;
         bool is_active()
         {
-            return version != 0;
+            return version.load(std::memory_order_acquire) != 0;
         }
         void deactivate()
         {
@@ -104,14 +121,44 @@ struct VersionList {
         }
         void activate(uint64_t v)
         {
-            version = v;
+            // Publishes current_top and filesize to readers which have pinned the entry
+            version.store(v, std::memory_order_release);
+        }
+        // Fails if the entry is being freed
+        bool try_pin() noexcept
+        {
+            uint32_t p = pins.load(std::memory_order_relaxed);
+            do {
+                if (p & being_freed)
+                    return false;
+            } while (!pins.compare_exchange_weak(p, p + 1, std::memory_order_acquire, std::memory_order_relaxed));
+            return true;
+        }
+        void unpin() noexcept
+        {
+            pins.fetch_sub(1, std::memory_order_release);
+        }
+        // Fails if the entry is pinned
+        bool try_lock_for_freeing() noexcept
+        {
+            uint32_t p = 0;
+            return pins.compare_exchange_strong(p, being_freed, std::memory_order_acquire,
+                                                std::memory_order_relaxed);
         }
+        void unlock_for_freeing() noexcept
+        {
+            pins.store(0, std::memory_order_release);
+        }
+        constexpr static uint32_t being_freed = 0x80000000;
     };
+    static_assert(std::atomic<uint32_t>::is_always_lock_free);
 
     void reserve(uint32_t size) noexcept
     {
-        for (auto i = entries; i < size; ++i)
+        for (auto i = entries; i < size; ++i) {
             data()[i].deactivate();
+            data()[i].pins = 0;
+        }
         if (size > entries) {
             // Fence preventing downward motion of above writes
             std::atomic_signal_fence(std::memory_order_release);
@@ -213,6 +260,16 @@ struct VersionList {
         if (auto a = allocating.load(); a != index_of_newest) {
             data()[a].deactivate();
         }
+        // Lock all entries but the newest against new read locks. The counts of a locked entry can only
+        // decrease. An entry which is pinned by a reader about to take a read lock is kept as if it was live.
+        std::vector<bool> locked(entries);
+        for (auto* rc = data(); rc < data() + entries; ++rc) {
+            if (rc->is_active() && index_of(*rc) != index_of_newest)
+                locked[index_of(*rc)] = rc->try_lock_for_freeing();
+        }
+        auto is_live = [&](ReadCount* rc) {
+            return rc->count_live || (!locked[index_of(*rc)] && index_of(*rc) != index_of_newest);
+        };
         // determine fully locked versions - after one of those all versions are considered live.
         for (auto* rc = data(); rc < data() + entries; ++rc) {
             if (!rc->is_active())
@@ -224,16 +281,19 @@ struct VersionList {
         }
         // collect reachable versions and determine oldest live reachable version
         // (oldest reachable version is the first entry in the top_refs map, so no need to find it explicitly)
+        std::vector<bool> reachable(entries);
         for (auto* rc = data(); rc < data() + entries; ++rc) {
             if (!rc->is_active())
                 continue;
-            if (rc->count_frozen || rc->count_live || rc->version >= oldest_full_v) {
+            uint64_t version = rc->version;
+            if (rc->count_frozen || is_live(rc) || version >= oldest_full_v || index_of(*rc) == index_of_newest) {
                 // entry is still reachable
-                top_refs.emplace(rc->version, VersionInfo{to_ref(rc->current_top), to_ref(rc->filesize)});
+                reachable[index_of(*rc)] = true;
+                top_refs.emplace(version, VersionInfo{to_ref(rc->current_top), to_ref(rc->filesize)});
             }
-            if (rc->count_live || rc->version >= oldest_full_v) {
-                if (rc->version < oldest_live_v)
-                    oldest_live_v = rc->version;
+            if (is_live(rc) || version >= oldest_full_v) {
+                if (version < oldest_live_v)
+                    oldest_live_v = version;
             }
         }
         // we must have found at least one reachable version
@@ -241,9 +301,9 @@ struct VersionList {
         // free unreachable entries and determine if we want to trigger backdating
         uint64_t oldest_v = top_refs.begin()->first;
         for (auto* rc = data(); rc < data() + entries; ++rc) {
-            if (!rc->is_active())
+            if (!locked[index_of(*rc)])
                 continue;
-            if (rc->count_frozen == 0 && rc->count_live == 0 && rc->version < oldest_full_v) {
+            if (!reachable[index_of(*rc)]) {
                 // entry is becoming unreachable.
                 // if it is also younger than a reachable version, then set 'any_new_unreachables' to trigger
                 // backdating
@@ -253,6 +313,7 @@ struct VersionList {
                 REALM_ASSERT(index_of(*rc) != index_of_newest);
                 free_entry(rc);
             }
+            rc->unlock_for_freeing();
         }
         REALM_ASSERT(oldest_v != std::numeric_limits<uint64_t>::max());
         REALM_ASSERT(oldest_live_v != std::numeric_limits<uint64_t>::max());
@@ -263,8 +324,8 @@ struct VersionList {
     {
         util::format(std::cout, "VersionList has %1 entries: \n", entries);
         for (auto* rc = data(); rc < data() + entries; ++rc) {
-            util::format(std::cout, "[%1]: version %2, live: %3, full: %4, frozen: %5\n", index_of(*rc), rc->version,
-                         rc->count_live, rc->count_full, rc->count_frozen);
+            util::format(std::cout, "[%1]: version %2, live: %3, full: %4, frozen: %5\n", index_of(*rc),
+                         rc->version.load(), rc->count_live.load(), rc->count_full.load(), rc->count_frozen.load());
         }
     }
 #endif // REALM_DEBUG
@@ -306,6 +367,19 @@ TransactionRef make_transaction_ref(Args&&... args)
     return TransactionRef(new Transaction(std::forward<Args>(args)...), TransactionDeleter);
 }
 
+util::MemoryAdvice to_memory_advice(DBOptions::AccessPattern pattern) noexcept
+{
+    switch (pattern) {
+        case DBOptions::AccessPattern::Sequential:
+            return util::MemoryAdvice::Sequential;
+        case DBOptions::AccessPattern::Random:
+            return util::MemoryAdvice::Random;
+        case DBOptions::AccessPattern::Normal:
+            break;
+    }
+    return util::MemoryAdvice::Normal;
+}
+
 } // anonymous namespace
 
 namespace realm {
@@ -439,6 +513,28 @@ struct alignas(8) DB::SharedInfo {
     std::atomic<uint64_t> writing_page_offset;
     std::atomic<uint64_t> write_counter;
 
+    /// Only used in group commit mode (see DBOptions::group_commit) and with
+    /// a commit journal, where the file header is only updated while holding
+    /// the syncmutex.
+    /// `durable_version` is the version whose top ref was last written to the
+    /// file header. A read lock on its VersionList entry at
+    /// `durable_reader_idx` is held on behalf of the session, so that its
+    /// space is not reused before a later version has become durable. Both
+    /// are guarded by the syncmutex, but `durable_version` may be read without
+    /// it.
+    InterprocessMutex::SharedPart shared_syncmutex;
+    std::atomic<uint64_t> durable_version = 0;
+    uint32_t durable_reader_idx = 0;
+    uint8_t group_commit = 0;
+
+    /// Only used with a commit journal (see DBOptions::commit_journal).
+    /// `journal_active` is the index of the journal file that commits are
+    /// appended to, and `journal_size` the size of the records in it. Both
+    /// are guarded by the write mutex.
+    uint8_t commit_journal = 0;
+    uint8_t journal_active = 0;
+    uint64_t journal_size = 0;
+
     // IMPORTANT: The VersionList MUST be the last field in SharedInfo - see above.
     VersionList readers;
 
@@ -560,11 +656,15 @@ public:
             }
         }
 
-        std::lock_guard lock(m_mutex);
         util::CheckedLockGuard info_lock(m_info_mutex);
-        auto index = m_info->readers.newest.load();
-        ensure_reader_mapping(index);
-        return {m_info->readers.get(index).version, index};
+        for (;;) {
+            auto index = m_info->readers.newest.load(std::memory_order_acquire);
+            ensure_reader_mapping(index);
+            uint64_t version = m_info->readers.get(index).version.load(std::memory_order_acquire);
+            // The entry may have been freed and reused if newer versions were added meanwhile
+            if (version != 0 && m_info->readers.newest.load(std::memory_order_acquire) == index)
+                return {version, index};
+        }
     }
 
     void release_read_lock(const ReadLockInfo& read_lock) REQUIRES(!m_local_readers_mutex, !m_info_mutex)
@@ -581,7 +681,6 @@ public:
                 r.version = 0;
         }
 
-        std::lock_guard lock(m_mutex);
         util::CheckedLockGuard info_lock(m_info_mutex);
         // we should not need to call ensure_full_reader_mapping,
         // since releasing a read lock means it has been grabbed
@@ -592,6 +691,24 @@ public:
         --field_for_type(r, read_lock.m_type);
     }
 
+    // A frozen read lock on the newest version which is not tracked by the
+    // local cache, so that it may be released by any session participant.
+    // It keeps the space of the version from being reused, but unlike a live
+    // read lock it does not hold back the trimming of the history.
+    ReadLockInfo grab_shared_read_lock() REQUIRES(!m_info_mutex)
+    {
+        return grab_version_list_entry(ReadLockInfo::Frozen, VersionID());
+    }
+
+    void release_shared_read_lock(const ReadLockInfo& read_lock) REQUIRES(!m_info_mutex)
+    {
+        util::CheckedLockGuard info_lock(m_info_mutex);
+        ensure_reader_mapping((unsigned int)read_lock.m_reader_idx);
+        auto& r = m_info->readers.get(read_lock.m_reader_idx);
+        REALM_ASSERT(read_lock.m_version == r.version);
+        --field_for_type(r, read_lock.m_type);
+    }
+
     ReadLockInfo grab_read_lock(ReadLockInfo::Type type, VersionID version_id = {})
         REQUIRES(!m_local_readers_mutex, !m_info_mutex)
     {
@@ -600,24 +717,12 @@ public:
             return read_lock;
 
         {
-            const bool pick_specific = version_id.version != VersionID().version;
-            std::lock_guard lock(m_mutex);
-            util::CheckedLockGuard info_lock(m_info_mutex);
-            auto newest = m_info->readers.newest.load();
-            REALM_ASSERT(newest != VersionList::nil);
-            read_lock.m_reader_idx = pick_specific ? version_id.index : newest;
-            ensure_reader_mapping((unsigned int)read_lock.m_reader_idx);
-            bool picked_newest = read_lock.m_reader_idx == (unsigned)newest;
-            auto& r = m_info->readers.get(read_lock.m_reader_idx);
-            if (pick_specific && version_id.version != r.version)
-                throw BadVersion(version_id.version);
-            if (!picked_newest) {
-                if (type == ReadLockInfo::Frozen && r.count_frozen == 0 && r.count_live == 0)
-                    throw BadVersion(version_id.version);
-                if (type != ReadLockInfo::Frozen && r.count_live == 0)
-                    throw BadVersion(version_id.version);
-            }
-            populate_read_lock(read_lock, r, type);
+            // A full read lock makes all later versions reachable, so it must
+            // not be taken while purge_versions() decides which ones to free
+            std::unique_lock<util::InterprocessMutex> lock(m_mutex, std::defer_lock);
+            if (type == ReadLockInfo::Full)
+                lock.lock();
+            read_lock = grab_version_list_entry(type, version_id); // Throws
         }
 
         {
@@ -664,13 +769,76 @@ public:
 
 
 private:
+    // The read locks held through this VersionManager. Only the first read lock
+    // of each type on a version is counted in the VersionList.
+    struct LocalReadCount {
+        uint64_t version = 0;
+        uint64_t filesize = 0;
+        uint64_t current_top = 0;
+        uint32_t count_live = 0;
+        uint32_t count_frozen = 0;
+        uint32_t count_full = 0;
+        bool is_active() const noexcept
+        {
+            return version != 0;
+        }
+    };
+
     void grow_local_cache(size_t new_size) REQUIRES(m_local_readers_mutex)
     {
         if (new_size > m_local_readers.size())
-            m_local_readers.resize(new_size, VersionList::ReadCount{});
+            m_local_readers.resize(new_size);
+    }
+
+    // Take a read lock on the newest version, or the one specified, in the
+    // VersionList without holding the versionlist mutex. See VersionList::ReadCount.
+    ReadLockInfo grab_version_list_entry(ReadLockInfo::Type type, VersionID version_id) REQUIRES(!m_info_mutex)
+    {
+        const bool pick_specific = version_id.version != VersionID().version;
+        util::CheckedLockGuard info_lock(m_info_mutex);
+        for (;;) {
+            auto newest = m_info->readers.newest.load(std::memory_order_acquire);
+            REALM_ASSERT(newest != VersionList::nil);
+            auto index = pick_specific ? version_id.index : newest;
+            ensure_reader_mapping((unsigned int)index);
+            auto& r = m_info->readers.get(index);
+            if (!r.try_pin()) {
+                // The entry is being freed
+                if (pick_specific)
+                    throw BadVersion(version_id.version);
+                continue;
+            }
+            bool picked_newest = m_info->readers.newest.load(std::memory_order_acquire) == index;
+            uint64_t version = r.version.load(std::memory_order_acquire);
+            bool valid = true;
+            if (pick_specific) {
+                valid = version == version_id.version;
+                if (valid && !picked_newest) {
+                    if (type == ReadLockInfo::Frozen)
+                        valid = r.count_frozen != 0 || r.count_live != 0;
+                    else
+                        valid = r.count_live != 0;
+                }
+            }
+            else if (!picked_newest) {
+                // A newer version was added before the entry was pinned
+                r.unpin();
+                continue;
+            }
+            if (!valid) {
+                r.unpin();
+                throw BadVersion(version_id.version);
+            }
+            ReadLockInfo read_lock;
+            read_lock.m_reader_idx = index;
+            populate_read_lock(read_lock, r, type);
+            r.unpin();
+            return read_lock;
+        }
     }
 
-    void populate_read_lock(ReadLockInfo& read_lock, VersionList::ReadCount& r, ReadLockInfo::Type type)
+    template <class T>
+    void populate_read_lock(ReadLockInfo& read_lock, T& r, ReadLockInfo::Type type)
     {
         ++field_for_type(r, type);
         read_lock.m_type = type;
@@ -705,7 +873,8 @@ private:
         return true;
     }
 
-    static uint32_t& field_for_type(VersionList::ReadCount& r, ReadLockInfo::Type type)
+    template <class T>
+    static decltype(T::count_live)& field_for_type(T& r, ReadLockInfo::Type type)
     {
         switch (type) {
             case ReadLockInfo::Frozen:
@@ -750,7 +919,7 @@ private:
 protected:
     util::InterprocessMutex& m_mutex;
     util::CheckedMutex m_local_readers_mutex;
-    std::vector<VersionList::ReadCount> m_local_readers GUARDED_BY(m_local_readers_mutex);
+    std::vector<LocalReadCount> m_local_readers GUARDED_BY(m_local_readers_mutex);
 
     util::CheckedMutex m_info_mutex;
     unsigned int m_local_max_entry GUARDED_BY(m_info_mutex) = 0;
@@ -935,6 +1104,14 @@ void DB::open(const std::string& path, const DBOptions& options)
     std::string coordination_dir = get_core_file(path, CoreFileType::Management);
     std::string lockfile_prefix = coordination_dir + "/access_control";
     m_alloc.set_read_only(false);
+    bool commit_journal =
+        options.commit_journal && options.durability == Durability::Full && !options.encryption_key;
+    bool group_commit = !commit_journal && options.group_commit && options.durability == Durability::Full &&
+                        !options.encryption_key;
+    if (commit_journal) {
+        m_journal = std::make_unique<CommitJournal>(path); // Throws
+        m_journal_checkpoint_size = options.journal_checkpoint_size;
+    }
 
     Replication::HistoryType openers_hist_type = Replication::hist_None;
     int openers_hist_schema_version = 0;
@@ -1114,6 +1291,8 @@ void DB::open(const std::string& path, const DBOptions& options)
         m_writemutex.set_shared_part(info->shared_writemutex, lockfile_prefix, "write");
         m_controlmutex.set_shared_part(info->shared_controlmutex, lockfile_prefix, "control");
         m_versionlist_mutex.set_shared_part(info->shared_versionlist_mutex, lockfile_prefix, "versions");
+        if (group_commit || commit_journal)
+            m_syncmutex.set_shared_part(info->shared_syncmutex, lockfile_prefix, "sync");
 
         // even though fields match wrt alignment and size, there may still be incompatibilities
         // between implementations, so lets ask one of the mutexes if it thinks it'll work.
@@ -1156,6 +1335,8 @@ void DB::open(const std::string& path, const DBOptions& options)
             cfg.clear_file = (options.durability == Durability::MemOnly && begin_new_session);
 
             cfg.encryption_key = options.encryption_key;
+            cfg.access_advice = to_memory_advice(options.access_pattern);
+            cfg.huge_pages = options.use_huge_pages;
             m_marker_observer = std::make_unique<EncryptionMarkerObserver>(*version_manager);
             try {
                 top_ref = alloc.attach_file(path, cfg, m_marker_observer.get()); // Throws
@@ -1298,6 +1479,44 @@ void DB::open(const std::string& path, const DBOptions& options)
                 }
 
                 alloc.convert_from_streaming_form(top_ref);
+                if (commit_journal || alloc.depends_on_journal()) {
+                    // Commits of the previous session which were not checkpointed. They are
+                    // recovered even if this session does not use the journal.
+                    std::unique_ptr<CommitJournal> recovery_journal;
+                    CommitJournal* journal = m_journal.get();
+                    if (!journal) {
+                        recovery_journal = std::make_unique<CommitJournal>(path); // Throws
+                        journal = recovery_journal.get();
+                    }
+                    CommitJournal::RecoveredVersion last;
+                    if (size_t n = journal->recover(version, top_ref, alloc.get_file(), last)) { // Throws
+                        GroupCommitter cm(alloc, last.file_format_version, Durability::Full,
+                                          m_marker_observer.get());
+                        cm.commit(last.top_ref); // Throws
+                        if (m_logger) {
+                            m_logger->log(util::Logger::Level::info,
+                                          "Recovered versions %1 to %2 from the commit journal", version + 1,
+                                          last.version);
+                        }
+                        REALM_ASSERT(last.version == version + n);
+                        // Start over with the recovered version
+                        continue;
+                    }
+                    journal->clear(0); // Throws
+                    journal->clear(1); // Throws
+                    if (alloc.depends_on_journal() != commit_journal) {
+                        // With the journal, the header is only updated by checkpoints, so a
+                        // session opening the file must recover the later versions first
+                        GroupCommitter cm(alloc, current_file_format_version, Durability::Full,
+                                          m_marker_observer.get());
+                        cm.set_depends_on_journal(commit_journal);
+                        cm.commit(top_ref); // Throws
+                    }
+                    if (!commit_journal) {
+                        recovery_journal.reset();
+                        CommitJournal::remove_files(path); // Throws
+                    }
+                }
                 try {
                     bool file_changed_size = alloc.align_filesize_for_mmap(top_ref, cfg);
                     if (file_changed_size) {
@@ -1335,6 +1554,17 @@ void DB::open(const std::string& path, const DBOptions& options)
                     file_size = Group::get_logical_file_size(top);
                 }
                 version_manager->init_versioning(top_ref, file_size, version);
+
+                info->commit_journal = commit_journal;
+                info->journal_active = 0;
+                info->journal_size = 0;
+                info->group_commit = group_commit;
+                if (group_commit || commit_journal) {
+                    // The initial version is the one referenced by the file header
+                    ReadLockInfo durable = version_manager->grab_shared_read_lock();
+                    info->durable_version = durable.m_version;
+                    info->durable_reader_idx = uint32_t(durable.m_reader_idx);
+                }
             }
             else { // Not the session initiator
                 // Durability setting must be consistent across a session. An
@@ -1344,6 +1574,13 @@ void DB::open(const std::string& path, const DBOptions& options)
                 if (Durability(info->durability) != options.durability)
                     throw RuntimeError(ErrorCodes::IncompatibleSession, "Durability not consistent");
 
+                // Only writers in group commit mode leave the update of the
+                // file header to whoever makes the next version durable.
+                if (bool(info->group_commit) != group_commit)
+                    throw RuntimeError(ErrorCodes::IncompatibleSession, "Group commit not consistent");
+                if (bool(info->commit_journal) != commit_journal)
+                    throw RuntimeError(ErrorCodes::IncompatibleSession, "Commit journal not consistent");
+
                 // History type must be consistent across a session. An
                 // inconsistency is a logic error, as the user is required to
                 // make sure that all possible concurrent session participants
@@ -1397,6 +1634,14 @@ void DB::open(const std::string& path, const DBOptions& options)
             // make our presence noted:
             ++info->num_participants;
             m_info = info;
+            m_group_commit = group_commit;
+            if (options.use_io_uring && !options.encryption_key) {
+                m_io_uring = util::IoUringWriter::create(alloc.get_file()); // Throws
+                if (!m_io_uring && m_logger) {
+                    m_logger->log(util::Logger::Level::detail,
+                                  "io_uring is not available, writing through the memory mappings");
+                }
+            }
 
             // Keep the mappings and file open:
             m_version_manager = std::move(version_manager);
@@ -1641,6 +1886,11 @@ bool DB::compact(bool bump_version_number, std::optional<const char*> output_enc
     }
 #endif
     {
+        // In group commit mode, or with a commit journal, the file header must not be
+        // updated while the file is replaced
+        std::unique_lock<InterprocessMutex> sync_lock(m_syncmutex, std::defer_lock);
+        if (m_group_commit || m_journal)
+            sync_lock.lock();                                     // Throws
         std::unique_lock<InterprocessMutex> lock(m_controlmutex); // Throws
         auto t1 = std::chrono::steady_clock::now();
 
@@ -1695,6 +1945,8 @@ bool DB::compact(bool bump_version_number, std::optional<const char*> output_enc
         // When someone attaches to the new database file, they *must* *not* see and
         // reuse any existing memory mapping of the stale file.
         tr->close_read_with_lock();
+        bool use_io_uring = bool(m_io_uring);
+        m_io_uring.reset();
         m_alloc.detach();
 
         util::File::move(tmp_path, m_db_path);
@@ -1710,6 +1962,8 @@ bool DB::compact(bool bump_version_number, std::optional<const char*> output_enc
         ref_type top_ref;
         top_ref = m_alloc.attach_file(m_db_path, cfg, m_marker_observer.get());
         m_alloc.convert_from_streaming_form(top_ref);
+        if (use_io_uring)
+            m_io_uring = util::IoUringWriter::create(m_alloc.get_file()); // Throws
         m_alloc.init_mapping_management(info->latest_version_number);
         info->number_of_versions = 1;
         size_t logical_file_size = sizeof(SlabAlloc::Header);
@@ -1719,6 +1973,21 @@ bool DB::compact(bool bump_version_number, std::optional<const char*> output_enc
             logical_file_size = Group::get_logical_file_size(top);
         }
         m_version_manager->init_versioning(top_ref, logical_file_size, info->latest_version_number);
+        if (m_group_commit || m_journal) {
+            ReadLockInfo durable = m_version_manager->grab_shared_read_lock();
+            info->durable_version = durable.m_version;
+            info->durable_reader_idx = uint32_t(durable.m_reader_idx);
+        }
+        if (m_journal) {
+            // The new file holds the latest version, so no record is needed for recovery
+            m_journal->clear(0); // Throws
+            m_journal->clear(1); // Throws
+            info->journal_active = 0;
+            info->journal_size = 0;
+            GroupCommitter cm(m_alloc, get_file_format_version(), Durability::Full, m_marker_observer.get());
+            cm.set_depends_on_journal(true);
+            cm.commit(top_ref); // Throws
+        }
         if (m_logger) {
             auto t2 = std::chrono::steady_clock::now();
             m_logger->log(util::Logger::Level::info, "DB compacted from: %1 to %2 in %3 us", file_size_before,
@@ -1765,6 +2034,96 @@ void DB::write_copy(std::string_view path, const char* output_encryption_key)
     }
 }
 
+struct DB::AsyncCompaction {
+    CompactionHandler handler;
+    size_t step_size;
+    size_t num_commits = 0;
+    TransactionRef tr;
+};
+
+void DB::async_compact(CompactionHandler handler, size_t step_size)
+{
+    if (!m_commit_helper)
+        throw Exception(ErrorCodes::IllegalOperation, "async_compact() requires DBOptions::enable_async_writes");
+    auto compaction = std::make_shared<AsyncCompaction>();
+    compaction->handler = std::move(handler);
+    compaction->step_size = std::max(step_size, size_t(1));
+    request_compaction_step(std::move(compaction)); // Throws
+}
+
+void DB::request_compaction_step(std::shared_ptr<AsyncCompaction> compaction)
+{
+    // The transaction of the previous step may still be inside its completion
+    // callback on the commit helper thread. Wait for that before releasing it.
+    if (compaction->tr)
+        compaction->tr->prepare_for_close();
+    compaction->tr = start_read(); // Throws
+    TransactionRef& tr = compaction->tr;
+    async_request_write_mutex(tr, [this, compaction]() mutable {
+        // This is called with the async state of the transaction locked, so the
+        // step itself must run on another thread
+        util::ThreadPool::get_default().submit([this, compaction = std::move(compaction)]() mutable {
+            run_compaction_step(std::move(compaction));
+        });
+    });
+}
+
+void DB::run_compaction_step(std::shared_ptr<AsyncCompaction> compaction) noexcept
+{
+    Transaction& tr = *compaction->tr;
+    try {
+        tr.promote_to_write(); // Throws
+        // The commit itself is empty. The work is done by the evacuation in low_level_commit().
+        m_compaction_step_size = compaction->step_size;
+        util::ScopeExit reset_step_size([this]() noexcept {
+            m_compaction_step_size = 0;
+        });
+        tr.commit_and_continue_as_read(false); // Throws
+        ++compaction->num_commits;
+    }
+    catch (...) {
+        // Releases the write lock
+        tr.prepare_for_close();
+        CompactionProgress progress;
+        progress.num_commits = compaction->num_commits;
+        progress.error = std::current_exception();
+        compaction->handler(progress);
+        return;
+    }
+    // Sync to disk and release the write lock on the commit helper thread
+    tr.async_complete_writes([this, compaction]() mutable {
+        util::ThreadPool::get_default().submit([this, compaction = std::move(compaction)]() mutable {
+            report_compaction_progress(std::move(compaction));
+        });
+    });
+}
+
+void DB::report_compaction_progress(std::shared_ptr<AsyncCompaction> compaction) noexcept
+{
+    CompactionProgress progress;
+    progress.error = compaction->tr->get_commit_exception();
+    progress.stage = get_evacuation_stage();
+    size_t free_space;
+    get_stats(free_space, progress.used_space);
+    progress.file_size = free_space + progress.used_space;
+    progress.num_commits = compaction->num_commits;
+    progress.done = !progress.error && progress.stage == EvacStage::idle;
+    if (m_logger) {
+        m_logger->log(util::Logger::Level::debug, "Compaction step %1: file size %2, used %3",
+                      progress.num_commits, progress.file_size, progress.used_space);
+    }
+    if (!compaction->handler(progress) || progress.done || progress.error)
+        return;
+    try {
+        request_compaction_step(compaction); // Throws
+    }
+    catch (...) {
+        progress.error = std::current_exception();
+        progress.done = false;
+        compaction->handler(progress);
+    }
+}
+
 uint_fast64_t DB::get_number_of_versions()
 {
     if (m_fake_read_lock_if_immutable)
@@ -1962,6 +2321,17 @@ void DB::close(bool allow_open_read_transactions)
 {
     // make helper thread(s) terminate
     m_commit_helper.reset();
+    if (m_checkpoint_thread.joinable()) {
+        // A checkpoint uses the write lock and the mappings of the file, so
+        // one which is scheduled is done before the thread stops
+        {
+            std::lock_guard checkpoint_lock(m_checkpoint_mutex);
+            m_checkpoint_thread_stop = true;
+        }
+        m_checkpoint_cv.notify_all();
+        m_checkpoint_thread.join();
+        m_checkpoint_thread_stop = false;
+    }
 
     if (m_fake_read_lock_if_immutable) {
         if (!is_attached())
@@ -1998,6 +2368,35 @@ void DB::close_internal(std::unique_lock<InterprocessMutex> lock, bool allow_ope
         if (!lock.owns_lock())
             lock.lock();
 
+        if (m_journal && info->num_participants == 1 && m_alloc.is_attached()) {
+            // The last participant commits the newest version to the file header, so that the
+            // file does not depend on the journal once the session has ended
+            try {
+                ReadLockInfo newest = m_version_manager->grab_shared_read_lock(); // Throws
+                try {
+                    GroupCommitter cm(m_alloc, get_file_format_version(), Durability::Full,
+                                      m_marker_observer.get());
+                    cm.set_depends_on_journal(false);
+                    cm.commit(newest.m_top_ref); // Throws
+                }
+                catch (...) {
+                    m_version_manager->release_shared_read_lock(newest);
+                    throw;
+                }
+                m_version_manager->release_shared_read_lock(newest);
+                m_journal->clear(0); // Throws
+                m_journal->clear(1); // Throws
+            }
+            catch (const std::exception& e) {
+                // The journal is recovered by the next session
+                if (m_logger) {
+                    m_logger->log(util::LogCategory::transaction, util::Logger::Level::error,
+                                  "Checkpoint at end of session failed: %1", e.what());
+                }
+            }
+        }
+
+        m_io_uring.reset();
         if (m_alloc.is_attached())
             m_alloc.detach();
 
@@ -2330,6 +2729,9 @@ void DB::do_release_read_lock(ReadLockInfo& read_lock) noexcept
 
 DB::ReadLockInfo DB::grab_read_lock(ReadLockInfo::Type type, VersionID version_id)
 {
+    std::chrono::steady_clock::time_point start;
+    if (m_metrics)
+        start = std::chrono::steady_clock::now();
     CheckedLockGuard lock(m_mutex); // mx on m_local_locks_held
     REALM_ASSERT_RELEASE(is_attached());
     auto read_lock = m_version_manager->grab_read_lock(type, version_id);
@@ -2337,6 +2739,8 @@ DB::ReadLockInfo DB::grab_read_lock(ReadLockInfo::Type type, VersionID version_i
     m_local_locks_held.emplace_back(read_lock);
     ++m_transaction_count;
     REALM_ASSERT(read_lock.m_file_size > read_lock.m_top_ref);
+    if (m_metrics)
+        m_metrics->read_lock.record(std::chrono::steady_clock::now() - start);
     return read_lock;
 }
 
@@ -2481,6 +2885,10 @@ Replication::version_type DB::do_commit(Transaction& transaction, bool commit_to
         }
         transaction.m_tables_to_clear.clear();
     }
+    if (m_enumerate_string_columns) {
+        enumerate_string_columns(transaction); // Throws
+    }
+    refresh_column_statistics(transaction); // Throws
     if (Replication* repl = get_replication()) {
         // If Replication::prepare_commit() fails, then the entire transaction
         // fails. The application then has the option of terminating the
@@ -2504,6 +2912,55 @@ Replication::version_type DB::do_commit(Transaction& transaction, bool commit_to
     return new_version;
 }
 
+void DB::refresh_column_statistics(Transaction& transaction)
+{
+    // Only tables modified by this transaction can have changed in size. Their top array has been copied on write.
+    Allocator& alloc = transaction.m_alloc;
+    for (size_t ndx = 0; ndx < transaction.m_table_accessors.size(); ++ndx) {
+        Table* table = transaction.m_table_accessors[ndx];
+        if (!table || alloc.is_read_only(transaction.m_tables.get_as_ref(ndx)))
+            continue;
+        table->refresh_stale_column_statistics(); // Throws
+    }
+}
+
+void DB::enumerate_string_columns(Transaction& transaction)
+{
+    // Only tables modified by this transaction are considered. Their top array has been copied on write.
+    Allocator& alloc = transaction.m_alloc;
+    for (size_t ndx = 0; ndx < transaction.m_table_accessors.size(); ++ndx) {
+        Table* table = transaction.m_table_accessors[ndx];
+        if (!table || alloc.is_read_only(transaction.m_tables.get_as_ref(ndx)))
+            continue;
+        size_t size = table->size();
+        for (auto col_key : table->get_column_keys()) {
+            if (col_key.get_type() != col_type_String || col_key.is_collection())
+                continue;
+            if (table->is_enumerated(col_key)) {
+                // New strings are appended to the list of unique values, so it may outgrow the limit
+                if (table->get_num_unique_values(col_key) > m_enumerate_string_columns_max_unique) {
+                    table->unenumerate_string_column(col_key); // Throws
+                    m_string_columns_not_enumerated[{table->get_key(), col_key}] = size;
+                }
+                continue;
+            }
+            if (size < m_enumerate_string_columns_min_size)
+                continue;
+            // Only check a column again when its table has doubled in size since the last time
+            auto it = m_string_columns_not_enumerated.find({table->get_key(), col_key});
+            if (it != m_string_columns_not_enumerated.end() && size < 2 * it->second)
+                continue;
+            if (table->enumerate_string_column(col_key, m_enumerate_string_columns_max_unique)) { // Throws
+                if (it != m_string_columns_not_enumerated.end())
+                    m_string_columns_not_enumerated.erase(it);
+            }
+            else {
+                m_string_columns_not_enumerated[{table->get_key(), col_key}] = size;
+            }
+        }
+    }
+}
+
 VersionID DB::get_version_id_of_latest_snapshot()
 {
     if (m_fake_read_lock_if_immutable)
@@ -2547,8 +3004,28 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction, b
 
     GroupWriter out(transaction, Durability(info->durability), m_marker_observer.get()); // Throws
     out.set_versions(new_version, top_refs, any_new_unreachables);
+    out.set_pack_integer_columns(m_pack_integer_columns);
+    out.set_eager_evacuation(m_compaction_step_size != 0);
+    CommitJournal::Record record;
+    if (m_journal)
+        out.set_journal_record(&record);
+    out.set_io_uring(m_io_uring.get());
+    out.set_metrics(m_metrics.get());
     out.prepare_evacuation();
     auto t1 = std::chrono::steady_clock::now();
+    // Time spent in each phase of the commit, only measured with DBOptions::enable_metrics
+    using clock = std::chrono::steady_clock;
+    clock::duration sync_time{}, header_time{}, notify_time{};
+    bool header_written = false;
+    clock::time_point phase_start;
+    auto start_phase = [&] {
+        if (m_metrics)
+            phase_start = clock::now();
+    };
+    auto end_phase = [&](clock::duration& time) {
+        if (m_metrics)
+            time += clock::now() - phase_start;
+    };
     auto commit_size = m_alloc.get_commit_size();
     if (m_logger) {
         m_logger->log(util::LogCategory::transaction, util::Logger::Level::debug, "Initiate commit version: %1",
@@ -2557,7 +3034,7 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction, b
     if (auto limit = out.get_evacuation_limit()) {
         // Get a work limit based on the size of the transaction we're about to commit
         // Add 4k to ensure progress on small commits
-        size_t work_limit = commit_size / 2 + out.get_free_list_size() + 0x1000;
+        size_t work_limit = commit_size / 2 + out.get_free_list_size() + 0x1000 + m_compaction_step_size;
         transaction.cow_outliers(out.get_evacuation_progress(), limit, work_limit);
     }
 
@@ -2568,6 +3045,19 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction, b
         std::lock_guard<InterprocessMutex> lock(m_controlmutex); // Throws
         new_top_ref = out.write_group();                         // Throws
     }
+    if (m_journal) {
+        // The commit is durable once its record is. The space written by the commit is not reachable
+        // from the version it was made on top of, so the file itself can be synchronized later.
+        record.finish(new_version, transaction.m_read_lock.m_top_ref, new_top_ref, out.get_logical_size(),
+                      get_file_format_version());
+        int active = info->journal_active;
+        start_phase();
+        m_journal->append(active, info->journal_size, record); // Throws
+        if (commit_to_disk)
+            m_journal->sync(active); // Throws
+        end_phase(sync_time);
+        info->journal_size += record.size();
+    }
     {
         // protect access to shared variables and m_reader_mapping from here
         CheckedLockGuard lock_guard(m_mutex);
@@ -2575,12 +3065,44 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction, b
         m_locked_space = out.get_locked_space_size();
         m_used_space = out.get_logical_size() - m_free_space;
         m_evac_stage.store(EvacStage(out.get_evacuation_stage()));
-        out.sync_according_to_durability();
-        if (Durability(info->durability) == Durability::Full || Durability(info->durability) == Durability::Unsafe) {
-            if (commit_to_disk) {
+        if (m_metrics) {
+            m_metrics->free_space.store(m_free_space, std::memory_order_relaxed);
+            m_metrics->used_space.store(m_used_space, std::memory_order_relaxed);
+            m_metrics->locked_space.store(m_locked_space, std::memory_order_relaxed);
+            m_metrics->evacuation_stage.store(int(m_evac_stage.load()), std::memory_order_relaxed);
+        }
+        if (m_group_commit || m_journal) {
+            // The file is synchronized and the header updated by wait_until_durable() or
+            // checkpoint_journal()
+            start_phase();
+            out.flush_all_mappings();
+            end_phase(sync_time);
+        }
+        else {
+            bool commit_header = commit_to_disk && (Durability(info->durability) == Durability::Full ||
+                                                    Durability(info->durability) == Durability::Unsafe);
+            if (m_io_uring && commit_header) {
+                // Submit the writes of the commit together with the new top ref. The arrays are
+                // synchronized along with the header.
+                out.queue_writes();
                 GroupCommitter cm(transaction, Durability(info->durability), m_marker_observer.get());
+                cm.set_io_uring(m_io_uring.get());
+                start_phase();
                 cm.commit(new_top_ref);
+                end_phase(header_time);
+            }
+            else {
+                start_phase();
+                out.sync_according_to_durability();
+                end_phase(sync_time);
+                if (commit_header) {
+                    GroupCommitter cm(transaction, Durability(info->durability), m_marker_observer.get());
+                    start_phase();
+                    cm.commit(new_top_ref);
+                    end_phase(header_time);
+                }
             }
+            header_written = commit_header;
         }
         size_t new_file_size = out.get_logical_size();
         // We must reset the allocators free space tracking before communicating the new
@@ -2592,16 +3114,35 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction, b
         // to crash. Other writers *must* be prevented from writing any further updates
         // to the database. The flag "commit_in_critical_phase" is used to prevent such updates.
         info->commit_in_critical_phase = 1;
+        start_phase();
         {
             m_version_manager->add_version(new_top_ref, new_file_size, new_version);
 
             // REALM_ASSERT(m_alloc.matches_section_boundary(new_file_size));
             REALM_ASSERT(new_top_ref < new_file_size);
         }
+        end_phase(notify_time);
         // At this point, the VersionList has been succesfully updated, and the next writer
         // can safely proceed once the writemutex has been lifted.
         info->commit_in_critical_phase = 0;
     }
+#ifndef _WIN32
+    // A compaction step which shrunk the file also truncates it. Nothing above the new
+    // end is reachable from any live version, so no reader will touch that part of its
+    // mapping. Encrypted files are not truncated, as pages are read and decrypted ahead
+    // of what is accessed. On Windows a file cannot be truncated while it is mapped.
+    if (m_compaction_step_size && !m_alloc.is_in_memory()) {
+        File& file = m_alloc.get_file();
+        size_t new_file_size = out.get_logical_size();
+        if (!file.get_encryption() && size_t(file.get_size()) > new_file_size) {
+            file.resize(new_file_size); // Throws
+            if (m_logger) {
+                m_logger->log(util::Logger::Level::detail, "File truncated to %1", new_file_size);
+            }
+        }
+    }
+#endif
+    start_phase();
     {
         // protect against concurrent updates to the .lock file.
         // must release m_mutex before this point to obey lock order
@@ -2612,7 +3153,18 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction, b
 
         m_new_commit_available.notify_all();
     }
+    end_phase(notify_time);
+    if (m_journal && info->journal_size >= m_journal_checkpoint_size)
+        schedule_checkpoint();
     auto t2 = std::chrono::steady_clock::now();
+    if (m_metrics) {
+        m_metrics->commit.record(t2 - t1);
+        m_metrics->sync.record(sync_time);
+        if (header_written)
+            m_metrics->header.record(header_time);
+        m_metrics->notify.record(notify_time);
+        m_metrics->number_of_versions.store(live_versions + 1, std::memory_order_relaxed);
+    }
     if (m_logger) {
         std::string to_disk_str = commit_to_disk ? util::format(" ref %1", new_top_ref) : " (no commit to disk)";
         m_logger->log(util::LogCategory::transaction, util::Logger::Level::debug, "Commit of size %1 done in %2 us%3",
@@ -2621,6 +3173,172 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction, b
     }
 }
 
+void DB::wait_until_durable(version_type version)
+{
+    if (!m_group_commit)
+        return;
+    SharedInfo* info = m_info;
+    if (info->durable_version.load(std::memory_order_acquire) >= version)
+        return;
+
+    // Whoever holds the syncmutex is making a version durable, which is likely
+    // to include ours by the time we get it. If not, we take the lead and make
+    // the newest version durable on behalf of all writers which have committed
+    // since the last sync.
+    std::lock_guard<InterprocessMutex> lock(m_syncmutex); // Throws
+    if (info->durable_version.load(std::memory_order_relaxed) >= version)
+        return;
+
+    auto t1 = std::chrono::steady_clock::now();
+    ReadLockInfo durable = m_version_manager->grab_shared_read_lock();
+    REALM_ASSERT(durable.m_version >= version);
+    try {
+        // Committing synchronizes the entire file, including the changes made
+        // by writers in other processes, before the header is updated.
+        GroupCommitter cm(m_alloc, get_file_format_version(), Durability::Full, m_marker_observer.get());
+        cm.commit(durable.m_top_ref); // Throws
+    }
+    catch (...) {
+        m_version_manager->release_shared_read_lock(durable);
+        throw;
+    }
+    if (m_metrics)
+        m_metrics->header.record(std::chrono::steady_clock::now() - t1);
+
+    // The previous durable version is no longer needed for recovery
+    ReadLockInfo previous;
+    previous.m_version = info->durable_version.load(std::memory_order_relaxed);
+    previous.m_reader_idx = info->durable_reader_idx;
+    previous.m_type = ReadLockInfo::Frozen;
+    info->durable_reader_idx = uint32_t(durable.m_reader_idx);
+    info->durable_version.store(durable.m_version, std::memory_order_release);
+    m_version_manager->release_shared_read_lock(previous);
+
+    if (m_logger) {
+        auto t2 = std::chrono::steady_clock::now();
+        m_logger->log(util::LogCategory::transaction, util::Logger::Level::debug,
+                      "Versions %1 to %2 made durable in %3 us", previous.m_version + 1, durable.m_version,
+                      std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count());
+    }
+}
+
+void DB::sync_journal()
+{
+    // A checkpoint may have made the other journal active since the commits
+    // were appended
+    m_journal->sync(0); // Throws
+    m_journal->sync(1); // Throws
+}
+
+void DB::schedule_checkpoint()
+{
+    // A checkpoint waits for the write lock, so it runs on a thread of its own
+    // rather than on a util::ThreadPool, whose tasks must never block on DB
+    // locks
+    std::lock_guard lock(m_checkpoint_mutex);
+    if (m_checkpoint_scheduled)
+        return;
+    if (!m_checkpoint_thread.joinable()) {
+        m_checkpoint_thread = std::thread([this] {
+            run_checkpoints();
+        }); // Throws
+    }
+    m_checkpoint_scheduled = true;
+    m_checkpoint_cv.notify_all();
+}
+
+void DB::run_checkpoints() noexcept
+{
+    std::unique_lock lock(m_checkpoint_mutex);
+    for (;;) {
+        m_checkpoint_cv.wait(lock, [this] {
+            return m_checkpoint_scheduled || m_checkpoint_thread_stop;
+        });
+        // A scheduled checkpoint is done before stopping
+        if (!m_checkpoint_scheduled)
+            return;
+        lock.unlock();
+        checkpoint_journal();
+        lock.lock();
+        m_checkpoint_scheduled = false;
+        m_checkpoint_cv.notify_all();
+    }
+}
+
+void DB::checkpoint_journal() noexcept
+{
+    SharedInfo* info = m_info;
+    try {
+        // Another session participant may already be checkpointing
+        std::unique_lock<InterprocessMutex> sync_lock(m_syncmutex, std::try_to_lock); // Throws
+        if (!sync_lock.owns_lock())
+            return;
+
+        auto t1 = std::chrono::steady_clock::now();
+        ReadLockInfo checkpoint;
+        int to_clear;
+        do_begin_write(); // Throws
+        try {
+            if (info->journal_size < m_journal_checkpoint_size) {
+                do_end_write();
+                return;
+            }
+            // Commits are appended to the other journal from now on, unless it
+            // still holds records because the previous checkpoint failed. Those
+            // are emptied instead once the newest version has been committed.
+            int active = info->journal_active;
+            if (m_journal->is_empty(1 - active)) { // Throws
+                info->journal_active = uint8_t(1 - active);
+                info->journal_size = 0;
+                to_clear = active;
+            }
+            else {
+                to_clear = 1 - active;
+            }
+            // Keeps the space of the version from being reused for as long as the header references it
+            checkpoint = m_version_manager->grab_shared_read_lock(); // Throws
+        }
+        catch (...) {
+            do_end_write();
+            throw;
+        }
+        do_end_write();
+
+        try {
+            GroupCommitter cm(m_alloc, get_file_format_version(), Durability::Full, m_marker_observer.get());
+            cm.commit(checkpoint.m_top_ref); // Throws
+            m_journal->clear(to_clear);      // Throws
+        }
+        catch (...) {
+            m_version_manager->release_shared_read_lock(checkpoint);
+            throw;
+        }
+        // The version previously referenced by the header is no longer needed if the Realm
+        // file is opened without recovering the journal
+        ReadLockInfo previous;
+        previous.m_version = info->durable_version.load(std::memory_order_relaxed);
+        previous.m_reader_idx = info->durable_reader_idx;
+        previous.m_type = ReadLockInfo::Frozen;
+        info->durable_reader_idx = uint32_t(checkpoint.m_reader_idx);
+        info->durable_version.store(checkpoint.m_version, std::memory_order_release);
+        m_version_manager->release_shared_read_lock(previous);
+
+        if (m_logger) {
+            auto t2 = std::chrono::steady_clock::now();
+            m_logger->log(util::LogCategory::transaction, util::Logger::Level::debug,
+                          "Checkpoint of version %1 done in %2 us", checkpoint.m_version,
+                          std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count());
+        }
+    }
+    catch (const std::exception& e) {
+        // The records stay in the journal, and the next commit schedules a new checkpoint
+        if (m_logger) {
+            m_logger->log(util::LogCategory::transaction, util::Logger::Level::error, "Checkpoint failed: %1",
+                          e.what());
+        }
+    }
+}
+
 #ifdef REALM_DEBUG
 void DB::reserve(size_t size)
 {
@@ -2669,6 +3387,7 @@ void DB::delete_files(const std::string& base_path, bool* did_delete, bool delet
 
     File::try_remove(get_core_file(base_path, CoreFileType::Note));
     File::try_remove(get_core_file(base_path, CoreFileType::Log));
+    CommitJournal::remove_files(base_path);
     util::try_remove_dir_recursive(get_core_file(base_path, CoreFileType::Management));
 
     if (delete_lockfile) {
@@ -2803,6 +3522,11 @@ void DB::async_request_write_mutex(TransactionRef& tr, util::UniqueFunction<void
 
 inline DB::DB(Private, const DBOptions& options)
     : m_upgrade_callback(std::move(options.upgrade_callback))
+    , m_metrics(options.enable_metrics ? std::make_shared<DBMetrics>() : nullptr)
+    , m_pack_integer_columns(options.pack_integer_columns)
+    , m_enumerate_string_columns(options.enumerate_string_columns)
+    , m_enumerate_string_columns_min_size(options.enumerate_string_columns_min_size)
+    , m_enumerate_string_columns_max_unique(options.enumerate_string_columns_max_unique)
     , m_log_id(util::gen_log_id(this))
 {
     if (options.enable_async_writes) {
@@ -19,6 +19,7 @@
 #ifndef REALM_DB_HPP
 #define REALM_DB_HPP
 
+#include <realm/db_metrics.hpp>
 #include <realm/db_options.hpp>
 #include <realm/group.hpp>
 #include <realm/handover_defs.hpp>
@@ -33,14 +34,21 @@
 #include <realm/util/encrypted_file_mapping.hpp>
 #include <realm/version_id.hpp>
 
+#include <exception>
 #include <functional>
 #include <cstdint>
 #include <limits>
+#include <map>
 #include <condition_variable>
+#include <thread>
 
 namespace realm {
 
 class Transaction;
+class CommitJournal;
+namespace util {
+class IoUringWriter;
+}
 using TransactionRef = std::shared_ptr<Transaction>;
 
 /// Thrown by DB::create() if the lock file is already open in another
@@ -295,6 +303,14 @@ public:
         return m_evac_stage;
     }
 
+    /// The latency histograms and gauges of this DB, which are updated as
+    /// commits and read transactions are made through it. Returns nullptr
+    /// unless DBOptions::enable_metrics was set when the DB was opened.
+    std::shared_ptr<DBMetrics> get_metrics() const noexcept
+    {
+        return m_metrics;
+    }
+
     /// Report the number of distinct versions stored in the database at the time
     /// of latest commit.
     /// Note: the database only cleans up versions as part of commit, so ending
@@ -332,6 +348,41 @@ public:
 
     void write_copy(std::string_view path, const char* output_encryption_key) REQUIRES(!m_mutex);
 
+    /// Progress of a compaction started with async_compact().
+    struct CompactionProgress {
+        EvacStage stage = EvacStage::idle;
+        /// Logical size of the file after the latest step
+        size_t file_size = 0;
+        /// Space in use by the latest version
+        size_t used_space = 0;
+        /// Number of commits made so far
+        size_t num_commits = 0;
+        /// Set when there is nothing more to do, either because the file has
+        /// been shrunk or because there was too little free space to bother.
+        bool done = false;
+        /// Set if a step failed, which ends the compaction.
+        std::exception_ptr error;
+    };
+    using CompactionHandler = util::UniqueFunction<bool(const CompactionProgress&)>;
+
+    /// Shrink the database file in the background while other readers and
+    /// writers carry on, unlike compact() which needs exclusive access.
+    ///
+    /// Live nodes at the end of the file are moved into free space further
+    /// down in a series of small commits, each moving about `step_size` bytes
+    /// worth of nodes. The write lock is requested through the async write
+    /// machinery for every step, so other writers get their turn in between.
+    /// Once nothing live is left above the new end of the file, and no reader
+    /// holds on to a version which needs it, the file is truncated. Encrypted
+    /// files, and files on Windows, are only truncated the next time they are
+    /// opened by the first process.
+    ///
+    /// `handler` is called on a background thread after each step, and the
+    /// compaction stops if it returns false. It is called a last time with
+    /// `done` or `error` set. Requires DBOptions::enable_async_writes, and the
+    /// DB must not be closed while the compaction is in progress.
+    void async_compact(CompactionHandler handler, size_t step_size = 0x100000) REQUIRES(!m_mutex);
+
 #ifdef REALM_DEBUG
     void test_ringbuf();
 #endif
@@ -449,6 +500,7 @@ public:
 
 private:
     class AsyncCommitHelper;
+    struct AsyncCompaction;
     class VersionManager;
     class EncryptionMarkerObserver;
     class FileVersionManager;
@@ -504,14 +556,39 @@ private:
     std::unique_ptr<ReadLockInfo> m_fake_read_lock_if_immutable;
     util::InterprocessMutex m_controlmutex;
     util::InterprocessMutex m_versionlist_mutex;
+    util::InterprocessMutex m_syncmutex;
     util::InterprocessCondVar m_new_commit_available;
     util::InterprocessCondVar m_pick_next_writer;
     std::function<void(int, int)> m_upgrade_callback;
+    // Only set with DBOptions::enable_metrics
+    std::shared_ptr<DBMetrics> m_metrics;
     std::unique_ptr<AsyncCommitHelper> m_commit_helper;
     std::shared_ptr<util::Logger> m_logger;
     std::mutex m_commit_listener_mutex;
     std::vector<CommitListener*> m_commit_listeners;
     bool m_is_sync_agent = false;
+    bool m_group_commit = false;
+    // Only set with DBOptions::commit_journal
+    std::unique_ptr<CommitJournal> m_journal;
+    size_t m_journal_checkpoint_size = 0;
+    // Checkpoints of the journal are done on a thread of their own, started by
+    // the first checkpoint
+    std::thread m_checkpoint_thread;
+    std::mutex m_checkpoint_mutex;
+    std::condition_variable m_checkpoint_cv;
+    bool m_checkpoint_scheduled = false;   // Guarded by m_checkpoint_mutex
+    bool m_checkpoint_thread_stop = false; // Guarded by m_checkpoint_mutex
+    // Only set with DBOptions::use_io_uring, if io_uring is available
+    std::unique_ptr<util::IoUringWriter> m_io_uring;
+    bool m_pack_integer_columns = false;
+    bool m_enumerate_string_columns = false;
+    size_t m_enumerate_string_columns_min_size = 0;
+    size_t m_enumerate_string_columns_max_unique = 0;
+    // Size of the table when a string column was last found to have too many unique values to be enumerated.
+    // Only accessed with the write mutex held.
+    std::map<std::pair<TableKey, ColKey>, size_t> m_string_columns_not_enumerated;
+    // Set while a step of async_compact() commits. Only accessed with the write mutex held.
+    size_t m_compaction_step_size = 0;
     // Id for this DB to be used in logging. We will just use some bits from the pointer.
     // The path cannot be used as this would not allow us to distinguish between two DBs opening
     // the same realm.
@@ -600,6 +677,20 @@ private:
     // Must be called only by someone that has a lock on the write mutex.
     void low_level_commit(uint_fast64_t new_version, Transaction& transaction, bool commit_to_disk = true)
         REQUIRES(!m_mutex);
+    // Must be called only by someone that has a lock on the write mutex.
+    void enumerate_string_columns(Transaction& transaction);
+    // Must be called only by someone that has a lock on the write mutex.
+    void refresh_column_statistics(Transaction& transaction);
+    // In group commit mode, return once the specified version (or a later one)
+    // has been made durable, making it durable if needed. Does nothing otherwise.
+    // Should be called after the write mutex has been released.
+    void wait_until_durable(version_type version);
+    // With a commit journal, synchronize the records of all commits to disk.
+    void sync_journal();
+    // Called with the write mutex held after a commit has been added to the journal
+    void schedule_checkpoint();
+    void run_checkpoints() noexcept;
+    void checkpoint_journal() noexcept REQUIRES(!m_mutex);
 
     void do_async_commits();
 
@@ -624,6 +715,10 @@ private:
     void async_end_write();
     void async_sync_to_disk(util::UniqueFunction<void()> fn);
 
+    void request_compaction_step(std::shared_ptr<AsyncCompaction>) REQUIRES(!m_mutex);
+    void run_compaction_step(std::shared_ptr<AsyncCompaction>) noexcept REQUIRES(!m_mutex);
+    void report_compaction_progress(std::shared_ptr<AsyncCompaction>) noexcept REQUIRES(!m_mutex);
+
     friend class SlabAlloc;
     friend class Transaction;
 };
@@ -0,0 +1,72 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/db_metrics.hpp>
+
+#include <realm/utilities.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace realm;
+
+void LatencyHistogram::record(Duration duration) noexcept
+{
+    int64_t ns = std::max<int64_t>(duration.count(), 0);
+    size_t bucket = std::min<size_t>(size_t(log2(size_t(ns)) + 1), num_buckets - 1);
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_total.fetch_add(ns, std::memory_order_relaxed);
+    int64_t current_max = m_max.load(std::memory_order_relaxed);
+    while (ns > current_max && !m_max.compare_exchange_weak(current_max, ns, std::memory_order_relaxed))
+        ;
+}
+
+LatencyHistogram::Duration LatencyHistogram::percentile(double fraction) const noexcept
+{
+    // The count of each bucket is loaded again below, so the total is
+    // computed from them rather than taken from m_count
+    uint64_t total_count = 0;
+    for (auto& bucket : m_buckets)
+        total_count += bucket.load(std::memory_order_relaxed);
+    if (total_count == 0)
+        return Duration(0);
+    uint64_t rank = std::max<uint64_t>(uint64_t(std::ceil(fraction * double(total_count))), 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < num_buckets; ++i) {
+        seen += bucket_count(i);
+        if (seen >= rank)
+            return std::min(bucket_limit(i), max());
+    }
+    return max();
+}
+
+void LatencyHistogram::reset() noexcept
+{
+    for (auto& bucket : m_buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_total.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+void DBMetrics::reset() noexcept
+{
+    for (auto histogram : {&commit, &free_lists, &write_arrays, &sync, &header, &notify, &read_lock})
+        histogram->reset();
+}
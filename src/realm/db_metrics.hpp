@@ -0,0 +1,121 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_DB_METRICS_HPP
+#define REALM_DB_METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace realm {
+
+/// A histogram of durations. Bucket `i` counts the durations of less than
+/// 2^i nanoseconds which did not fit in bucket `i - 1`, and the last bucket
+/// counts everything longer. Recording a duration is a handful of relaxed
+/// atomic operations, so it is cheap enough to do on every commit and every
+/// read transaction. A histogram which is read while durations are recorded
+/// may not include all of the most recent ones in all of its figures.
+class LatencyHistogram {
+public:
+    using Duration = std::chrono::nanoseconds;
+    static constexpr size_t num_buckets = 40; // The last bucket starts at about 4.5 minutes
+
+    void record(Duration) noexcept;
+
+    uint64_t count() const noexcept
+    {
+        return m_count.load(std::memory_order_relaxed);
+    }
+    Duration total() const noexcept
+    {
+        return Duration(m_total.load(std::memory_order_relaxed));
+    }
+    Duration max() const noexcept
+    {
+        return Duration(m_max.load(std::memory_order_relaxed));
+    }
+    uint64_t bucket_count(size_t bucket) const noexcept
+    {
+        return m_buckets[bucket].load(std::memory_order_relaxed);
+    }
+    /// The smallest duration which does not fit in `bucket`.
+    static Duration bucket_limit(size_t bucket) noexcept
+    {
+        return Duration(int64_t(1) << bucket);
+    }
+
+    /// An upper bound of the duration which `fraction` (e.g. 0.99 for the
+    /// 99th percentile) of the recorded durations do not exceed. It is the
+    /// limit of the bucket the percentile falls in, but no more than max().
+    /// Returns zero if nothing has been recorded.
+    Duration percentile(double fraction) const noexcept;
+
+    void reset() noexcept;
+
+private:
+    std::atomic<uint64_t> m_buckets[num_buckets] = {};
+    std::atomic<uint64_t> m_count = 0;
+    std::atomic<int64_t> m_total = 0; // In nanoseconds
+    std::atomic<int64_t> m_max = 0;   // In nanoseconds
+};
+
+/// Measurements of the commits and read transactions made through a DB (see
+/// DBOptions::enable_metrics and DB::get_metrics()). Commits made through
+/// other DB instances, including other processes, are not included.
+struct DBMetrics {
+    /// Each commit, from writing the changed arrays until other processes
+    /// have been notified of the new version.
+    LatencyHistogram commit;
+    /// Reading in and rebuilding the free lists of the file when writing a
+    /// commit (GroupWriter::read_in_freelist() and recreate_freelist()).
+    LatencyHistogram free_lists;
+    /// Writing the changed arrays to free space in the file, not counting
+    /// the time spent on the free lists.
+    LatencyHistogram write_arrays;
+    /// Synchronizing the written arrays to disk (or flushing them to the
+    /// file if the commit is not made durable right away).
+    LatencyHistogram sync;
+    /// Writing the new top ref to the file header and flipping the slot
+    /// selector, including synchronizing the header to disk. With
+    /// DBOptions::group_commit this is recorded by the writer which makes a
+    /// batch of versions durable, and includes synchronizing the file.
+    LatencyHistogram header;
+    /// Publishing the new version to readers and notifying waiting processes.
+    LatencyHistogram notify;
+    /// Taking a read lock when a transaction begins or advances to a newer
+    /// version, including waiting for the mutexes involved.
+    LatencyHistogram read_lock;
+
+    /// The number of versions in the version list, the free, used and
+    /// locked space in the file (see DB::get_stats()), and the evacuation
+    /// stage (a DB::EvacStage) as of the latest commit.
+    std::atomic<uint64_t> number_of_versions = 0;
+    std::atomic<uint64_t> free_space = 0;
+    std::atomic<uint64_t> used_space = 0;
+    std::atomic<uint64_t> locked_space = 0;
+    std::atomic<int> evacuation_stage = 0;
+
+    /// Clear all histograms.
+    void reset() noexcept;
+};
+
+} // namespace realm
+
+#endif // REALM_DB_METRICS_HPP
@@ -34,6 +34,13 @@ struct DBOptions {
         Unsafe // If you use this, you loose ACID property
     };
 
+    /// How the application expects to read the Realm file. See access_pattern.
+    enum class AccessPattern {
+        Normal,
+        Sequential, // Mostly full scans of large tables
+        Random      // Mostly lookups of individual objects
+    };
+
     explicit DBOptions(Durability level = Durability::Full, const char* key = nullptr)
         : durability(level)
         , encryption_key(key)
@@ -102,10 +109,95 @@ struct DBOptions {
     /// a performance impact.
     bool enable_async_writes = false;
 
+    /// If set, commits are not synchronized to disk by the committing writer
+    /// while it holds the write lock. Instead, once the write lock has been
+    /// released, the writer waits until a version at least as new as its own
+    /// has been made durable. Only one session participant at a time (in any
+    /// process) synchronizes the file and updates its header, and it does so
+    /// for the newest version, so writers which commit while a sync is in
+    /// progress all share the next one. Other transactions may observe a
+    /// version before it has become durable.
+    ///
+    /// All session participants must agree on this setting. It only has an
+    /// effect with Durability::Full and unencrypted files.
+    bool group_commit = false;
+
+    /// If set, a commit appends the arrays it has written to the Realm file to
+    /// a journal file next to it, and only synchronizes the journal to disk
+    /// (see commit_journal.hpp). This replaces synchronizing the scattered
+    /// parts of the Realm file written by the commit and updating its header
+    /// with a single sequential write. Once the journal has grown to
+    /// `journal_checkpoint_size` bytes, the newest version is committed to the
+    /// header of the Realm file in the background and the journal is emptied.
+    /// Commits which were not checkpointed are recovered from the journal
+    /// when the next session begins.
+    ///
+    /// All session participants must agree on this setting. It only has an
+    /// effect with Durability::Full and unencrypted files, and takes
+    /// precedence over `group_commit`.
+    bool commit_journal = false;
+    size_t journal_checkpoint_size = 16 * 1024 * 1024;
+
     /// If set, opening a file which is not a Realm file or cannot be decrypted
     /// will clear and reinitialize the file.
     bool clear_on_invalid_file = false;
 
+    /// If set, commits store the modified parts of non-nullable integer
+    /// columns in a bit packed encoding whenever that takes up less space.
+    /// The encoding subtracts the smallest value (or a linear progression for
+    /// sorted values) from the values and then uses as few bits as needed for
+    /// what is left, which typically makes timestamps, ids and other large
+    /// numbers of a similar magnitude much smaller. Reads decode the packed
+    /// parts on the fly.
+    bool pack_integer_columns = false;
+
+    /// If set, commits convert string columns with few different values to
+    /// the enumerated representation (see Table::enumerate_string_column()),
+    /// where each object stores a small integer index into a list of the
+    /// unique strings in the column. This is done for columns in tables
+    /// modified by the commit which have at least
+    /// `enumerate_string_columns_min_size` objects and at most
+    /// `enumerate_string_columns_max_unique` different strings. Equality
+    /// queries on enumerated columns compare the integer indexes instead of
+    /// the strings.
+    ///
+    /// Strings that are no longer used are not removed from the list of
+    /// unique values. When the list grows beyond
+    /// `enumerate_string_columns_max_unique` entries, the column is converted
+    /// back to storing the strings directly.
+    bool enumerate_string_columns = false;
+    size_t enumerate_string_columns_min_size = 1000;
+    size_t enumerate_string_columns_max_unique = 256;
+
+    /// A hint to the operating system about how the memory mapped Realm file
+    /// is going to be read. Sequential makes the kernel read ahead more
+    /// aggressively, which speeds up scans of tables that are not in the page
+    /// cache, while Random turns read ahead off, which avoids reading pages
+    /// that are not needed when objects are mostly accessed one at a time.
+    /// Parts of the file can also be prefetched explicitly with
+    /// Transaction::prefetch(). The hint has no effect on encrypted files.
+    AccessPattern access_pattern = AccessPattern::Normal;
+
+    /// If set, ask for the mappings of the Realm file to be backed by
+    /// transparent huge pages, which reduces TLB misses for large files. This
+    /// is only supported on Linux, and only for file systems that support huge
+    /// pages for the page cache.
+    bool use_huge_pages = false;
+
+    /// If set, commits write the arrays they have changed and the file header
+    /// through an io_uring rather than the memory mappings of the file. The
+    /// arrays are submitted as one batch, together with the new top ref and
+    /// an fsync ordered after all of them, which replaces synchronizing each
+    /// of the mappings written to separately. This is only supported on
+    /// Linux 5.6 or later; where io_uring is not available the memory
+    /// mappings are used as before. It has no effect on encrypted files.
+    bool use_io_uring = false;
+
+    /// If set, the DB measures how long its commits and the phases of them
+    /// take, and how long beginning and advancing read transactions waits
+    /// for a read lock. See DB::get_metrics().
+    bool enable_metrics = false;
+
     /// sys_tmp_dir will be used if the temp_dir is empty when creating DBOptions.
     /// It must be writable and allowed to create pipe/fifo file on it.
     /// set_sys_tmp_dir is not a thread-safe call and it is only supposed to be called once
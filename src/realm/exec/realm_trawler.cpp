@@ -185,6 +185,9 @@ protected:
             case 2:
                 num_bytes = size;
                 break;
+            case 3: // Packed, size is the number of 64-bit words
+                num_bytes = size * 8;
+                break;
         }
 
         // Ensure 8-byte alignment
@@ -28,6 +28,7 @@
 #include <realm/util/file_mapper.hpp>
 #include <realm/util/memory_stream.hpp>
 #include <realm/util/thread.hpp>
+#include <realm/util/thread_pool.hpp>
 #include <realm/impl/destroy_guard.hpp>
 #include <realm/utilities.hpp>
 #include <realm/exceptions.hpp>
@@ -325,7 +326,7 @@ int Group::get_target_file_format_version_for_session(int current_file_format_ve
     // individual file format versions.
 
     if (requested_history_type == Replication::hist_None) {
-        if (current_file_format_version == 24) {
+        if (current_file_format_version == 25) {
             // We are able to open these file formats in RO mode
             return current_file_format_version;
         }
@@ -419,6 +420,7 @@ int Group::read_only_version_check(SlabAlloc& alloc, ref_type top_ref, const std
         case 0:
             file_format_ok = (top_ref == 0);
             break;
+        case 24: // Only differs from 25 by what it cannot contain
         case g_current_file_format_version:
             file_format_ok = true;
             break;
@@ -429,6 +431,12 @@ int Group::read_only_version_check(SlabAlloc& alloc, ref_type top_ref, const std
                                            "has a file format version (%2) which requires an upgrade",
                                            path, file_format_version),
                               path);
+    if (REALM_UNLIKELY(alloc.depends_on_journal()))
+        throw FileAccessError(ErrorCodes::IncompatibleSession,
+                              util::format("Realm file at path '%1' cannot be opened in read-only mode because its "
+                                           "latest versions must be recovered from the commit journal",
+                                           path),
+                              path);
     return file_format_version;
 }
 
@@ -931,11 +939,128 @@ ref_type Group::DefaultTableWriter::write_names(_impl::OutputStream& out)
     bool only_if_modified = false;                                    // Always
     return m_group->m_table_names.write(out, deep, only_if_modified); // Throws
 }
+
+namespace {
+
+// Writes arrays one after the other into a region of a file, through a buffer of bounded size
+class FileRegionWriter : public _impl::ArrayWriterBase {
+public:
+    FileRegionWriter(File& file, ref_type begin, size_t buffer_size)
+        : m_file(file)
+        , m_buffer(std::make_unique<char[]>(buffer_size))
+        , m_buffer_size(buffer_size)
+        , m_flushed_ref(begin)
+    {
+    }
+
+    ref_type write_array(const char* data, size_t size, uint32_t checksum) override
+    {
+        REALM_ASSERT(size % 8 == 0);
+        ref_type ref = get_ref_of_next_array();
+        // The checksum takes the place of the first 4 bytes, like in _impl::OutputStream
+        write(reinterpret_cast<const char*>(&checksum), 4); // Throws
+        write(data + 4, size - 4);                          // Throws
+        return ref;
+    }
+
+    ref_type get_ref_of_next_array() const noexcept
+    {
+        return m_flushed_ref + m_buffer_used;
+    }
+
+    void flush()
+    {
+        m_file.write(m_flushed_ref, m_buffer.get(), m_buffer_used); // Throws
+        m_flushed_ref += m_buffer_used;
+        m_buffer_used = 0;
+    }
+
+private:
+    File& m_file;
+    std::unique_ptr<char[]> m_buffer;
+    size_t m_buffer_size;
+    size_t m_buffer_used = 0;
+    ref_type m_flushed_ref;
+
+    void write(const char* data, size_t size)
+    {
+        while (size > 0) {
+            if (m_buffer_used == m_buffer_size)
+                flush(); // Throws
+            size_t n = std::min(size, m_buffer_size - m_buffer_used);
+            std::copy_n(data, n, m_buffer.get() + m_buffer_used);
+            m_buffer_used += n;
+            data += n;
+            size -= n;
+        }
+    }
+};
+
+} // anonymous namespace
+
 ref_type Group::DefaultTableWriter::write_tables(_impl::OutputStream& out)
 {
-    bool deep = true;                                            // Deep
-    bool only_if_modified = false;                               // Always
-    return m_group->m_tables.write(out, deep, only_if_modified); // Throws
+    bool deep = true;              // Deep
+    bool only_if_modified = false; // Always
+    const Array& tables = m_group->m_tables;
+    size_t num_tables = tables.size();
+    auto& pool = util::ThreadPool::get_default();
+    if (!m_output_file || num_tables < 2 || pool.num_threads() == 0)
+        return tables.write(out, deep, only_if_modified); // Throws
+
+    // The tables are written concurrently, each into a region of the file
+    // reserved for it. To know the size of the regions up front, all arrays
+    // with refs are written with the width needed for the largest ref in the
+    // output (see Array::write_with_ref_width()).
+    Allocator& alloc = tables.get_alloc();
+    auto get_table_ref = [&](size_t ndx) -> ref_type {
+        RefOrTagged rot = tables.get_as_ref_or_tagged(ndx);
+        return rot.is_ref() ? rot.get_as_ref() : 0;
+    };
+    std::vector<Array::WriteSizes> sizes(num_tables);
+    pool.run_parallel(num_tables, [&](size_t i) {
+        if (ref_type ref = get_table_ref(i))
+            sizes[i] = Array::get_write_sizes(ref, alloc); // Throws
+    });
+
+    ref_type begin = out.get_ref_of_next_array();
+    size_t width_ndx = 0;
+    size_t total_size = 0;
+    for (;; ++width_ndx) {
+        total_size = 0;
+        for (auto& table_sizes : sizes)
+            total_size += table_sizes[width_ndx];
+        // Refs of the last width can hold any ref
+        if (width_ndx + 1 == Array::WriteSizes().size() || begin + total_size <= (1ULL << ((8 << width_ndx) - 1)))
+            break;
+    }
+    size_t ref_width = size_t(8) << width_ndx;
+
+    REALM_ASSERT_RELEASE(out.skip(total_size) == begin); // Throws
+    std::vector<ref_type> new_refs(num_tables);
+    std::vector<ref_type> region_begin(num_tables);
+    for (size_t i = 0, pos = begin; i < num_tables; pos += sizes[i][width_ndx], ++i)
+        region_begin[i] = pos;
+    constexpr size_t max_buffer_size = 1024 * 1024;
+    pool.run_parallel(num_tables, [&](size_t i) {
+        ref_type ref = get_table_ref(i);
+        if (!ref)
+            return;
+        size_t region_size = sizes[i][width_ndx];
+        FileRegionWriter writer(*m_output_file, region_begin[i], std::min(region_size, max_buffer_size));
+        new_refs[i] = Array::write_with_ref_width(ref, alloc, writer, ref_width); // Throws
+        writer.flush();                                                           // Throws
+        REALM_ASSERT_RELEASE(writer.get_ref_of_next_array() == region_begin[i] + region_size);
+    });
+
+    Array new_tables(Allocator::get_default());
+    new_tables.create(Array::type_HasRefs, tables.get_context_flag()); // Throws
+    _impl::ShallowArrayDestroyGuard dg(&new_tables);
+    for (size_t i = 0; i < num_tables; ++i) {
+        int_fast64_t value = tables.get(i);
+        new_tables.add(new_refs[i] ? from_ref(new_refs[i]) : value); // Throws
+    }
+    return new_tables.write(out, !deep, only_if_modified); // Throws
 }
 
 auto Group::DefaultTableWriter::write_history(_impl::OutputStream& out) -> HistoryInfo
@@ -995,7 +1120,12 @@ void Group::write(File& file, const char* encryption_key, uint_fast64_t version_
 
     std::ostream out(&streambuf);
     out.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+    // Encrypted files are written a page at a time, so concurrent writes to
+    // different parts of a page would not work
+    if (!encryption_key)
+        writer.set_output_file(&file);
     write(out, encryption_key != 0, version_number, writer);
+    writer.set_output_file(nullptr);
     int sync_status = streambuf.pubsync();
     REALM_ASSERT(sync_status == 0);
 }
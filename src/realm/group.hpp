@@ -763,6 +763,11 @@ private:
     ///     Backlinks in BPlusTree
     ///     Sort order of Strings changed (affects sets and the string index)
     ///
+    ///  25 Packed integer leaves (see Array::write_packed()).
+    ///     Ordered indexes (col_attr_Ordered_Indexed).
+    ///     Zone maps in the table top array (see ZoneMap).
+    ///     Journal flag in the file header (see SlabAlloc::flags_Journal).
+    ///
     /// IMPORTANT: When introducing a new file format version, be sure to review
     /// the file validity checks in Group::open() and DB::do_open, the file
     /// format selection logic in
@@ -770,7 +775,7 @@ private:
     /// upgrade logic in Group::upgrade_file_format(), AND the lists of accepted
     /// file formats and the version deletion list residing in "backup_restore.cpp"
 
-    static constexpr int g_current_file_format_version = 24;
+    static constexpr int g_current_file_format_version = 25;
 
     int get_file_format_version() const noexcept;
     void set_file_format_version(int) noexcept;
@@ -1133,8 +1138,16 @@ public:
         m_group = g;
     }
 
+    /// Set when the output stream writes to an unencrypted file, which
+    /// write_tables() may then also write to directly.
+    void set_output_file(util::File* file)
+    {
+        m_output_file = file;
+    }
+
 protected:
     const Group* m_group = nullptr;
+    util::File* m_output_file = nullptr;
 };
 
 class Group::DefaultTableWriter : public Group::TableWriter {
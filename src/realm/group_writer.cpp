@@ -24,10 +24,12 @@
 #include <realm/group_writer.hpp>
 
 #include <realm/alloc_slab.hpp>
+#include <realm/db_metrics.hpp>
 #include <realm/transaction.hpp>
 #include <realm/disable_sync_to_disk.hpp>
 #include <realm/impl/destroy_guard.hpp>
 #include <realm/impl/simulated_failure.hpp>
+#include <realm/util/io_uring_writer.hpp>
 #include <realm/util/safe_int_ops.hpp>
 
 using namespace realm;
@@ -230,10 +232,15 @@ WriteWindowMgr::WriteWindowMgr(SlabAlloc& alloc, Durability dura, WriteMarker* w
 }
 
 GroupCommitter::GroupCommitter(Transaction& group, Durability dura, WriteMarker* write_marker)
-    : m_group(group)
-    , m_alloc(group.m_alloc)
+    : GroupCommitter(group.m_alloc, group.get_file_format_version(), dura, write_marker)
+{
+}
+
+GroupCommitter::GroupCommitter(SlabAlloc& alloc, int file_format_version, Durability dura, WriteMarker* write_marker)
+    : m_alloc(alloc)
+    , m_file_format_version(file_format_version)
     , m_durability(dura)
-    , m_window_mgr(group.m_alloc, dura, write_marker)
+    , m_window_mgr(alloc, dura, write_marker)
 {
 }
 
@@ -307,6 +314,15 @@ GroupWriter::GroupWriter(Transaction& group, Durability dura, WriteMarker* write
 
 void GroupWriter::sync_according_to_durability()
 {
+    if (m_io_uring) {
+        queue_writes(); // Throws
+        if (m_durability == Durability::Full && !get_disable_sync_to_disk())
+            m_io_uring->sync(); // Throws
+        m_io_uring->wait();     // Throws
+        m_buffered_arrays.clear();
+        m_buffered_runs.clear();
+        return;
+    }
     switch (m_durability) {
         case Durability::Full:
         case Durability::Unsafe:
@@ -317,7 +333,36 @@ void GroupWriter::sync_according_to_durability()
     }
 }
 
-GroupWriter::~GroupWriter() = default;
+void GroupWriter::flush_all_mappings()
+{
+    if (m_io_uring) {
+        write_buffered_arrays(); // Throws
+        return;
+    }
+    m_window_mgr.flush_all_mappings();
+}
+
+void GroupWriter::write_buffered_arrays()
+{
+    queue_writes();     // Throws
+    m_io_uring->wait(); // Throws
+    m_buffered_arrays.clear();
+    m_buffered_runs.clear();
+}
+
+void GroupWriter::queue_writes()
+{
+    REALM_ASSERT(m_io_uring);
+    for (auto& run : m_buffered_runs)
+        m_io_uring->write(run.ref, m_buffered_arrays.data() + run.offset, run.size); // Throws
+}
+
+GroupWriter::~GroupWriter()
+{
+    // Writes of the buffered arrays may still be queued if the commit failed
+    if (m_io_uring)
+        m_io_uring->discard();
+}
 
 size_t GroupWriter::get_file_size() const noexcept
 {
@@ -647,8 +692,16 @@ ref_type GroupWriter::write_group()
     ALLOC_DBG_COUT("Commit nr " << m_current_version << "   ( from " << m_oldest_reachable_version << " )"
                                 << std::endl);
 
+    using clock = std::chrono::steady_clock;
+    clock::time_point start_time;
+    clock::duration free_list_time{};
+    if (m_metrics)
+        start_time = clock::now();
+
     read_in_freelist();
     // Now, 'm_size_map' holds all free elements candidate for recycling
+    if (m_metrics)
+        free_list_time += clock::now() - start_time;
 
     Array& top = m_group.m_top;
     ALLOC_DBG_COUT("  Allocating file space for data:" << std::endl);
@@ -667,7 +720,17 @@ ref_type GroupWriter::write_group()
         writer = in_memory_writer.get();
     }
     ref_type names_ref = m_group.m_table_names.write(*writer, deep, only_if_modified); // Throws
-    ref_type tables_ref = m_group.m_tables.write(*writer, deep, only_if_modified);     // Throws
+    ref_type tables_ref;
+    if (m_pack_integer_columns) {
+        Allocator& alloc = m_group.m_tables.get_alloc();
+        tables_ref = Array::write_deep(m_group.m_tables.get_ref(), alloc, *writer, only_if_modified,
+                                       [&](size_t, ref_type table_ref) {
+                                           return Table::write_packed(alloc, table_ref, *writer); // Throws
+                                       });
+    }
+    else {
+        tables_ref = m_group.m_tables.write(*writer, deep, only_if_modified); // Throws
+    }
 
     int_fast64_t value_1 = from_ref(names_ref);
     int_fast64_t value_2 = from_ref(tables_ref);
@@ -785,6 +848,10 @@ ref_type GroupWriter::write_group()
             top.set(Group::s_file_size_ndx, RefOrTagged::make_tagged(m_logical_size));
             auto ref = top.get_as_ref(Group::s_evacuation_point_ndx);
             REALM_ASSERT(ref);
+            // The array has been written by this commit, and its header is
+            // read back from the file
+            if (m_io_uring)
+                write_buffered_arrays(); // Throws
             Array::destroy(ref, m_alloc);
             top.set(Group::s_evacuation_point_ndx, 0);
             m_evacuation_limit = 0;
@@ -805,7 +872,12 @@ ref_type GroupWriter::write_group()
     // Now, let's update the realm-style freelists, which will later be written to file.
     // Function returns index of element holding the space reserved for the free
     // lists in the file.
+    clock::time_point recreate_time;
+    if (m_metrics)
+        recreate_time = clock::now();
     size_t reserve_ndx = recreate_freelist(reserve_pos);
+    if (m_metrics)
+        free_list_time += clock::now() - recreate_time;
 
     ALLOC_DBG_COUT("  Freelist size after merge: " << m_free_positions.size() << "   freelist space required: "
                                                    << max_free_space_needed << std::endl);
@@ -855,7 +927,7 @@ ref_type GroupWriter::write_group()
         size_t free_space = m_free_space_size + reserve_size - max_free_space_needed - m_locked_space_size;
         REALM_ASSERT(m_logical_size > free_space);
         size_t used_space = m_logical_size - free_space;
-        if (free_space > 2 * used_space) {
+        if (free_space > (m_eager_evacuation ? used_space : 2 * used_space)) {
             // Clean up potential
             auto limit = util::round_up_to_page_size(used_space + used_space / 2);
 
@@ -922,6 +994,13 @@ ref_type GroupWriter::write_group()
         // Write top
         write_array_at(translator, top_ref, top.get_header(), top_byte_size); // Throws
     }
+    else if (m_io_uring) {
+        uint32_t checksum = 0x41414141UL; // "AAAA" in ASCII, as in write_array_at()
+        buffer_array_at(free_positions_ref, m_free_positions.get_header(), free_positions_size, checksum); // Throws
+        buffer_array_at(free_sizes_ref, m_free_lengths.get_header(), free_sizes_size, checksum);           // Throws
+        buffer_array_at(free_versions_ref, m_free_versions.get_header(), free_versions_size, checksum);    // Throws
+        buffer_array_at(top_ref, top.get_header(), top_byte_size, checksum);                               // Throws
+    }
     else {
         MapWindow* window = m_window_mgr.get_window(reserve_ref, end_ref - reserve_ref);
         char* start_addr = window->translate(reserve_ref);
@@ -943,6 +1022,10 @@ ref_type GroupWriter::write_group()
         write_array_at(window, top_ref, top.get_header(), top_byte_size); // Throws
         window->encryption_write_barrier(start_addr, used);
     }
+    if (m_metrics) {
+        m_metrics->free_lists.record(free_list_time);
+        m_metrics->write_arrays.record(clock::now() - start_time - free_list_time);
+    }
     // Return top_ref so that it can be saved in lock file used for coordination
     return top_ref;
 }
@@ -1341,6 +1424,10 @@ ref_type GroupWriter::write_array(const char* data, size_t size, uint32_t checks
 {
     // Get position of free space to write in (expanding file if needed)
     size_t pos = get_free_space(size);
+    if (m_io_uring) {
+        buffer_array_at(to_ref(pos), data, size, checksum); // Throws
+        return to_ref(pos);
+    }
 
     // Write the block
     MapWindow* window = m_window_mgr.get_window(pos, size);
@@ -1352,6 +1439,8 @@ ref_type GroupWriter::write_array(const char* data, size_t size, uint32_t checks
     window->encryption_write_barrier(dest_addr, size);
     // return ref of the written array
     ref_type ref = to_ref(pos);
+    if (m_journal_record)
+        m_journal_record->add(ref, dest_addr, size); // Throws
     return ref;
 }
 
@@ -1368,6 +1457,27 @@ void GroupWriter::write_array_at(T* translator, ref_type ref, const char* data,
     uint32_t dummy_checksum = 0x41414141UL; // "AAAA" in ASCII
     memcpy(dest_addr, &dummy_checksum, 4);
     memcpy(dest_addr + 4, data + 4, size - 4);
+    if (m_journal_record)
+        m_journal_record->add(ref, dest_addr, size); // Throws
+}
+
+void GroupWriter::buffer_array_at(ref_type ref, const char* data, size_t size, uint32_t checksum)
+{
+    if (m_buffered_arrays.size() + size > max_buffered_size && !m_buffered_arrays.empty())
+        write_buffered_arrays(); // Throws
+    size_t offset = m_buffered_arrays.size();
+    m_buffered_arrays.resize(offset + size); // Throws
+    char* dest_addr = m_buffered_arrays.data() + offset;
+    memcpy(dest_addr, &checksum, 4);
+    memcpy(dest_addr + 4, data + 4, size - 4);
+    if (!m_buffered_runs.empty() && m_buffered_runs.back().ref + m_buffered_runs.back().size == ref) {
+        m_buffered_runs.back().size += size;
+    }
+    else {
+        m_buffered_runs.push_back({ref, offset, size}); // Throws
+    }
+    if (m_journal_record)
+        m_journal_record->add(ref, dest_addr, size); // Throws
 }
 
 
@@ -1386,20 +1496,48 @@ void GroupCommitter::commit(ref_type new_top_ref)
     // new snapshot. Other bits must remain unchanged.
     unsigned old_flags = file_header.m_flags;
     unsigned new_flags = old_flags ^ SlabAlloc::flags_SelectBit;
+    if (m_depends_on_journal) {
+        new_flags = *m_depends_on_journal ? new_flags | SlabAlloc::flags_Journal
+                                          : new_flags & ~unsigned(SlabAlloc::flags_Journal);
+    }
     int slot_selector = ((new_flags & SlabAlloc::flags_SelectBit) != 0 ? 1 : 0);
 
     // Update top ref and file format version
-    int file_format_version = m_group.get_file_format_version();
+    int file_format_version = m_file_format_version;
     using type_1 = std::remove_reference<decltype(file_header.m_file_format[0])>::type;
     REALM_ASSERT(!util::int_cast_has_overflow<type_1>(file_format_version));
+    using type_2 = std::remove_reference<decltype(file_header.m_flags)>::type;
+
+    // When running the test suite, device synchronization is disabled
+    bool disable_sync = get_disable_sync_to_disk() || m_durability == Durability::Unsafe;
+
+    if (m_io_uring) {
+        // The header is only read through the mapping. The new top ref is
+        // written together with any writes already queued, and a single
+        // fsync covers all of them.
+        SlabAlloc::Header header = file_header;
+        header.m_file_format[slot_selector] = type_1(file_format_version);
+        header.m_top_ref[slot_selector] = new_top_ref;
+        m_io_uring->write(0, reinterpret_cast<const char*>(&header), sizeof header); // Throws
+        if (!disable_sync)
+            m_io_uring->sync(); // Throws
+        m_io_uring->wait();     // Throws
+
+        // Flip the slot selector bit
+        header.m_flags = type_2(new_flags);
+        m_io_uring->write(offsetof(SlabAlloc::Header, m_flags), reinterpret_cast<const char*>(&header.m_flags),
+                          sizeof header.m_flags); // Throws
+        if (!disable_sync)
+            m_io_uring->sync(); // Throws
+        m_io_uring->wait();     // Throws
+        return;
+    }
+
     // only write the file format field if necessary (optimization)
     if (type_1(file_format_version) != file_header.m_file_format[slot_selector]) {
         // write barrier on the entire `file_header` happens below
         file_header.m_file_format[slot_selector] = type_1(file_format_version);
     }
-
-    // When running the test suite, device synchronization is disabled
-    bool disable_sync = get_disable_sync_to_disk() || m_durability == Durability::Unsafe;
     file_header.m_top_ref[slot_selector] = new_top_ref;
 
     // Make sure that that all data relating to the new snapshot is written to
@@ -1413,7 +1551,6 @@ void GroupCommitter::commit(ref_type new_top_ref)
 
     // Flip the slot selector bit.
     window->encryption_read_barrier(&file_header, sizeof file_header);
-    using type_2 = std::remove_reference<decltype(file_header.m_flags)>::type;
     file_header.m_flags = type_2(new_flags);
 
     // Write new selector to disk
@@ -22,10 +22,12 @@
 #include <cstdint> // unint8_t etc
 #include <utility>
 #include <map>
+#include <optional>
 
 #include <realm/util/file.hpp>
 #include <realm/alloc.hpp>
 #include <realm/array.hpp>
+#include <realm/commit_journal.hpp>
 #include <realm/impl/array_writer.hpp>
 #include <realm/db_options.hpp>
 
@@ -35,8 +37,10 @@ namespace realm {
 // Pre-declarations
 class Transaction;
 class SlabAlloc;
+struct DBMetrics;
 namespace util {
 class WriteMarker;
+class IoUringWriter;
 }
 
 class Reachable {
@@ -95,17 +99,37 @@ public:
     using Durability = DBOptions::Durability;
     using MapWindow = WriteWindowMgr::MapWindow;
     GroupCommitter(Transaction&, Durability dura = Durability::Full, util::WriteMarker* write_marker = nullptr);
+    GroupCommitter(SlabAlloc&, int file_format_version, Durability dura = Durability::Full,
+                   util::WriteMarker* write_marker = nullptr);
     ~GroupCommitter();
+
+    /// Write the file header through `writer` rather than the memory mapping.
+    /// Writes already queued on it are submitted together with the new top
+    /// ref, and synchronized by the same fsync.
+    void set_io_uring(util::IoUringWriter* writer) noexcept
+    {
+        m_io_uring = writer;
+    }
+
+    /// Mark the file header as depending on the commit journal, or clear the
+    /// mark, along with the new top ref. It is left as it is by default.
+    void set_depends_on_journal(bool value) noexcept
+    {
+        m_depends_on_journal = value;
+    }
+
     /// Flush changes to physical medium, then write the new top ref
     /// to the file header, then flush again. Pass the top ref
     /// returned by write_group().
     void commit(ref_type new_top_ref);
 
 protected:
-    Transaction& m_group;
     SlabAlloc& m_alloc;
+    int m_file_format_version;
     Durability m_durability;
     WriteWindowMgr m_window_mgr;
+    util::IoUringWriter* m_io_uring = nullptr;
+    std::optional<bool> m_depends_on_journal;
 };
 
 /// This class is not supposed to be reused for multiple write sessions. In
@@ -129,6 +153,43 @@ public:
 
     void set_versions(uint64_t current, TopRefMap& top_refs, bool any_num_unreachables) noexcept;
 
+    /// Write the leaves of non-nullable integer columns in the packed encoding
+    /// when that saves space. See DBOptions::pack_integer_columns.
+    void set_pack_integer_columns(bool value) noexcept
+    {
+        m_pack_integer_columns = value;
+    }
+
+    /// Start evacuating the end of the file as soon as the free space exceeds
+    /// the used space, rather than twice the used space. Used for the commits
+    /// made by DB::async_compact().
+    void set_eager_evacuation(bool value) noexcept
+    {
+        m_eager_evacuation = value;
+    }
+
+    /// Add every array written to the file to `record`. Used when commits
+    /// are made durable through a CommitJournal.
+    void set_journal_record(CommitJournal::Record* record) noexcept
+    {
+        m_journal_record = record;
+    }
+
+    /// Write the arrays through `writer` rather than the memory mappings. They
+    /// are copied to a buffer, and written when the commit is synchronized or
+    /// flushed, or when queue_writes() is called. See DBOptions::use_io_uring.
+    void set_io_uring(util::IoUringWriter* writer) noexcept
+    {
+        m_io_uring = writer;
+    }
+
+    /// Record the time spent by write_group() on the free lists and on
+    /// writing arrays in `metrics`. See DBOptions::enable_metrics.
+    void set_metrics(DBMetrics* metrics) noexcept
+    {
+        m_metrics = metrics;
+    }
+
     /// Write all changed array nodes into free space.
     ///
     /// Returns the new top ref. When in full durability mode, call
@@ -197,6 +258,14 @@ public:
         }
     }
     void sync_according_to_durability();
+    /// Write back all changes made through the mappings to the file without
+    /// synchronizing it to disk. Used when the commit is made durable later.
+    void flush_all_mappings();
+    /// Queue the writes of the buffered arrays on the IoUringWriter without
+    /// waiting for them. They are completed by the next
+    /// IoUringWriter::wait(), which must be called before this GroupWriter is
+    /// destroyed.
+    void queue_writes();
 
 private:
     friend class InMemoryWriter;
@@ -232,6 +301,23 @@ private:
     size_t m_evacuation_limit;
     int64_t m_backoff;
     size_t m_logical_size = 0;
+    bool m_pack_integer_columns = false;
+    bool m_eager_evacuation = false;
+    CommitJournal::Record* m_journal_record = nullptr;
+
+    // Only used with an IoUringWriter: the arrays not written yet, and the
+    // runs of adjacent ones in m_buffered_arrays
+    struct BufferedRun {
+        ref_type ref;
+        size_t offset;
+        size_t size;
+    };
+    DBMetrics* m_metrics = nullptr;
+    util::IoUringWriter* m_io_uring = nullptr;
+    std::vector<char> m_buffered_arrays;
+    std::vector<BufferedRun> m_buffered_runs;
+    // Once this much is buffered, the buffered arrays are written before more are added
+    static constexpr size_t max_buffered_size = 16 * 1024 * 1024;
 
     //  m_free_in_file;
     std::vector<FreeSpaceEntry> m_not_free_in_file;
@@ -283,6 +369,11 @@ private:
 
     template <class T>
     void write_array_at(T* translator, ref_type, const char* data, size_t size);
+    /// Copy an array to the buffer of arrays to be written through the
+    /// IoUringWriter.
+    void buffer_array_at(ref_type, const char* data, size_t size, uint32_t checksum);
+    /// Write the buffered arrays through the IoUringWriter and wait for them.
+    void write_buffered_arrays();
     FreeListElement split_freelist_chunk(FreeListElement, size_t alloc_pos);
 
     /// Backdate (if possible) any blocks in the freelist belonging to
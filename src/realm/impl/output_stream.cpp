@@ -39,6 +39,19 @@ void OutputStream::write(const char* data, size_t size)
 }
 
 
+ref_type OutputStream::skip(size_t size)
+{
+    REALM_ASSERT(size % 8 == 0);
+
+    m_out.flush(); // Throws
+    ref_type ref = m_next_ref;
+    if (int_add_with_overflow_detect(m_next_ref, size))
+        throw util::overflow_error("Stream size overflow");
+    m_out.seekp(std::streamoff(m_next_ref)); // Throws
+    return ref;
+}
+
+
 ref_type OutputStream::write_array(const char* data, size_t size, uint32_t checksum)
 {
     REALM_ASSERT(size % 8 == 0);
@@ -41,6 +41,12 @@ public:
 
     void write(const char* data, size_t size);
 
+    /// Leave a gap of `size` bytes in the output, to be filled in by other
+    /// means, and return the ref of its start. Anything written so far is
+    /// flushed first. The underlying stream must support seeking, and must
+    /// have been at its start when this OutputStream was created.
+    ref_type skip(size_t size);
+
     ref_type write_array(const char* data, size_t size, uint32_t checksum) override;
 
 private:
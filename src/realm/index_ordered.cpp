@@ -0,0 +1,283 @@
+/*************************************************************************
+ *
+ * Copyright 2023 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/index_ordered.hpp>
+#include <realm/unicode.hpp>
+#include <realm/util/thread_pool.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+using namespace realm;
+
+OrderedIndex::OrderedIndex(const ClusterColumn& target_column, Allocator& alloc)
+    : SearchIndex(target_column, &m_top)
+    , m_top(alloc)
+    , m_values(alloc)
+    , m_keys(alloc)
+{
+    m_top.create(Array::type_HasRefs, false, 2, 0); // Throws
+    _impl::DeepArrayDestroyGuard dg(&m_top);
+    m_values.set_parent(&m_top, 0);
+    m_keys.set_parent(&m_top, 1);
+    m_values.create(); // Throws
+    m_keys.create();   // Throws
+    dg.release();
+}
+
+OrderedIndex::OrderedIndex(ref_type ref, ArrayParent* parent, size_t ndx_in_parent,
+                           const ClusterColumn& target_column, Allocator& alloc)
+    : SearchIndex(target_column, &m_top)
+    , m_top(alloc)
+    , m_values(alloc)
+    , m_keys(alloc)
+{
+    m_top.init_from_ref(ref);
+    m_top.set_parent(parent, ndx_in_parent);
+    m_values.set_parent(&m_top, 0);
+    m_keys.set_parent(&m_top, 1);
+    init_trees();
+}
+
+void OrderedIndex::init_trees()
+{
+    m_values.init_from_parent();
+    m_keys.init_from_parent();
+}
+
+void OrderedIndex::update_from_parent() noexcept
+{
+    m_top.update_from_parent();
+    init_trees();
+}
+
+void OrderedIndex::refresh_accessor_tree(const ClusterColumn& target_column)
+{
+    m_top.init_from_parent();
+    init_trees();
+    m_target_column = target_column;
+}
+
+size_t OrderedIndex::lower_bound(const Mixed& value) const
+{
+    return m_values.partition_point([&](size_t, const Mixed& v) {
+        return v.compare(value) < 0;
+    });
+}
+
+size_t OrderedIndex::upper_bound(const Mixed& value) const
+{
+    return m_values.partition_point([&](size_t, const Mixed& v) {
+        return v.compare(value) <= 0;
+    });
+}
+
+size_t OrderedIndex::insert_position(const Mixed& value, ObjKey key) const
+{
+    // Entries with equal values are ordered by key
+    size_t begin = lower_bound(value);
+    size_t end = upper_bound(value);
+    if (begin == end)
+        return begin;
+    return m_keys.partition_point([&](size_t ndx, int64_t k) {
+        return ndx < begin || (ndx < end && k < key.value);
+    });
+}
+
+size_t OrderedIndex::find(const Mixed& value, ObjKey key) const
+{
+    size_t ndx = insert_position(value, key);
+    if (ndx < size() && m_keys.get(ndx) == key.value)
+        return ndx;
+    return realm::npos;
+}
+
+void OrderedIndex::get_keys(size_t begin, size_t end, std::vector<ObjKey>& result) const
+{
+    result.reserve(result.size() + (end - begin));
+    for (size_t i = begin; i < end; ++i)
+        result.push_back(ObjKey(m_keys.get(i)));
+}
+
+void OrderedIndex::insert(ObjKey key, const Mixed& value)
+{
+    size_t ndx = insert_position(value, key);
+    m_values.insert(ndx, value); // Throws
+    m_keys.insert(ndx, key.value); // Throws
+}
+
+void OrderedIndex::set(ObjKey key, const Mixed& new_value)
+{
+    Mixed old_value = m_target_column.get_value(key);
+    if (old_value.compare(new_value) == 0)
+        return;
+
+    erase(key);
+    insert(key, new_value); // Throws
+}
+
+void OrderedIndex::erase(ObjKey key)
+{
+    size_t ndx = find(m_target_column.get_value(key), key);
+    REALM_ASSERT(ndx != realm::npos);
+    m_values.erase(ndx);
+    m_keys.erase(ndx);
+}
+
+void OrderedIndex::clear()
+{
+    m_values.clear();
+    m_keys.clear();
+}
+
+ObjKey OrderedIndex::find_first(const Mixed& value) const
+{
+    size_t ndx = lower_bound(value);
+    if (ndx < size() && m_values.get(ndx).compare(value) == 0)
+        return get_key(ndx);
+    return {};
+}
+
+void OrderedIndex::find_all(std::vector<ObjKey>& result, Mixed value, bool case_insensitive) const
+{
+    if (case_insensitive && value.is_type(type_String)) {
+        // Entries equal except for case are not adjacent, so this must visit all non-null strings
+        auto needle = case_map(value.get_string(), true, IgnoreErrors);
+        for (size_t i = begin_non_null(); i < size(); ++i) {
+            Mixed v = m_values.get(i);
+            if (v.is_type(type_String) && case_map(v.get_string(), true, IgnoreErrors) == needle)
+                result.push_back(get_key(i));
+        }
+        std::sort(result.begin(), result.end());
+        return;
+    }
+    get_keys(lower_bound(value), upper_bound(value), result);
+}
+
+FindRes OrderedIndex::find_all_no_copy(Mixed value, InternalFindResult& result) const
+{
+    size_t begin = lower_bound(value);
+    size_t end = upper_bound(value);
+    if (begin == end)
+        return FindRes_not_found;
+    if (end - begin == 1) {
+        result.payload = m_keys.get(begin);
+        return FindRes_single;
+    }
+    // The keys of equal values are stored in ascending order, so the range can be used directly
+    result.payload = int64_t(m_keys.get_ref());
+    result.start_ndx = begin;
+    result.end_ndx = end;
+    return FindRes_column;
+}
+
+size_t OrderedIndex::count(const Mixed& value) const
+{
+    return upper_bound(value) - lower_bound(value);
+}
+
+bool OrderedIndex::has_duplicate_values() const noexcept
+{
+    size_t sz = size();
+    for (size_t i = 1; i < sz; ++i) {
+        if (m_values.get(i - 1).compare(m_values.get(i)) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool OrderedIndex::is_empty() const
+{
+    return size() == 0;
+}
+
+void OrderedIndex::insert_bulk(const ArrayUnsigned* keys, uint64_t key_offset, size_t num_values,
+                               ArrayPayload& values)
+{
+    std::vector<Entry> entries;
+    entries.reserve(num_values);
+    for (size_t i = 0; i < num_values; ++i) {
+        ObjKey key(keys ? keys->get(i) + key_offset : i + key_offset);
+        entries.push_back({values.get_any(i), key});
+    }
+    insert_entries(entries); // Throws
+}
+
+void OrderedIndex::insert_entries(std::vector<Entry>& entries)
+{
+    if (entries.empty())
+        return;
+
+    constexpr size_t min_entries_per_run = 0x10000;
+    auto less = [](const Entry& a, const Entry& b) {
+        int c = a.value.compare(b.value);
+        return c < 0 || (c == 0 && a.key < b.key);
+    };
+    util::parallel_sort(util::ThreadPool::get_default(), entries.begin(), entries.end(), less,
+                        min_entries_per_run); // Throws
+
+    // The entries which sort after all the existing ones, which is all of them when the index is built from
+    // scratch, are appended to the last leaves. The others are inserted where they belong.
+    auto appended = entries.begin();
+    if (size_t sz = size()) {
+        Entry last{m_values.get(sz - 1), get_key(sz - 1)};
+        appended = std::upper_bound(entries.begin(), entries.end(), last, less);
+        for (auto it = entries.begin(); it != appended; ++it)
+            insert(it->key, it->value); // Throws
+    }
+    for (auto it = appended; it != entries.end(); ++it) {
+        m_values.add(it->value);  // Throws
+        m_keys.add(it->key.value); // Throws
+    }
+}
+
+void OrderedIndex::insert_bulk_list(const ArrayUnsigned*, uint64_t, size_t, ArrayInteger&)
+{
+    // Collections cannot have an ordered index, see Table::do_add_search_index()
+    REALM_UNREACHABLE();
+}
+
+void OrderedIndex::verify() const
+{
+    m_values.verify();
+    m_keys.verify();
+    REALM_ASSERT(m_values.size() == m_keys.size());
+    size_t sz = size();
+    for (size_t i = 1; i < sz; ++i) {
+        int c = m_values.get(i - 1).compare(m_values.get(i));
+        REALM_ASSERT(c < 0 || (c == 0 && m_keys.get(i - 1) < m_keys.get(i)));
+    }
+#ifdef REALM_DEBUG
+    if (m_target_column.size() == sz) {
+        for (size_t i = 0; i < sz; ++i) {
+            REALM_ASSERT(m_target_column.get_value(get_key(i)).compare(m_values.get(i)) == 0);
+        }
+    }
+#endif
+}
+
+#ifdef REALM_DEBUG // LCOV_EXCL_START ignore debug functions
+
+void OrderedIndex::print() const
+{
+    size_t sz = size();
+    for (size_t i = 0; i < sz; ++i)
+        std::cout << i << ": " << m_values.get(i) << " -> " << get_key(i) << std::endl;
+}
+
+#endif // LCOV_EXCL_STOP ignore debug functions
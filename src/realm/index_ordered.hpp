@@ -0,0 +1,132 @@
+/*************************************************************************
+ *
+ * Copyright 2023 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_ORDERED_HPP
+#define REALM_INDEX_ORDERED_HPP
+
+#include <realm/array_mixed.hpp>
+#include <realm/bplustree.hpp>
+#include <realm/column_integer.hpp>
+#include <realm/search_index.hpp>
+
+/*
+The OrderedIndex keeps all (value, object key) pairs of a column sorted by value, and by key for equal values. The
+pairs are stored in two B+trees of equal size, one holding the values and one holding the keys:
+
+    top (HasRefs)
+     |-- 0: BPlusTree<Mixed>  values, ascending according to Mixed::compare()
+     `-- 1: IntegerColumn     object keys, ascending within each run of equal values
+
+Values are compared with Mixed::compare(), which is also what query conditions and SortDescriptor use, so a range
+of positions in the index is exactly the set of objects matching a range condition, and walking the index yields
+the objects in sorted order. Null sorts before any other value.
+
+Unlike the StringIndex, the full value is stored, so strings are not truncated to a prefix, and the memory use is
+comparable to that of the indexed column itself.
+*/
+
+namespace realm {
+
+class OrderedIndex : public SearchIndex {
+public:
+    OrderedIndex(const ClusterColumn& target_column, Allocator&);
+    OrderedIndex(ref_type, ArrayParent*, size_t ndx_in_parent, const ClusterColumn& target_column, Allocator&);
+
+    static bool type_supported(realm::DataType type)
+    {
+        return (type == type_Int || type == type_String || type == type_Timestamp || type == type_Float ||
+                type == type_Double || type == type_Decimal || type == type_ObjectId);
+    }
+
+    // SearchIndex interface:
+    void insert(ObjKey key, const Mixed& value) final;
+    void set(ObjKey key, const Mixed& new_value) final;
+    ObjKey find_first(const Mixed& value) const final;
+    void find_all(std::vector<ObjKey>& result, Mixed value, bool case_insensitive = false) const final;
+    FindRes find_all_no_copy(Mixed value, InternalFindResult& result) const final;
+    size_t count(const Mixed& value) const final;
+    void erase(ObjKey key) final;
+    void clear() final;
+    bool has_duplicate_values() const noexcept final;
+    bool is_empty() const final;
+    void insert_bulk(const ArrayUnsigned* keys, uint64_t key_offset, size_t num_values, ArrayPayload& values) final;
+    void insert_bulk_list(const ArrayUnsigned* keys, uint64_t key_offset, size_t num_values,
+                          ArrayInteger& ref_array) final;
+    void verify() const final;
+#ifdef REALM_DEBUG
+    void print() const final;
+#endif // REALM_DEBUG
+
+    void update_from_parent() noexcept final;
+    void refresh_accessor_tree(const ClusterColumn& target_column) final;
+
+    // Ordered access:
+
+    /// Number of entries, which is the number of objects in the table.
+    size_t size() const noexcept
+    {
+        return m_keys.size();
+    }
+    Mixed get(size_t ndx) const
+    {
+        return m_values.get(ndx);
+    }
+    ObjKey get_key(size_t ndx) const
+    {
+        return ObjKey(m_keys.get(ndx));
+    }
+
+    /// Position of the first entry whose value is not less than `value`.
+    size_t lower_bound(const Mixed& value) const;
+    /// Position of the first entry whose value is greater than `value`.
+    size_t upper_bound(const Mixed& value) const;
+    /// Position of the first entry that is not null.
+    size_t begin_non_null() const
+    {
+        return upper_bound(Mixed());
+    }
+
+    /// Append the keys of the entries in positions [begin, end) to `result`.
+    void get_keys(size_t begin, size_t end, std::vector<ObjKey>& result) const;
+
+    struct Entry {
+        Mixed value;
+        ObjKey key;
+    };
+    /// Insert many entries at once. They are sorted first (in parallel when
+    /// there are many of them), and those which sort after all the existing
+    /// entries are appended, so building an index this way does not search
+    /// the trees at all. Strings and binaries referenced by the values must
+    /// stay valid until this returns.
+    void insert_entries(std::vector<Entry>& entries);
+
+private:
+    // Position of the entry for (value, key), or npos
+    size_t find(const Mixed& value, ObjKey key) const;
+    // Position where (value, key) should be inserted
+    size_t insert_position(const Mixed& value, ObjKey key) const;
+    void init_trees();
+
+    Array m_top;
+    BPlusTree<Mixed> m_values;
+    IntegerColumn m_keys;
+};
+
+} // namespace realm
+
+#endif // REALM_INDEX_ORDERED_HPP
@@ -16,6 +16,7 @@
  *
  **************************************************************************/
 
+#include <cmath>
 #include <cstdio>
 #include <iomanip>
 #include <list>
@@ -32,6 +33,7 @@
 #include <realm/column_integer.hpp>
 #include <realm/unicode.hpp>
 #include <realm/tokenizer.hpp>
+#include <realm/util/thread_pool.hpp>
 
 using namespace realm;
 using namespace realm::util;
@@ -1380,61 +1382,93 @@ void StringIndex::erase_list(ObjKey key, const Lst<String>& list)
 }
 
 namespace {
-template <typename T>
-void intersect(std::vector<ObjKey>& result, T& keys)
-{
-    if (result.empty()) {
-        result.reserve(keys.size());
-        for (auto k : keys) {
-            result.emplace_back(k);
-        }
-    }
-    else {
-        auto it = result.begin();
-        auto keep = it;
-        auto m = keys.begin();
-
-        // only keep intersection
-        while (it != result.end() && m != keys.end()) {
-            int64_t int_val = *m;
-            if (it->value < int_val) {
-                it++; // don't keep if match is not in new set
-            }
-            else if (it->value > int_val) {
-                ++m; // ignore new matches
-            }
-            else {
-                // Found both places - make sure it is kept
-                if (keep < it)
-                    *keep = *it;
-                ++keep;
-                ++it;
-                ++m;
-            }
-        }
-        if (keep != result.end()) {
-            result.erase(keep, result.end());
-        }
+// Position of the first of the ascending values get(begin), ..., get(end - 1) which is not less than `value`. The
+// search steps forward from `begin` in doubling strides before bisecting, so looking up ascending values one after
+// the other costs time logarithmic in the distance between their positions rather than in the length of the list.
+template <typename Getter>
+size_t gallop(const Getter& get, size_t begin, size_t end, int64_t value)
+{
+    size_t lo = begin;
+    size_t hi = begin;
+    size_t step = 1;
+    while (hi < end && get(hi) < value) {
+        lo = hi + 1;
+        hi += step;
+        step *= 2;
+    }
+    hi = std::min(hi, end);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (get(mid) < value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Only keep the keys in `result` which are also among get(begin), ..., get(end - 1)
+template <typename Getter>
+void intersect(std::vector<ObjKey>& result, const Getter& get, size_t begin, size_t end)
+{
+    auto keep = result.begin();
+    for (auto key : result) {
+        begin = gallop(get, begin, end, key.value);
+        if (begin == end)
+            break;
+        if (get(begin) == key.value)
+            *keep++ = key;
     }
+    result.erase(keep, result.end());
 }
 
-struct FindResWrapper {
-    InternalFindResult& res;
-    IntegerColumn& indexes;
-    size_t n = 0;
-    size_t size()
-    {
-        return res.end_ndx - res.start_ndx;
-    }
-    auto begin()
+// The keys of the objects containing one search token
+struct Postings {
+    size_t size() const
     {
-        return indexes.cbegin();
-    }
-    auto end()
-    {
-        return indexes.cend();
+        return column ? end - begin : keys.size();
     }
+    std::vector<ObjKey> keys;
+    // If not zero, the keys are in positions [begin, end) of the IntegerColumn with this ref instead
+    ref_type column = 0;
+    size_t begin = 0;
+    size_t end = 0;
 };
+
+// Checks whether the words of `text` contain each of the phrases. The words are read once, keeping for every phrase
+// the lengths of its beginnings which end with the previous word, and reading stops once all phrases are found.
+bool contains_phrases(Tokenizer& tokenizer, std::string_view text,
+                      const std::vector<std::vector<std::string>>& phrases)
+{
+    std::vector<std::vector<size_t>> matched(phrases.size());
+    std::vector<bool> found(phrases.size(), false);
+    size_t remaining = phrases.size();
+    tokenizer.reset(text);
+    while (tokenizer.next()) {
+        auto word = tokenizer.get_token();
+        for (size_t i = 0; i < phrases.size(); ++i) {
+            if (found[i])
+                continue;
+            auto& phrase = phrases[i];
+            auto& lengths = matched[i];
+            // Lengths are kept longest first
+            auto keep = lengths.begin();
+            for (auto len : lengths) {
+                if (phrase[len] == word)
+                    *keep++ = len + 1;
+            }
+            lengths.erase(keep, lengths.end());
+            if (phrase.front() == word)
+                lengths.push_back(1);
+            if (!lengths.empty() && lengths.front() == phrase.size()) {
+                found[i] = true;
+                if (--remaining == 0)
+                    return true;
+            }
+        }
+    }
+    return false;
+}
 } // namespace
 
 void StringIndex::insert_bulk(const ArrayUnsigned* keys, uint64_t key_offset, size_t num_values, ArrayPayload& values)
@@ -1475,6 +1509,129 @@ void StringIndex::insert_bulk_list(const ArrayUnsigned* keys, uint64_t key_offse
 }
 
 
+namespace {
+
+// Orders entries the way they are laid out in the index: by the 4 byte keys of
+// their index data at each offset, then as the lists of duplicates are sorted,
+// by value (nulls first) and object key.
+struct EntryLess {
+    bool operator()(const StringIndex::Entry& a, const StringIndex::Entry& b) const noexcept
+    {
+        StringConversionBuffer buffer_a, buffer_b;
+        StringData data_a = a.value.get_index_data(buffer_a);
+        StringData data_b = b.value.get_index_data(buffer_b);
+        for (size_t offset = 0; offset <= StringIndex::s_max_offset; offset += StringIndex::s_index_key_length) {
+            StringIndex::key_type key_a = StringIndex::create_key(data_a, offset);
+            StringIndex::key_type key_b = StringIndex::create_key(data_b, offset);
+            if (key_a != key_b)
+                return key_a < key_b;
+            // Past the end of both, all keys are zero
+            if (offset > data_a.size() && offset > data_b.size())
+                break;
+        }
+        if (a.value.is_null() != b.value.is_null())
+            return a.value.is_null();
+        if (!a.value.is_null()) {
+            if (int cmp = a.value.compare(b.value))
+                return cmp < 0;
+        }
+        return a.key < b.key;
+    }
+};
+
+} // namespace
+
+void StringIndex::build(std::vector<Entry>& entries)
+{
+    REALM_ASSERT(is_empty());
+    REALM_ASSERT(!m_target_column.full_word());
+    if (entries.empty())
+        return;
+
+    constexpr size_t min_entries_per_run = 0x10000;
+    util::parallel_sort(util::ThreadPool::get_default(), entries.begin(), entries.end(), EntryLess(),
+                        min_entries_per_run); // Throws
+
+    ref_type ref = build_tree(m_array->get_alloc(), entries.data(), entries.data() + entries.size(), 0); // Throws
+    m_array->destroy_deep();
+    m_array->init_from_ref(ref);
+    m_array->update_parent(); // Throws
+}
+
+// Build the (sub)index of the sorted entries in [begin, end), which all have
+// the same index data before `offset`, and return the ref of its root.
+ref_type StringIndex::build_tree(Allocator& alloc, const Entry* begin, const Entry* end, size_t offset)
+{
+    StringConversionBuffer buffer;
+    auto get_key = [&](const Entry* entry) {
+        return create_key(entry->value.get_index_data(buffer), offset);
+    };
+
+    // The slots of the leaves, one for each distinct key at this offset
+    std::vector<std::pair<key_type, int64_t>> slots;
+    for (const Entry* group_begin = begin; group_begin != end;) {
+        key_type key = get_key(group_begin);
+        const Entry* group_end = group_begin + 1;
+        while (group_end != end && get_key(group_end) == key)
+            ++group_end;
+
+        if (group_end - group_begin == 1) {
+            slots.emplace_back(key, int64_t((uint64_t(group_begin->key.value) << 1) + 1)); // literal
+        }
+        else {
+            // Like leaf_insert(), the entries are kept in a list if they all
+            // have the same index data, or if the index must not be nested
+            // any deeper. They are already in the order of the list then.
+            StringConversionBuffer first_buffer, other_buffer;
+            StringData first_data = group_begin->value.get_index_data(first_buffer);
+            bool make_list = offset + s_index_key_length > s_max_offset ||
+                             std::all_of(group_begin + 1, group_end, [&](const Entry& entry) {
+                                 return entry.value.get_index_data(other_buffer) == first_data;
+                             });
+            if (make_list) {
+                IntegerColumn list(alloc);
+                list.create(); // Throws
+                for (const Entry* entry = group_begin; entry != group_end; ++entry)
+                    list.add(entry->key.value); // Throws
+                slots.emplace_back(key, int64_t(list.get_ref()));
+            }
+            else {
+                ref_type subindex = build_tree(alloc, group_begin, group_end, offset + s_index_key_length); // Throws
+                slots.emplace_back(key, int64_t(subindex));
+            }
+        }
+        group_begin = group_end;
+    }
+
+    // Pack the slots into full leaves, and then the leaves into full inner
+    // nodes, level by level until a single root remains.
+    std::vector<ref_type> nodes;
+    for (size_t i = 0; i < slots.size(); i += REALM_MAX_BPNODE_SIZE) {
+        std::unique_ptr<IndexArray> leaf = create_node(alloc, true); // Throws
+        Array keys(alloc);
+        get_child(*leaf, 0, keys);
+        size_t leaf_end = std::min(slots.size(), i + REALM_MAX_BPNODE_SIZE);
+        for (size_t j = i; j < leaf_end; ++j) {
+            keys.add(slots[j].first);   // Throws
+            leaf->add(slots[j].second); // Throws
+        }
+        nodes.push_back(leaf->get_ref());
+    }
+    while (nodes.size() > 1) {
+        std::vector<ref_type> parents;
+        for (size_t i = 0; i < nodes.size(); i += REALM_MAX_BPNODE_SIZE) {
+            StringIndex node(inner_node_tag(), alloc);
+            size_t node_end = std::min(nodes.size(), i + REALM_MAX_BPNODE_SIZE);
+            for (size_t j = i; j < node_end; ++j)
+                node.node_add_key(nodes[j]); // Throws
+            parents.push_back(node.get_ref());
+        }
+        nodes = std::move(parents);
+    }
+    return nodes.front();
+}
+
+
 void StringIndex::find_all_fulltext(std::vector<ObjKey>& result, StringData value) const
 {
     InternalFindResult res;
@@ -1482,7 +1639,7 @@ void StringIndex::find_all_fulltext(std::vector<ObjKey>& result, StringData valu
 
     auto tokenizer = Tokenizer::get_instance();
     tokenizer->reset({value.data(), value.size()});
-    auto [includes, excludes] = tokenizer->get_search_tokens();
+    auto [includes, excludes, phrases] = tokenizer->get_search_tokens();
     if (includes.empty()) {
         if (excludes.empty()) {
             throw InvalidArgument("Missing search token");
@@ -1490,45 +1647,72 @@ void StringIndex::find_all_fulltext(std::vector<ObjKey>& result, StringData valu
         result = m_target_column.get_all_keys();
     }
     else {
+        // Look up the postings of all tokens before intersecting them, so that the intersection can start with
+        // the rarest token and only has to look up its few keys in the postings of the more common ones
+        std::vector<Postings> postings(includes.size());
+        auto p = postings.begin();
         for (auto& token : includes) {
             if (token.back() == '*') {
                 std::set<int64_t> keys;
                 m_array->index_string_find_all_prefix(keys, StringData(token.data(), token.size() - 1));
-                intersect(result, keys);
+                p->keys.reserve(keys.size());
+                for (auto k : keys)
+                    p->keys.emplace_back(k);
             }
             else {
                 switch (find_all_no_copy(StringData{token}, res)) {
                     case FindRes_not_found:
-                        result.clear();
                         break;
-                    case FindRes_column: {
-                        IntegerColumn indexes(m_array->get_alloc(), ref_type(res.payload));
-                        FindResWrapper wrapper{res, indexes};
-                        intersect(result, wrapper);
+                    case FindRes_column:
+                        p->column = ref_type(res.payload);
+                        p->begin = res.start_ndx;
+                        p->end = res.end_ndx;
                         break;
-                    }
                     case FindRes_single:
-                        // merge in single res
-                        if (result.empty()) {
-                            result.emplace_back(res.payload);
-                        }
-                        else {
-                            ObjKey key(res.payload);
-                            auto pos = std::lower_bound(result.begin(), result.end(), key);
-                            if (pos != result.end() && key == *pos) {
-                                result.clear();
-                                result.push_back(key);
-                            }
-                            else {
-                                result.clear();
-                            }
-                        }
+                        p->keys.emplace_back(res.payload);
                         break;
                 }
             }
-            if (result.empty())
+            if (p->size() == 0)
                 return;
+            ++p;
+        }
+        std::sort(postings.begin(), postings.end(), [](const Postings& a, const Postings& b) {
+            return a.size() < b.size();
+        });
+
+        auto& rarest = postings.front();
+        if (rarest.column) {
+            IntegerColumn column(m_array->get_alloc(), rarest.column);
+            result.reserve(rarest.size());
+            for (size_t i = rarest.begin; i < rarest.end; ++i)
+                result.emplace_back(column.get(i));
+        }
+        else {
+            result = std::move(rarest.keys);
+        }
+        for (auto it = postings.begin() + 1; it != postings.end() && !result.empty(); ++it) {
+            if (it->column) {
+                IntegerColumn column(m_array->get_alloc(), it->column);
+                intersect(
+                    result,
+                    [&](size_t i) {
+                        return column.get(i);
+                    },
+                    it->begin, it->end);
+            }
+            else {
+                auto& keys = it->keys;
+                intersect(
+                    result,
+                    [&](size_t i) {
+                        return keys[i].value;
+                    },
+                    0, keys.size());
+            }
         }
+        if (result.empty())
+            return;
     }
 
     for (auto& token : excludes) {
@@ -1583,6 +1767,100 @@ void StringIndex::find_all_fulltext(std::vector<ObjKey>& result, StringData valu
             }
         }
     }
+
+    if (!phrases.empty()) {
+        // The index has no token positions, so the words of the objects containing all tokens of the phrases are
+        // read again, up to where the last of the phrases is found
+        auto keep = result.begin();
+        for (auto key : result) {
+            Mixed value = m_target_column.get_value(key);
+            if (!value.is_type(type_String))
+                continue;
+            if (contains_phrases(*tokenizer, std::string_view(value.get_string()), phrases))
+                *keep++ = key;
+        }
+        result.erase(keep, result.end());
+    }
+}
+
+void StringIndex::rank_fulltext(std::vector<std::pair<ObjKey, double>>& result, StringData value,
+                                size_t num_objects, double avg_words) const
+{
+    REALM_ASSERT(result.empty());
+
+    std::vector<ObjKey> keys;
+    find_all_fulltext(keys, value);
+    if (keys.empty())
+        return;
+
+    auto tokenizer = Tokenizer::get_instance();
+    tokenizer->reset({value.data(), value.size()});
+    auto includes = tokenizer->get_search_tokens().includes;
+
+    // Rare words count for more, by the number of objects containing them
+    struct Term {
+        std::string_view word;
+        bool is_prefix;
+        double idf;
+    };
+    std::vector<Term> terms;
+    for (auto& token : includes) {
+        bool is_prefix = token.back() == '*';
+        std::string_view word(token.data(), is_prefix ? token.size() - 1 : token.size());
+        size_t df = 0;
+        if (is_prefix) {
+            std::set<int64_t> prefix_keys;
+            m_array->index_string_find_all_prefix(prefix_keys, StringData(word.data(), word.size()));
+            df = prefix_keys.size();
+        }
+        else {
+            InternalFindResult res;
+            switch (find_all_no_copy(StringData(word.data(), word.size()), res)) {
+                case FindRes_not_found:
+                    break;
+                case FindRes_column:
+                    df = res.end_ndx - res.start_ndx;
+                    break;
+                case FindRes_single:
+                    df = 1;
+                    break;
+            }
+        }
+        double n = double(std::max(num_objects, df));
+        terms.push_back({word, is_prefix, std::log((n - df + 0.5) / (df + 0.5) + 1)});
+    }
+
+    constexpr double k1 = 1.2;
+    constexpr double b = 0.75;
+    std::vector<size_t> frequencies(terms.size());
+    result.reserve(keys.size());
+    for (auto key : keys) {
+        Mixed text = m_target_column.get_value(key);
+        std::fill(frequencies.begin(), frequencies.end(), 0);
+        size_t num_words = 0;
+        if (text.is_type(type_String)) {
+            tokenizer->reset(std::string_view(text.get_string()));
+            while (tokenizer->next()) {
+                auto word = tokenizer->get_token();
+                ++num_words;
+                for (size_t i = 0; i < terms.size(); ++i) {
+                    auto& term = terms[i];
+                    if (term.is_prefix ? word.substr(0, term.word.size()) == term.word : word == term.word)
+                        ++frequencies[i];
+                }
+            }
+        }
+        double length_norm = k1 * (1 - b + b * (avg_words > 0 ? num_words / avg_words : 1));
+        double score = 0;
+        for (size_t i = 0; i < terms.size(); ++i) {
+            double tf = double(frequencies[i]);
+            score += terms[i].idf * tf * (k1 + 1) / (tf + length_norm);
+        }
+        result.emplace_back(key, score);
+    }
+    std::stable_sort(result.begin(), result.end(), [](auto& a, auto& b) {
+        return a.second > b.second;
+    });
 }
 
 
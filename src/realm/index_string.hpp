@@ -155,7 +155,23 @@ public:
     void insert_bulk_list(const ArrayUnsigned* keys, uint64_t key_offset, size_t num_values,
                           ArrayInteger& ref_array) final;
 
+    struct Entry {
+        Mixed value;
+        ObjKey key;
+    };
+    // Fill an empty index with all the entries at once. The entries are sorted
+    // (in parallel when there are many of them) and the index is then built
+    // bottom-up from full nodes, which is much faster than inserting them one
+    // by one. Strings and binaries referenced by the values must stay valid
+    // until this returns. Not supported for full-text and list indexes.
+    void build(std::vector<Entry>& entries);
+
     void find_all_fulltext(std::vector<ObjKey>& result, StringData value) const;
+    // Score the objects matching the full-text search `value` by BM25, best
+    // match first. `num_objects` is the number of objects in the table and
+    // `avg_words` the average number of words in their text.
+    void rank_fulltext(std::vector<std::pair<ObjKey, double>>& result, StringData value, size_t num_objects,
+                       double avg_words) const;
 
     void clear() override;
     bool has_duplicate_values() const noexcept override;
@@ -213,6 +229,7 @@ private:
 
     static std::unique_ptr<IndexArray> create_node(Allocator&, bool is_leaf);
 
+    static ref_type build_tree(Allocator&, const Entry* begin, const Entry* end, size_t offset);
     void insert_with_offset(ObjKey key, StringData index_data, const Mixed& value, size_t offset);
     void insert_row_list(size_t ref, size_t offset, StringData value);
     void insert_to_existing_list(ObjKey key, Mixed value, IntegerColumn& list);
@@ -52,6 +52,7 @@ public:
         wtype_Bits = 0,     // width indicates how many bits every element occupies
         wtype_Multiply = 1, // width indicates how many bytes every element occupies
         wtype_Ignore = 2,   // each element is 1 byte
+        wtype_Packed = 3,   // size is the number of 64-bit words of payload, see Array::write_packed()
     };
 
     static const int header_size = 8; // Number of bytes used by header
@@ -159,6 +160,7 @@ public:
         // 0: bits      (width/8) * size
         // 1: multiply  width * size
         // 2: ignore    1 * size
+        // 3: packed    8 * size
         typedef unsigned char uchar;
         uchar* h = reinterpret_cast<uchar*>(header);
         h[4] = uchar((int(h[4]) & ~0x18) | int(value) << 3);
@@ -228,6 +230,9 @@ public:
             case wtype_Ignore:
                 num_bytes = size;
                 break;
+            case wtype_Packed:
+                num_bytes = size * 8;
+                break;
         }
 
         // Ensure 8-byte alignment
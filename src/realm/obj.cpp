@@ -44,6 +44,7 @@
 #include "realm/table_view.hpp"
 #include "realm/util/base64.hpp"
 #include "realm/util/overload.hpp"
+#include "realm/zone_map.hpp"
 
 #include <ostream>
 
@@ -552,6 +553,8 @@ int64_t Obj::_get<int64_t>(ColKey::Idx col_ndx) const
 
     ref_type ref = to_ref(Array::get(m_mem.get_addr(), col_ndx.val + 1));
     char* header = alloc.translate(ref);
+    if (REALM_UNLIKELY(Array::get_wtype_from_header(header) == Array::wtype_Packed))
+        return Array::get(header, m_row_ndx);
     int width = Array::get_width_from_header(header);
     char* data = Array::get_data_from_header(header);
     REALM_TEMPEX(return get_direct, width, (data, m_row_ndx));
@@ -1306,6 +1309,10 @@ Obj& Obj::set<int64_t>(ColKey col_key, int64_t value, bool is_default)
     if (index && !m_key.is_unresolved()) {
         index->set(m_key, value);
     }
+    ZoneMap* zone_map = m_table->get_zone_map(col_key);
+    if (zone_map && !m_key.is_unresolved()) {
+        zone_map->insert(m_key, value);
+    }
 
     Allocator& alloc = get_alloc();
     alloc.bump_content_version();
@@ -1385,6 +1392,9 @@ Obj& Obj::add_int(ColKey col_key, int64_t value)
                 if (SearchIndex* index = m_table->get_search_index(col_key)) {
                     index->set(m_key, new_val);
                 }
+                if (ZoneMap* zone_map = m_table->get_zone_map(col_key)) {
+                    zone_map->insert(m_key, new_val);
+                }
                 values.set(m_row_ndx, new_val);
             }
             else {
@@ -1400,6 +1410,9 @@ Obj& Obj::add_int(ColKey col_key, int64_t value)
             if (SearchIndex* index = m_table->get_search_index(col_key)) {
                 index->set(m_key, new_val);
             }
+            if (ZoneMap* zone_map = m_table->get_zone_map(col_key)) {
+                zone_map->insert(m_key, new_val);
+            }
             values.set(m_row_ndx, new_val);
         }
     }
@@ -1678,6 +1691,10 @@ Obj& Obj::set(ColKey col_key, T value, bool is_default)
     if (index && !m_key.is_unresolved()) {
         index->set(m_key, value);
     }
+    ZoneMap* zone_map = m_table->get_zone_map(col_key);
+    if (zone_map && !m_key.is_unresolved()) {
+        zone_map->insert(m_key, value);
+    }
 
     Allocator& alloc = get_alloc();
     alloc.bump_content_version();
@@ -2327,6 +2344,10 @@ Obj& Obj::set_null(ColKey col_key, bool is_default)
     if (index && !m_key.is_unresolved()) {
         index->set(m_key, null{});
     }
+    ZoneMap* zone_map = m_table->get_zone_map(col_key);
+    if (zone_map && !m_key.is_unresolved()) {
+        zone_map->insert(m_key, Mixed());
+    }
 
     switch (col_type) {
         case col_type_Int:
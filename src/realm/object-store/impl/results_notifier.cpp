@@ -21,6 +21,7 @@
 #include <realm/object-store/shared_realm.hpp>
 #include <realm/util/scope_exit.hpp>
 
+#include <algorithm>
 #include <numeric>
 
 using namespace realm;
@@ -114,17 +115,13 @@ bool ResultsNotifier::do_add_required_change_info(TransactionChangeInfo& info)
         update_related_tables(*m_query->get_table());
     }
 
-    return m_query->get_table() && has_run() && have_callbacks();
+    m_table_changes_tracked = m_query->get_table() && has_run() && have_callbacks();
+    return m_table_changes_tracked;
 }
 
-void ResultsNotifier::calculate_changes()
+void ResultsNotifier::calculate_changes(ObjKeys next_objs)
 {
     if (has_run() && have_callbacks()) {
-        ObjKeys next_objs;
-        next_objs.reserve(m_run_tv.size());
-        for (size_t i = 0; i < m_run_tv.size(); ++i)
-            next_objs.push_back(m_run_tv.get_key(i));
-
         auto table_key = m_query->get_table()->get_key();
         if (auto it = m_info->tables.find(table_key); it != m_info->tables.end()) {
             auto& changes = it->second;
@@ -138,15 +135,101 @@ void ResultsNotifier::calculate_changes()
         m_change = CollectionChangeBuilder::calculate(m_previous_objs, next_objs,
                                                       get_modification_checker(*m_info, m_query->get_table()),
                                                       m_target_is_in_table_order);
+    }
+    m_previous_objs = std::move(next_objs);
+}
 
-        m_previous_objs = std::move(next_objs);
+// Bring the results of the previous run up to date by checking only the
+// objects which were inserted or modified against the query, and merging
+// those which match into the results at their position in the sort order.
+// This is only possible when neither the query nor the sort follows a link,
+// as a change to a linked object, even one in the same table, can change the
+// match or the position of the objects linking to it. Returns false if the
+// query has to be run again instead.
+bool ResultsNotifier::update_incrementally(ObjKeys& next_objs)
+{
+    if (!m_previous_objs_are_current || !m_table_changes_tracked || m_info->schema_changed)
+        return false;
+    auto& table = *m_query->get_table();
+    if (!m_query->produces_results_in_table_order() || m_query->follows_links())
+        return false;
+    const SortDescriptor* sort = nullptr;
+    for (size_t i = 0; i < m_descriptor_ordering.size(); ++i) {
+        if (sort || m_descriptor_ordering.get_type(i) != DescriptorType::Sort)
+            return false;
+        sort = static_cast<const SortDescriptor*>(m_descriptor_ordering[i]);
+        std::vector<TableKey> linked_tables;
+        sort->collect_dependencies(&table, linked_tables);
+        if (!linked_tables.empty())
+            return false;
     }
-    else {
-        size_t sz = m_run_tv.size();
-        m_previous_objs.resize(sz);
-        for (size_t i = 0; i < sz; ++i)
-            m_previous_objs[i] = m_run_tv.get_key(i);
+
+    auto it = m_info->tables.find(table.get_key());
+    if (it == m_info->tables.end()) {
+        // None of the objects changed
+        next_objs = m_previous_objs;
+        return true;
+    }
+    auto& changes = it->second;
+    // Running the query is cheaper when much of the table changed
+    if (changes.insertions_size() + changes.modifications_size() + changes.deletions_size() > table.size() / 16)
+        return false;
+
+    std::vector<ObjKey> candidates;
+    candidates.reserve(changes.insertions_size() + changes.modifications_size());
+    for (auto key : changes.get_insertions())
+        candidates.push_back(key);
+    for (auto& modification : changes.get_modifications())
+        candidates.push_back(modification.first);
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    next_objs.clear();
+    next_objs.reserve(m_previous_objs.size() + candidates.size());
+    for (auto key : m_previous_objs) {
+        if (!changes.deletions_contains(key) && !std::binary_search(candidates.begin(), candidates.end(), key))
+            next_objs.push_back(key);
     }
+    std::vector<ObjKey> matches = m_query->find_matching(candidates);
+
+    if (!sort) {
+        // The results are in table order
+        auto mid = next_objs.insert(next_objs.end(), matches.begin(), matches.end());
+        std::inplace_merge(next_objs.begin(), mid, next_objs.end());
+        return true;
+    }
+
+    // Objects which the sort does not order are in table order, as the sort
+    // leaves the results of the query
+    SortValueLookup lookup = sort->get_value_lookup(table);
+    const size_t num_columns = lookup.num_columns();
+    std::vector<SortValueLookup::Value> match_values(matches.size() * num_columns);
+    for (size_t i = 0; i < matches.size(); ++i)
+        lookup.load(matches[i], &match_values[i * num_columns]);
+    std::vector<size_t> match_order(matches.size());
+    std::iota(match_order.begin(), match_order.end(), 0);
+    std::sort(match_order.begin(), match_order.end(), [&](size_t a, size_t b) {
+        int c = lookup.compare(&match_values[a * num_columns], &match_values[b * num_columns]);
+        return c ? c < 0 : matches[a] < matches[b];
+    });
+
+    std::vector<SortValueLookup::Value> values(num_columns);
+    ObjKeys merged;
+    merged.reserve(next_objs.size() + matches.size());
+    auto begin = next_objs.begin();
+    for (size_t m : match_order) {
+        auto pos = std::partition_point(begin, next_objs.end(), [&](ObjKey key) {
+            lookup.load(key, values.data());
+            int c = lookup.compare(values.data(), &match_values[m * num_columns]);
+            return c ? c < 0 : key < matches[m];
+        });
+        merged.insert(merged.end(), begin, pos);
+        merged.push_back(matches[m]);
+        begin = pos;
+    }
+    merged.insert(merged.end(), begin, next_objs.end());
+    next_objs = std::move(merged);
+    return true;
 }
 
 void ResultsNotifier::run()
@@ -166,8 +249,10 @@ void ResultsNotifier::run()
     {
         auto lock = lock_target();
         // Don't run the query if the results aren't actually going to be used
-        if (!get_realm() || (!have_callbacks() && !m_results_were_used))
+        if (!get_realm() || (!have_callbacks() && !m_results_were_used)) {
+            m_previous_objs_are_current = false;
             return;
+        }
     }
 
     auto new_versions = m_query->sync_view_if_needed();
@@ -189,12 +274,22 @@ void ResultsNotifier::run()
         return;
     }
 
+    ObjKeys next_objs;
     m_run_tv = TableView(*m_query, size_t(-1));
-    // Syncing will be done here
-    m_run_tv.apply_descriptor_ordering(m_descriptor_ordering);
+    if (update_incrementally(next_objs)) {
+        m_run_tv.assign_query_results(m_descriptor_ordering, next_objs);
+    }
+    else {
+        // Syncing will be done here
+        m_run_tv.apply_descriptor_ordering(m_descriptor_ordering);
+        next_objs.reserve(m_run_tv.size());
+        for (size_t i = 0; i < m_run_tv.size(); ++i)
+            next_objs.push_back(m_run_tv.get_key(i));
+    }
     m_last_seen_version = std::move(new_versions);
+    m_previous_objs_are_current = true;
 
-    calculate_changes();
+    calculate_changes(std::move(next_objs));
 }
 
 void ResultsNotifier::do_prepare_handover(Transaction& sg)
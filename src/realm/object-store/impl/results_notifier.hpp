@@ -71,11 +71,17 @@ private:
 
     // The objects from the previous run of the query, for calculating diffs
     ObjKeys m_previous_objs;
+    // False if the query was not run at the version the notifier advanced
+    // from, so m_previous_objs cannot be brought up to date from m_info
+    bool m_previous_objs_are_current = false;
 
     TransactionChangeInfo* m_info = nullptr;
+    // True if m_info gathers the changes made to the objects of the table
+    bool m_table_changes_tracked = false;
     bool m_results_were_used = true;
 
-    void calculate_changes();
+    void calculate_changes(ObjKeys next_objs);
+    bool update_incrementally(ObjKeys& next_objs);
 
     void run() override;
     void do_prepare_handover(Transaction&) override;
@@ -24,6 +24,7 @@
 #include "realm/uuid.hpp"
 #include "realm/util/base64.hpp"
 #include "realm/util/overload.hpp"
+#include "realm/util/scope_exit.hpp"
 #include "realm/object-store/class.hpp"
 
 #define YY_NO_UNISTD_H 1
@@ -320,6 +321,11 @@ std::string_view string_for_op(CompareType op)
 NoArguments ParserDriver::s_default_args;
 query_parser::KeyPathMapping ParserDriver::s_default_mapping;
 
+namespace {
+// The arguments of a prepared query while it is not being bound
+NoArguments s_no_arguments;
+} // namespace
+
 ParserNode::~ParserNode() = default;
 
 QueryNode::~QueryNode() = default;
@@ -878,11 +884,11 @@ Query GeoWithinNode::visit(ParserDriver* drv)
     REALM_ASSERT_3(argument.size(), >, 1);
     REALM_ASSERT_3(argument[0], ==, '$');
     size_t arg_no = size_t(strtol(argument.substr(1).c_str(), nullptr, 10));
-    auto right_type = drv->m_args.is_argument_null(arg_no) ? DataType(-1) : drv->m_args.type_for_argument(arg_no);
+    auto right_type = drv->m_args->is_argument_null(arg_no) ? DataType(-1) : drv->m_args->type_for_argument(arg_no);
 
     Geospatial geo_from_argument;
     if (right_type == type_Geospatial) {
-        geo_from_argument = drv->m_args.geospatial_for_argument(arg_no);
+        geo_from_argument = drv->m_args->geospatial_for_argument(arg_no);
     }
     else if (right_type == type_String) {
         // This is a "hack" to allow users to pass in geospatial objects
@@ -890,7 +896,7 @@ Query GeoWithinNode::visit(ParserDriver* drv)
         // the CAPI doesn't have support for marshalling polygons (of variable length)
         // yet and that project was deprioritized to geospatial phase 2. This should be
         // removed once SDKs are all using the binding generator.
-        std::string str_val = drv->m_args.string_for_argument(arg_no);
+        std::string str_val = drv->m_args->string_for_argument(arg_no);
         const std::string simulated_prefix = "simulated GEOWITHIN ";
         str_val = simulated_prefix + str_val;
         ParserDriver sub_driver;
@@ -953,8 +959,13 @@ std::unique_ptr<Subexpr> PropertyNode::visit(ParserDriver* drv, DataType)
     path->resolve_arg(drv);
     if (path->path_elems.back().is_key() && path->path_elems.back().get_key() == "@links") {
         identifier = "@links";
-        // This is a backlink aggregate query
+        // This is a backlink aggregate query. The path is followed without the trailing "@links", which is put
+        // back afterwards so that the node can be visited again (see PreparedQuery).
+        PathElement links = std::move(path->path_elems.back());
         path->path_elems.pop_back();
+        util::ScopeExit restore([&]() noexcept {
+            path->path_elems.push_back(std::move(links));
+        });
         auto link_chain = path->visit(drv, comp_type);
         auto sub = link_chain.get_backlink_count<Int>();
         return sub.clone();
@@ -970,7 +981,7 @@ std::unique_ptr<Subexpr> PropertyNode::visit(ParserDriver* drv, DataType)
 
     Path indexes;
     while (!path->at_end()) {
-        indexes.emplace_back(std::move(*(path->current_path_elem++)));
+        indexes.emplace_back(*(path->current_path_elem++));
     }
 
     if (!indexes.empty()) {
@@ -1016,7 +1027,11 @@ std::unique_ptr<Subexpr> PropertyNode::visit(ParserDriver* drv, DataType)
                 if (!post_op && is_length_suffix(trailing)) {
                     // If 'length' is the operator, the last id in the path must be the name
                     // of a list property
+                    PathElement suffix = std::move(path->path_elems.back());
                     path->path_elems.pop_back();
+                    util::ScopeExit restore([&]() noexcept {
+                        path->path_elems.push_back(std::move(suffix));
+                    });
                     const std::string& prop = path->path_elems.back().get_key();
                     std::unique_ptr<Subexpr> subexpr{path->visit(drv, comp_type).column(prop, false)};
                     if (auto list = dynamic_cast<ColumnListBase*>(subexpr.get())) {
@@ -1138,8 +1153,7 @@ std::unique_ptr<Subexpr> LinkAggrNode::visit(ParserDriver* drv, DataType)
                                              agg_op_type_to_str(type), property->get_identifier()));
     }
     const LinkChain& link_chain = property->link_chain();
-    prop_name = drv->translate(link_chain, prop_name);
-    auto col_key = link_chain.get_current_table()->get_column_key(prop_name);
+    auto col_key = link_chain.get_current_table()->get_column_key(drv->translate(link_chain, prop_name));
 
     switch (col_key.get_type()) {
         case col_type_Int:
@@ -1414,13 +1428,13 @@ std::unique_ptr<Subexpr> ConstantNode::visit(ParserDriver* drv, DataType hint)
 
     if (type == Type::ARG) {
         size_t arg_no = size_t(strtol(text.substr(1).c_str(), nullptr, 10));
-        if (m_comp_type && !drv->m_args.is_argument_list(arg_no)) {
+        if (m_comp_type && !drv->m_args->is_argument_list(arg_no)) {
             throw InvalidQueryError(util::format(
                 "ANY/ALL/NONE are only allowed on arguments which contain a list but '%1' is not a list.",
                 explain_value_message));
         }
-        if (drv->m_args.is_argument_list(arg_no)) {
-            std::vector<Mixed> mixed_list = drv->m_args.list_for_argument(arg_no);
+        if (drv->m_args->is_argument_list(arg_no)) {
+            std::vector<Mixed> mixed_list = drv->m_args->list_for_argument(arg_no);
             for (auto& mixed : mixed_list) {
                 if (!mixed.is_null()) {
                     convert_if_needed(mixed);
@@ -1428,11 +1442,11 @@ std::unique_ptr<Subexpr> ConstantNode::visit(ParserDriver* drv, DataType hint)
             }
             return copy_list_of_args(mixed_list);
         }
-        if (drv->m_args.is_argument_null(arg_no)) {
+        if (drv->m_args->is_argument_null(arg_no)) {
             explain_value_message = util::format("argument '%1' which is NULL", explain_value_message);
         }
         else {
-            value = drv->m_args.mixed_for_argument(arg_no);
+            value = drv->m_args->mixed_for_argument(arg_no);
             if (value.is_null()) {
                 explain_value_message = util::format("argument %1 of type null", explain_value_message);
             }
@@ -1691,9 +1705,13 @@ std::unique_ptr<Subexpr> ListNode::visit(ParserDriver* drv, DataType hint)
 void PathNode::resolve_arg(ParserDriver* drv)
 {
     if (arg.size()) {
-        if (path_elems.size()) {
+        // The elements from the argument of a previous visit are replaced
+        if (path_elems.size() != m_num_arg_elems) {
             throw InvalidQueryError("Key path argument cannot be mixed with other elements");
         }
+        path_elems.clear();
+        backlink = 0;
+        m_num_arg_elems = 0;
         auto arg_str = drv->get_arg_for_key_path(arg);
         const char* path = arg_str.data();
         do {
@@ -1702,6 +1720,7 @@ void PathNode::resolve_arg(ParserDriver* drv)
             add_element(elem);
             path = p;
         } while (*path++ == '.');
+        m_num_arg_elems = path_elems.size();
     }
 }
 
@@ -1825,7 +1844,7 @@ static void verify_conditions(Subexpr* left, Subexpr* right, util::serializer::S
 
 ParserDriver::ParserDriver(TableRef t, Arguments& args, const query_parser::KeyPathMapping& mapping)
     : m_base_table(t)
-    , m_args(args)
+    , m_args(&args)
     , m_mapping(mapping)
 {
     yylex_init(&m_yyscanner);
@@ -1840,15 +1859,15 @@ PathElement ParserDriver::get_arg_for_index(const std::string& i)
 {
     REALM_ASSERT(i[0] == '$');
     size_t arg_no = size_t(strtol(i.substr(1).c_str(), nullptr, 10));
-    if (m_args.is_argument_null(arg_no) || m_args.is_argument_list(arg_no)) {
+    if (m_args->is_argument_null(arg_no) || m_args->is_argument_list(arg_no)) {
         throw InvalidQueryError("Invalid index parameter");
     }
-    auto type = m_args.type_for_argument(arg_no);
+    auto type = m_args->type_for_argument(arg_no);
     switch (type) {
         case type_Int:
-            return size_t(m_args.long_for_argument(arg_no));
+            return size_t(m_args->long_for_argument(arg_no));
         case type_String:
-            return m_args.string_for_argument(arg_no);
+            return m_args->string_for_argument(arg_no);
         default:
             throw InvalidQueryError("Invalid index type");
     }
@@ -1859,36 +1878,36 @@ std::string ParserDriver::get_arg_for_key_path(const std::string& i)
     REALM_ASSERT(i[0] == '$');
     REALM_ASSERT(i[1] == 'K');
     size_t arg_no = size_t(strtol(i.substr(2).c_str(), nullptr, 10));
-    if (m_args.is_argument_null(arg_no) || m_args.is_argument_list(arg_no)) {
+    if (m_args->is_argument_null(arg_no) || m_args->is_argument_list(arg_no)) {
         throw InvalidQueryArgError(util::format("Null or list cannot be used for parameter '%1'", i));
     }
-    auto type = m_args.type_for_argument(arg_no);
+    auto type = m_args->type_for_argument(arg_no);
     if (type != type_String) {
         throw InvalidQueryArgError(util::format("Invalid index type for '%1'. Expected a string, but found type '%2'",
                                                 i, get_data_type_name(type)));
     }
-    return m_args.string_for_argument(arg_no);
+    return m_args->string_for_argument(arg_no);
 }
 
 double ParserDriver::get_arg_for_coordinate(const std::string& str)
 {
     REALM_ASSERT(str[0] == '$');
     size_t arg_no = size_t(strtol(str.substr(1).c_str(), nullptr, 10));
-    if (m_args.is_argument_null(arg_no)) {
+    if (m_args->is_argument_null(arg_no)) {
         throw InvalidQueryError(util::format("NULL cannot be used in coordinate at argument '%1'", str));
     }
-    if (m_args.is_argument_list(arg_no)) {
+    if (m_args->is_argument_list(arg_no)) {
         throw InvalidQueryError(util::format("A list cannot be used in a coordinate at argument '%1'", str));
     }
 
-    auto type = m_args.type_for_argument(arg_no);
+    auto type = m_args->type_for_argument(arg_no);
     switch (type) {
         case type_Int:
-            return double(m_args.long_for_argument(arg_no));
+            return double(m_args->long_for_argument(arg_no));
         case type_Double:
-            return m_args.double_for_argument(arg_no);
+            return m_args->double_for_argument(arg_no);
         case type_Float:
-            return double(m_args.float_for_argument(arg_no));
+            return double(m_args->float_for_argument(arg_no));
         default:
             throw InvalidQueryError(util::format("Invalid parameter '%1' used in coordinate at argument '%2'",
                                                  get_data_type_name(type), str));
@@ -2017,6 +2036,51 @@ std::string check_escapes(const char* str)
     return ret + std::string(str);
 }
 
+PreparedQuery::PreparedQuery(ConstTableRef table, const std::string& query_string, const KeyPathMapping& mapping)
+    : m_query_string(query_string)
+    , m_driver(std::make_unique<ParserDriver>(table.cast_away_const(), s_no_arguments, mapping))
+{
+    try {
+        m_driver->parse(query_string);
+    }
+    catch (const NoArgsError&) {
+        // The parser needs the value of an argument used as a list index or a coordinate
+        m_parse_on_bind = true;
+        return;
+    }
+    m_driver->result->canonicalize();
+}
+
+PreparedQuery::PreparedQuery(PreparedQuery&&) noexcept = default;
+PreparedQuery& PreparedQuery::operator=(PreparedQuery&&) noexcept = default;
+PreparedQuery::~PreparedQuery() = default;
+
+Query PreparedQuery::bind(ConstTableRef table, const std::vector<Arg>& arguments)
+{
+    MixedArguments args(arguments);
+    return bind(table, args);
+}
+
+Query PreparedQuery::bind(ConstTableRef table, const std::vector<Mixed>& arguments)
+{
+    MixedArguments args(arguments);
+    return bind(table, args);
+}
+
+Query PreparedQuery::bind(ConstTableRef table, Arguments& arguments)
+{
+    if (m_parse_on_bind) {
+        return table->query(m_query_string, arguments, m_driver->m_mapping);
+    }
+    ParserDriver& drv = *m_driver;
+    drv.m_base_table = table.cast_away_const();
+    drv.m_args = &arguments;
+    util::ScopeExit reset_args([&]() noexcept {
+        drv.m_args = &s_no_arguments;
+    });
+    return drv.result->visit(&drv).set_ordering(drv.ordering->visit(&drv));
+}
+
 } // namespace query_parser
 
 Query Table::query(const std::string& query_string, const std::vector<MixedArguments::Arg>& arguments) const
@@ -2054,6 +2118,17 @@ Query Table::query(const std::string& query_string, query_parser::Arguments& arg
     return driver.result->visit(&driver).set_ordering(driver.ordering->visit(&driver));
 }
 
+query_parser::PreparedQuery Table::prepare_query(const std::string& query_string) const
+{
+    return query_parser::PreparedQuery(m_own_ref, query_string, {});
+}
+
+query_parser::PreparedQuery Table::prepare_query(const std::string& query_string,
+                                                 const query_parser::KeyPathMapping& mapping) const
+{
+    return query_parser::PreparedQuery(m_own_ref, query_string, mapping);
+}
+
 std::unique_ptr<Subexpr> LinkChain::column(const std::string& col, bool has_path)
 {
     auto col_key = m_current_table->get_column_key(col);
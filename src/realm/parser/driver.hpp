@@ -341,6 +341,7 @@ private:
     std::string arg;
     std::string backlink_str;
     int backlink = 0;
+    size_t m_num_arg_elems = 0;
 };
 
 class PropertyNode : public ValueNode {
@@ -653,7 +654,7 @@ public:
     QueryNode* result = nullptr;
     DescriptorOrderingNode* ordering = nullptr;
     TableRef m_base_table;
-    Arguments& m_args;
+    Arguments* m_args;
     query_parser::KeyPathMapping m_mapping;
     ParserNodeStore m_parse_nodes;
     void* m_yyscanner;
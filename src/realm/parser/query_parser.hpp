@@ -28,6 +28,13 @@
 #include <realm/uuid.hpp>
 #include <realm/util/any.hpp>
 #include <realm/mixed.hpp>
+#include <realm/table_ref.hpp>
+
+#include <external/mpark/variant.hpp>
+
+namespace realm {
+class Query;
+}
 
 namespace realm::query_parser {
 
@@ -339,6 +346,41 @@ public:
     }
 };
 
+class KeyPathMapping;
+class ParserDriver;
+
+/// A query string which is parsed once and can then be turned into a Query for any number of argument values
+/// without being parsed again (see Table::prepare_query()). The parsed query refers to classes and properties by
+/// name and holds no table accessor, so the table to run it on is passed to each bind. This may be the table it
+/// was prepared on in any later transaction, or any table with the properties it uses. Binding still looks up the
+/// key paths and builds the query nodes, and can fail in the same way as Table::query() does for invalid
+/// arguments. A query which uses arguments as list indexes or coordinates needs them to be parsed, and is parsed
+/// again whenever it is bound. A PreparedQuery is not thread safe.
+class PreparedQuery {
+public:
+    using Arg = mpark::variant<Mixed, std::vector<Mixed>>;
+
+    PreparedQuery(ConstTableRef table, const std::string& query_string, const KeyPathMapping& mapping);
+    PreparedQuery(PreparedQuery&&) noexcept;
+    PreparedQuery& operator=(PreparedQuery&&) noexcept;
+    ~PreparedQuery();
+
+    Query bind(ConstTableRef table, const std::vector<Arg>& arguments = {});
+    Query bind(ConstTableRef table, const std::vector<Mixed>& arguments);
+    Query bind(ConstTableRef table, Arguments& arguments);
+
+    const std::string& get_query_string() const noexcept
+    {
+        return m_query_string;
+    }
+
+private:
+    std::string m_query_string;
+    // Owns the parse tree, which is visited again for each bind
+    std::unique_ptr<ParserDriver> m_driver;
+    bool m_parse_on_bind = false;
+};
+
 void parse(const std::string&);
 
 } // namespace realm::query_parser
@@ -27,11 +27,21 @@
 #include <realm/query_expression.hpp>
 #include <realm/table_view.hpp>
 #include <realm/set.hpp>
+#include <realm/util/thread_pool.hpp>
 
 #include <algorithm>
+#include <atomic>
 
 using namespace realm;
 
+namespace {
+// Minimum number of objects each thread must get for it to be worth splitting a scan across threads
+constexpr size_t c_min_objects_per_thread = 4 * REALM_MAX_BPNODE_SIZE;
+// The clusters are split into more ranges than there are threads, so that threads which finish early
+// can pick up work from threads stuck in an expensive part of the table
+constexpr size_t c_ranges_per_thread = 4;
+} // anonymous namespace
+
 Query::Query()
 {
     create();
@@ -87,6 +97,7 @@ Query::Query(const Query& source)
     , m_groups(source.m_groups)
     , m_table(source.m_table)
     , m_ordering(source.m_ordering)
+    , m_max_threads(source.m_max_threads)
 {
     if (source.m_owned_source_table_view) {
         m_owned_source_table_view = source.m_owned_source_table_view->clone();
@@ -133,6 +144,7 @@ Query& Query::operator=(const Query& source)
             m_view = m_source_collection.get();
         }
         m_ordering = source.m_ordering;
+        m_max_threads = source.m_max_threads;
     }
     return *this;
 }
@@ -158,6 +170,7 @@ Query::Query(const Query* source, Transaction* tr, PayloadPolicy policy)
         REALM_ASSERT_DEBUG(m_view);
     }
     m_groups = source->m_groups;
+    m_max_threads = source->m_max_threads;
     if (source->m_table)
         set_table(tr->import_copy_of(source->m_table));
     // otherwise: empty query.
@@ -1100,6 +1113,17 @@ bool Query::eval_object(const Obj& obj) const
     return true;
 }
 
+std::vector<ObjKey> Query::find_matching(const std::vector<ObjKey>& keys) const
+{
+    init();
+    std::vector<ObjKey> matches;
+    for (auto key : keys) {
+        if (auto obj = m_table->try_get_object(key); obj && eval_object(obj))
+            matches.push_back(key);
+    }
+    return matches;
+}
+
 
 template <typename T>
 void Query::aggregate(QueryStateBase& st, ColKey column_key) const
@@ -1133,6 +1157,14 @@ void Query::aggregate(QueryStateBase& st, ColKey column_key) const
                     }
                 }
             }
+            else if (auto num_threads = get_num_threads_for_scan(); num_threads > 1 && st.supports_partial()) {
+                std::vector<std::unique_ptr<QueryStateBase>> range_states(num_threads * c_ranges_per_thread);
+                for (auto& range_state : range_states)
+                    range_state = st.make_partial();
+                parallel_scan<LeafType>(num_threads, range_states, column_key);
+                for (auto& range_state : range_states)
+                    st.merge_partial(*range_state);
+            }
             else {
                 // no index, traverse cluster tree
                 node = pn;
@@ -1163,6 +1195,58 @@ void Query::aggregate(QueryStateBase& st, ColKey column_key) const
     }
 }
 
+size_t Query::get_num_threads_for_scan() const
+{
+    if (m_max_threads < 2 || m_view)
+        return 1;
+    return std::max(size_t(1), std::min(m_max_threads, m_table->size() / c_min_objects_per_thread));
+}
+
+template <class LeafType>
+void Query::parallel_scan(size_t num_threads, std::vector<std::unique_ptr<QueryStateBase>>& range_states,
+                          ColKey column_key) const
+{
+    const Table* table = m_table.unchecked_ptr();
+    const ClusterTree& clusters = table->m_clusters;
+    const auto leaves = clusters.get_leaf_positions();
+    const size_t num_ranges = range_states.size();
+
+    // The nodes hold the state of the cluster being searched, so each thread needs a copy of its own
+    std::vector<std::unique_ptr<ParentNode>> roots;
+    for (size_t i = 0; i < num_threads; ++i) {
+        auto& root = roots.emplace_back(root_node()->clone());
+        root->init(true);
+        std::vector<ParentNode*> vec;
+        root->gather_children(vec);
+    }
+
+    std::atomic<size_t> next_range{0};
+    auto scan = [&](size_t thread_ndx) {
+        ParentNode* node = roots[thread_ndx].get();
+        std::unique_ptr<ArrayPayload> leaf;
+        if constexpr (!std::is_void_v<LeafType>)
+            leaf = std::make_unique<LeafType>(table->get_alloc());
+
+        for (size_t r = next_range++; r < num_ranges; r = next_range++) {
+            QueryStateBase* st = range_states[r].get();
+            const size_t begin = leaves.size() * r / num_ranges;
+            const size_t end = leaves.size() * (r + 1) / num_ranges;
+            auto f = [&](const Cluster* cluster) {
+                size_t e = cluster->node_size();
+                node->set_cluster(cluster);
+                if (leaf)
+                    cluster->init_leaf(column_key, leaf.get());
+                st->m_key_offset = cluster->get_offset();
+                st->m_key_values = cluster->get_key_array();
+                aggregate_internal(node, st, 0, e, leaf.get());
+                return IteratorControl::AdvanceToNext;
+            };
+            clusters.traverse(f, leaves.data() + begin, leaves.data() + end);
+        }
+    };
+    util::ThreadPool::get_default().run_parallel(num_threads, scan);
+}
+
 size_t Query::find_best_node(ParentNode* pn) const
 {
     auto score_compare = [](const ParentNode* a, const ParentNode* b) {
@@ -1197,6 +1281,10 @@ void Query::aggregate_internal(ParentNode* pn, QueryStateBase* st, size_t start,
     // statistics.
     constexpr size_t probe_matches = 4;
 
+    // The zone map of a condition column shows that no object in this cluster can match
+    if (pn->cluster_excluded())
+        return;
+
     while (start < end) {
         // Executes start...end range of a query and will stay inside the condition loop of the node it was called
         // on. Can be called on any node; yields same result, but different performance. Returns prematurely if
@@ -1468,6 +1556,23 @@ void Query::do_find_all(QueryStateBase& st) const
                     }
                 }
             }
+            else if (auto num_threads = st.limit() == size_t(-1) ? get_num_threads_for_scan() : 1;
+                     num_threads > 1) {
+                std::vector<std::vector<ObjKey>> range_keys(num_threads * c_ranges_per_thread);
+                std::vector<std::unique_ptr<QueryStateBase>> range_states;
+                for (auto& keys : range_keys)
+                    range_states.push_back(std::make_unique<QueryStateFindAll<std::vector<ObjKey>>>(keys));
+                parallel_scan(num_threads, range_states);
+
+                // Report the matches to the caller's state in table order
+                st.m_key_values = nullptr;
+                for (auto& keys : range_keys) {
+                    for (auto key : keys) {
+                        st.m_key_offset = key.value;
+                        st.match(0, Mixed());
+                    }
+                }
+            }
             else {
                 // no index on best node (and likely no index at all), descend B+-tree
                 node = pn;
@@ -1582,6 +1687,16 @@ size_t Query::do_count(size_t limit) const
                 cnt = std::min(limit, sz);
             }
         }
+        else if (auto num_threads = limit == size_t(-1) ? get_num_threads_for_scan() : 1; num_threads > 1) {
+            QueryStateCount st;
+            std::vector<std::unique_ptr<QueryStateBase>> range_states(num_threads * c_ranges_per_thread);
+            for (auto& range_state : range_states)
+                range_state = st.make_partial();
+            parallel_scan(num_threads, range_states);
+            for (auto& range_state : range_states)
+                st.merge_partial(*range_state);
+            cnt = st.get_count();
+        }
         else {
             // no index, descend down the B+-tree instead
             node = pn;
@@ -1681,136 +1796,12 @@ size_t Query::remove() const
     return rows;
 }
 
-#if REALM_MULTITHREAD_QUERY
-TableView Query::find_all_multi(size_t start, size_t end)
+Query& Query::set_threads(size_t max_threads)
 {
-    static_cast<void>(start);
-    static_cast<void>(end);
-
-    // Initialization
-    init();
-    ts.next_job = start;
-    ts.end_job = end;
-    ts.done_job = 0;
-    ts.count = 0;
-    ts.table = &table;
-    ts.node = first[0];
-
-    // Signal all threads to start
-    pthread_mutex_unlock(&ts.jobs_mutex);
-    pthread_cond_broadcast(&ts.jobs_cond);
-
-    // Wait until all threads have completed
-    pthread_mutex_lock(&ts.completed_mutex);
-    while (ts.done_job < ts.end_job)
-        pthread_cond_wait(&ts.completed_cond, &ts.completed_mutex);
-    pthread_mutex_lock(&ts.jobs_mutex);
-    pthread_mutex_unlock(&ts.completed_mutex);
-
-    TableView tv(*m_table);
-
-    // Sort search results because user expects ascending order
-    sort(ts.chunks.begin(), ts.chunks.end(), &Query::comp);
-    for (size_t i = 0; i < ts.chunks.size(); ++i) {
-        const size_t from = ts.chunks[i].m_root_node;
-        const size_t upto = (i == ts.chunks.size() - 1) ? size_t(-1) : ts.chunks[i + 1].m_root_node;
-        size_t first = ts.chunks[i].second;
-
-        while (first < ts.results.size() && ts.results[first] < upto && ts.results[first] >= from) {
-            tv.get_ref_column().add(ts.results[first]);
-            ++first;
-        }
-    }
-
-    return move(tv);
-}
-
-int Query::set_threads(unsigned int threadcount)
-{
-#if defined(_WIN32) || defined(__WIN32__) || defined(_WIN64)
-    pthread_win32_process_attach_np();
-#endif
-    pthread_mutex_init(&ts.result_mutex, nullptr);
-    pthread_cond_init(&ts.completed_cond, nullptr);
-    pthread_mutex_init(&ts.jobs_mutex, nullptr);
-    pthread_mutex_init(&ts.completed_mutex, nullptr);
-    pthread_cond_init(&ts.jobs_cond, nullptr);
-
-    pthread_mutex_lock(&ts.jobs_mutex);
-
-    for (size_t i = 0; i < m_threadcount; ++i)
-        pthread_detach(threads[i]);
-
-    for (size_t i = 0; i < threadcount; ++i) {
-        int r = pthread_create(&threads[i], nullptr, query_thread, (void*)&ts);
-        if (r != 0)
-            REALM_ASSERT(false); // todo
-    }
-    m_threadcount = threadcount;
-    return 0;
-}
-
-
-void* Query::query_thread(void* arg)
-{
-    static_cast<void>(arg);
-    thread_state* ts = static_cast<thread_state*>(arg);
-
-    std::vector<size_t> res;
-    std::vector<pair<size_t, size_t>> chunks;
-
-    for (;;) {
-        // Main waiting loop that waits for a query to start
-        pthread_mutex_lock(&ts->jobs_mutex);
-        while (ts->next_job == ts->end_job)
-            pthread_cond_wait(&ts->jobs_cond, &ts->jobs_mutex);
-        pthread_mutex_unlock(&ts->jobs_mutex);
-
-        for (;;) {
-            // Pick a job
-            pthread_mutex_lock(&ts->jobs_mutex);
-            if (ts->next_job == ts->end_job)
-                break;
-            const size_t chunk = min(ts->end_job - ts->next_job, thread_chunk_size);
-            const size_t mine = ts->next_job;
-            ts->next_job += chunk;
-            size_t r = mine - 1;
-            const size_t end = mine + chunk;
-
-            pthread_mutex_unlock(&ts->jobs_mutex);
-
-            // Execute job
-            for (;;) {
-                r = ts->node->find_first(r + 1, end);
-                if (r == end)
-                    break;
-                res.push_back(r);
-            }
-
-            // Append result in common queue shared by all threads.
-            pthread_mutex_lock(&ts->result_mutex);
-            ts->done_job += chunk;
-            if (res.size() > 0) {
-                ts->chunks.push_back(std::pair<size_t, size_t>(mine, ts->results.size()));
-                ts->count += res.size();
-                for (size_t i = 0; i < res.size(); i++) {
-                    ts->results.push_back(res[i]);
-                }
-                res.clear();
-            }
-            pthread_mutex_unlock(&ts->result_mutex);
-
-            // Signal main thread that we might have compleeted
-            pthread_mutex_lock(&ts->completed_mutex);
-            pthread_cond_signal(&ts->completed_cond);
-            pthread_mutex_unlock(&ts->completed_mutex);
-        }
-    }
-    return 0;
+    m_max_threads = std::max(max_threads, size_t(1));
+    return *this;
 }
 
-#endif // REALM_MULTITHREADQUERY
-
 std::string Query::validate() const
 {
     if (!m_groups.size())
@@ -2033,6 +2024,14 @@ void Query::get_outside_versions(TableVersions& versions) const
     }
 }
 
+bool Query::follows_links() const
+{
+    std::vector<TableKey> table_keys;
+    if (ParentNode* root = root_node())
+        root->get_link_dependencies(table_keys);
+    return !table_keys.empty();
+}
+
 TableVersions Query::sync_view_if_needed() const
 {
     if (m_view) {
@@ -26,14 +26,6 @@
 #include <string>
 #include <vector>
 
-#define REALM_MULTITHREAD_QUERY 0
-
-#if REALM_MULTITHREAD_QUERY
-// FIXME: Use our C++ thread abstraction API since it provides a much
-// higher level of encapsulation and safety.
-#include <pthread.h>
-#endif
-
 #include <realm/aggregate_ops.hpp>
 #include <realm/binary_data.hpp>
 #include <realm/column_type_traits.hpp>
@@ -277,12 +269,18 @@ public:
     // Deletion
     size_t remove() const;
 
-#if REALM_MULTITHREAD_QUERY
     // Multi-threading
-    TableView find_all_multi(size_t start = 0, size_t end = size_t(-1));
-    TableView find_all_multi(size_t start = 0, size_t end = size_t(-1)) const;
-    int set_threads(unsigned int threadcount);
-#endif
+    // Allow find_all(), count(), sum(), min(), max() and avg() to split the scan of the table across up to
+    // `max_threads` threads, including the calling thread. The result is the same as when evaluating on a
+    // single thread, and matches are still reported in table order. Queries which are restricted by a view,
+    // can be answered through a search index or have a limit are always evaluated on the calling thread, as
+    // are queries on tables too small to benefit from it. The table must not be modified while a query is
+    // being evaluated.
+    Query& set_threads(size_t max_threads);
+    size_t get_threads() const noexcept
+    {
+        return m_max_threads;
+    }
 
     const ConstTableRef& get_table() const noexcept
     {
@@ -299,6 +297,8 @@ public:
         return m_groups.size() > 0 && m_groups[0].m_root_node;
     }
     void get_outside_versions(TableVersions&) const;
+    // True if the query follows any link or backlink, even to its own table.
+    bool follows_links() const;
 
     // True if matching rows are guaranteed to be returned in table order.
     bool produces_results_in_table_order() const
@@ -328,6 +328,9 @@ public:
     util::bind_ptr<DescriptorOrdering> get_ordering();
 
     bool eval_object(const Obj& obj) const;
+    // The objects among `keys` which exist and match the conditions of the query, in the same order. A
+    // restricting view is not taken into account.
+    std::vector<ObjKey> find_matching(const std::vector<ObjKey>& keys) const;
 
 private:
     void create();
@@ -368,6 +371,10 @@ private:
 
     void do_find_all(QueryStateBase& st) const;
     size_t do_count(size_t limit = size_t(-1)) const;
+    size_t get_num_threads_for_scan() const;
+    template <class LeafType = void>
+    void parallel_scan(size_t num_threads, std::vector<std::unique_ptr<QueryStateBase>>& range_states,
+                       ColKey column_key = {}) const;
     void delete_nodes() noexcept;
 
     ParentNode* root_node() const
@@ -406,6 +413,7 @@ private:
     TableView* m_source_table_view = nullptr; // table views are not refcounted, and not owned by the query.
     std::unique_ptr<TableView> m_owned_source_table_view; // <--- except when indicated here
     util::bind_ptr<DescriptorOrdering> m_ordering;
+    size_t m_max_threads = 1;
 };
 
 // Implementation:
@@ -35,8 +35,9 @@ public:
     using QueryStateBase::QueryStateBase;
     bool match(size_t index, Mixed value) noexcept final
     {
+        // The leaf finders pass the value of the condition column, which is not
+        // the one being aggregated when there is a source column
         if (m_source_column) {
-            REALM_ASSERT_DEBUG(value.is_null());
             value = m_source_column->get_any(index);
         }
         if (!value.is_null()) {
@@ -59,6 +60,15 @@ public:
         }
         return (m_limit > m_match_count);
     }
+    bool match_leaf(const Array& leaf) final
+    {
+        if constexpr (std::is_same_v<T, int64_t>) {
+            m_state.accumulate_sum(leaf.get_sum(), leaf.size());
+            m_match_count += leaf.size();
+            return true;
+        }
+        return false;
+    }
     ResultType result_sum() const
     {
         return m_state.result();
@@ -67,6 +77,20 @@ public:
     {
         return m_state.items_counted();
     }
+    bool supports_partial() const noexcept final
+    {
+        return true;
+    }
+    std::unique_ptr<QueryStateBase> make_partial() const final
+    {
+        return std::make_unique<QueryStateSum>(m_limit);
+    }
+    void merge_partial(const QueryStateBase& other) final
+    {
+        auto& partial = static_cast<const QueryStateSum&>(other);
+        m_state.combine(partial.m_state);
+        m_match_count += partial.m_match_count;
+    }
 
 private:
     aggregate_operations::Sum<typename util::RemoveOptional<T>::type> m_state;
@@ -78,8 +102,9 @@ public:
     using QueryStateBase::QueryStateBase;
     bool match(size_t index, Mixed value) noexcept final
     {
+        // The leaf finders pass the value of the condition column, which is not
+        // the one being aggregated when there is a source column
         if (m_source_column) {
-            REALM_ASSERT_DEBUG(value.is_null());
             value = m_source_column->get_any(index);
         }
         if (!value.is_null()) {
@@ -106,10 +131,43 @@ public:
         }
         return m_limit > m_match_count;
     }
+    bool match_leaf(const Array& leaf) final
+    {
+        if constexpr (std::is_same_v<R, int64_t>) {
+            int64_t value;
+            size_t ndx;
+            bool found = std::is_same_v<State<int64_t>, aggregate_operations::Maximum<int64_t>>
+                             ? leaf.maximum(value, 0, size_t(-1), &ndx)
+                             : leaf.minimum(value, 0, size_t(-1), &ndx);
+            if (found && m_state.accumulate(value)) {
+                ++m_match_count;
+                m_minmax_key = (m_key_values ? m_key_values->get(ndx) : ndx) + m_key_offset;
+            }
+            return true;
+        }
+        return false;
+    }
     Mixed get_result() const
     {
         return m_state.is_null() ? Mixed() : m_state.result();
     }
+    bool supports_partial() const noexcept final
+    {
+        return true;
+    }
+    std::unique_ptr<QueryStateBase> make_partial() const final
+    {
+        return std::make_unique<QueryStateMinMax>(m_limit);
+    }
+    void merge_partial(const QueryStateBase& other) final
+    {
+        // Partial results are merged in table order, so on ties the first object found is kept, just as when
+        // the query is evaluated on a single thread
+        auto& partial = static_cast<const QueryStateMinMax&>(other);
+        if (m_state.combine(partial.m_state))
+            m_minmax_key = partial.m_minmax_key;
+        m_match_count += partial.m_match_count;
+    }
 
 private:
     State<typename util::RemoveOptional<R>::type> m_state;
@@ -39,8 +39,11 @@ ParentNode::ParentNode(const ParentNode& from)
 
 size_t ParentNode::find_first(size_t start, size_t end)
 {
+    if (m_cluster_excluded)
+        return not_found;
+
     size_t sz = m_children.size();
-    size_t current_cond = 0;
+    size_t current_cond = m_first_condition < sz ? m_first_condition : 0;
     size_t nb_cond_to_test = sz;
 
     while (REALM_LIKELY(start < end)) {
@@ -271,7 +274,9 @@ void StringNodeEqualBase::init(bool will_query_ranges)
 {
     StringNodeBase::init(will_query_ranges);
 
-    const bool uses_index = has_search_index();
+    // The column may have been enumerated by a commit since the table was set
+    m_is_string_enum = m_table.unchecked_ptr()->is_enumerated(m_condition_column_key);
+    const bool uses_index = has_search_index() && index_lookup_pays_off();
     if (m_is_string_enum) {
         m_dT = 1.0;
     }
@@ -286,6 +291,9 @@ void StringNodeEqualBase::init(bool will_query_ranges)
         m_index_evaluator = std::make_optional(IndexEvaluator{});
         _search_index_init();
     }
+    else {
+        m_index_evaluator.reset();
+    }
 }
 
 size_t StringNodeEqualBase::find_first_local(size_t start, size_t end)
@@ -344,6 +352,29 @@ void IndexEvaluator::init(std::vector<ObjKey>* storage)
     }
 }
 
+bool IndexEvaluator::init(const OrderedIndex* index, Mixed lower, bool lower_inclusive, Mixed upper,
+                          bool upper_inclusive, std::vector<ObjKey>* storage)
+{
+    REALM_ASSERT(index);
+    size_t begin = index->begin_non_null();
+    if (!lower.is_null())
+        begin = std::max(begin, lower_inclusive ? index->lower_bound(lower) : index->upper_bound(lower));
+    size_t end = index->size();
+    if (!upper.is_null())
+        end = upper_inclusive ? index->upper_bound(upper) : index->lower_bound(upper);
+    end = std::max(begin, end);
+
+    if ((end - begin) * c_max_range_fraction > index->size())
+        return false;
+
+    // The index yields the keys in value order, the clusters must be visited in key order
+    storage->clear();
+    index->get_keys(begin, end, *storage);
+    std::sort(storage->begin(), storage->end());
+    init(storage);
+    return true;
+}
+
 size_t IndexEvaluator::do_search_index(const Cluster* cluster, size_t start, size_t end)
 {
     if (start >= end) {
@@ -416,6 +447,20 @@ void StringNode<Equal>::_search_index_init()
     m_index_evaluator->init(index, StringNodeBase::m_string_value);
 }
 
+std::optional<double> StringNode<Equal>::estimate_selectivity(const ColumnStatistics& stats) const
+{
+    if (m_needles.empty())
+        return stats.estimate<Equal>(Mixed(m_string_value));
+    double selectivity = 0;
+    for (auto& needle : m_needles) {
+        auto needle_selectivity = stats.estimate<Equal>(Mixed(needle));
+        if (!needle_selectivity)
+            return {};
+        selectivity += *needle_selectivity;
+    }
+    return std::min(selectivity, 1.0);
+}
+
 bool StringNode<Equal>::do_consume_condition(ParentNode& node)
 {
     // Don't use the search index if present since we're in a scenario where
@@ -453,8 +498,43 @@ bool StringNode<Equal>::do_consume_condition(ParentNode& node)
     return true;
 }
 
+void StringNode<Equal>::resolve_enum_needles()
+{
+    if (m_needles.empty()) {
+        m_enum_needle = m_leaf->find_enum_index(m_string_value);
+    }
+    else {
+        // A single pass over the unique values rather than a search of them per needle
+        size_t enum_count = m_leaf->get_enum_count();
+        m_enum_needles.assign(enum_count, false);
+        for (size_t ndx = 0; ndx < enum_count; ++ndx) {
+            if (m_needles.count(m_leaf->get_enum_value(ndx)))
+                m_enum_needles[ndx] = true;
+        }
+    }
+    m_enum_needles_resolved = true;
+}
+
 size_t StringNode<Equal>::_find_first_local(size_t start, size_t end)
 {
+    if (m_leaf->is_enumerated()) {
+        if (!m_enum_needles_resolved)
+            resolve_enum_needles();
+        if (m_needles.empty()) {
+            if (m_enum_needle == realm::not_found)
+                return not_found;
+            return m_leaf->find_first_enum_index(m_enum_needle, start, end);
+        }
+        if (end == npos)
+            end = m_leaf->size();
+        for (size_t s = start; s < end; ++s) {
+            size_t ndx = m_leaf->get_enum_index(s);
+            if (ndx < m_enum_needles.size() && m_enum_needles[ndx])
+                return s;
+        }
+        return not_found;
+    }
+
     if (m_needles.empty()) {
         return m_leaf->find_first(m_string_value, start, end);
     }
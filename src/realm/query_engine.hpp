@@ -85,7 +85,9 @@ TConditionValue:    Type of values in condition column. That is, int64_t, float,
 #include <realm/array_string.hpp>
 #include <realm/array_timestamp.hpp>
 #include <realm/column_integer.hpp>
+#include <realm/column_statistics.hpp>
 #include <realm/column_type_traits.hpp>
+#include <realm/index_ordered.hpp>
 #include <realm/index_string.hpp>
 #include <realm/query_conditions.hpp>
 #include <realm/query_expression.hpp>
@@ -94,6 +96,7 @@ TConditionValue:    Type of values in condition column. That is, int64_t, float,
 #include <realm/util/flat_map.hpp>
 #include <realm/util/serializer.hpp>
 #include <realm/utilities.hpp>
+#include <realm/zone_map.hpp>
 
 #include <map>
 #include <unordered_set>
@@ -134,6 +137,7 @@ public:
         m_children = v;
         m_children.erase(m_children.begin() + i);
         m_children.insert(m_children.begin(), this);
+        order_children_by_cost();
     }
 
     double cost() const
@@ -150,6 +154,19 @@ public:
     virtual void init(bool will_query_ranges)
     {
         m_dD = 100.0;
+        m_zone_map = nullptr;
+        if (will_query_ranges && m_table && m_condition_column_key)
+            m_zone_map = m_table.unchecked_ptr()->get_zone_map(m_condition_column_key);
+
+        // Start out from the match distance the column statistics predict rather than learning it on the first
+        // clusters
+        m_estimated_selectivity.reset();
+        if (m_table && m_condition_column_key && m_table.unchecked_ptr()->valid_column(m_condition_column_key)) {
+            if (auto stats = m_table.unchecked_ptr()->get_column_statistics(m_condition_column_key))
+                m_estimated_selectivity = estimate_selectivity(*stats);
+        }
+        if (m_estimated_selectivity)
+            m_dD = 1.0 / std::max(*m_estimated_selectivity, c_min_estimated_selectivity);
 
         if (m_child)
             m_child->init(will_query_ranges);
@@ -179,6 +196,15 @@ public:
         if (m_child)
             m_child->set_cluster(cluster);
         cluster_changed();
+        // If one condition cannot match any object in the cluster, neither can the conditions ANDed with it
+        m_cluster_excluded = (m_zone_map && !cluster_may_match()) || (m_child && m_child->m_cluster_excluded);
+    }
+
+    /// True if this condition, or one of the conditions ANDed after it, cannot match any object in the current
+    /// cluster according to the zone map of its column. find_first() returns not_found right away then.
+    bool cluster_excluded() const noexcept
+    {
+        return m_cluster_excluded;
     }
 
     virtual void collect_dependencies(std::vector<TableKey>&) const {}
@@ -274,10 +300,54 @@ public:
     size_t m_probes = 0;
     size_t m_matches = 0;
 
+    // Estimates of fewer matches are taken as this
+    constexpr static double c_min_estimated_selectivity = 1e-6;
+    // Like IndexEvaluator::c_max_range_fraction, a search index is not used to look up conditions expected to match
+    // more than this fraction of the objects
+    constexpr static double c_max_index_selectivity = 1.0 / 8;
+
 protected:
     ConstTableRef m_table = ConstTableRef();
     const Cluster* m_cluster = nullptr;
     QueryStateBase* m_state = nullptr;
+    // The zone map of the condition column, if it has one and the query traverses the clusters
+    const ZoneMap* m_zone_map = nullptr;
+    bool m_cluster_excluded = false;
+    // The fraction of the objects expected to match this condition according to the statistics of its column
+    std::optional<double> m_estimated_selectivity;
+    // The position in m_children of the condition find_first() starts with
+    size_t m_first_condition = 0;
+
+    // False if the column statistics predict that so many objects match that scanning the leaves is faster than
+    // looking up the matches in the search index
+    bool index_lookup_pays_off() const noexcept
+    {
+        return !m_estimated_selectivity || *m_estimated_selectivity <= c_max_index_selectivity;
+    }
+
+    // When the selectivity of some condition has been estimated, the conditions checked after a local match are
+    // ordered by their cost, so that objects which do not match are rejected by the most selective condition first,
+    // and find_first() starts with the cheapest condition.
+    void order_children_by_cost()
+    {
+        m_first_condition = 0;
+        if (std::none_of(m_children.begin(), m_children.end(), [](const ParentNode* node) {
+                return bool(node->m_estimated_selectivity);
+            }))
+            return;
+        auto by_cost = [](const ParentNode* a, const ParentNode* b) {
+            return a->cost() < b->cost();
+        };
+        std::stable_sort(m_children.begin() + 1, m_children.end(), by_cost);
+        if (m_children.size() > 1 && by_cost(m_children[1], this))
+            m_first_condition = 1;
+    }
+
+    // The keys of the first and the last object in the current cluster
+    std::pair<ObjKey, ObjKey> cluster_key_range() const
+    {
+        return {m_cluster->get_real_key(0), m_cluster->get_real_key(m_cluster->node_size() - 1)};
+    }
 
     ColumnType get_real_column_type(ColKey key)
     {
@@ -290,6 +360,18 @@ private:
     {
         // TODO: Should eventually be pure
     }
+    // Called with a non-empty cluster when the condition column has a zone map. Conditions which can tell from the
+    // zone map that none of the objects in the cluster can match return false.
+    virtual bool cluster_may_match() const
+    {
+        return true;
+    }
+    // Called when the condition column has statistics. Conditions which can estimate the fraction of the objects
+    // they match from them return it.
+    virtual std::optional<double> estimate_selectivity(const ColumnStatistics&) const
+    {
+        return {};
+    }
     virtual bool do_consume_condition(ParentNode&)
     {
         return false;
@@ -314,6 +396,14 @@ class IndexEvaluator {
 public:
     void init(SearchIndex* index, Mixed value);
     void init(std::vector<ObjKey>* storage);
+    // Find the objects with a value in the given range using an ordered index, storing their keys in `storage`. A
+    // null bound leaves the range open in that direction, and null values never match. If the range covers so
+    // much of the table that scanning the leaves is expected to be faster, nothing is done and false is returned.
+    bool init(const OrderedIndex* index, Mixed lower, bool lower_inclusive, Mixed upper, bool upper_inclusive,
+              std::vector<ObjKey>* storage);
+
+    // Ranges matching more than 1/c_max_range_fraction of the table are scanned instead
+    constexpr static size_t c_max_range_fraction = 8;
 
     size_t do_search_index(const Cluster* cluster, size_t start, size_t end);
 
@@ -393,6 +483,15 @@ protected:
         return end;
     }
 
+    template <class TConditionFunction>
+    bool zone_map_may_match(const TConditionValue& value) const
+    {
+        if (m_cluster->node_size() == 0)
+            return true;
+        auto [first, last] = cluster_key_range();
+        return m_zone_map->may_match<TConditionFunction>(first, last, Mixed(value));
+    }
+
     std::string describe(util::serializer::SerialisationState& state) const override
     {
         return state.describe_column(ParentNode::m_table, ColumnNodeBase::m_condition_column_key) + " " +
@@ -425,9 +524,15 @@ public:
         : ColumnNodeBase(from)
         , m_from(from.m_from)
         , m_to(from.m_to)
+        , m_has_ordered_index(from.m_has_ordered_index)
     {
     }
 
+    void table_changed() override
+    {
+        m_has_ordered_index = m_table->search_index_type(m_condition_column_key) == IndexType::Ordered;
+    }
+
     void cluster_changed() override
     {
         m_leaf.emplace(m_table.unchecked_ptr()->get_alloc());
@@ -439,13 +544,48 @@ public:
         ColumnNodeBase::init(will_query_ranges);
 
         m_dT = .25;
+        m_index_evaluator.reset();
+        if (m_has_ordered_index) {
+            auto index = static_cast<const OrderedIndex*>(m_table->get_search_index(m_condition_column_key));
+            m_index_evaluator.emplace();
+            if (m_index_evaluator->init(index, Mixed(m_from), true, Mixed(m_to), true, &m_index_matches))
+                m_dT = 0;
+            else
+                m_index_evaluator.reset();
+        }
+    }
+
+    bool has_search_index() const override
+    {
+        return bool(m_index_evaluator);
+    }
+
+    const IndexEvaluator* index_based_keys() override
+    {
+        return m_index_evaluator ? &*m_index_evaluator : nullptr;
     }
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (m_index_evaluator) {
+            return m_index_evaluator->do_search_index(m_cluster, start, end);
+        }
         return m_leaf->find_first_in_range(m_from, m_to, start, end);
     }
 
+    bool cluster_may_match() const override
+    {
+        if (m_cluster->node_size() == 0)
+            return true;
+        auto [first, last] = cluster_key_range();
+        return m_zone_map->may_match_between(first, last, Mixed(m_from), Mixed(m_to));
+    }
+
+    std::optional<double> estimate_selectivity(const ColumnStatistics& stats) const override
+    {
+        return stats.estimate_between(Mixed(m_from), Mixed(m_to));
+    }
+
     std::string describe(util::serializer::SerialisationState& state) const override
     {
         return state.describe_column(ParentNode::m_table, ColumnNodeBase::m_condition_column_key) + " between {" +
@@ -464,6 +604,10 @@ private:
 
     // Leaf cache
     std::optional<LeafType> m_leaf;
+
+    bool m_has_ordered_index = false;
+    std::optional<IndexEvaluator> m_index_evaluator;
+    std::vector<ObjKey> m_index_matches;
 };
 
 
@@ -481,11 +625,53 @@ public:
     }
     IntegerNode(const IntegerNode& from)
         : BaseType(from)
+        , m_has_ordered_index(from.m_has_ordered_index)
+    {
+    }
+
+    void table_changed() override
     {
+        if constexpr (is_any_v<TConditionFunction, Greater, GreaterEqual, Less, LessEqual>) {
+            m_has_ordered_index =
+                this->m_table->search_index_type(this->m_condition_column_key) == IndexType::Ordered;
+        }
+    }
+
+    void init(bool will_query_ranges) override
+    {
+        BaseType::init(will_query_ranges);
+
+        m_index_evaluator.reset();
+        Mixed value(this->m_value);
+        if (m_has_ordered_index && !value.is_null()) {
+            constexpr bool is_lower_bound = is_any_v<TConditionFunction, Greater, GreaterEqual>;
+            constexpr bool inclusive = is_any_v<TConditionFunction, GreaterEqual, LessEqual>;
+            auto index =
+                static_cast<const OrderedIndex*>(this->m_table->get_search_index(this->m_condition_column_key));
+            m_index_evaluator.emplace();
+            if (m_index_evaluator->init(index, is_lower_bound ? value : Mixed(), inclusive,
+                                        is_lower_bound ? Mixed() : value, inclusive, &m_index_matches))
+                this->m_dT = 0;
+            else
+                m_index_evaluator.reset();
+        }
+    }
+
+    bool has_search_index() const override
+    {
+        return bool(m_index_evaluator);
+    }
+
+    const IndexEvaluator* index_based_keys() override
+    {
+        return m_index_evaluator ? &*m_index_evaluator : nullptr;
     }
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (m_index_evaluator) {
+            return m_index_evaluator->do_search_index(this->m_cluster, start, end);
+        }
         return this->m_leaf->template find_first<TConditionFunction>(this->m_value, start, end);
     }
 
@@ -494,6 +680,16 @@ public:
         return BaseType::template find_all_local<TConditionFunction>(start, end);
     }
 
+    bool cluster_may_match() const override
+    {
+        return BaseType::template zone_map_may_match<TConditionFunction>(this->m_value);
+    }
+
+    std::optional<double> estimate_selectivity(const ColumnStatistics& stats) const override
+    {
+        return stats.estimate<TConditionFunction>(Mixed(this->m_value));
+    }
+
     std::string describe_condition() const override
     {
         return TConditionFunction::description();
@@ -503,6 +699,11 @@ public:
     {
         return std::unique_ptr<ParentNode>(new ThisType(*this));
     }
+
+private:
+    bool m_has_ordered_index = false;
+    std::optional<IndexEvaluator> m_index_evaluator;
+    std::vector<ObjKey> m_index_matches;
 };
 
 template <size_t linear_search_threshold, class LeafType, class NeedleContainer>
@@ -588,7 +789,8 @@ public:
         BaseType::init(will_query_ranges);
         m_nb_needles = m_needles.size();
 
-        if (has_search_index() && m_nb_needles == 0) {
+        m_index_evaluator.reset();
+        if (has_search_index() && m_nb_needles == 0 && this->index_lookup_pays_off()) {
             SearchIndex* index = ParentNode::m_table->get_search_index(ParentNode::m_condition_column_key);
             m_index_evaluator = IndexEvaluator();
             m_index_evaluator->init(index, BaseType::m_value);
@@ -616,8 +818,8 @@ public:
 
     bool has_search_index() const override
     {
-        return this->m_table->search_index_type(IntegerNodeBase<LeafType>::m_condition_column_key) ==
-               IndexType::General;
+        auto type = this->m_table->search_index_type(IntegerNodeBase<LeafType>::m_condition_column_key);
+        return type == IndexType::General || type == IndexType::Ordered;
     }
 
     const IndexEvaluator* index_based_keys() override
@@ -653,6 +855,30 @@ public:
         return BaseType::template find_all_local<Equal>(start, end);
     }
 
+    bool cluster_may_match() const override
+    {
+        if (m_nb_needles) {
+            return std::any_of(m_needles.begin(), m_needles.end(), [this](const TConditionValue& needle) {
+                return BaseType::template zone_map_may_match<Equal>(needle);
+            });
+        }
+        return BaseType::template zone_map_may_match<Equal>(this->m_value);
+    }
+
+    std::optional<double> estimate_selectivity(const ColumnStatistics& stats) const override
+    {
+        if (m_needles.empty())
+            return stats.estimate<Equal>(Mixed(this->m_value));
+        double selectivity = 0;
+        for (const auto& needle : m_needles) {
+            auto needle_selectivity = stats.estimate<Equal>(Mixed(needle));
+            if (!needle_selectivity)
+                return {};
+            selectivity += *needle_selectivity;
+        }
+        return std::min(selectivity, 1.0);
+    }
+
     std::string describe(util::serializer::SerialisationState& state) const override
     {
         REALM_ASSERT(this->m_condition_column_key);
@@ -740,6 +966,19 @@ public:
             return find(false);
     }
 
+    bool cluster_may_match() const override
+    {
+        if (m_cluster->node_size() == 0)
+            return true;
+        auto [first, last] = cluster_key_range();
+        return m_zone_map->may_match<TConditionFunction>(first, last, Mixed(m_value));
+    }
+
+    std::optional<double> estimate_selectivity(const ColumnStatistics& stats) const override
+    {
+        return stats.estimate<TConditionFunction>(Mixed(m_value));
+    }
+
     std::string describe(util::serializer::SerialisationState& state) const override
     {
         REALM_ASSERT(m_condition_column_key);
@@ -959,6 +1198,9 @@ public:
         ParentNode::init(will_query_ranges);
 
         if constexpr (std::is_same_v<TConditionFunction, Equal>) {
+            table_changed();
+            if (!index_lookup_pays_off())
+                m_index_evaluator.reset();
             if (m_index_evaluator) {
                 SearchIndex* index = m_table->get_search_index(m_condition_column_key);
                 m_index_evaluator->init(index, m_value);
@@ -1009,6 +1251,11 @@ public:
         return not_found;
     }
 
+    std::optional<double> estimate_selectivity(const ColumnStatistics& stats) const override
+    {
+        return stats.estimate<TConditionFunction>(m_value ? Mixed(*m_value) : Mixed());
+    }
+
     std::string describe(util::serializer::SerialisationState& state) const override
     {
         return state.describe_column(ParentNode::m_table, m_condition_column_key) + " " +
@@ -1070,6 +1317,9 @@ public:
         TimestampNodeBase::init(will_query_ranges);
 
         if constexpr (std::is_same_v<TConditionFunction, Equal>) {
+            table_changed();
+            if (!index_lookup_pays_off())
+                m_index_evaluator.reset();
             if (m_index_evaluator) {
                 SearchIndex* index =
                     TimestampNodeBase::m_table->get_search_index(TimestampNodeBase::m_condition_column_key);
@@ -1077,15 +1327,32 @@ public:
                 this->m_dT = 0;
             }
         }
+        else if constexpr (is_any_v<TConditionFunction, Greater, GreaterEqual, Less, LessEqual>) {
+            m_index_evaluator.reset();
+            if (m_has_ordered_index && !m_value.is_null()) {
+                constexpr bool is_lower_bound = is_any_v<TConditionFunction, Greater, GreaterEqual>;
+                constexpr bool inclusive = is_any_v<TConditionFunction, GreaterEqual, LessEqual>;
+                auto index = static_cast<const OrderedIndex*>(m_table->get_search_index(m_condition_column_key));
+                m_index_evaluator.emplace();
+                if (m_index_evaluator->init(index, is_lower_bound ? Mixed(m_value) : Mixed(), inclusive,
+                                            is_lower_bound ? Mixed() : Mixed(m_value), inclusive, &m_index_matches))
+                    this->m_dT = 0;
+                else
+                    m_index_evaluator.reset();
+            }
+        }
     }
 
     void table_changed() override
     {
+        auto index_type = this->m_table->search_index_type(TimestampNodeBase::m_condition_column_key);
         if constexpr (std::is_same_v<TConditionFunction, Equal>) {
-            const bool has_index =
-                this->m_table->search_index_type(TimestampNodeBase::m_condition_column_key) == IndexType::General;
+            const bool has_index = index_type == IndexType::General || index_type == IndexType::Ordered;
             m_index_evaluator = has_index ? std::make_optional(IndexEvaluator{}) : std::nullopt;
         }
+        else {
+            m_has_ordered_index = index_type == IndexType::Ordered;
+        }
     }
 
     const IndexEvaluator* index_based_keys() override
@@ -1100,14 +1367,25 @@ public:
 
     size_t find_first_local(size_t start, size_t end) override
     {
-        if constexpr (std::is_same_v<TConditionFunction, Equal>) {
-            if (m_index_evaluator) {
-                return m_index_evaluator->do_search_index(this->m_cluster, start, end);
-            }
+        if (m_index_evaluator) {
+            return m_index_evaluator->do_search_index(this->m_cluster, start, end);
         }
         return m_leaf->find_first<TConditionFunction>(m_value, start, end);
     }
 
+    bool cluster_may_match() const override
+    {
+        if (m_cluster->node_size() == 0)
+            return true;
+        auto [first, last] = cluster_key_range();
+        return m_zone_map->may_match<TConditionFunction>(first, last, Mixed(m_value));
+    }
+
+    std::optional<double> estimate_selectivity(const ColumnStatistics& stats) const override
+    {
+        return stats.estimate<TConditionFunction>(Mixed(m_value));
+    }
+
     std::string describe(util::serializer::SerialisationState& state) const override
     {
         REALM_ASSERT(m_condition_column_key);
@@ -1122,6 +1400,8 @@ public:
 
 protected:
     std::optional<IndexEvaluator> m_index_evaluator;
+    bool m_has_ordered_index = false;
+    std::vector<ObjKey> m_index_matches;
 };
 
 class DecimalNodeBase : public ParentNode {
@@ -1989,6 +2269,12 @@ public:
     }
     StringNode(ColKey col, const Mixed* begin, const Mixed* end);
 
+    void init(bool will_query_ranges) override
+    {
+        StringNodeEqualBase::init(will_query_ranges);
+        m_enum_needles_resolved = false;
+    }
+
     void _search_index_init() override;
 
     bool do_consume_condition(ParentNode& other) override;
@@ -2017,8 +2303,16 @@ public:
 
 private:
     size_t _find_first_local(size_t start, size_t end) override;
+    std::optional<double> estimate_selectivity(const ColumnStatistics& stats) const override;
+    void resolve_enum_needles();
     std::unordered_set<StringData> m_needles;
     std::vector<std::unique_ptr<char[]>> m_needle_storage;
+
+    // For enumerated columns the needles are matched by their position in the list of unique values, which is
+    // shared by all leaves of the column and so only looked up once per query execution.
+    bool m_enum_needles_resolved = false;
+    size_t m_enum_needle = realm::not_found;
+    std::vector<bool> m_enum_needles;
 };
 
 
@@ -17,11 +17,293 @@
  **************************************************************************/
 
 #include <realm/query_expression.hpp>
+#include <realm/column_statistics.hpp>
 #include <realm/group.hpp>
 #include <realm/dictionary.hpp>
+#include <realm/query.hpp>
+#include <realm/table_view.hpp>
 
 namespace realm {
 
+namespace {
+
+template <class TOperator, class T>
+void apply_operator(const T* left, const T* right, T* result, size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        if constexpr (std::is_same_v<TOperator, Plus>) {
+            result[i] = left[i] + right[i];
+        }
+        else if constexpr (std::is_same_v<TOperator, Minus>) {
+            result[i] = left[i] - right[i];
+        }
+        else if constexpr (std::is_same_v<TOperator, Mul>) {
+            result[i] = left[i] * right[i];
+        }
+        else if constexpr (std::is_same_v<TOperator, Div> && std::is_same_v<T, int64_t>) {
+            // Like Mixed::operator/()
+            if (right[i] == 0)
+                result[i] = left[i] < 0 ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max();
+            else
+                result[i] = left[i] / right[i];
+        }
+        else {
+            static_assert(std::is_same_v<TOperator, Div>);
+            result[i] = left[i] / right[i];
+        }
+    }
+}
+
+// The loops below avoid branches so that they can be vectorized
+template <class TCond, class T>
+bool compare_values(const T* left, const T* right, const uint8_t* left_nulls, const uint8_t* right_nulls,
+                    uint8_t* matches, size_t size)
+{
+    if constexpr (std::is_floating_point_v<T>) {
+        // Mixed orders NaN before all other values, which IEEE comparisons do not
+        bool has_nan = false;
+        for (size_t i = 0; i < size; ++i) {
+            has_nan |= (!left_nulls[i] & (left[i] != left[i])) | (!right_nulls[i] & (right[i] != right[i]));
+        }
+        if (has_nan)
+            return false;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        uint8_t both_null = left_nulls[i] & right_nulls[i];
+        uint8_t no_null = !(left_nulls[i] | right_nulls[i]);
+        if constexpr (std::is_same_v<TCond, Equal>) {
+            matches[i] = both_null | (no_null & (left[i] == right[i]));
+        }
+        else if constexpr (std::is_same_v<TCond, NotEqual>) {
+            matches[i] = !(both_null | (no_null & (left[i] == right[i])));
+        }
+        else if constexpr (std::is_same_v<TCond, Greater>) {
+            matches[i] = no_null & (left[i] > right[i]);
+        }
+        else if constexpr (std::is_same_v<TCond, Less>) {
+            matches[i] = no_null & (left[i] < right[i]);
+        }
+        else if constexpr (std::is_same_v<TCond, GreaterEqual>) {
+            matches[i] = both_null | (no_null & (left[i] >= right[i]));
+        }
+        else {
+            static_assert(std::is_same_v<TCond, LessEqual>);
+            matches[i] = both_null | (no_null & (left[i] <= right[i]));
+        }
+    }
+    return true;
+}
+
+template <class From, class To>
+void convert_values(const std::vector<From>& from, std::vector<To>& to, size_t size)
+{
+    to.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+        to[i] = To(from[i]);
+    }
+}
+
+// Nulls are stored as a particular NaN
+template <class T>
+bool load_float_values(const BasicArray<T>& leaf, size_t begin, size_t end, T* values, uint8_t* nulls)
+{
+    bool has_nulls = false;
+    for (size_t ndx = begin; ndx < end; ++ndx) {
+        T value = leaf.get(ndx);
+        if (null::is_null_float(value)) {
+            nulls[ndx - begin] = 1;
+            has_nulls = true;
+            value = 0;
+        }
+        values[ndx - begin] = value;
+    }
+    return has_nulls;
+}
+
+} // anonymous namespace
+
+void ValueBatch::init(DataType type, size_t size)
+{
+    REALM_ASSERT_DEBUG(size <= max_size);
+    m_type = type;
+    m_size = size;
+    m_has_nulls = false;
+    if (type == type_Int) {
+        m_ints.resize(size);
+    }
+    else if (type == type_Float) {
+        m_floats.resize(size);
+    }
+    else {
+        REALM_ASSERT(type == type_Double);
+        m_doubles.resize(size);
+    }
+    m_nulls.assign(size, 0);
+}
+
+void ValueBatch::load(const ArrayInteger& leaf, size_t begin, size_t end)
+{
+    init(type_Int, end - begin);
+    int64_t* values = m_ints.data();
+    size_t ndx = begin;
+    for (; ndx + ValueBase::chunk_size <= end; ndx += ValueBase::chunk_size) {
+        leaf.get_chunk(ndx, values + (ndx - begin));
+    }
+    for (; ndx < end; ++ndx) {
+        values[ndx - begin] = leaf.get(ndx);
+    }
+}
+
+void ValueBatch::load(const ArrayIntNull& leaf, size_t begin, size_t end)
+{
+    // The values are stored after the value representing null
+    const Array& arr = leaf;
+    init(type_Int, end - begin);
+    int64_t* values = m_ints.data();
+    size_t ndx = begin + 1;
+    for (; ndx + ValueBase::chunk_size <= end + 1; ndx += ValueBase::chunk_size) {
+        arr.get_chunk(ndx, values + (ndx - begin - 1));
+    }
+    for (; ndx < end + 1; ++ndx) {
+        values[ndx - begin - 1] = arr.get(ndx);
+    }
+    int64_t null_value = leaf.null_value();
+    uint8_t any_null = 0;
+    for (size_t i = 0; i < m_size; ++i) {
+        uint8_t is_null = values[i] == null_value;
+        m_nulls[i] = is_null;
+        values[i] = is_null ? 0 : values[i];
+        any_null |= is_null;
+    }
+    m_has_nulls = any_null;
+}
+
+void ValueBatch::load(const ArrayFloat& leaf, size_t begin, size_t end)
+{
+    init(type_Float, end - begin);
+    m_has_nulls = load_float_values<float>(leaf, begin, end, m_floats.data(), m_nulls.data());
+}
+
+void ValueBatch::load(const ArrayDouble& leaf, size_t begin, size_t end)
+{
+    init(type_Double, end - begin);
+    m_has_nulls = load_float_values<double>(leaf, begin, end, m_doubles.data(), m_nulls.data());
+}
+
+void ValueBatch::fill(Mixed value, size_t size)
+{
+    init(value.get_type(), size);
+    switch (m_type) {
+        case type_Int:
+            std::fill(m_ints.begin(), m_ints.end(), value.get_int());
+            break;
+        case type_Float:
+            std::fill(m_floats.begin(), m_floats.end(), value.get_float());
+            break;
+        default:
+            std::fill(m_doubles.begin(), m_doubles.end(), value.get_double());
+            break;
+    }
+}
+
+bool ValueBatch::promote(DataType type, bool exact)
+{
+    if (type == m_type)
+        return true;
+    if (m_type == type_Int) {
+        if (exact) {
+            // Integers of this magnitude all have an exact representation
+            const int64_t limit = int64_t(1) << (type == type_Float ? 24 : 53);
+            uint8_t in_range = 1;
+            for (size_t i = 0; i < m_size; ++i) {
+                in_range &= (m_ints[i] <= limit) & (m_ints[i] >= -limit);
+            }
+            if (!in_range)
+                return false;
+        }
+        if (type == type_Float)
+            convert_values(m_ints, m_floats, m_size);
+        else
+            convert_values(m_ints, m_doubles, m_size);
+    }
+    else {
+        REALM_ASSERT(m_type == type_Float && type == type_Double);
+        convert_values(m_floats, m_doubles, m_size);
+    }
+    m_type = type;
+    return true;
+}
+
+template <class TOperator>
+void ValueBatch::fun(ValueBatch& left, ValueBatch& right)
+{
+    REALM_ASSERT_DEBUG(left.size() == right.size());
+    // The type of the result is the widest of the two, like for Mixed::operator+() and friends
+    DataType type = std::max(left.get_type(), right.get_type());
+    left.promote(type, false);
+    right.promote(type, false);
+    init(type, left.size());
+    if (left.m_has_nulls || right.m_has_nulls) {
+        for (size_t i = 0; i < m_size; ++i) {
+            m_nulls[i] = left.m_nulls[i] | right.m_nulls[i];
+        }
+        m_has_nulls = true;
+    }
+    switch (type) {
+        case type_Int:
+            apply_operator<TOperator>(left.m_ints.data(), right.m_ints.data(), m_ints.data(), m_size);
+            break;
+        case type_Float:
+            apply_operator<TOperator>(left.m_floats.data(), right.m_floats.data(), m_floats.data(), m_size);
+            break;
+        default:
+            apply_operator<TOperator>(left.m_doubles.data(), right.m_doubles.data(), m_doubles.data(), m_size);
+            break;
+    }
+    if (m_has_nulls && type == type_Int) {
+        // A null may have been divided by zero
+        for (size_t i = 0; i < m_size; ++i) {
+            m_ints[i] = m_nulls[i] ? 0 : m_ints[i];
+        }
+    }
+}
+
+template <class TCond>
+bool ValueBatch::compare(ValueBatch& left, ValueBatch& right, uint8_t* matches)
+{
+    REALM_ASSERT_DEBUG(left.size() == right.size());
+    if (left.get_type() != right.get_type()) {
+        // Mixed compares an Int to a Float or Double as if both were converted exactly to double
+        if (!left.promote(type_Double, true) || !right.promote(type_Double, true))
+            return false;
+    }
+    const uint8_t* left_nulls = left.m_nulls.data();
+    const uint8_t* right_nulls = right.m_nulls.data();
+    switch (left.get_type()) {
+        case type_Int:
+            return compare_values<TCond>(left.m_ints.data(), right.m_ints.data(), left_nulls, right_nulls, matches,
+                                         left.size());
+        case type_Float:
+            return compare_values<TCond>(left.m_floats.data(), right.m_floats.data(), left_nulls, right_nulls,
+                                         matches, left.size());
+        default:
+            return compare_values<TCond>(left.m_doubles.data(), right.m_doubles.data(), left_nulls, right_nulls,
+                                         matches, left.size());
+    }
+}
+
+template void ValueBatch::fun<Plus>(ValueBatch&, ValueBatch&);
+template void ValueBatch::fun<Minus>(ValueBatch&, ValueBatch&);
+template void ValueBatch::fun<Mul>(ValueBatch&, ValueBatch&);
+template void ValueBatch::fun<Div>(ValueBatch&, ValueBatch&);
+
+template bool ValueBatch::compare<Equal>(ValueBatch&, ValueBatch&, uint8_t*);
+template bool ValueBatch::compare<NotEqual>(ValueBatch&, ValueBatch&, uint8_t*);
+template bool ValueBatch::compare<Greater>(ValueBatch&, ValueBatch&, uint8_t*);
+template bool ValueBatch::compare<Less>(ValueBatch&, ValueBatch&, uint8_t*);
+template bool ValueBatch::compare<GreaterEqual>(ValueBatch&, ValueBatch&, uint8_t*);
+template bool ValueBatch::compare<LessEqual>(ValueBatch&, ValueBatch&, uint8_t*);
+
 void LinkMap::set_base_table(ConstTableRef table)
 {
     if (table == get_base_table())
@@ -50,8 +332,9 @@ void LinkMap::set_base_table(ConstTableRef table)
 
 void LinkMap::collect_dependencies(std::vector<TableKey>& tables) const
 {
-    for (auto& t : m_tables) {
-        TableKey k = t->get_key();
+    // The base table is the one being queried, which is not a dependency of its own
+    for (size_t i = 1; i < m_tables.size(); ++i) {
+        TableKey k = m_tables[i]->get_key();
         if (find(tables.begin(), tables.end(), k) == tables.end()) {
             tables.push_back(k);
         }
@@ -263,6 +546,66 @@ std::vector<ObjKey> LinkMap::get_origin_objkeys(ObjKey key, size_t column) const
     return ret;
 }
 
+std::vector<ObjKey> LinkMap::find_in_target_table(ColKey column, Mixed value) const
+{
+    auto target = get_target_table();
+    // The Mixed overload of Query::equal() only applies to Mixed columns
+    Query q = target->where();
+    switch (value.get_type()) {
+        case type_Int:
+            q.equal(column, value.get_int());
+            break;
+        case type_Bool:
+            q.equal(column, value.get_bool());
+            break;
+        case type_String:
+            q.equal(column, value.get_string());
+            break;
+        case type_Timestamp:
+            q.equal(column, value.get_timestamp());
+            break;
+        case type_Float:
+            q.equal(column, value.get_float());
+            break;
+        case type_Double:
+            q.equal(column, value.get_double());
+            break;
+        case type_ObjectId:
+            q.equal(column, value.get_object_id());
+            break;
+        case type_UUID:
+            q.equal(column, value.get_uuid());
+            break;
+        default:
+            q.equal(column, value);
+            break;
+    }
+    auto tv = q.find_all();
+    std::vector<ObjKey> keys;
+    keys.reserve(tv.size());
+    for (size_t i = 0; i < tv.size(); ++i)
+        keys.push_back(tv.get_key(i));
+    return keys;
+}
+
+bool LinkMap::prefers_reverse_traversal(ColKey column, Mixed value) const
+{
+    if (!has_links() || value.is_null() || value.get_type() != DataType(column.get_type()))
+        return false;
+    auto target = get_target_table().unchecked_ptr();
+    auto stats = target->get_column_statistics(column);
+    if (!stats)
+        return false;
+    auto selectivity = stats->estimate<Equal>(value);
+    if (!selectivity)
+        return false;
+    // Going backwards scans the target table once, and the links back from the matching objects are assumed to
+    // reach the same fraction of the base table. Going forwards follows the links of every object of the base table.
+    double base_size = double(get_base_table()->size());
+    double target_size = double(target->size());
+    return target_size + 2 * *selectivity * base_size < base_size * get_nb_hops();
+}
+
 ColumnDictionaryKeys Columns<Dictionary>::keys()
 {
     return ColumnDictionaryKeys(*this);
@@ -88,6 +88,10 @@ Value<T> containing 8 values representing table rows i...i + 7.
 So Value<T> contains 8 concecutive values and all operations are based on these chunks. This is
 to save overhead by virtual calls needed for evaluating a query that has been dynamically constructed at runtime.
 
+Comparisons of numeric expressions without links, like 'table.price * table.quantity > 1000', go further: Compare
+calls evaluate_batch() instead, which evaluates up to ValueBatch::max_size rows of the leaf at a time into vectors of
+unboxed values, and compares them in one go.
+
 
 Memory allocation:
 -----------------------------------------------------------------------------------------------------------------------
@@ -643,6 +647,57 @@ private:
     }
 };
 
+// The values of a numeric expression for a range of rows of a cluster, unboxed into a vector of int64_t, float or
+// double and a vector telling which of them are null. Evaluating up to a whole leaf into these at a time lets the
+// arithmetic and the comparisons run as simple loops over arrays which the compiler can vectorize, instead of one
+// virtual call per ValueBase::chunk_size rows and one QueryValue per value.
+class ValueBatch {
+public:
+    static constexpr size_t max_size = 1000;
+
+    void init(DataType type, size_t size);
+
+    DataType get_type() const
+    {
+        return m_type;
+    }
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    void load(const ArrayInteger& leaf, size_t begin, size_t end);
+    void load(const ArrayIntNull& leaf, size_t begin, size_t end);
+    void load(const ArrayFloat& leaf, size_t begin, size_t end);
+    void load(const ArrayDouble& leaf, size_t begin, size_t end);
+    // Set all values to `value`, which must be a non-null Int, Float or Double
+    void fill(Mixed value, size_t size);
+
+    // this = TOperator()(left, right), with the types promoted like Mixed arithmetic does
+    template <class TOperator>
+    void fun(ValueBatch& left, ValueBatch& right);
+
+    // Set matches[i] to 1 if TCond()(left[i], right[i]) is true and to 0 otherwise. Returns false, without setting
+    // anything, if the result could differ from comparing the values as QueryValues, which is when a non-null value
+    // is NaN, or when an Int must be compared to a Float or Double it cannot be converted to exactly.
+    template <class TCond>
+    static bool compare(ValueBatch& left, ValueBatch& right, uint8_t* matches);
+
+private:
+    DataType m_type = type_Int;
+    size_t m_size = 0;
+    bool m_has_nulls = false;
+    std::vector<int64_t> m_ints;
+    std::vector<float> m_floats;
+    std::vector<double> m_doubles;
+    std::vector<uint8_t> m_nulls;
+
+    // Convert the values to `type`, which must be wider than the current type. Int values are converted the way
+    // Mixed::export_to_type() does, and if `exact` is true, the conversion fails if any of them cannot be
+    // converted exactly.
+    bool promote(DataType type, bool exact);
+};
+
 class Expression {
 public:
     virtual ~Expression() = default;
@@ -740,6 +795,19 @@ public:
         return false;
     }
 
+    // True if the expression has a single Int, Float or Double value for each row, and evaluate_batch() can
+    // evaluate it
+    virtual bool has_batch_evaluation() const
+    {
+        return false;
+    }
+
+    // Load the values for the rows [begin, end) of the current cluster into destination
+    virtual void evaluate_batch(size_t, size_t, ValueBatch&)
+    {
+        REALM_UNREACHABLE();
+    }
+
     virtual bool has_single_value() const
     {
         return false;
@@ -765,6 +833,13 @@ public:
         return {};
     }
 
+    // True if finding the objects equal to the value at the end of the link path first, and following the links
+    // to them backwards with find_all(), is expected to be faster than following the links of every object
+    virtual bool prefers_reverse_link_traversal(Mixed) const
+    {
+        return false;
+    }
+
     virtual ConstTableRef get_target_table() const
     {
         return {};
@@ -1361,6 +1436,19 @@ public:
         destination = *this;
     }
 
+    bool has_batch_evaluation() const override
+    {
+        if (m_from_list || size() != 1)
+            return false;
+        auto& val = get(0);
+        return val.is_type(type_Int) || val.is_type(type_Float) || val.is_type(type_Double);
+    }
+
+    void evaluate_batch(size_t begin, size_t end, ValueBatch& destination) override
+    {
+        destination.fill(get(0), end - begin);
+    }
+
     std::unique_ptr<Subexpr> clone() const override
     {
         return make_subexpr<Value<T>>(*this);
@@ -1624,6 +1712,13 @@ public:
 
     std::vector<ObjKey> get_origin_objkeys(ObjKey key, size_t column = 0) const;
 
+    // The objects of the target table whose value in `column` equals `value`, found by a query
+    std::vector<ObjKey> find_in_target_table(ColKey column, Mixed value) const;
+    // True if the statistics of `column` in the target table predict that finding the objects whose value in it
+    // equals `value`, and following the links to them backwards, is faster than following the links of every object
+    // of the base table
+    bool prefers_reverse_traversal(ColKey column, Mixed value) const;
+
     size_t count_links(size_t row) const
     {
         size_t count = 0;
@@ -1812,6 +1907,11 @@ public:
         return m_link_map.has_indexes();
     }
 
+    bool prefers_reverse_link_traversal(Mixed value) const final
+    {
+        return m_link_map.prefers_reverse_traversal(m_column_key, value);
+    }
+
     std::vector<ObjKey> find_all(Mixed value) const final
     {
         std::vector<ObjKey> ret;
@@ -1826,9 +1926,7 @@ public:
             if (auto k = m_link_map.get_target_table()->find_primary_key(value))
                 result.push_back(k);
         }
-        else {
-            SearchIndex* index = m_link_map.get_target_table()->get_search_index(m_column_key);
-            REALM_ASSERT(index);
+        else if (SearchIndex* index = m_link_map.get_target_table()->get_search_index(m_column_key)) {
             if (value.is_null()) {
                 index->find_all(result, realm::null{});
             }
@@ -1837,6 +1935,10 @@ public:
                 index->find_all(result, val);
             }
         }
+        else {
+            // Only when prefers_reverse_link_traversal()
+            result = m_link_map.find_in_target_table(m_column_key, value);
+        }
 
         for (ObjKey k : result) {
             auto ndxs = m_link_map.get_origin_objkeys(k);
@@ -3992,6 +4094,29 @@ public:
         }
     }
 
+    bool has_batch_evaluation() const override
+    {
+        return realm::is_any_v<T, int64_t, float, double> && !links_exist();
+    }
+
+    void evaluate_batch(size_t begin, size_t end, ValueBatch& destination) override
+    {
+        if constexpr (realm::is_any_v<T, int64_t, float, double>) {
+            if (auto leaf = mpark::get_if<NullableLeafType>(&m_leaf)) {
+                destination.load(*leaf, begin, end);
+            }
+            else {
+                destination.load(mpark::get<LeafType>(m_leaf), begin, end);
+            }
+        }
+        else {
+            static_cast<void>(begin);
+            static_cast<void>(end);
+            static_cast<void>(destination);
+            REALM_UNREACHABLE();
+        }
+    }
+
 private:
     using ObjPropertyExpr<T>::m_link_map;
     using ObjPropertyExpr<T>::m_column_key;
@@ -4387,6 +4512,18 @@ public:
         destination = result;
     }
 
+    bool has_batch_evaluation() const override
+    {
+        return m_left->has_batch_evaluation() && m_right->has_batch_evaluation();
+    }
+
+    void evaluate_batch(size_t begin, size_t end, ValueBatch& destination) override
+    {
+        m_left->evaluate_batch(begin, end, m_left_batch);
+        m_right->evaluate_batch(begin, end, m_right_batch);
+        destination.template fun<oper>(m_left_batch, m_right_batch);
+    }
+
     std::string description(util::serializer::SerialisationState& state) const override
     {
         std::string s = "(";
@@ -4423,6 +4560,8 @@ private:
     bool m_left_is_const;
     bool m_right_is_const;
     Mixed m_const_value;
+    ValueBatch m_left_batch;
+    ValueBatch m_right_batch;
 };
 
 class CompareBase : public Expression {
@@ -4455,6 +4594,7 @@ public:
         else {
             m_left->set_cluster(cluster);
             m_right->set_cluster(cluster);
+            m_batch_begin = m_batch_end = 0;
         }
     }
 
@@ -4540,6 +4680,17 @@ protected:
     std::vector<ObjKey> m_matches;
     mutable size_t m_index_get = 0;
     size_t m_index_end = 0;
+
+    // If true, the values of both sides are evaluated up to ValueBatch::max_size rows at a time, and the result of
+    // comparing them is kept for the following calls to find_first() within the same rows
+    bool m_evaluate_batches = false;
+    mutable ValueBatch m_left_batch;
+    mutable ValueBatch m_right_batch;
+    mutable std::vector<uint8_t> m_batch_matches;
+    mutable size_t m_batch_begin = 0;
+    mutable size_t m_batch_end = 0;
+    // False if the rows of the current batch must be compared one chunk at a time
+    mutable bool m_batch_compared = false;
 };
 
 template <class TCond>
@@ -4550,6 +4701,10 @@ public:
     double init() override
     {
         double dT = 50.0;
+        m_evaluate_batches = is_any_v<TCond, Equal, NotEqual, Greater, Less, GreaterEqual, LessEqual> &&
+                             m_left->has_batch_evaluation() && m_right->has_batch_evaluation() &&
+                             !m_left->get_comparison_type() && !m_right->get_comparison_type();
+        m_batch_begin = m_batch_end = 0;
         if ((m_left->has_single_value()) || (m_right->has_single_value())) {
             dT = 10.0;
             if constexpr (std::is_same_v<TCond, Equal>) {
@@ -4569,7 +4724,8 @@ public:
                     column = m_left.get();
                 }
 
-                if (column->has_search_index() && !column->has_indexes_in_link_map() &&
+                if ((column->has_search_index() || column->prefers_reverse_link_traversal(const_value)) &&
+                    !column->has_indexes_in_link_map() &&
                     column->get_comparison_type().value_or(ExpressionComparisonType::Any) ==
                         ExpressionComparisonType::Any &&
                     const_value_cmp_type.value_or(ExpressionComparisonType::Any) != ExpressionComparisonType::None) {
@@ -4613,7 +4769,48 @@ public:
         if (m_has_matches) {
             return find_first_with_matches(start, end);
         }
+        if (m_evaluate_batches) {
+            return find_first_in_batches(start, end);
+        }
+        return find_first_in_chunks(start, end);
+    }
+
+    size_t find_first_in_batches(size_t start, size_t end) const
+    {
+        while (start < end) {
+            if (start < m_batch_begin || start >= m_batch_end) {
+                compare_batch(start, std::min(end, start + ValueBatch::max_size));
+            }
+            size_t batch_end = std::min(end, m_batch_end);
+            if (m_batch_compared) {
+                auto first = m_batch_matches.data() + (start - m_batch_begin);
+                if (auto match = static_cast<const uint8_t*>(memchr(first, 1, batch_end - start)))
+                    return m_batch_begin + size_t(match - m_batch_matches.data());
+            }
+            else {
+                size_t match = find_first_in_chunks(start, batch_end);
+                if (match != not_found)
+                    return match;
+            }
+            start = batch_end;
+        }
+        return not_found;
+    }
+
+    void compare_batch(size_t begin, size_t end) const
+    {
+        m_left->evaluate_batch(begin, end, m_left_batch);
+        m_right->evaluate_batch(begin, end, m_right_batch);
+        m_batch_matches.resize(end - begin);
+        if constexpr (is_any_v<TCond, Equal, NotEqual, Greater, Less, GreaterEqual, LessEqual>) {
+            m_batch_compared = ValueBatch::compare<TCond>(m_left_batch, m_right_batch, m_batch_matches.data());
+        }
+        m_batch_begin = begin;
+        m_batch_end = end;
+    }
 
+    size_t find_first_in_chunks(size_t start, size_t end) const
+    {
         size_t match;
         ValueBase left_buf;
         ValueBase right_buf;
@@ -21,6 +21,7 @@
 
 #include <cstdlib> // size_t
 #include <cstdint> // unint8_t etc
+#include <memory>
 
 #include <realm/node.hpp>
 
@@ -32,6 +33,7 @@ enum Action { act_ReturnFirst, act_Sum, act_Max, act_Min, act_Count, act_FindAll
 // Array::VTable only uses the first 4 conditions (enums) in an array of function pointers
 enum { cond_Equal, cond_NotEqual, cond_Greater, cond_Less, cond_VTABLE_FINDER_COUNT, cond_None, cond_LeftNotNull };
 
+class Array;
 class ArrayUnsigned;
 class Mixed;
 
@@ -60,6 +62,28 @@ public:
         return false;
     }
 
+    // Called with a leaf of non-nullable integers which all match, so that the state can aggregate the leaf as a
+    // whole. Returns false if this is not supported, in which case match() must be called for each element instead.
+    // Only used when there is no limit.
+    virtual bool match_leaf(const Array&)
+    {
+        return false;
+    }
+
+    // Support for evaluating a query on several threads. Each part of the table is evaluated into a
+    // separate state obtained from make_partial(), and the results of the parts are then folded into
+    // this state in table order with merge_partial(). Only states for which supports_partial() returns
+    // true can be split.
+    virtual bool supports_partial() const noexcept
+    {
+        return false;
+    }
+    virtual std::unique_ptr<QueryStateBase> make_partial() const
+    {
+        return nullptr;
+    }
+    virtual void merge_partial(const QueryStateBase&) {}
+
     inline size_t match_count() const noexcept
     {
         return m_match_count;
@@ -104,6 +128,18 @@ public:
     {
         return m_match_count;
     }
+    bool supports_partial() const noexcept final
+    {
+        return true;
+    }
+    std::unique_ptr<QueryStateBase> make_partial() const final
+    {
+        return std::make_unique<QueryStateCount>(m_limit);
+    }
+    void merge_partial(const QueryStateBase& other) final
+    {
+        m_match_count += other.match_count();
+    }
 };
 
 } // namespace realm
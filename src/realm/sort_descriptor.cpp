@@ -17,15 +17,66 @@
  **************************************************************************/
 
 #include <realm/sort_descriptor.hpp>
+#include <realm/index_ordered.hpp>
 #include <realm/table.hpp>
 #include <realm/table_view.hpp>
 #include <realm/db.hpp>
 #include <realm/util/assert.hpp>
 #include <realm/list.hpp>
 #include <realm/dictionary.hpp>
+#include <realm/util/thread_pool.hpp>
+
+#include <cmath>
+#include <unordered_map>
 
 using namespace realm;
 
+namespace {
+
+// Call `fn(begin, end)` for consecutive ranges covering [0, size), on several
+// threads if `parallel` is set and there are enough elements to make it
+// worthwhile
+void for_each_range(size_t size, bool parallel, util::FunctionRef<void(size_t, size_t)> fn)
+{
+    constexpr size_t min_range_size = 0x1000;
+    auto& pool = util::ThreadPool::get_default();
+    size_t num_ranges = parallel ? std::min(pool.num_threads() + 1, size / min_range_size) : 1;
+    if (num_ranges < 2) {
+        fn(0, size);
+        return;
+    }
+    pool.run_parallel(num_ranges, [&](size_t range) {
+        fn(size * range / num_ranges, size * (range + 1) / num_ranges);
+    });
+}
+
+// The tables along the link chain `columns` of a sort or distinct descriptor, starting with `root_table`
+std::vector<const Table*> get_link_chain_tables(const Table& root_table, const std::vector<ExtendedColumnKey>& columns)
+{
+    if (columns.empty()) {
+        throw InvalidArgument(ErrorCodes::InvalidSortDescriptor, "Missing property");
+    }
+    if (columns.back().is_collection()) {
+        throw InvalidArgument(ErrorCodes::InvalidSortDescriptor, "Cannot sort on a collection property");
+    }
+
+    std::vector<const Table*> tables = {&root_table};
+    for (size_t j = 0; j + 1 < columns.size(); ++j) {
+        ColKey col = columns[j];
+        if (!tables[j]->valid_column(col)) {
+            throw InvalidArgument(ErrorCodes::InvalidSortDescriptor, "Invalid property");
+        }
+        if (!(col.get_type() == col_type_Link && !col.is_list())) {
+            // Only last column in link chain is allowed to be non-link
+            throw InvalidArgument(ErrorCodes::InvalidSortDescriptor, "All but last property must be a link");
+        }
+        tables.push_back(tables[j]->get_link_target(col).unchecked_ptr());
+    }
+    return tables;
+}
+
+} // namespace
+
 ConstTableRef ExtendedColumnKey::get_target_table(const Table* table) const
 {
     return (m_colkey.get_type() == col_type_Link) ? table->get_link_target(m_colkey) : ConstTableRef{};
@@ -210,7 +261,10 @@ BaseDescriptor::Sorter::Sorter(std::vector<std::vector<ExtendedColumnKey>> const
 {
     REALM_ASSERT(!column_lists.empty());
     REALM_ASSERT_EX(column_lists.size() == ascending.size(), column_lists.size(), ascending.size());
-    size_t translated_size = std::max_element(indexes.begin(), indexes.end())->index_in_view + 1;
+    m_translated_size = std::max_element(indexes.begin(), indexes.end())->index_in_view + 1;
+    // Looking up objects creates accessors and initializes leaves, which is
+    // only safe to do from several threads at once in a frozen transaction
+    m_parallel_lookup = root_table.is_frozen();
 
     m_columns.reserve(column_lists.size());
     for (size_t i = 0; i < column_lists.size(); ++i) {
@@ -218,53 +272,31 @@ BaseDescriptor::Sorter::Sorter(std::vector<std::vector<ExtendedColumnKey>> const
         auto sz = columns.size();
         REALM_ASSERT_EX(!columns.empty(), i);
 
-        if (columns.empty()) {
-            throw InvalidArgument(ErrorCodes::InvalidSortDescriptor, "Missing property");
-        }
-        if (columns.empty() || columns.back().is_collection()) {
-            throw InvalidArgument(ErrorCodes::InvalidSortDescriptor, "Cannot sort on a collection property");
-        }
-
-        if (sz == 1) { // no link chain
-            m_columns.emplace_back(&root_table, columns[0], ascending[i]);
-            continue;
-        }
-
-        std::vector<const Table*> tables = {&root_table};
-        tables.resize(sz);
-        for (size_t j = 0; j + 1 < sz; ++j) {
-            ColKey col = columns[j];
-            if (!tables[j]->valid_column(col)) {
-                throw InvalidArgument(ErrorCodes::InvalidSortDescriptor, "Invalid property");
-            }
-            if (!(col.get_type() == col_type_Link && !col.is_list())) {
-                // Only last column in link chain is allowed to be non-link
-                throw InvalidArgument(ErrorCodes::InvalidSortDescriptor, "All but last property must be a link");
-            }
-            tables[j + 1] = tables[j]->get_link_target(col).unchecked_ptr();
-        }
-
+        std::vector<const Table*> tables = get_link_chain_tables(root_table, columns);
         m_columns.emplace_back(tables.back(), columns.back(), ascending[i]);
+        if (sz == 1) // no link chain
+            continue;
 
         auto& translated_keys = m_columns.back().translated_keys;
-        translated_keys.resize(translated_size);
-
-        for (const auto& index : indexes) {
-            size_t index_in_view = index.index_in_view;
-            ObjKey translated_key = index.key_for_object;
-            for (size_t j = 0; j + 1 < sz; ++j) {
-                const Obj obj = tables[j]->get_object(translated_key);
-                // type was checked when creating the ColumnsDescriptor
-                translated_key = columns[j].get_link_target(obj);
-                if (!translated_key || translated_key.is_unresolved()) {
-                    translated_key = null_key; // normalize unresolve to null
-                    break;
+        translated_keys.resize(m_translated_size);
+
+        for_each_range(indexes.size(), m_parallel_lookup, [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) {
+                size_t index_in_view = indexes[k].index_in_view;
+                ObjKey translated_key = indexes[k].key_for_object;
+                for (size_t j = 0; j + 1 < sz; ++j) {
+                    const Obj obj = tables[j]->get_object(translated_key);
+                    // type was checked when creating the ColumnsDescriptor
+                    translated_key = columns[j].get_link_target(obj);
+                    if (!translated_key || translated_key.is_unresolved()) {
+                        translated_key = null_key; // normalize unresolve to null
+                        break;
+                    }
                 }
+                translated_keys[index_in_view] = translated_key;
             }
-            translated_keys[index_in_view] = translated_key;
-        }
+        });
     }
-    m_cache.resize(column_lists.size() - 1);
 }
 
 BaseDescriptor::Sorter DistinctDescriptor::sorter(Table const& table, const IndexPairs& indexes) const
@@ -317,23 +349,17 @@ void SortDescriptor::execute(IndexPairs& v, const Sorter& predicate, const BaseD
         limit = static_cast<const LimitDescriptor*>(next)->get_limit();
     }
     // Measurements shows that if limit is smaller than size / 16, then
-    // it is quicker to make a sorted insert into a smaller vector
+    // it is quicker to only sort the first objects, which is done with a heap
     if (limit < (v.size() >> 4)) {
-        IndexPairs buffer;
-        buffer.reserve(limit + 1);
-        for (auto& elem : v) {
-            auto it = std::lower_bound(buffer.begin(), buffer.end(), elem, std::ref(predicate));
-            buffer.insert(it, elem);
-            if (buffer.size() > limit) {
-                buffer.pop_back();
-            }
-        }
+        std::partial_sort(v.begin(), v.begin() + limit, v.end(), std::ref(predicate));
         v.m_removed_by_limit += v.size() - limit;
         v.erase(v.begin() + limit, v.end());
-        std::move(buffer.begin(), buffer.end(), v.begin());
     }
     else {
-        std::sort(v.begin(), v.end(), std::ref(predicate));
+        // All values are cached, so the comparisons can run on several threads
+        constexpr size_t min_rows_per_run = 0x4000;
+        util::parallel_sort(util::ThreadPool::get_default(), v.begin(), v.end(), std::ref(predicate),
+                            min_rows_per_run);
     }
 
     // not doing this on the last step is an optimisation
@@ -348,6 +374,236 @@ void SortDescriptor::execute(IndexPairs& v, const Sorter& predicate, const BaseD
     }
 }
 
+bool SortDescriptor::execute_using_index(const Table& table, IndexPairs& v, const BaseDescriptor* next) const
+{
+    if (m_column_keys.size() != 1 || m_column_keys[0].size() != 1 || m_column_keys[0][0].has_index())
+        return false;
+    ColKey col_key = m_column_keys[0][0];
+    if (!table.valid_column(col_key) || table.search_index_type(col_key) != IndexType::Ordered)
+        return false;
+    auto index = static_cast<const OrderedIndex*>(table.get_search_index(col_key));
+
+    size_t limit = size_t(-1);
+    if (next && next->get_type() == DescriptorType::Limit) {
+        limit = static_cast<const LimitDescriptor*>(next)->get_limit();
+    }
+
+    // Walking the index visits about limit * (table size / view size) entries, or all of them without a limit.
+    // Sorting the view needs v.size() * log2(v.size()) comparisons.
+    const size_t num_entries = index->size();
+    const size_t view_size = v.size();
+    size_t expected_steps = num_entries;
+    if (limit < view_size)
+        expected_steps = std::min(num_entries, (limit + 1) * (num_entries / std::max<size_t>(view_size, 1) + 1));
+    if (view_size < 2 || double(expected_steps) > view_size * std::log2(double(view_size)))
+        return false;
+
+    // Position in the view of each object. A view may contain the same object more than once, the index cannot
+    // produce that.
+    std::unordered_map<int64_t, size_t> view_positions;
+    view_positions.reserve(view_size);
+    for (size_t i = 0; i < view_size; ++i) {
+        if (!view_positions.emplace(v[i].key_for_object.value, i).second)
+            return false;
+    }
+
+    IndexPairs sorted;
+    sorted.reserve(std::min(limit, view_size));
+    IndexPairs run;
+    // Objects with equal values keep their order in the view, as with execute()
+    auto emit_run = [&](size_t begin, size_t end) {
+        run.clear();
+        for (size_t i = begin; i < end; ++i) {
+            auto it = view_positions.find(index->get_key(i).value);
+            if (it != view_positions.end())
+                run.push_back(v[it->second]);
+        }
+        if (run.size() > 1)
+            std::sort(run.begin(), run.end());
+        for (auto& pair : run) {
+            if (sorted.size() == limit)
+                break;
+            sorted.push_back(pair);
+        }
+    };
+
+    const bool ascending = m_ascending[0];
+    size_t ndx = 0;
+    while (ndx < num_entries && sorted.size() < limit && sorted.size() < view_size) {
+        // Find the run of entries with equal values starting (ascending) or ending (descending) at ndx
+        size_t pos = ascending ? ndx : num_entries - 1 - ndx;
+        Mixed value = index->get(pos);
+        size_t begin = pos;
+        size_t end = pos + 1;
+        if (ascending) {
+            while (end < num_entries && index->get(end).compare(value) == 0)
+                ++end;
+        }
+        else {
+            while (begin > 0 && index->get(begin - 1).compare(value) == 0)
+                --begin;
+        }
+        emit_run(begin, end);
+        ndx += end - begin;
+    }
+
+    if (sorted.size() < view_size) {
+        // All objects are in the index, so the only way to get here is by reaching the limit
+        REALM_ASSERT(sorted.size() == limit);
+        sorted.m_removed_by_limit = v.m_removed_by_limit + view_size - limit;
+    }
+    else {
+        sorted.m_removed_by_limit = v.m_removed_by_limit;
+    }
+    v = std::move(sorted);
+
+    if (next) {
+        for (size_t i = 0; i < v.size(); ++i) {
+            v[i].index_in_view = i;
+        }
+    }
+    return true;
+}
+
+std::unique_ptr<QueryStateTopK> SortDescriptor::make_top_k_state(const Table& table, size_t limit) const
+{
+    REALM_ASSERT(!m_column_keys.empty());
+    // As in execute(), picking the first objects beats sorting all of them when the limit is small compared to the
+    // number of objects
+    if (limit >= (table.size() >> 4))
+        return nullptr;
+    // Walking an ordered index of the sort column does not compare values at all
+    if (m_column_keys.size() == 1 && m_column_keys[0].size() == 1 && !m_column_keys[0][0].has_index() &&
+        table.valid_column(m_column_keys[0][0]) && table.search_index_type(m_column_keys[0][0]) == IndexType::Ordered)
+        return nullptr;
+    return std::make_unique<QueryStateTopK>(table, m_column_keys, m_ascending, limit);
+}
+
+SortValueLookup SortDescriptor::get_value_lookup(const Table& table) const
+{
+    return SortValueLookup(table, m_column_keys, m_ascending);
+}
+
+SortValueLookup::SortValueLookup(const Table& root_table, const std::vector<std::vector<ExtendedColumnKey>>& columns,
+                                 const std::vector<bool>& ascending)
+{
+    REALM_ASSERT_EX(columns.size() == ascending.size(), columns.size(), ascending.size());
+    for (size_t i = 0; i < columns.size(); ++i)
+        m_columns.push_back({get_link_chain_tables(root_table, columns[i]), columns[i], ascending[i]});
+}
+
+void SortValueLookup::load(ObjKey key, Value* values) const noexcept
+{
+    for (size_t t = 0; t < m_columns.size(); ++t) {
+        auto& col = m_columns[t];
+        ObjKey target_key = key;
+        for (size_t j = 0; j + 1 < col.columns.size(); ++j) {
+            target_key = col.columns[j].get_link_target(col.tables[j]->get_object(target_key));
+            if (!target_key || target_key.is_unresolved()) {
+                target_key = null_key;
+                break;
+            }
+        }
+        values[t].null_link = !target_key;
+        if (target_key)
+            values[t].value = col.columns.back().get_value(col.tables.back()->get_object(target_key));
+        else
+            values[t].value = Mixed();
+    }
+}
+
+// Must match BaseDescriptor::Sorter::operator()
+int SortValueLookup::compare(const Value* values_a, const Value* values_b) const noexcept
+{
+    for (size_t t = 0; t < m_columns.size(); ++t) {
+        bool null_a = values_a[t].null_link;
+        bool null_b = values_b[t].null_link;
+        if (null_a && null_b)
+            continue;
+        if (null_a || null_b) {
+            // Sort null links at the end if ascending, else at beginning.
+            return (m_columns[t].ascending != null_a) ? -1 : 1;
+        }
+        if (int c = values_a[t].value.compare(values_b[t].value))
+            return m_columns[t].ascending ? c : -c;
+    }
+    return 0;
+}
+
+QueryStateTopK::QueryStateTopK(const Table& root_table, const std::vector<std::vector<ExtendedColumnKey>>& columns,
+                               const std::vector<bool>& ascending, size_t limit)
+    : m_lookup(root_table, columns, ascending)
+    , m_top_limit(limit)
+{
+    size_t num_slots = limit + 1;
+    m_slot_keys.resize(num_slots);
+    m_slot_match_ndx.resize(num_slots);
+    m_values.resize(num_slots * m_lookup.num_columns());
+    m_heap.reserve(num_slots);
+}
+
+void QueryStateTopK::load(size_t slot, ObjKey key) noexcept
+{
+    m_slot_keys[slot] = key;
+    m_slot_match_ndx[slot] = m_match_count;
+    m_lookup.load(key, &m_values[slot * m_lookup.num_columns()]);
+}
+
+bool QueryStateTopK::less(size_t slot_a, size_t slot_b) const noexcept
+{
+    size_t num_columns = m_lookup.num_columns();
+    if (int c = m_lookup.compare(&m_values[slot_a * num_columns], &m_values[slot_b * num_columns]))
+        return c < 0;
+    return m_slot_match_ndx[slot_a] < m_slot_match_ndx[slot_b];
+}
+
+bool QueryStateTopK::match(size_t index, Mixed) noexcept
+{
+    return match(index);
+}
+
+bool QueryStateTopK::match(size_t index) noexcept
+{
+    if (m_top_limit == 0)
+        return false;
+    ObjKey key((m_key_values ? m_key_values->get(index) : index) + m_key_offset);
+    auto heap_less = [this](size_t a, size_t b) {
+        return less(a, b);
+    };
+
+    if (m_heap.size() < m_top_limit) {
+        size_t slot = m_heap.size();
+        load(slot, key);
+        m_heap.push_back(slot);
+        std::push_heap(m_heap.begin(), m_heap.end(), heap_less);
+        m_spare_slot = m_heap.size();
+    }
+    else {
+        load(m_spare_slot, key);
+        if (less(m_spare_slot, m_heap.front())) {
+            // Replace the last of the objects kept
+            std::pop_heap(m_heap.begin(), m_heap.end(), heap_less);
+            std::swap(m_heap.back(), m_spare_slot);
+            std::push_heap(m_heap.begin(), m_heap.end(), heap_less);
+        }
+    }
+    ++m_match_count;
+    return true;
+}
+
+std::vector<ObjKey> QueryStateTopK::get_keys() const
+{
+    std::vector<size_t> slots = m_heap;
+    std::sort(slots.begin(), slots.end(), [this](size_t a, size_t b) {
+        return less(a, b);
+    });
+    std::vector<ObjKey> keys;
+    keys.reserve(slots.size());
+    for (size_t slot : slots)
+        keys.push_back(m_slot_keys[slot]);
+    return keys;
+}
+
 std::string LimitDescriptor::get_description(ConstTableRef) const
 {
     return "LIMIT(" + util::serializer::print_value(m_limit) + ")";
@@ -391,13 +647,52 @@ void FilterDescriptor::execute(const Table& table, KeyValues& key_values, const
     key_values = std::move(filtered);
 }
 
+std::string RelevanceDescriptor::get_description(ConstTableRef) const
+{
+    throw SerializationError("Serialization of RelevanceDescriptor is not supported");
+    return "";
+}
+
+std::unique_ptr<BaseDescriptor> RelevanceDescriptor::clone() const
+{
+    return std::unique_ptr<BaseDescriptor>(new RelevanceDescriptor(*this));
+}
+
+void RelevanceDescriptor::execute(const Table& table, KeyValues& key_values, const BaseDescriptor*) const
+{
+    std::unordered_map<ObjKey, double> scores;
+    for (auto& [key, score] : table.rank_fulltext(m_col_key, m_terms)) // Throws
+        scores.emplace(key, score);
+
+    // Scores are never negative, so objects which do not match sort last
+    std::vector<std::pair<ObjKey, double>> ranked;
+    auto sz = key_values.size();
+    ranked.reserve(sz);
+    for (size_t i = 0; i < sz; i++) {
+        auto key = key_values.get(i);
+        auto it = scores.find(key);
+        ranked.emplace_back(key, it == scores.end() ? -1. : it->second);
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](auto& a, auto& b) {
+        return a.second > b.second;
+    });
+
+    KeyValues sorted;
+    sorted.create();
+    for (auto& [key, score] : ranked)
+        sorted.add(key);
+    key_values = std::move(sorted);
+}
+
 // This function must conform to 'is less' predicate - that is:
 // return true if i is strictly smaller than j
 bool BaseDescriptor::Sorter::operator()(IndexPair i, IndexPair j, bool total_ordering) const
 {
     // Sorting can be specified by multiple columns, so that if two entries in the first column are
-    // identical, then the rows are ordered according to the second column, and so forth. For the
-    // first column, all the payload of the View is cached in IndexPair::cached_value.
+    // identical, then the rows are ordered according to the second column, and so forth. The values
+    // of the first column are cached in IndexPair::cached_value, and those of the others in m_values.
+    const size_t num_cached_columns = m_columns.size() - 1;
+    REALM_ASSERT_DEBUG(m_values.size() == m_translated_size * num_cached_columns);
     for (size_t t = 0; t < m_columns.size(); t++) {
         ObjKey key_i = i.key_for_object;
         ObjKey key_j = j.key_for_object;
@@ -424,30 +719,9 @@ bool BaseDescriptor::Sorter::operator()(IndexPair i, IndexPair j, bool total_ord
             c = i.cached_value.compare(j.cached_value);
         }
         else {
-            if (m_cache[t - 1].empty()) {
-                m_cache[t - 1].resize(256);
-            }
-            ObjCache& cache_i = m_cache[t - 1][key_i.value & 0xFF];
-            ObjCache& cache_j = m_cache[t - 1][key_j.value & 0xFF];
-
-            if (cache_i.key != key_i) {
-                const auto& obj = m_columns[t].table->get_object(key_i);
-                const auto& col_key = m_columns[t].col_key;
-
-                cache_i.value = col_key.get_value(obj);
-                cache_i.key = key_i;
-            }
-            Mixed val_i = cache_i.value;
-
-            if (cache_j.key != key_j) {
-                const auto& obj = m_columns[t].table->get_object(key_j);
-                const auto& col_key = m_columns[t].col_key;
-
-                cache_j.value = col_key.get_value(obj);
-                cache_j.key = key_j;
-            }
-
-            c = val_i.compare(cache_j.value);
+            const Mixed& val_i = m_values[i.index_in_view * num_cached_columns + t - 1];
+            const Mixed& val_j = m_values[j.index_in_view * num_cached_columns + t - 1];
+            c = val_i.compare(val_j);
         }
         // if c is negative i comes before j
         if (c) {
@@ -458,28 +732,30 @@ bool BaseDescriptor::Sorter::operator()(IndexPair i, IndexPair j, bool total_ord
     return total_ordering ? i.index_in_view < j.index_in_view : 0;
 }
 
-void BaseDescriptor::Sorter::cache_first_column(IndexPairs& v)
+void BaseDescriptor::Sorter::cache_columns(IndexPairs& v)
 {
     if (m_columns.empty())
         return;
 
-    auto& col = m_columns[0];
-    const auto& ck = col.col_key;
-    for (size_t i = 0; i < v.size(); i++) {
-        IndexPair& index = v[i];
-        ObjKey key = index.key_for_object;
-
-        if (!col.translated_keys.empty()) {
-            key = col.translated_keys[v[i].index_in_view];
-            if (!key) {
-                index.cached_value = Mixed();
-                continue;
+    const size_t num_cached_columns = m_columns.size() - 1;
+    m_values.assign(m_translated_size * num_cached_columns, Mixed());
+    for_each_range(v.size(), m_parallel_lookup, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            IndexPair& index = v[i];
+            for (size_t t = 0; t < m_columns.size(); ++t) {
+                auto& col = m_columns[t];
+                ObjKey key = index.key_for_object;
+                if (!col.translated_keys.empty())
+                    key = col.translated_keys[index.index_in_view];
+                // Null links are sorted without looking at the value
+                Mixed value = key ? col.col_key.get_value(col.table->get_object(key)) : Mixed();
+                if (t == 0)
+                    index.cached_value = value;
+                else
+                    m_values[index.index_in_view * num_cached_columns + t - 1] = value;
             }
         }
-
-        const auto obj = col.table->get_object(key);
-        index.cached_value = ck.get_value(obj);
-    }
+    });
 }
 
 DescriptorOrdering::DescriptorOrdering(const DescriptorOrdering& other)
@@ -536,6 +812,13 @@ void DescriptorOrdering::append_filter(FilterDescriptor filter)
     }
 }
 
+void DescriptorOrdering::append_relevance(RelevanceDescriptor relevance)
+{
+    if (relevance.is_valid()) {
+        m_descriptors.emplace_back(new RelevanceDescriptor(std::move(relevance)));
+    }
+}
+
 void DescriptorOrdering::append(const DescriptorOrdering& other)
 {
     for (const auto& d : other.m_descriptors) {
@@ -567,7 +850,7 @@ bool DescriptorOrdering::will_apply_sort() const
 {
     return std::any_of(m_descriptors.begin(), m_descriptors.end(), [](const std::unique_ptr<BaseDescriptor>& desc) {
         REALM_ASSERT(desc->is_valid());
-        return desc->get_type() == DescriptorType::Sort;
+        return desc->get_type() == DescriptorType::Sort || desc->get_type() == DescriptorType::Relevance;
     });
 }
 
@@ -24,17 +24,20 @@
 #include <realm/cluster.hpp>
 #include <realm/path.hpp>
 #include <realm/mixed.hpp>
+#include <realm/query_state.hpp>
 #include <realm/util/bind_ptr.hpp>
 
 
 namespace realm {
 
 class SortDescriptor;
+class QueryStateTopK;
+class SortValueLookup;
 class ConstTableRef;
 class Group;
 class KeyValues;
 
-enum class DescriptorType { Sort, Distinct, Limit, Filter };
+enum class DescriptorType { Sort, Distinct, Limit, Filter, Relevance };
 
 struct LinkPathPart {
     // Constructor for forward links
@@ -95,7 +98,12 @@ public:
                 return !col.translated_keys.empty() && !col.translated_keys[i.index_in_view];
             });
         }
-        void cache_first_column(IndexPairs& v);
+        // Look up the values of all the sort columns for every entry of `v`
+        // once, so that comparing entries does not have to look up objects.
+        // This must be done before the entries are compared, and makes the
+        // comparisons safe to do from several threads. The values are only
+        // looked up on several threads if the table is frozen.
+        void cache_columns(IndexPairs& v);
 
     private:
         struct SortColumn {
@@ -112,12 +120,11 @@ public:
             bool ascending;
         };
         std::vector<SortColumn> m_columns;
-        struct ObjCache {
-            ObjKey key;
-            Mixed value;
-        };
-        using TableCache = std::vector<ObjCache>;
-        mutable std::vector<TableCache> m_cache;
+        // The values of the columns after the first, which is cached in
+        // IndexPair::cached_value, by index_in_view and then column
+        std::vector<Mixed> m_values;
+        size_t m_translated_size = 0;
+        bool m_parallel_lookup = false;
 
         friend class ObjList;
     };
@@ -243,12 +250,85 @@ public:
 
     void execute(IndexPairs& v, const Sorter& predicate, const BaseDescriptor* next) const override;
 
+    // Sort by walking the ordered index of the sort column instead of comparing values. This is only possible
+    // when sorting on a single column of `table` which has an ordered index, and only done when it is expected
+    // to be faster than execute(). Returns false if `v` was left untouched.
+    bool execute_using_index(const Table& table, IndexPairs& v, const BaseDescriptor* next) const;
+
+    // Make a query state which keeps only the first `limit` matches of a query on `table` in the order of this
+    // descriptor (see QueryStateTopK). Returns nullptr if sorting all the matches is expected to be faster.
+    std::unique_ptr<QueryStateTopK> make_top_k_state(const Table& table, size_t limit) const;
+
+    // Look up the values of the sort columns for single objects of `table` (see SortValueLookup).
+    SortValueLookup get_value_lookup(const Table& table) const;
+
     std::string get_description(ConstTableRef attached_table) const override;
 
 private:
     std::vector<bool> m_ascending;
 };
 
+// Looks up the values of the columns of a sort for one object at a time, following the link chain of each
+// column, and compares objects by them. Used where the objects to order are not all known up front.
+class SortValueLookup {
+public:
+    struct Value {
+        Mixed value;
+        bool null_link = false;
+    };
+
+    SortValueLookup(const Table& root_table, const std::vector<std::vector<ExtendedColumnKey>>& columns,
+                    const std::vector<bool>& ascending);
+
+    size_t num_columns() const noexcept
+    {
+        return m_columns.size();
+    }
+    // Store the values of the object `key` of the root table in `values[0]` to `values[num_columns() - 1]`
+    void load(ObjKey key, Value* values) const noexcept;
+    // Negative if the object with `values_a` sorts before the one with `values_b`, positive if it sorts after it
+    // and zero if the sort does not order them. Orders as BaseDescriptor::Sorter does.
+    int compare(const Value* values_a, const Value* values_b) const noexcept;
+
+private:
+    struct SortColumn {
+        std::vector<const Table*> tables; // Along the link chain, starting with the root table
+        std::vector<ExtendedColumnKey> columns;
+        bool ascending;
+    };
+    std::vector<SortColumn> m_columns;
+};
+
+// Query state which picks the first `limit` objects in sorted order among the matches of a query, so that a sort
+// followed by a limit needs memory for `limit` objects rather than for all the matches. The sort values of each
+// match are looked up when it is found and compared with those of the objects kept so far, which are held in a
+// bounded heap with the last of them at the top. Matches with equal values keep the order they were found in.
+class QueryStateTopK : public QueryStateBase {
+public:
+    QueryStateTopK(const Table& root_table, const std::vector<std::vector<ExtendedColumnKey>>& columns,
+                   const std::vector<bool>& ascending, size_t limit);
+
+    bool match(size_t index, Mixed) noexcept final;
+    bool match(size_t index) noexcept final;
+
+    // The keys of the objects picked, in sorted order
+    std::vector<ObjKey> get_keys() const;
+
+private:
+    SortValueLookup m_lookup;
+    size_t m_top_limit;
+    // Slot `i` holds an object with its sort values at m_values[i * m_lookup.num_columns()]. One slot more than
+    // `m_top_limit` is allocated to hold the latest match while it is compared.
+    std::vector<ObjKey> m_slot_keys;
+    std::vector<size_t> m_slot_match_ndx;
+    std::vector<SortValueLookup::Value> m_values;
+    std::vector<size_t> m_heap; // Slots in use
+    size_t m_spare_slot = 0;
+
+    void load(size_t slot, ObjKey key) noexcept;
+    bool less(size_t slot_a, size_t slot_b) const noexcept;
+};
+
 class LimitDescriptor : public BaseDescriptor {
 public:
     LimitDescriptor(size_t limit)
@@ -307,6 +387,40 @@ private:
     std::function<bool(const Obj&)> m_predicate;
 };
 
+// Orders the objects by how well the text of a column with a full-text index
+// matches a full-text search, best match first, by the score given by
+// Table::rank_fulltext(). Objects which do not match come last, in the order
+// they had before. This is a sort without a column to sort on, so it does not
+// merge with a SortDescriptor.
+class RelevanceDescriptor : public BaseDescriptor {
+public:
+    RelevanceDescriptor(ColKey col_key, std::string terms)
+        : m_col_key(col_key)
+        , m_terms(std::move(terms))
+    {
+    }
+    RelevanceDescriptor() = default;
+    ~RelevanceDescriptor() = default;
+
+    bool is_valid() const noexcept override
+    {
+        return bool(m_col_key);
+    }
+    std::string get_description(ConstTableRef attached_table) const override;
+    std::unique_ptr<BaseDescriptor> clone() const override;
+
+    DescriptorType get_type() const override
+    {
+        return DescriptorType::Relevance;
+    }
+
+    void execute(const Table&, KeyValues&, const BaseDescriptor*) const override;
+
+private:
+    ColKey m_col_key;
+    std::string m_terms;
+};
+
 class DescriptorOrdering : public util::AtomicRefCountBase {
 public:
     DescriptorOrdering() = default;
@@ -319,6 +433,7 @@ public:
     void append_distinct(DistinctDescriptor distinct);
     void append_limit(LimitDescriptor limit);
     void append_filter(FilterDescriptor predicate);
+    void append_relevance(RelevanceDescriptor relevance);
     void append(const DescriptorOrdering& other);
     void append(DescriptorOrdering&& other);
     realm::util::Optional<size_t> get_min_limit() const;
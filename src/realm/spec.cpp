@@ -265,6 +265,15 @@ void Spec::upgrade_string_to_enum(size_t column_ndx, ref_type keys_ref)
     m_enumkeys.set(column_ndx, keys_ref);
 }
 
+void Spec::downgrade_enum_to_string(size_t column_ndx)
+{
+    REALM_ASSERT(is_string_enum_type(column_ndx));
+
+    ref_type keys_ref = m_enumkeys.get_as_ref(column_ndx);
+    Array::destroy_deep(keys_ref, m_top.get_alloc());
+    m_enumkeys.set(column_ndx, 0);
+}
+
 bool Spec::is_string_enum_type(size_t column_ndx) const noexcept
 {
     return m_enumkeys.is_attached() ? (m_enumkeys.get(column_ndx) != 0) : false;
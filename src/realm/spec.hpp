@@ -67,6 +67,7 @@ public:
 
     // Auto Enumerated string columns
     void upgrade_string_to_enum(size_t column_ndx, ref_type keys_ref);
+    void downgrade_enum_to_string(size_t column_ndx);
     size_t _get_enumkeys_ndx(size_t column_ndx) const noexcept;
     bool is_string_enum_type(size_t column_ndx) const noexcept;
     ref_type get_enumkeys_ref(size_t column_ndx, ArrayParent*& keys_parent) noexcept;
@@ -29,14 +29,19 @@
 #include <realm/dictionary.hpp>
 #include <realm/exceptions.hpp>
 #include <realm/impl/destroy_guard.hpp>
+#include <realm/index_ordered.hpp>
 #include <realm/index_string.hpp>
 #include <realm/query_conditions_tpl.hpp>
 #include <realm/replication.hpp>
 #include <realm/table_view.hpp>
+#include <realm/tokenizer.hpp>
 #include <realm/util/features.h>
 #include <realm/util/serializer.hpp>
+#include <realm/zone_map.hpp>
+#include <realm/column_statistics.hpp>
 
 #include <stdexcept>
+#include <unordered_map>
 
 #ifdef REALM_DEBUG
 #include <iostream>
@@ -356,6 +361,8 @@ Table::Table(Allocator& alloc)
     , m_index_refs(m_alloc)
     , m_opposite_table(m_alloc)
     , m_opposite_column(m_alloc)
+    , m_zone_map_refs(m_alloc)
+    , m_column_statistics_refs(m_alloc)
     , m_repl(&g_dummy_replication)
     , m_own_ref(this, alloc.get_instance_version())
 {
@@ -363,6 +370,8 @@ Table::Table(Allocator& alloc)
     m_index_refs.set_parent(&m_top, top_position_for_search_indexes);
     m_opposite_table.set_parent(&m_top, top_position_for_opposite_table);
     m_opposite_column.set_parent(&m_top, top_position_for_opposite_column);
+    m_zone_map_refs.set_parent(&m_top, top_position_for_zone_maps);
+    m_column_statistics_refs.set_parent(&m_top, top_position_for_column_statistics);
 
     ref_type ref = create_empty_table(m_alloc); // Throws
     ArrayParent* parent = nullptr;
@@ -378,6 +387,8 @@ Table::Table(Replication* const* repl, Allocator& alloc)
     , m_index_refs(m_alloc)
     , m_opposite_table(m_alloc)
     , m_opposite_column(m_alloc)
+    , m_zone_map_refs(m_alloc)
+    , m_column_statistics_refs(m_alloc)
     , m_repl(repl)
     , m_own_ref(this, alloc.get_instance_version())
 {
@@ -385,6 +396,8 @@ Table::Table(Replication* const* repl, Allocator& alloc)
     m_index_refs.set_parent(&m_top, top_position_for_search_indexes);
     m_opposite_table.set_parent(&m_top, top_position_for_opposite_table);
     m_opposite_column.set_parent(&m_top, top_position_for_opposite_column);
+    m_zone_map_refs.set_parent(&m_top, top_position_for_zone_maps);
+    m_column_statistics_refs.set_parent(&m_top, top_position_for_column_statistics);
     m_cookie = cookie_created;
 }
 
@@ -567,6 +580,35 @@ TableKey Table::get_key_direct(Allocator& alloc, ref_type top_ref)
     }
 }
 
+ref_type Table::write_packed(Allocator& alloc, ref_type top_ref, _impl::ArrayWriterBase& out)
+{
+    bool only_if_modified = true;
+    if (alloc.is_read_only(top_ref))
+        return top_ref;
+
+    Array table_top(alloc);
+    table_top.init_from_ref(top_ref);
+    Spec spec(alloc);
+    spec.init(table_top.get_as_ref(top_position_for_spec));
+
+    std::vector<bool> packed_columns;
+    for (size_t spec_ndx = 0; spec_ndx < spec.get_column_count(); ++spec_ndx) {
+        ColKey col_key = spec.get_key(spec_ndx);
+        if (col_key.get_type() == col_type_Int && !col_key.is_nullable() && !col_key.is_collection()) {
+            size_t leaf_ndx = col_key.get_index().val;
+            if (packed_columns.size() <= leaf_ndx)
+                packed_columns.resize(leaf_ndx + 1);
+            packed_columns[leaf_ndx] = true;
+        }
+    }
+
+    return Array::write_deep(top_ref, alloc, out, only_if_modified, [&](size_t ndx, ref_type ref) {
+        if (ndx == top_position_for_cluster_tree)
+            return ClusterTree::write_packed(ref, alloc, out, packed_columns); // Throws
+        return Array::write(ref, alloc, out, only_if_modified);               // Throws
+    });
+}
+
 
 void Table::init(ref_type top_ref, ArrayParent* parent, size_t ndx_in_parent, bool is_writable, bool is_frzn)
 {
@@ -684,6 +726,36 @@ static void do_bulk_insert_index(Table* table, SearchIndex* index, ColKey col_ke
     using LeafType = typename ColumnTypeTraits<Type>::cluster_leaf_type;
     LeafType leaf(alloc);
 
+    // A new string or ordered index is built from all the values at once
+    // rather than by inserting them object by object
+    auto collect = [&](auto& entries) {
+        entries.reserve(table->size());
+        table->traverse_clusters([&](const Cluster* cluster) {
+            cluster->init_leaf(col_key, &leaf);
+            const ArrayUnsigned* keys = cluster->get_key_array();
+            uint64_t offset = cluster->get_offset();
+            size_t num_values = cluster->node_size();
+            for (size_t i = 0; i < num_values; ++i) {
+                ObjKey key(keys ? keys->get(i) + offset : i + offset);
+                entries.push_back({leaf.get_any(i), key});
+            }
+            return IteratorControl::AdvanceToNext;
+        });
+    };
+    auto string_index = dynamic_cast<StringIndex*>(index);
+    if (string_index && !string_index->is_fulltext_index() && string_index->is_empty()) {
+        std::vector<StringIndex::Entry> entries;
+        collect(entries);
+        string_index->build(entries); // Throws
+        return;
+    }
+    if (auto ordered_index = dynamic_cast<OrderedIndex*>(index)) {
+        std::vector<OrderedIndex::Entry> entries;
+        collect(entries);
+        ordered_index->insert_entries(entries); // Throws
+        return;
+    }
+
     auto f = [&col_key, &index, &leaf](const Cluster* cluster) {
         cluster->init_leaf(col_key, &leaf);
         index->insert_bulk(cluster->get_key_array(), cluster->get_offset(), cluster->node_size(), leaf);
@@ -759,6 +831,25 @@ void Table::populate_search_index(ColKey col_key)
     else if (type == type_Mixed) {
         do_bulk_insert_index<Mixed>(this, index, col_key, get_alloc());
     }
+    else if (type == type_Float) {
+        if (is_nullable(col_key)) {
+            do_bulk_insert_index<Optional<float>>(this, index, col_key, get_alloc());
+        }
+        else {
+            do_bulk_insert_index<float>(this, index, col_key, get_alloc());
+        }
+    }
+    else if (type == type_Double) {
+        if (is_nullable(col_key)) {
+            do_bulk_insert_index<Optional<double>>(this, index, col_key, get_alloc());
+        }
+        else {
+            do_bulk_insert_index<double>(this, index, col_key, get_alloc());
+        }
+    }
+    else if (type == type_Decimal) {
+        do_bulk_insert_index<Decimal128>(this, index, col_key, get_alloc());
+    }
     else {
         REALM_ASSERT_RELEASE(false && "Data type does not support search index");
     }
@@ -776,6 +867,38 @@ void Table::erase_from_search_indexes(ObjKey key)
     }
 }
 
+namespace {
+// The value inserted in a search index for an object created without a value for `col_key`
+Mixed default_index_value(ColKey col_key)
+{
+    bool nullable = col_key.is_nullable();
+    switch (col_key.get_type()) {
+        case col_type_Int:
+            return ArrayIntNull::default_value(nullable);
+        case col_type_Bool:
+            return ArrayBoolNull::default_value(nullable);
+        case col_type_String:
+            return ArrayString::default_value(nullable);
+        case col_type_Timestamp:
+            return ArrayTimestamp::default_value(nullable);
+        case col_type_ObjectId:
+            return ArrayObjectIdNull::default_value(nullable);
+        case col_type_Float:
+            return ArrayFloatNull::default_value(nullable);
+        case col_type_Double:
+            return ArrayDoubleNull::default_value(nullable);
+        case col_type_Decimal:
+            return ArrayDecimal128::default_value(nullable);
+        case col_type_Mixed:
+            return Mixed();
+        case col_type_UUID:
+            return ArrayUUIDNull::default_value(nullable);
+        default:
+            REALM_UNREACHABLE();
+    }
+}
+} // namespace
+
 void Table::update_indexes(ObjKey key, const FieldValues& values)
 {
     // Tombstones do not use index - will crash if we try to insert values
@@ -800,64 +923,11 @@ void Table::update_indexes(ObjKey key, const FieldValues& values)
             auto col_key = m_leaf_ndx2colkey[column_ndx];
             if (col_key.is_collection())
                 continue;
-            auto type = col_key.get_type();
-            auto attr = col_key.get_attrs();
-            bool nullable = attr.test(col_attr_Nullable);
-            switch (type) {
-                case col_type_Int:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayIntNull::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<int64_t>());
-                    }
-                    break;
-                case col_type_Bool:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayBoolNull::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<bool>());
-                    }
-                    break;
-                case col_type_String:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayString::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<String>());
-                    }
-                    break;
-                case col_type_Timestamp:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayTimestamp::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<Timestamp>());
-                    }
-                    break;
-                case col_type_ObjectId:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayObjectIdNull::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<ObjectId>());
-                    }
-                    break;
-                case col_type_Mixed:
-                    index->insert(key, init_value);
-                    break;
-                case col_type_UUID:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayUUIDNull::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<UUID>());
-                    }
-                    break;
-                default:
-                    REALM_UNREACHABLE();
-            }
+            index->insert(key, init_value.is_null() ? default_index_value(col_key) : init_value);
+        }
+        if (column_ndx < m_zone_maps.size() && m_zone_maps[column_ndx]) {
+            auto col_key = m_leaf_ndx2colkey[column_ndx];
+            m_zone_maps[column_ndx]->insert(key, init_value.is_null() ? default_index_value(col_key) : init_value);
         }
     }
 }
@@ -869,6 +939,11 @@ void Table::clear_indexes()
             index->clear();
         }
     }
+    for (auto&& zone_map : m_zone_maps) {
+        if (zone_map) {
+            zone_map->clear();
+        }
+    }
 }
 
 void Table::do_add_search_index(ColKey col_key, IndexType type)
@@ -879,9 +954,16 @@ void Table::do_add_search_index(ColKey col_key, IndexType type)
     if (m_index_accessors[column_ndx] != nullptr)
         return;
 
-    if (!StringIndex::type_supported(DataType(col_key.get_type())) ||
-        (col_key.is_collection() && !(col_key.is_list() && col_key.get_type() == col_type_String)) ||
-        (type == IndexType::Fulltext && col_key.get_type() != col_type_String)) {
+    bool supported;
+    if (type == IndexType::Ordered) {
+        supported = OrderedIndex::type_supported(DataType(col_key.get_type())) && !col_key.is_collection();
+    }
+    else {
+        supported = StringIndex::type_supported(DataType(col_key.get_type())) &&
+                    (!col_key.is_collection() || (col_key.is_list() && col_key.get_type() == col_type_String)) &&
+                    (type != IndexType::Fulltext || col_key.get_type() == col_type_String);
+    }
+    if (!supported) {
         // Not ideal, but this is what we used to throw, so keep throwing that for compatibility reasons, even though
         // it should probably be a type mismatch exception instead.
         throw IllegalOperation(util::format("Index not supported for this property: %1", get_column_name(col_key)));
@@ -893,8 +975,14 @@ void Table::do_add_search_index(ColKey col_key, IndexType type)
     REALM_ASSERT(m_index_accessors[column_ndx] == nullptr);
 
     // Create the index
-    m_index_accessors[column_ndx] =
-        std::make_unique<StringIndex>(ClusterColumn(&m_clusters, col_key, type), get_alloc()); // Throws
+    if (type == IndexType::Ordered) {
+        m_index_accessors[column_ndx] =
+            std::make_unique<OrderedIndex>(ClusterColumn(&m_clusters, col_key, type), get_alloc()); // Throws
+    }
+    else {
+        m_index_accessors[column_ndx] =
+            std::make_unique<StringIndex>(ClusterColumn(&m_clusters, col_key, type), get_alloc()); // Throws
+    }
     SearchIndex* index = m_index_accessors[column_ndx].get();
     // Insert ref to index
     index->set_parent(&m_index_refs, column_ndx);
@@ -914,6 +1002,8 @@ void Table::add_search_index(ColKey col_key, IndexType type)
 
     if (col_key == m_primary_key_col && type == IndexType::Fulltext)
         throw InvalidColumnKey("primary key cannot have a full text index");
+    if (col_key == m_primary_key_col && type == IndexType::Ordered)
+        throw InvalidColumnKey("primary key cannot have an ordered index");
 
     switch (type) {
         case IndexType::None:
@@ -925,7 +1015,7 @@ void Table::add_search_index(ColKey col_key, IndexType type)
                 REALM_ASSERT(search_index_type(col_key) == IndexType::Fulltext);
                 return;
             }
-            if (attr.test(col_attr_Indexed)) {
+            if (attr.test(col_attr_Indexed) || attr.test(col_attr_Ordered_Indexed)) {
                 this->remove_search_index(col_key);
             }
             break;
@@ -934,7 +1024,16 @@ void Table::add_search_index(ColKey col_key, IndexType type)
                 REALM_ASSERT(search_index_type(col_key) == IndexType::General);
                 return;
             }
-            if (attr.test(col_attr_FullText_Indexed)) {
+            if (attr.test(col_attr_FullText_Indexed) || attr.test(col_attr_Ordered_Indexed)) {
+                this->remove_search_index(col_key);
+            }
+            break;
+        case IndexType::Ordered:
+            if (attr.test(col_attr_Ordered_Indexed)) {
+                REALM_ASSERT(search_index_type(col_key) == IndexType::Ordered);
+                return;
+            }
+            if (attr.test(col_attr_Indexed) || attr.test(col_attr_FullText_Indexed)) {
                 this->remove_search_index(col_key);
             }
             break;
@@ -942,8 +1041,19 @@ void Table::add_search_index(ColKey col_key, IndexType type)
 
     do_add_search_index(col_key, type);
 
-    // Update spec
-    attr.set(type == IndexType::Fulltext ? col_attr_FullText_Indexed : col_attr_Indexed);
+    // Update spec, re-reading the attributes as an index of another type may have been removed above
+    attr = m_spec.get_column_attr(spec_ndx);
+    switch (type) {
+        case IndexType::Fulltext:
+            attr.set(col_attr_FullText_Indexed);
+            break;
+        case IndexType::Ordered:
+            attr.set(col_attr_Ordered_Indexed);
+            break;
+        default:
+            attr.set(col_attr_Indexed);
+            break;
+    }
     m_spec.set_column_attr(spec_ndx, attr); // Throws
 }
 
@@ -969,17 +1079,136 @@ void Table::remove_search_index(ColKey col_key)
     auto attr = m_spec.get_column_attr(spec_ndx);
     attr.reset(col_attr_Indexed);
     attr.reset(col_attr_FullText_Indexed);
+    attr.reset(col_attr_Ordered_Indexed);
     m_spec.set_column_attr(spec_ndx, attr); // Throws
 }
 
-void Table::enumerate_string_column(ColKey col_key)
+void Table::add_zone_map(ColKey col_key)
+{
+    check_column(col_key);
+    if (!ZoneMap::type_supported(get_column_type(col_key)) || col_key.is_collection())
+        throw IllegalOperation(util::format("Zone map not supported for this property: %1", get_column_name(col_key)));
+
+    // Early-out if the column has a zone map already
+    if (has_zone_map(col_key))
+        return;
+
+    if (!m_zone_map_refs.is_attached()) {
+        // This is the first zone map of the table
+        while (m_top.size() <= top_position_for_zone_maps)
+            m_top.add(0); // Throws
+        MemRef mem = Array::create_empty_array(Array::type_HasRefs, false, get_alloc()); // Throws
+        m_zone_map_refs.init_from_mem(mem);
+        m_zone_map_refs.update_parent(); // Throws
+    }
+    size_t col_ndx = col_key.get_index().val;
+    while (m_zone_map_refs.size() <= col_ndx)
+        m_zone_map_refs.add(0); // Throws
+    if (m_zone_maps.size() <= col_ndx)
+        m_zone_maps.resize(col_ndx + 1);
+
+    auto& zone_map = m_zone_maps[col_ndx];
+    zone_map = std::make_unique<ZoneMap>(get_alloc()); // Throws
+    zone_map->set_parent(&m_zone_map_refs, col_ndx);
+    m_zone_map_refs.set(col_ndx, zone_map->get_ref()); // Throws
+
+    populate_zone_map(col_key);
+}
+
+void Table::remove_zone_map(ColKey col_key)
+{
+    check_column(col_key);
+    size_t col_ndx = col_key.get_index().val;
+
+    // Early-out if the column has no zone map
+    if (col_ndx >= m_zone_maps.size() || !m_zone_maps[col_ndx])
+        return;
+
+    m_zone_maps[col_ndx]->destroy();
+    m_zone_maps[col_ndx].reset();
+    m_zone_map_refs.set(col_ndx, 0);
+}
+
+void Table::populate_zone_map(ColKey col_key)
+{
+    ZoneMap* zone_map = m_zone_maps[col_key.get_index().val].get();
+    for (auto& obj : *this) {
+        zone_map->insert(obj.get_key(), obj.get_any(col_key));
+    }
+}
+
+void Table::collect_column_statistics(ColKey col_key)
+{
+    check_column(col_key);
+    if (!ColumnStatistics::type_supported(get_column_type(col_key)) || col_key.is_collection())
+        throw IllegalOperation(
+            util::format("Column statistics not supported for this property: %1", get_column_name(col_key)));
+
+    if (!m_column_statistics_refs.is_attached()) {
+        // These are the first statistics of the table
+        while (m_top.size() <= top_position_for_column_statistics)
+            m_top.add(0); // Throws
+        MemRef mem = Array::create_empty_array(Array::type_HasRefs, false, get_alloc()); // Throws
+        m_column_statistics_refs.init_from_mem(mem);
+        m_column_statistics_refs.update_parent(); // Throws
+    }
+    size_t col_ndx = col_key.get_index().val;
+    while (m_column_statistics_refs.size() <= col_ndx)
+        m_column_statistics_refs.add(0); // Throws
+    if (m_column_statistics.size() <= col_ndx)
+        m_column_statistics.resize(col_ndx + 1);
+
+    auto stats = std::make_unique<ColumnStatistics>(ColumnStatistics::collect(*this, col_key)); // Throws
+    ref_type ref = stats->write(get_alloc());                                                   // Throws
+    if (ref_type old_ref = m_column_statistics_refs.get_as_ref(col_ndx))
+        Array::destroy_deep(old_ref, get_alloc());
+    m_column_statistics_refs.set_as_ref(col_ndx, ref); // Throws
+    m_column_statistics[col_ndx] = std::move(stats);
+}
+
+void Table::remove_column_statistics(ColKey col_key)
+{
+    check_column(col_key);
+    size_t col_ndx = col_key.get_index().val;
+
+    // Early-out if the column has no statistics
+    if (col_ndx >= m_column_statistics.size() || !m_column_statistics[col_ndx])
+        return;
+
+    Array::destroy_deep(m_column_statistics_refs.get_as_ref(col_ndx), get_alloc());
+    m_column_statistics_refs.set(col_ndx, 0);
+    m_column_statistics[col_ndx].reset();
+}
+
+size_t Table::refresh_stale_column_statistics()
+{
+    size_t sz = size();
+    size_t refreshed = 0;
+    for (size_t col_ndx = 0; col_ndx < m_column_statistics.size(); ++col_ndx) {
+        if (m_column_statistics[col_ndx] && m_column_statistics[col_ndx]->is_stale(sz)) {
+            collect_column_statistics(m_leaf_ndx2colkey[col_ndx]); // Throws
+            ++refreshed;
+        }
+    }
+    return refreshed;
+}
+
+bool Table::enumerate_string_column(ColKey col_key, size_t max_unique_values)
 {
     check_column(col_key);
     size_t column_ndx = colkey2spec_ndx(col_key);
     ColumnType type = col_key.get_type();
     if (type == col_type_String && !col_key.is_collection() && !m_spec.is_string_enum_type(column_ndx)) {
-        m_clusters.enumerate_string_column(col_key);
+        return m_clusters.enumerate_string_column(col_key, max_unique_values); // Throws
     }
+    return true;
+}
+
+void Table::unenumerate_string_column(ColKey col_key)
+{
+    check_column(col_key);
+    if (is_enumerated(col_key))
+        m_clusters.unenumerate_string_column(col_key); // Throws
 }
 
 bool Table::is_enumerated(ColKey col_key) const noexcept
@@ -1064,6 +1293,8 @@ ColKey Table::do_insert_root_column(ColKey col_key, ColumnType type, StringData
 void Table::do_erase_root_column(ColKey col_key)
 {
     size_t col_ndx = col_key.get_index().val;
+    remove_zone_map(col_key);
+    remove_column_statistics(col_key);
     // If the column had a source index we have to remove and destroy that as well
     ref_type index_ref = m_index_refs.get_as_ref(col_ndx);
     if (index_ref) {
@@ -1249,6 +1480,10 @@ void Table::fully_detach() noexcept
     m_opposite_table.detach();
     m_opposite_column.detach();
     m_index_accessors.clear();
+    m_zone_map_refs.detach();
+    m_zone_maps.clear();
+    m_column_statistics_refs.detach();
+    m_column_statistics.clear();
 }
 
 
@@ -1272,8 +1507,11 @@ IndexType Table::search_index_type(ColKey col_key) const noexcept
 {
     if (m_index_accessors[col_key.get_index().val].get()) {
         auto attr = m_spec.get_column_attr(m_leaf_ndx2spec_ndx[col_key.get_index().val]);
-        bool fulltext = attr.test(col_attr_FullText_Indexed);
-        return fulltext ? IndexType::Fulltext : IndexType::General;
+        if (attr.test(col_attr_FullText_Indexed))
+            return IndexType::Fulltext;
+        if (attr.test(col_attr_Ordered_Indexed))
+            return IndexType::Ordered;
+        return IndexType::General;
     }
     return IndexType::None;
 }
@@ -1645,6 +1883,10 @@ void Table::aggregate(QueryStateBase& st, ColKey column_key) const
         cluster->init_leaf(column_key, &leaf);
         st.m_key_offset = cluster->get_offset();
         st.m_key_values = cluster->get_key_array();
+        if constexpr (std::is_same_v<T, int64_t>) {
+            if (st.limit() == size_t(-1) && st.match_leaf(leaf))
+                return IteratorControl::AdvanceToNext;
+        }
         st.set_payload_column(&leaf);
         bool cont = true;
         size_t sz = leaf.size();
@@ -1917,6 +2159,32 @@ TableView Table::find_all_fulltext(ColKey col_key, StringData terms) const
     return where().fulltext(col_key, terms).find_all();
 }
 
+std::vector<std::pair<ObjKey, double>> Table::rank_fulltext(ColKey col_key, StringData terms) const
+{
+    StringIndex* index = get_string_index(col_key);
+    if (!(index && index->is_fulltext_index())) {
+        throw IllegalOperation{"Column has no fulltext index"};
+    }
+
+    constexpr size_t max_samples = 1000;
+    size_t sz = size();
+    size_t step = std::max<size_t>(sz / max_samples, 1);
+    size_t num_samples = 0;
+    size_t num_words = 0;
+    auto tokenizer = Tokenizer::get_instance();
+    for (size_t i = 0; i < sz; i += step) {
+        StringData text = get_object(i).get<String>(col_key);
+        tokenizer->reset(std::string_view(text.data(), text.size()));
+        while (tokenizer->next())
+            ++num_words;
+        ++num_samples;
+    }
+
+    std::vector<std::pair<ObjKey, double>> result;
+    index->rank_fulltext(result, terms, sz, num_samples ? double(num_words) / num_samples : 0.);
+    return result;
+}
+
 TableView Table::get_sorted_view(ColKey col_key, bool ascending)
 {
     TableView tv = where().find_all();
@@ -1962,6 +2230,19 @@ void Table::update_from_parent() noexcept
             }
         }
 
+        if (m_zone_map_refs.is_attached()) {
+            m_zone_map_refs.update_from_parent();
+            for (auto&& zone_map : m_zone_maps) {
+                if (zone_map != nullptr) {
+                    zone_map->update_from_parent();
+                }
+            }
+        }
+
+        if (m_column_statistics_refs.is_attached()) {
+            m_column_statistics_refs.update_from_parent();
+        }
+
         m_opposite_table.update_from_parent();
         m_opposite_column.update_from_parent();
         if (m_top.size() > top_position_for_flags) {
@@ -2161,18 +2442,79 @@ void Table::refresh_index_accessors()
         else {
             auto attr = m_spec.get_column_attr(m_leaf_ndx2spec_ndx[col_ndx]);
             bool fulltext = attr.test(col_attr_FullText_Indexed);
+            bool ordered = attr.test(col_attr_Ordered_Indexed);
             auto col_key = m_leaf_ndx2colkey[col_ndx];
-            ClusterColumn virtual_col(&m_clusters, col_key, fulltext ? IndexType::Fulltext : IndexType::General);
+            ClusterColumn virtual_col(&m_clusters, col_key,
+                                      fulltext ? IndexType::Fulltext
+                                               : (ordered ? IndexType::Ordered : IndexType::General));
 
-            if (m_index_accessors[col_ndx]) { // still there, refresh:
+            if (m_index_accessors[col_ndx] && ordered == bool(dynamic_cast<OrderedIndex*>(
+                                                                m_index_accessors[col_ndx].get()))) {
+                // still there, refresh:
                 m_index_accessors[col_ndx]->refresh_accessor_tree(virtual_col);
             }
-            else { // new index!
+            else if (ordered) { // new index!
+                m_index_accessors[col_ndx] =
+                    std::make_unique<OrderedIndex>(ref, &m_index_refs, col_ndx, virtual_col, get_alloc());
+            }
+            else {
                 m_index_accessors[col_ndx] =
                     std::make_unique<StringIndex>(ref, &m_index_refs, col_ndx, virtual_col, get_alloc());
             }
         }
     }
+
+    refresh_zone_maps();
+    refresh_column_statistics();
+}
+
+void Table::refresh_zone_maps()
+{
+    if (m_top.size() <= top_position_for_zone_maps || m_top.get_as_ref(top_position_for_zone_maps) == 0) {
+        m_zone_map_refs.detach();
+        m_zone_maps.clear();
+        return;
+    }
+
+    m_zone_map_refs.init_from_parent();
+    size_t col_ndx_end = std::min(m_leaf_ndx2colkey.size(), m_zone_map_refs.size());
+    m_zone_maps.resize(col_ndx_end);
+    for (size_t col_ndx = 0; col_ndx < col_ndx_end; col_ndx++) {
+        ref_type ref = m_zone_map_refs.get_as_ref(col_ndx);
+        if (ref == 0) {
+            m_zone_maps[col_ndx].reset();
+        }
+        else if (m_zone_maps[col_ndx]) {
+            m_zone_maps[col_ndx]->refresh_accessor_tree();
+        }
+        else {
+            m_zone_maps[col_ndx] = std::make_unique<ZoneMap>(ref, &m_zone_map_refs, col_ndx, get_alloc());
+        }
+    }
+}
+
+void Table::refresh_column_statistics()
+{
+    if (m_top.size() <= top_position_for_column_statistics ||
+        m_top.get_as_ref(top_position_for_column_statistics) == 0) {
+        m_column_statistics_refs.detach();
+        m_column_statistics.clear();
+        return;
+    }
+
+    m_column_statistics_refs.init_from_parent();
+    size_t col_ndx_end = std::min(m_leaf_ndx2colkey.size(), m_column_statistics_refs.size());
+    m_column_statistics.resize(col_ndx_end);
+    for (size_t col_ndx = 0; col_ndx < col_ndx_end; col_ndx++) {
+        ref_type ref = m_column_statistics_refs.get_as_ref(col_ndx);
+        if (ref == 0) {
+            m_column_statistics[col_ndx].reset();
+        }
+        else {
+            m_column_statistics[col_ndx] =
+                std::make_unique<ColumnStatistics>(ColumnStatistics::read(ref, get_alloc())); // Throws
+        }
+    }
 }
 
 bool Table::is_cross_table_link_target() const noexcept
@@ -2198,6 +2540,10 @@ void Table::verify() const
     m_clusters.verify();
     if (nb_unresolved())
         m_tombstones->verify();
+    for (auto&& zone_map : m_zone_maps) {
+        if (zone_map)
+            zone_map->verify();
+    }
 #endif
 }
 
@@ -2286,14 +2632,8 @@ Obj Table::create_object(GlobalKey object_id, const FieldValues& values)
     }
 }
 
-Obj Table::create_object_with_primary_key(const Mixed& primary_key, FieldValues&& field_values, UpdateMode mode,
-                                          bool* did_create)
+void Table::check_primary_key(ColKey primary_key_col, const Mixed& primary_key) const
 {
-    auto primary_key_col = get_primary_key_column();
-    if (is_embedded() || !primary_key_col)
-        throw InvalidArgument(ErrorCodes::UnexpectedPrimaryKey,
-                              util::format("Table has no primary key: %1", get_name()));
-
     DataType type = DataType(primary_key_col.get_type());
 
     if (primary_key.is_null() && !primary_key_col.is_nullable()) {
@@ -2309,6 +2649,17 @@ Obj Table::create_object_with_primary_key(const Mixed& primary_key, FieldValues&
     }
 
     REALM_ASSERT(type == type_String || type == type_ObjectId || type == type_Int || type == type_UUID);
+}
+
+Obj Table::create_object_with_primary_key(const Mixed& primary_key, FieldValues&& field_values, UpdateMode mode,
+                                          bool* did_create)
+{
+    auto primary_key_col = get_primary_key_column();
+    if (is_embedded() || !primary_key_col)
+        throw InvalidArgument(ErrorCodes::UnexpectedPrimaryKey,
+                              util::format("Table has no primary key: %1", get_name()));
+
+    check_primary_key(primary_key_col, primary_key);
 
     if (did_create)
         *did_create = false;
@@ -2704,6 +3055,190 @@ void Table::create_objects(const std::vector<ObjKey>& keys)
     }
 }
 
+std::vector<ObjKey> Table::create_objects(const std::vector<ColumnValues>& columns,
+                                          util::Span<const Mixed> primary_keys, UpdateMode mode)
+{
+    if (is_embedded())
+        throw IllegalOperation(util::format("Explicit creation of embedded object not allowed in: %1", get_name()));
+    auto primary_key_col = get_primary_key_column();
+    if (!primary_key_col && !primary_keys.empty())
+        throw InvalidArgument(ErrorCodes::UnexpectedPrimaryKey,
+                              util::format("Table has no primary key: %1", get_name()));
+
+    size_t num_objects = primary_key_col ? primary_keys.size() : columns.empty() ? 0 : columns[0].values.size();
+    ClusterRows rows;
+    rows.values.resize(m_leaf_ndx2colkey.size());
+    if (primary_key_col) {
+        for (auto& primary_key : primary_keys)
+            check_primary_key(primary_key_col, primary_key);
+        rows.values[primary_key_col.get_index().val] = primary_keys.data();
+        rows.col_keys.push_back(primary_key_col);
+    }
+    for (auto& column : columns) {
+        ColKey col_key = column.col_key;
+        check_column(col_key);
+        if (col_key == primary_key_col || col_key.is_collection() || col_key.get_type() == col_type_BackLink)
+            throw InvalidArgument(util::format("Cannot create objects with values of '%1'", get_column_name(col_key)));
+        if (column.values.size() != num_objects)
+            throw InvalidArgument(util::format("Expected %1 values of '%2', got %3", num_objects,
+                                               get_column_name(col_key), column.values.size()));
+        auto& values = rows.values[col_key.get_index().val];
+        if (values)
+            throw InvalidArgument(util::format("Values of '%1' given twice", get_column_name(col_key)));
+        if (col_key.get_type() != col_type_Mixed) {
+            auto type = DataType(col_key.get_type());
+            bool nullable = col_key.is_nullable();
+            for (auto& value : column.values) {
+                if (value.is_null()) {
+                    // As with Obj::set()
+                    if (!nullable)
+                        throw NotNullable(get_class_name(), get_column_name(col_key));
+                }
+                else if (value.get_type() != type) {
+                    throw InvalidArgument(ErrorCodes::TypeMismatch,
+                                          util::format("Wrong type of value for '%1'", get_column_name(col_key)));
+                }
+            }
+        }
+        values = column.values.data();
+        rows.col_keys.push_back(col_key);
+    }
+    std::sort(rows.col_keys.begin(), rows.col_keys.end(), [](ColKey a, ColKey b) {
+        return a.get_index().val < b.get_index().val;
+    });
+
+    std::vector<ObjKey> keys(num_objects);
+    // The objects to update instead, and the objects which create them. New objects are
+    // looked up by primary key in `new_objects` as they are not in the search index yet.
+    // All the primary keys are checked before anything is replicated or inserted, so
+    // that an ObjectAlreadyExists leaves the table and the history untouched.
+    std::vector<std::pair<size_t, size_t>> updates;
+    std::vector<size_t> resurrected;
+    if (primary_key_col) {
+        std::unordered_map<Mixed, size_t> new_objects;
+        auto& index = *m_index_accessors[primary_key_col.get_index().val];
+        for (size_t i = 0; i < num_objects; ++i) {
+            const Mixed& primary_key = primary_keys[i];
+            if (ObjKey existing = index.find_first(primary_key)) {
+                if (mode == UpdateMode::never)
+                    throw ObjectAlreadyExists(get_class_name(), primary_key);
+                keys[i] = existing;
+                updates.emplace_back(i, i);
+                continue;
+            }
+            if (auto [it, inserted] = new_objects.emplace(primary_key, i); !inserted) {
+                if (mode == UpdateMode::never)
+                    throw ObjectAlreadyExists(get_class_name(), primary_key);
+                updates.emplace_back(it->second, i);
+                continue;
+            }
+            if (m_tombstones) {
+                GlobalKey object_id{primary_key};
+                ObjKey unres_key = global_to_local_object_id_hashed(object_id).get_unresolved();
+                if (auto tombstone = m_tombstones->try_get_obj(unres_key);
+                    tombstone && tombstone.get_any(primary_key_col) == primary_key) {
+                    resurrected.push_back(i);
+                    continue;
+                }
+            }
+            rows.rows.push_back(i);
+        }
+    }
+
+    auto repl = get_repl();
+    // Objects resurrected from a tombstone get the links to it, so they are created one at a time
+    for (size_t i : resurrected) {
+        FieldValues field_values;
+        for (auto col_key : rows.col_keys) {
+            Mixed value = rows.values[col_key.get_index().val][i];
+            if (col_key != primary_key_col && !value.is_null())
+                field_values.insert(col_key, value);
+        }
+        keys[i] = create_object_with_primary_key(primary_keys[i], std::move(field_values)).get_key();
+    }
+    if (primary_key_col) {
+        for (size_t i : rows.rows) {
+            keys[i] = get_next_valid_key();
+            rows.keys.push_back(keys[i]);
+            if (repl)
+                repl->create_object_with_primary_key(this, keys[i], primary_keys[i]);
+        }
+    }
+    else {
+        for (size_t i = 0; i < num_objects; ++i) {
+            GlobalKey object_id = allocate_object_id_squeezed();
+            ObjKey key = object_id.get_local_key(get_sync_file_id());
+            // Check if this key collides with an already existing object, as in create_object()
+            while (m_clusters.is_valid(key)) {
+                object_id = allocate_object_id_squeezed();
+                key = object_id.get_local_key(get_sync_file_id());
+            }
+            if (repl)
+                repl->create_object(this, object_id);
+            keys[i] = key;
+            rows.keys.push_back(key);
+            rows.rows.push_back(i);
+        }
+    }
+
+    // Keys are allocated in ascending order, so this is usually sorted already
+    if (!std::is_sorted(rows.keys.begin(), rows.keys.end())) {
+        std::sort(rows.rows.begin(), rows.rows.end(), [&](size_t a, size_t b) {
+            return keys[a] < keys[b];
+        });
+        for (size_t i = 0; i < rows.rows.size(); ++i)
+            rows.keys[i] = keys[rows.rows[i]];
+    }
+    m_clusters.insert_rows(rows);
+
+    for (size_t col_ndx = 0; col_ndx < m_index_accessors.size(); ++col_ndx) {
+        if (auto&& index = m_index_accessors[col_ndx]) {
+            auto col_key = m_leaf_ndx2colkey[col_ndx];
+            if (col_key.is_collection())
+                continue;
+            Mixed default_value = default_index_value(col_key);
+            for (size_t i = 0; i < rows.keys.size(); ++i) {
+                Mixed value = rows.get(col_ndx, i);
+                index->insert(rows.keys[i], value.is_null() ? default_value : value);
+            }
+        }
+    }
+    for (size_t col_ndx = 0; col_ndx < m_zone_maps.size(); ++col_ndx) {
+        if (auto&& zone_map = m_zone_maps[col_ndx]) {
+            Mixed default_value = default_index_value(m_leaf_ndx2colkey[col_ndx]);
+            for (size_t i = 0; i < rows.keys.size(); ++i) {
+                Mixed value = rows.get(col_ndx, i);
+                zone_map->insert(rows.keys[i], value.is_null() ? default_value : value);
+            }
+        }
+    }
+
+    if (repl) {
+        for (size_t i = 0; i < rows.keys.size(); ++i) {
+            for (auto col_key : rows.col_keys) {
+                Mixed value = rows.get(col_key.get_index().val, i);
+                if (col_key != primary_key_col && !value.is_null())
+                    repl->set(this, col_key, rows.keys[i], value, _impl::instr_Set);
+            }
+        }
+        if (is_asymmetric() && repl->get_history_type() == Replication::HistoryType::hist_SyncClient) {
+            get_parent_group()->m_tables_to_clear.insert(this->m_key);
+        }
+    }
+
+    for (auto [target, i] : updates) {
+        auto obj = m_clusters.get(keys[target]);
+        keys[i] = obj.get_key();
+        for (auto& column : columns) {
+            const Mixed& value = column.values[i];
+            if (mode == UpdateMode::all || obj.get_any(column.col_key) != value)
+                obj.set_any(column.col_key, value);
+        }
+    }
+
+    return keys;
+}
+
 void Table::dump_objects()
 {
     m_clusters.dump_objects();
@@ -2930,6 +3465,9 @@ void Table::do_set_primary_key_column(ColKey col_key)
         if (attr.test(col_attr_FullText_Indexed)) {
             throw InvalidColumnKey("primary key cannot have a full text index");
         }
+        if (attr.test(col_attr_Ordered_Indexed)) {
+            throw InvalidColumnKey("primary key cannot have an ordered index");
+        }
     }
 
     if (m_primary_key_col) {
@@ -3227,6 +3765,8 @@ ColKey Table::set_nullability(ColKey col_key, bool nullable, bool throw_on_null)
     check_column(col_key);
 
     auto index_type = search_index_type(col_key);
+    bool had_zone_map = has_zone_map(col_key);
+    bool had_column_statistics = get_column_statistics(col_key) != nullptr;
     std::string column_name(get_column_name(col_key));
     auto type = col_key.get_type();
     auto attr = col_key.get_attrs();
@@ -3262,6 +3802,10 @@ ColKey Table::set_nullability(ColKey col_key, bool nullable, bool throw_on_null)
 
     if (index_type != IndexType::None)
         do_add_search_index(new_col, index_type);
+    if (had_zone_map)
+        add_zone_map(new_col);
+    if (had_column_statistics)
+        collect_column_statistics(new_col);
 
     return new_col;
 }
@@ -62,6 +62,8 @@ class Subexpr;
 template <class>
 class SubQuery;
 class TableView;
+class ZoneMap;
+class ColumnStatistics;
 
 struct Link {};
 typedef Link BackLink;
@@ -77,6 +79,7 @@ namespace query_parser {
 class Arguments;
 class KeyPathMapping;
 class ParserDriver;
+class PreparedQuery;
 } // namespace query_parser
 
 enum class ExpressionComparisonType : unsigned char {
@@ -248,12 +251,65 @@ public:
     }
     void remove_search_index(ColKey col_key);
 
-    void enumerate_string_column(ColKey col_key);
+    /// Store the strings of the column as indexes into a list of the unique
+    /// values in the column. If the column holds more than
+    /// `max_unique_values` different strings, it is left unchanged and false
+    /// is returned.
+    bool enumerate_string_column(ColKey col_key, size_t max_unique_values = realm::npos);
+    /// Store the strings of an enumerated column directly in the leaves again.
+    /// Does nothing if the column is not enumerated.
+    void unenumerate_string_column(ColKey col_key);
     bool is_enumerated(ColKey col_key) const noexcept;
     bool contains_unique_values(ColKey col_key) const;
 
     //@}
 
+    /// A zone map keeps the smallest and largest value, and whether there
+    /// are nulls, for each block of consecutive object keys (see ZoneMap).
+    /// Queries with range and equality conditions on the column use it to
+    /// skip the clusters none of whose values can match, which pays off when
+    /// the values correlate with the order in which the objects are created,
+    /// such as timestamps. Only Int, Timestamp, Float and Double columns
+    /// which are not collections can have a zone map. Adding a zone map to a
+    /// column which has one has no effect. Zone maps are not replicated.
+    void add_zone_map(ColKey col_key);
+    void remove_zone_map(ColKey col_key);
+    bool has_zone_map(ColKey col_key) const noexcept
+    {
+        return get_zone_map(col_key) != nullptr;
+    }
+    // Will return nullptr if the column has no zone map
+    ZoneMap* get_zone_map(ColKey col_key) const noexcept
+    {
+        auto col_ndx = col_key.get_index().val;
+        return col_ndx < m_zone_maps.size() ? m_zone_maps[col_ndx].get() : nullptr;
+    }
+
+    /// Column statistics describe the values of a column from a sample of
+    /// its objects (see ColumnStatistics). Queries use them to estimate how
+    /// many objects match each condition before they start, in order to
+    /// decide between looking up the matches in a search index and scanning,
+    /// to choose the order in which ANDed conditions are evaluated, and to
+    /// decide whether to evaluate a condition across a link from the linked
+    /// objects backwards. Collecting the statistics of a column which has
+    /// them samples it again. They are stored in the file, but not
+    /// replicated. A commit samples the columns of the tables it modified
+    /// again when the number of objects has changed by more than a quarter
+    /// since they were sampled. Only columns which are not collections, of
+    /// the types accepted by ColumnStatistics::type_supported(), can have
+    /// statistics.
+    void collect_column_statistics(ColKey col_key);
+    void remove_column_statistics(ColKey col_key);
+    // Will return nullptr if no statistics have been collected for the column
+    const ColumnStatistics* get_column_statistics(ColKey col_key) const noexcept
+    {
+        auto col_ndx = col_key.get_index().val;
+        return col_ndx < m_column_statistics.size() ? m_column_statistics[col_ndx].get() : nullptr;
+    }
+    /// Sample the columns whose statistics are stale again. Returns the
+    /// number of columns sampled.
+    size_t refresh_stale_column_statistics();
+
     /// If the specified column is optimized to store only unique values, then
     /// this function returns the number of unique values currently
     /// stored. Otherwise it returns zero. This function is mainly intended for
@@ -323,6 +379,24 @@ public:
     void create_objects(size_t number, std::vector<ObjKey>& keys);
     /// Create a number of objects with keys supplied
     void create_objects(const std::vector<ObjKey>& keys);
+    /// Create a number of objects at once from the values of each column.
+    /// Each of `columns` holds the values of one column for all the objects,
+    /// and columns not given get their default values, as with
+    /// create_object(). For tables with a primary key, `primary_keys` holds
+    /// the primary key of each object, and objects which exist already are
+    /// updated according to `mode`, as with create_object_with_primary_key().
+    /// All of them must have the same size. As with Obj::set(), NotNullable
+    /// is thrown for a null value of a column which is not nullable. Return
+    /// the keys of the objects in the order of the values. Invalid values, and
+    /// with UpdateMode::never an existing or repeated primary key, are
+    /// detected before anything changes.
+    ///
+    /// This is much faster than creating the objects one at a time, as the
+    /// values are written to the clusters and added to the search indexes one
+    /// column at a time. Collection columns cannot be given.
+    std::vector<ObjKey> create_objects(const std::vector<ColumnValues>& columns,
+                                       util::Span<const Mixed> primary_keys = {},
+                                       UpdateMode mode = UpdateMode::all);
     /// Does the key refer to an object within the table?
     bool is_valid(ObjKey key) const noexcept
     {
@@ -421,6 +495,10 @@ public:
     // Get the key of this table directly, without needing a Table accessor.
     static TableKey get_key_direct(Allocator& alloc, ref_type top_ref);
 
+    // Write the table at `top_ref` like Array::write() does, but write the leaves of non-nullable integer columns
+    // with Array::write_packed(). Like get_key_direct(), this works without a Table accessor.
+    static ref_type write_packed(Allocator& alloc, ref_type top_ref, _impl::ArrayWriterBase& out);
+
     // Aggregate functions
     size_t count_int(ColKey col_key, int64_t value) const;
     size_t count_string(ColKey col_key, StringData value) const;
@@ -472,6 +550,13 @@ public:
     TableView find_all_null(ColKey col_key) const;
 
     TableView find_all_fulltext(ColKey col_key, StringData value) const;
+    /// Keys of the objects matching the full-text search `value` with their
+    /// BM25 score, best match first. Words which occur more often in the
+    /// text of an object and in fewer objects overall give a higher score,
+    /// and long texts are scored lower. The average length of the texts is
+    /// estimated from a sample of at most 1000 objects. To order a TableView
+    /// by this score, sort it with a RelevanceDescriptor.
+    std::vector<std::pair<ObjKey, double>> rank_fulltext(ColKey col_key, StringData value) const;
 
     TableView get_sorted_view(ColKey col_key, bool ascending = true);
     TableView get_sorted_view(ColKey col_key, bool ascending = true) const;
@@ -604,6 +689,10 @@ public:
                 const query_parser::KeyPathMapping& mapping) const;
     Query query(const std::string& query_string, query_parser::Arguments& arguments,
                 const query_parser::KeyPathMapping&) const;
+    /// Parse a query string once, to run it many times with different arguments (see query_parser::PreparedQuery)
+    query_parser::PreparedQuery prepare_query(const std::string& query_string) const;
+    query_parser::PreparedQuery prepare_query(const std::string& query_string,
+                                              const query_parser::KeyPathMapping& mapping) const;
 
     //@{
     /// WARNING: The link() and backlink() methods will alter a state on the Table object and return a reference
@@ -732,6 +821,10 @@ private:
     Array m_opposite_table;                    // 7th slot in m_top
     Array m_opposite_column;                   // 8th slot in m_top
     std::vector<std::unique_ptr<SearchIndex>> m_index_accessors;
+    Array m_zone_map_refs; // 15th slot in m_top
+    std::vector<std::unique_ptr<ZoneMap>> m_zone_maps;
+    Array m_column_statistics_refs; // 16th slot in m_top
+    std::vector<std::unique_ptr<ColumnStatistics>> m_column_statistics;
     ColKey m_primary_key_col;
     Replication* const* m_repl;
     static Replication* g_dummy_replication;
@@ -746,6 +839,9 @@ private:
     void erase_from_search_indexes(ObjKey key);
     void update_indexes(ObjKey key, const FieldValues& values);
     void clear_indexes();
+    void populate_zone_map(ColKey col_key);
+    void refresh_zone_maps();
+    void refresh_column_statistics();
     template <typename T>
     void do_populate_index(StringIndex* index, ColKey::Idx col_ndx);
 
@@ -791,6 +887,7 @@ private:
     void validate_column_is_unique(ColKey col_key) const;
 
     ObjKey get_next_valid_key();
+    void check_primary_key(ColKey primary_key_col, const Mixed& primary_key) const;
     /// Some Object IDs are generated as a tuple of the client_file_ident and a
     /// local sequence number. This function takes the next number in the
     /// sequence for the given table and returns an appropriate globally unique
@@ -875,6 +972,10 @@ private:
     // flags contents: bit 0-1 - table type
     static constexpr int top_position_for_tombstones = 13;
     static constexpr int top_array_size = 14;
+    // Only present if a zone map has been added to the table
+    static constexpr int top_position_for_zone_maps = 14;
+    // Only present if column statistics have been collected for the table
+    static constexpr int top_position_for_column_statistics = 15;
 
     enum { s_collision_map_lo = 0, s_collision_map_hi = 1, s_collision_map_local_id = 2, s_collision_map_num_slots };
 
@@ -345,6 +345,19 @@ void TableView::update_query(const Query& q)
     do_sync();
 }
 
+void TableView::assign_query_results(const DescriptorOrdering& ordering, const std::vector<ObjKey>& keys)
+{
+    REALM_ASSERT(m_query);
+    util::CriticalSection cs(m_race_detector);
+    m_descriptor_ordering = ordering;
+    m_descriptor_ordering.collect_dependencies(m_table.unchecked_ptr());
+    m_key_values.clear();
+    for (auto key : keys)
+        m_key_values.add(key);
+    m_last_seen_versions.clear();
+    get_dependencies(m_last_seen_versions);
+}
+
 void TableView::clear()
 {
     m_table.check();
@@ -424,6 +437,12 @@ void TableView::sort(SortDescriptor order)
     apply_descriptors(m_descriptor_ordering);
 }
 
+void TableView::sort(RelevanceDescriptor order)
+{
+    m_descriptor_ordering.append_relevance(std::move(order));
+    apply_descriptors(m_descriptor_ordering);
+}
+
 
 void TableView::do_sync()
 {
@@ -435,6 +454,7 @@ void TableView::do_sync()
     // - Table::get_backlink_view()
     // Here we sync with the respective source.
     m_last_seen_versions.clear();
+    size_t first_descriptor = 0;
 
     if (m_collection_source) {
         m_key_values.clear();
@@ -478,16 +498,34 @@ void TableView::do_sync()
                     limit = l;
             }
         }
-        QueryStateFindAll<std::vector<ObjKey>> st(m_key_values, limit);
-        m_query->do_find_all(st);
+
+        // A sort followed by a limit can be applied while the query runs, keeping only the first objects
+        std::unique_ptr<QueryStateTopK> top_k;
+        if (limit == size_t(-1) && m_descriptor_ordering.size() >= 2 &&
+            m_descriptor_ordering.get_type(0) == DescriptorType::Sort &&
+            m_descriptor_ordering.get_type(1) == DescriptorType::Limit) {
+            auto sort = static_cast<const SortDescriptor*>(m_descriptor_ordering[0]);
+            auto limit_descriptor = static_cast<const LimitDescriptor*>(m_descriptor_ordering[1]);
+            top_k = sort->make_top_k_state(*m_table, limit_descriptor->get_limit());
+        }
+        if (top_k) {
+            m_query->do_find_all(*top_k);
+            for (auto key : top_k->get_keys())
+                m_key_values.add(key);
+            first_descriptor = 2;
+        }
+        else {
+            QueryStateFindAll<std::vector<ObjKey>> st(m_key_values, limit);
+            m_query->do_find_all(st);
+        }
     }
 
-    apply_descriptors(m_descriptor_ordering);
+    apply_descriptors(m_descriptor_ordering, first_descriptor);
 
     get_dependencies(m_last_seen_versions);
 }
 
-void TableView::apply_descriptors(const DescriptorOrdering& ordering)
+void TableView::apply_descriptors(const DescriptorOrdering& ordering, size_t first_descriptor)
 {
     if (ordering.is_empty())
         return;
@@ -529,7 +567,7 @@ void TableView::apply_descriptors(const DescriptorOrdering& ordering)
     };
 
     const int num_descriptors = int(ordering.size());
-    for (int desc_ndx = 0; desc_ndx < num_descriptors; ++desc_ndx) {
+    for (int desc_ndx = int(first_descriptor); desc_ndx < num_descriptors; ++desc_ndx) {
         const BaseDescriptor* base_descr = ordering[desc_ndx];
         const BaseDescriptor* next = ((desc_ndx + 1) < num_descriptors) ? ordering[desc_ndx + 1] : nullptr;
 
@@ -540,12 +578,17 @@ void TableView::apply_descriptors(const DescriptorOrdering& ordering)
                 use_indexpairs();
             }
 
+            if (base_descr->get_type() == DescriptorType::Sort &&
+                static_cast<const SortDescriptor*>(base_descr)->execute_using_index(*m_table, index_pairs, next)) {
+                continue;
+            }
+
             BaseDescriptor::Sorter predicate = base_descr->sorter(*m_table, index_pairs);
 
             // Sorting can be specified by multiple columns, so that if two entries in the first column are
-            // identical, then the rows are ordered according to the second column, and so forth. For the
-            // first column, we cache all the payload of fields of the view in a std::vector<Mixed>
-            predicate.cache_first_column(index_pairs);
+            // identical, then the rows are ordered according to the second column, and so forth. The values
+            // of all the columns are looked up once up front rather than on every comparison
+            predicate.cache_columns(index_pairs);
 
             base_descr->execute(index_pairs, predicate, next);
         }
@@ -254,6 +254,11 @@ public:
 
     void clear();
 
+    // Set the objects of a view backed by a query to `keys`, which must be what applying `ordering` to the
+    // results of the query gives at the current version. For callers which keep such results up to date from the
+    // changes made to the table, and can thereby avoid running the query again.
+    void assign_query_results(const DescriptorOrdering& ordering, const std::vector<ObjKey>& keys);
+
     // Change the TableView to be backed by another query
     // only works if the TableView is already backed by a query, and both
     // queries points to the same Table
@@ -361,6 +366,9 @@ public:
     // Sort m_key_values according to multiple columns
     void sort(SortDescriptor order);
 
+    // Sort m_key_values by relevance to a full-text search, best match first
+    void sort(RelevanceDescriptor order);
+
     // Remove rows that are duplicated with respect to the column set passed as argument.
     // distinct() will preserve the original order of the row pointers, also if the order is a result of sort()
     // If two rows are identical (for the given set of distinct-columns), then the last row is removed.
@@ -400,7 +408,8 @@ protected:
     void get_dependencies(TableVersions&) const final;
 
     void do_sync();
-    void apply_descriptors(const DescriptorOrdering&);
+    // Apply the descriptors of `ordering` from index `first_descriptor` on
+    void apply_descriptors(const DescriptorOrdering&, size_t first_descriptor = 0);
 
     mutable ConstTableRef m_table;
     // The source column index that this view contain backlinks for.
@@ -19,6 +19,8 @@
 #include <realm/tokenizer.hpp>
 #include <realm/exceptions.hpp>
 
+#include <algorithm>
+
 namespace realm {
 
 Tokenizer::~Tokenizer() {}
@@ -41,10 +43,11 @@ std::set<std::string> Tokenizer::get_all_tokens()
     }
     return tokens;
 }
-std::pair<std::set<std::string>, std::set<std::string>> Tokenizer::get_search_tokens()
+SearchTokens Tokenizer::get_search_tokens()
 {
     std::vector<std::string_view> incl;
     std::vector<std::string_view> excl;
+    std::vector<std::string_view> phr;
 
     const char* begin = nullptr;
     const char* end = nullptr;
@@ -64,6 +67,18 @@ std::pair<std::set<std::string>, std::set<std::string>> Tokenizer::get_search_to
         if (isspace(static_cast<unsigned char>(*m_cur_pos))) {
             add_token();
         }
+        else if (*m_cur_pos == '"' && (!begin || (*begin == '-' && end - begin == 1))) {
+            if (begin) {
+                throw InvalidArgument("Excluding a phrase is not supported");
+            }
+            // A phrase lasts until the closing quote or the end of the text
+            auto phrase_begin = m_cur_pos + 1;
+            auto phrase_end = std::find(phrase_begin, m_end_pos, '"');
+            phr.emplace_back(phrase_begin, phrase_end - phrase_begin);
+            m_cur_pos = phrase_end;
+            if (m_cur_pos == m_end_pos)
+                break;
+        }
         else {
             if (begin) {
                 end++;
@@ -76,9 +91,21 @@ std::pair<std::set<std::string>, std::set<std::string>> Tokenizer::get_search_to
     }
     add_token();
 
-    std::set<std::string> includes;
-    std::set<std::string> excludes;
+    SearchTokens tokens;
+    auto& includes = tokens.includes;
+    auto& excludes = tokens.excludes;
 
+    for (auto& phrase : phr) {
+        reset(phrase);
+        std::vector<std::string> words;
+        while (next()) {
+            words.emplace_back(get_token());
+        }
+        includes.insert(words.begin(), words.end());
+        // A phrase of one word is just an ordinary search token
+        if (words.size() > 1)
+            tokens.phrases.push_back(std::move(words));
+    }
     for (auto& tok : incl) {
         reset(tok);
         next();
@@ -107,7 +134,7 @@ std::pair<std::set<std::string>, std::set<std::string>> Tokenizer::get_search_to
         }
     }
 
-    return {includes, excludes};
+    return tokens;
 }
 
 TokenInfoMap Tokenizer::get_token_info()
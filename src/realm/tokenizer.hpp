@@ -48,6 +48,13 @@ struct TokenInfo {
 
 using TokenInfoMap = std::map<std::string, TokenInfo>;
 
+struct SearchTokens {
+    std::set<std::string> includes;
+    std::set<std::string> excludes;
+    // Token sequences which must occur next to each other and in this order. Their tokens are in includes too.
+    std::vector<std::vector<std::string>> phrases;
+};
+
 class Tokenizer {
 public:
     virtual ~Tokenizer();
@@ -60,7 +67,7 @@ public:
         return {m_buffer, m_size};
     }
     std::set<std::string> get_all_tokens();
-    std::pair<std::set<std::string>, std::set<std::string>> get_search_tokens();
+    SearchTokens get_search_tokens();
     TokenInfoMap get_token_info();
 
     static std::unique_ptr<Tokenizer> get_instance();
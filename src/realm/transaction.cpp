@@ -226,9 +226,11 @@ DB::version_type Transaction::commit()
 
     db->end_write_on_correct_thread();
 
+    DBRef db_ref = db; // Reset by do_end_read()
     do_end_read();
     m_read_lock = lock_after_commit;
 
+    db_ref->wait_until_durable(new_version); // Throws
     return new_version;
 }
 
@@ -324,6 +326,8 @@ VersionID Transaction::commit_and_continue_as_read(bool commit_to_disk)
                 m_async_stage = AsyncState::HasCommits;
             }
         }
+        if (commit_to_disk)
+            db->wait_until_durable(version); // Throws
 
         // Remap file if it has grown, and update refs in underlying node structure.
         remap_and_update_refs(m_read_lock.m_top_ref, m_read_lock.m_file_size, false); // Throws
@@ -350,6 +354,8 @@ VersionID Transaction::commit_and_continue_writing()
     flush_accessors_for_commit();
 
     DB::version_type version = db->do_commit(*this); // Throws
+    // We keep the write mutex, so no other writer can share the sync
+    db->wait_until_durable(version); // Throws
 
     // We need to set m_read_lock in order for wait_for_change to work.
     // To set it, we grab a readlock on the latest available snapshot
@@ -400,6 +406,14 @@ void Transaction::copy_to(TransactionRef dest) const
     replicate(dest.get(), repl);
 }
 
+void Transaction::prefetch(TableKey table_key, ColKey col_key, util::MemoryAdvice advice) const
+{
+    ConstTableRef table = get_table(table_key); // Throws
+    if (col_key)
+        table->check_column(col_key); // Throws
+    table->m_clusters.prefetch(col_key, advice);
+}
+
 _impl::History* Transaction::get_history() const
 {
     if (!m_history) {
@@ -533,7 +547,7 @@ void Transaction::upgrade_file_format(int target_file_format_version)
     // Be sure to revisit the following upgrade logic when a new file format
     // version is introduced. The following assert attempt to help you not
     // forget it.
-    REALM_ASSERT_EX(target_file_format_version == 24, target_file_format_version);
+    REALM_ASSERT_EX(target_file_format_version == 25, target_file_format_version);
 
     // DB::do_open() must ensure that only supported version are allowed.
     // It does that by asking backup if the current file format version is
@@ -584,6 +598,7 @@ void Transaction::upgrade_file_format(int target_file_format_version)
             t->migrate_col_keys();
         }
     }
+    // Version 25 only adds structures which older versions cannot read, so there is nothing to convert
     // NOTE: Additional future upgrade steps go here.
 }
 
@@ -675,8 +690,16 @@ void Transaction::complete_async_commit()
             db->m_logger->log(util::LogCategory::transaction, util::Logger::Level::trace,
                               "Tr %1: Committing ref %2 to disk", m_log_id, read_lock.m_top_ref);
         }
-        GroupCommitter out(*this);
-        out.commit(read_lock.m_top_ref); // Throws
+        if (db->m_journal) {
+            db->sync_journal(); // Throws
+        }
+        else if (db->m_group_commit) {
+            db->wait_until_durable(read_lock.m_version); // Throws
+        }
+        else {
+            GroupCommitter out(*this);
+            out.commit(read_lock.m_top_ref); // Throws
+        }
         // we must release the write mutex before the callback, because the callback
         // is allowed to re-request it.
         db->release_read_lock(read_lock);
@@ -96,6 +96,19 @@ public:
 
     void copy_to(TransactionRef dest) const;
 
+    /// Pass a hint about how the specified table is going to be read to the
+    /// operating system. This covers the nodes of the table's cluster tree and
+    /// either the leaves of the specified column, including any strings,
+    /// binaries and collections they refer to, or the leaves of all columns if
+    /// no column is specified. With the default advice, the memory is read in
+    /// the background, so that a following query or iteration over the table
+    /// does not have to wait for each page of a file which is not in the page
+    /// cache. For encrypted files the memory is decrypted eagerly instead.
+    ///
+    /// This is purely an optimization, and never changes what is read.
+    void prefetch(TableKey table_key, ColKey col_key = {},
+                  util::MemoryAdvice advice = util::MemoryAdvice::WillNeed) const;
+
     _impl::History* get_history() const;
 
     // direct handover of accessor instances
@@ -75,6 +75,13 @@ public:
 
     enum class ReadResult { Eof, Uninitialized, InterruptedFirstWrite, StaleHmac, Failed, Success };
     ReadResult read(FileDesc fd, File::SizeType pos, char* dst, WriteObserver* observer = nullptr);
+    // Read up to `count` consecutive pages starting at `pos` with a single read and decrypt them into `dst`,
+    // splitting the work between several threads if there are enough pages. The pages must all be covered by
+    // the same block of IVs. Returns the number of leading pages which were read successfully, which may be
+    // less than `count` if a page needs the error handling of read(). Does nothing if other processes may be
+    // writing to the file.
+    size_t read_pages(FileDesc fd, File::SizeType pos, size_t count, char* dst, WriteObserver* observer = nullptr);
+    static constexpr size_t max_pages_per_read = 32;
     void try_read_block(FileDesc fd, File::SizeType pos, char* dst) noexcept;
     void write(FileDesc fd, File::SizeType pos, const char* src, WriteMarker* marker = nullptr) noexcept;
     bool refresh_iv(FileDesc fd, size_t page_ndx);
@@ -117,10 +124,15 @@ private:
     std::vector<bool> m_iv_blocks_read;
     std::unique_ptr<char[]> m_rw_buffer;
     std::unique_ptr<char[]> m_dst_buffer;
+    // Encrypted and decrypted data for read_pages(), allocated on first use
+    std::unique_ptr<char[]> m_pages_buffer;
+    // Used by read_pages() for decrypting on other threads, as a cipher context cannot be shared
+    std::vector<std::unique_ptr<AESCryptor>> m_helpers;
 
     bool constant_time_equals(const Hmac&, const Hmac&) const;
     void calculate_hmac(Hmac&) const;
     void crypt(EncryptionMode mode, File::SizeType pos, char* dst, const char* src, const char* stored_iv) noexcept;
+    bool decrypt_page(File::SizeType pos, char* dst, const char* src, const IVTable& iv) noexcept;
     IVTable& get_iv_table(FileDesc fd, File::SizeType data_pos, IVLookupMode mode = IVLookupMode::UseCache) noexcept;
     void handle_error();
     void read_iv_block(FileDesc fd, File::SizeType data_pos);
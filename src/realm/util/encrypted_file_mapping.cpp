@@ -26,8 +26,10 @@
 #if REALM_ENABLE_ENCRYPTION
 #include <realm/util/aes_cryptor.hpp>
 #include <realm/util/errno.hpp>
+#include <realm/util/scope_exit.hpp>
 #include <realm/util/sha_crypto.hpp>
 #include <realm/util/terminate.hpp>
+#include <realm/util/thread_pool.hpp>
 #include <realm/utilities.hpp>
 
 #include <algorithm>
@@ -155,6 +157,11 @@ constexpr uint8_t metadata_size = sizeof(IVTable);
 constexpr uint8_t pages_per_block = encryption_page_size / metadata_size;
 static_assert(metadata_size == 64,
               "changing the size of the metadata breaks compatibility with existing Realm files");
+// Number of pages following the ones requested by a read barrier which are
+// read and decrypted along with them
+constexpr size_t read_ahead_pages = 16;
+// Smallest number of pages worth decrypting on a separate thread
+constexpr size_t min_pages_per_decryption_task = 8;
 
 using SizeType = File::SizeType;
 
@@ -281,6 +288,16 @@ void memcpy_if_changed(void* dst, const void* src, size_t n)
 #endif
 }
 
+// Runs of pages are decrypted on a pool of their own rather than the default
+// one. The thread waiting for the decryption holds the mutex of the file, so
+// it must not help out with tasks which might try to acquire it.
+ThreadPool& decryption_pool()
+{
+    // Intentionally leaked like ThreadPool::get_default()
+    static ThreadPool& pool = *new ThreadPool(std::min(std::max(std::thread::hardware_concurrency(), 2u), 4u) - 1);
+    return pool;
+}
+
 } // anonymous namespace
 
 AESCryptor::AESCryptor(const char* key)
@@ -529,6 +546,72 @@ AESCryptor::ReadResult AESCryptor::attempt_read(FileDesc fd, SizeType pos, char*
     return ReadResult::Success;
 }
 
+size_t AESCryptor::read_pages(FileDesc fd, SizeType pos, size_t count, char* dst, WriteObserver* observer)
+{
+    // Reads racing with writes from another process are retried page by page
+    if (observer && !observer->no_concurrent_writer_seen())
+        return 0;
+    REALM_ASSERT(count > 0 && count <= max_pages_per_read);
+    REALM_ASSERT(block_index(pos) == block_index(pos + SizeType(count - 1) * encryption_page_size));
+
+    if (!m_pages_buffer)
+        m_pages_buffer.reset(new char[2 * max_pages_per_read * encryption_page_size]); // Throws
+    char* encrypted = m_pages_buffer.get();
+    char* decrypted = encrypted + max_pages_per_read * encryption_page_size;
+
+    // Copied as reading another block of IVs may reallocate the buffer
+    std::array<IVTable, max_pages_per_read> ivs;
+    for (size_t i = 0; i < count; ++i)
+        ivs[i] = get_iv_table(fd, pos + SizeType(i) * encryption_page_size);
+
+    size_t bytes_read = File::read_static(fd, data_pos_to_file_pos(pos), encrypted, count * encryption_page_size);
+    count = std::min(count, bytes_read / encryption_page_size);
+
+    std::array<bool, max_pages_per_read> decrypted_ok;
+    auto decrypt_range = [&](AESCryptor& cryptor, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            size_t offset = i * encryption_page_size;
+            decrypted_ok[i] =
+                cryptor.decrypt_page(pos + SizeType(offset), decrypted + offset, encrypted + offset, ivs[i]);
+        }
+    };
+
+    ThreadPool& pool = decryption_pool();
+    size_t num_tasks = std::min(count / min_pages_per_decryption_task, pool.num_threads() + 1);
+    if (num_tasks < 2) {
+        decrypt_range(*this, 0, count);
+    }
+    else {
+        while (m_helpers.size() < num_tasks - 1)
+            m_helpers.push_back(std::make_unique<AESCryptor>(get_key())); // Throws
+        pool.run_parallel(num_tasks, [&](size_t task) {
+            AESCryptor& cryptor = task == 0 ? *this : *m_helpers[task - 1];
+            decrypt_range(cryptor, count * task / num_tasks, count * (task + 1) / num_tasks);
+        }); // Throws
+    }
+
+    size_t num_decrypted = 0;
+    while (num_decrypted < count && decrypted_ok[num_decrypted])
+        ++num_decrypted;
+    memcpy_if_changed(dst, decrypted, num_decrypted * encryption_page_size);
+    return num_decrypted;
+}
+
+// Check the HMAC of the encrypted page in `src` against the current IV and
+// decrypt it into `dst`. Any other case is left to attempt_read().
+bool AESCryptor::decrypt_page(SizeType pos, char* dst, const char* src, const IVTable& iv) noexcept
+{
+    if (iv.iv1 == 0)
+        return false;
+    Hmac hmac;
+    hmac_sha224(Span(reinterpret_cast<const uint8_t*>(src), encryption_page_size), hmac,
+                Span(m_key).sub_span<32>());
+    if (!constant_time_equals(hmac, iv.hmac1))
+        return false;
+    crypt(mode_Decrypt, pos, dst, src, reinterpret_cast<const char*>(&iv.iv1));
+    return true;
+}
+
 void AESCryptor::try_read_block(FileDesc fd, SizeType pos, char* dst) noexcept
 {
     size_t bytes_read = check_read(fd, data_pos_to_file_pos(pos), m_rw_buffer.get());
@@ -743,7 +826,7 @@ bool EncryptedFileMapping::copy_up_to_date_page(size_t local_ndx) noexcept
             continue;
 
         memcpy_if_changed(page_addr(local_ndx), m->page_addr(other_mapping_ndx), encryption_page_size);
-        set(m_page_state[local_ndx], UpToDate);
+        set_up_to_date(local_ndx);
         clear(m_page_state[local_ndx], StaleIV);
         return true;
     }
@@ -768,12 +851,13 @@ bool EncryptedFileMapping::check_possibly_stale_page(size_t local_ndx) noexcept
         m->assert_locked();
         if (!m->contains_page(ndx_in_file))
             continue;
-        auto& state = m->m_page_state[ndx_in_file - m->m_first_page];
+        size_t other_local_ndx = ndx_in_file - m->m_first_page;
+        auto& state = m->m_page_state[other_local_ndx];
         if (is(state, StaleIV)) {
             REALM_ASSERT(is_not(state, UpToDate));
             clear(state, StaleIV);
             if (!did_change)
-                set(state, UpToDate);
+                m->set_up_to_date(other_local_ndx);
         }
     }
     return !did_change;
@@ -787,7 +871,12 @@ void EncryptedFileMapping::throw_decryption_error(size_t local_ndx, std::string_
     throw DecryptionFailed(util::format("page %1 in file of size %2 %3", local_ndx + m_first_page, fs, msg));
 }
 
-void EncryptedFileMapping::refresh_page(size_t local_ndx, bool to_modify)
+// Bring the page at `local_ndx` up to date. If it has to be read from disk,
+// the following pages which are not up to date either are read along with it,
+// up to `end` and then some more in the expectation that they will be needed
+// soon. Reading a run of pages takes a single read() and decrypting them can
+// be spread over multiple threads.
+void EncryptedFileMapping::refresh_pages(size_t local_ndx, size_t end, bool to_modify)
 {
     REALM_ASSERT_EX(local_ndx < m_page_state.size(), local_ndx, m_page_state.size());
     REALM_ASSERT(is_not(m_page_state[local_ndx], Dirty));
@@ -796,6 +885,34 @@ void EncryptedFileMapping::refresh_page(size_t local_ndx, bool to_modify)
         return;
     }
 
+    // A run must be covered by a single block of IVs to be contiguous in the file
+    size_t ndx_in_file = local_ndx + m_first_page;
+    size_t block_end = (ndx_in_file / pages_per_block + 1) * pages_per_block - m_first_page;
+    size_t run_limit = std::min({m_page_state.size(), block_end, std::max(end, local_ndx + 1) + read_ahead_pages,
+                                 local_ndx + AESCryptor::max_pages_per_read});
+    size_t run_end = local_ndx + 1;
+    while (run_end < run_limit) {
+        PageState& ps = m_page_state[run_end];
+        if (is(ps, UpToDate) || copy_up_to_date_page(run_end) || check_possibly_stale_page(run_end))
+            break;
+        ++run_end;
+    }
+
+    size_t num_read = 0;
+    if (run_end - local_ndx > 1) {
+        num_read = m_file.cryptor.read_pages(m_file.fd, page_pos(local_ndx), run_end - local_ndx,
+                                             page_addr(local_ndx), m_observer); // Throws
+        for (size_t i = local_ndx; i < local_ndx + num_read; ++i)
+            set_up_to_date(i);
+    }
+    // Pages which could not be read as part of a run (if they are needed)
+    // go through read_page(), which reports errors and handles retries.
+    if (num_read == 0)
+        read_page(local_ndx, to_modify); // Throws
+}
+
+void EncryptedFileMapping::read_page(size_t local_ndx, bool to_modify)
+{
     char* addr = page_addr(local_ndx);
     switch (m_file.cryptor.read(m_file.fd, page_pos(local_ndx), addr, m_observer)) {
         case AESCryptor::ReadResult::Eof:
@@ -818,7 +935,69 @@ void EncryptedFileMapping::refresh_page(size_t local_ndx, bool to_modify)
         case AESCryptor::ReadResult::Success:
             break;
     }
+    set_up_to_date(local_ndx);
+}
+
+void EncryptedFileMapping::set_up_to_date(size_t local_ndx) noexcept
+{
     set(m_page_state[local_ndx], UpToDate);
+    m_ready_pages.load(std::memory_order_relaxed)->ready[local_ndx].store(true, std::memory_order_release);
+}
+
+void EncryptedFileMapping::clear_up_to_date(size_t local_ndx) noexcept
+{
+    clear(m_page_state[local_ndx], UpToDate);
+    m_ready_pages.load(std::memory_order_relaxed)->ready[local_ndx].store(false, std::memory_order_release);
+}
+
+void EncryptedFileMapping::resize_ready_pages(size_t count, bool keep_state)
+{
+    ReadyPages* pages = m_ready_pages.load(std::memory_order_relaxed);
+    if (keep_state && count <= pages->capacity) {
+        for (size_t i = count; i < pages->count.load(std::memory_order_relaxed); ++i)
+            pages->ready[i].store(false, std::memory_order_relaxed);
+        pages->count.store(count, std::memory_order_release);
+        return;
+    }
+
+    auto new_pages = std::make_unique<ReadyPages>();
+    new_pages->addr = reinterpret_cast<uintptr_t>(m_addr);
+    new_pages->capacity = keep_state ? std::max(count, 2 * pages->capacity) : count;
+    new_pages->ready.reset(new std::atomic<bool>[new_pages->capacity]()); // Throws
+    if (keep_state) {
+        for (size_t i = 0; i < pages->count.load(std::memory_order_relaxed); ++i)
+            new_pages->ready[i].store(pages->ready[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    new_pages->count.store(count, std::memory_order_relaxed);
+    m_ready_pages_tables.push_back(std::move(new_pages)); // Throws
+    m_ready_pages.store(m_ready_pages_tables.back().get(), std::memory_order_seq_cst);
+
+    // A reader which is not counted yet will see the new table, as it registers
+    // itself before loading m_ready_pages, so the replaced tables can go if no
+    // reader is registered now. Otherwise they are retried on the next resize.
+    if (m_ready_pages_tables.size() > 1 && m_ready_pages_readers.load(std::memory_order_seq_cst) == 0)
+        m_ready_pages_tables.erase(m_ready_pages_tables.begin(), m_ready_pages_tables.end() - 1);
+}
+
+bool EncryptedFileMapping::is_up_to_date(const void* addr, size_t size) const noexcept
+{
+    m_ready_pages_readers.fetch_add(1, std::memory_order_seq_cst);
+    auto unregister = util::make_scope_exit([&]() noexcept {
+        m_ready_pages_readers.fetch_sub(1, std::memory_order_release);
+    });
+    const ReadyPages* pages = m_ready_pages.load(std::memory_order_seq_cst);
+    if (!pages || reinterpret_cast<uintptr_t>(addr) < pages->addr)
+        return false;
+    size_t offset = size_t(reinterpret_cast<uintptr_t>(addr) - pages->addr);
+    size_t begin = offset / encryption_page_size;
+    size_t end = (offset + size - 1) / encryption_page_size;
+    if (end >= pages->count.load(std::memory_order_acquire))
+        return false;
+    for (size_t i = begin; i <= end; ++i) {
+        if (!pages->ready[i].load(std::memory_order_acquire))
+            return false;
+    }
+    return true;
 }
 
 void EncryptedFile::mark_data_as_possibly_stale()
@@ -834,10 +1013,11 @@ void EncryptedFile::mark_data_as_possibly_stale()
 
 void EncryptedFileMapping::mark_pages_for_iv_check()
 {
-    for (auto& state : m_page_state) {
+    for (size_t i = 0; i < m_page_state.size(); ++i) {
+        auto& state = m_page_state[i];
         if (is(state, UpToDate) && is_not(state, Dirty | Writable)) {
             REALM_ASSERT(is_not(state, StaleIV));
-            clear(state, UpToDate);
+            clear_up_to_date(i);
             set(state, StaleIV);
         }
     }
@@ -866,7 +1046,7 @@ void EncryptedFileMapping::write_and_update_all(size_t local_ndx, uint16_t offse
         // page may be out of date
         else if (is(state, StaleIV)) {
             memcpy_if_changed(m->page_addr(other_local_ndx), page_addr(local_ndx), encryption_page_size);
-            set(state, UpToDate);
+            m->set_up_to_date(other_local_ndx);
             clear(state, StaleIV);
         }
     }
@@ -996,14 +1176,19 @@ void EncryptedFileMapping::write_barrier(const void* addr, size_t size) noexcept
 
 void EncryptedFileMapping::read_barrier(const void* addr, size_t size, bool to_modify)
 {
-    CheckedLockGuard lock(m_file.mutex);
     REALM_ASSERT(size > 0);
+    // Once decrypted, a page stays up to date until it is marked for an IV
+    // check, so most reads do not need the mutex.
+    if (!to_modify && is_up_to_date(addr, size))
+        return;
+
+    CheckedLockGuard lock(m_file.mutex);
     size_t begin = get_local_index_of_address(addr);
     size_t end = get_local_index_of_address(addr, size - 1);
     for (size_t local_ndx = begin; local_ndx <= end; ++local_ndx) {
         PageState& ps = m_page_state[local_ndx];
         if (is_not(ps, UpToDate))
-            refresh_page(local_ndx, to_modify);
+            refresh_pages(local_ndx, end + 1, to_modify);
         if (to_modify)
             set(ps, Writable);
     }
@@ -1014,6 +1199,7 @@ void EncryptedFileMapping::extend_to(SizeType offset, size_t new_size)
     CheckedLockGuard lock(m_file.mutex);
     REALM_ASSERT_EX(new_size % encryption_page_size == 0, new_size, encryption_page_size);
     m_page_state.resize(page_count(new_size), PageState::Clean);
+    resize_ready_pages(m_page_state.size(), true); // Throws
     m_file.cryptor.set_data_size(offset + SizeType(new_size));
 }
 
@@ -1036,6 +1222,7 @@ void EncryptedFileMapping::set(void* new_addr, size_t new_size, SizeType new_fil
     m_first_page = size_t(new_file_offset / encryption_page_size);
     m_page_state.clear();
     m_page_state.resize(new_size / encryption_page_size, PageState::Clean);
+    resize_ready_pages(m_page_state.size(), false); // Throws
 }
 
 SizeType encrypted_size_to_data_size(SizeType size) noexcept
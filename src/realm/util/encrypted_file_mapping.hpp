@@ -23,6 +23,7 @@
 #include <realm/util/checked_mutex.hpp>
 #include <realm/util/file.hpp>
 
+#include <atomic>
 #include <vector>
 
 namespace realm::util {
@@ -123,6 +124,20 @@ private:
         Dirty = 8     // the page has been modified with respect to what's on file.
     };
     std::vector<PageState> m_page_state GUARDED_BY(m_file.mutex);
+
+    // Mirrors the UpToDate flag of each page so that read_barrier() can skip taking the mutex when all the pages
+    // are up to date. Readers may be using the table while the mapping is extended, so a table is replaced
+    // rather than reallocated when it is too small. Replaced tables are freed once no reader is inside
+    // is_up_to_date(), as counted by m_ready_pages_readers.
+    struct ReadyPages {
+        uintptr_t addr = 0;
+        std::atomic<size_t> count{0};
+        size_t capacity = 0;
+        std::unique_ptr<std::atomic<bool>[]> ready;
+    };
+    std::atomic<ReadyPages*> m_ready_pages{nullptr};
+    std::vector<std::unique_ptr<ReadyPages>> m_ready_pages_tables GUARDED_BY(m_file.mutex);
+    mutable std::atomic<size_t> m_ready_pages_readers{0};
     // little helpers:
     static constexpr void clear(PageState& ps, int p)
     {
@@ -152,7 +167,12 @@ private:
     File::SizeType page_pos(size_t local_ndx) const noexcept REQUIRES(m_file.mutex);
     bool copy_up_to_date_page(size_t local_ndx) noexcept REQUIRES(m_file.mutex);
     bool check_possibly_stale_page(size_t local_ndx) noexcept REQUIRES(m_file.mutex);
-    void refresh_page(size_t local_ndx, bool to_modify) REQUIRES(m_file.mutex);
+    void refresh_pages(size_t local_ndx, size_t end, bool to_modify) REQUIRES(m_file.mutex);
+    void read_page(size_t local_ndx, bool to_modify) REQUIRES(m_file.mutex);
+    void set_up_to_date(size_t local_ndx) noexcept REQUIRES(m_file.mutex);
+    void clear_up_to_date(size_t local_ndx) noexcept REQUIRES(m_file.mutex);
+    void resize_ready_pages(size_t count, bool keep_state) REQUIRES(m_file.mutex);
+    bool is_up_to_date(const void* addr, size_t size) const noexcept;
     void write_and_update_all(size_t local_ndx, uint16_t offset, uint16_t size) noexcept REQUIRES(m_file.mutex);
     void validate_page(size_t local_ndx) noexcept REQUIRES(m_file.mutex);
     void validate() noexcept REQUIRES(m_file.mutex);
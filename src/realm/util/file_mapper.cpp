@@ -248,6 +248,45 @@ void msync(FileDesc fd, void* addr, size_t size)
 #endif
 }
 
+void madvise(const void* addr, size_t size, MemoryAdvice advice) noexcept
+{
+    auto shift = reinterpret_cast<uintptr_t>(addr) & (page_size() - 1);
+    void* page_addr = const_cast<char*>(static_cast<const char*>(addr) - shift);
+    size += shift;
+#ifdef _WIN32
+    if (advice == MemoryAdvice::WillNeed) {
+        WIN32_MEMORY_RANGE_ENTRY range{page_addr, size};
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#else
+    int native_advice;
+    switch (advice) {
+        case MemoryAdvice::Normal:
+            native_advice = MADV_NORMAL;
+            break;
+        case MemoryAdvice::Sequential:
+            native_advice = MADV_SEQUENTIAL;
+            break;
+        case MemoryAdvice::Random:
+            native_advice = MADV_RANDOM;
+            break;
+        case MemoryAdvice::WillNeed:
+            native_advice = MADV_WILLNEED;
+            break;
+        case MemoryAdvice::HugePages:
+#ifdef MADV_HUGEPAGE
+            native_advice = MADV_HUGEPAGE;
+            break;
+#else
+            return;
+#endif
+        default:
+            return;
+    }
+    ::madvise(page_addr, size, native_advice);
+#endif
+}
+
 #if REALM_ENABLE_ENCRYPTION
 void do_encryption_read_barrier(const void* addr, size_t size, EncryptedFileMapping* mapping, bool to_modify)
 {
@@ -37,6 +37,21 @@ void munmap(void* addr, size_t size);
 void msync(FileDesc fd, void* addr, size_t size);
 void* mmap_anon(size_t size);
 
+/// Hints about how a range of mapped memory is going to be accessed.
+enum class MemoryAdvice {
+    Normal,     ///< No particular pattern, undoes Sequential and Random
+    Sequential, ///< Read ahead aggressively
+    Random,     ///< Do not read ahead
+    WillNeed,   ///< Start reading the range in the background
+    HugePages,  ///< Back the range with huge pages where possible
+};
+
+/// Pass a hint about a range of mapped memory to the operating system. The
+/// range is extended to whole pages. Hints which the platform does not
+/// support are ignored, as are failures, since the hint does not change what
+/// the memory contains.
+void madvise(const void* addr, size_t size, MemoryAdvice advice) noexcept;
+
 #if REALM_ENABLE_ENCRYPTION
 
 void* mmap_fixed(FileDesc fd, void* address_request, size_t size, File::AccessMode access, uint64_t offset);
@@ -0,0 +1,381 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/util/io_uring_writer.hpp>
+
+#include <realm/exceptions.hpp>
+#include <realm/util/assert.hpp>
+#include <realm/util/errno.hpp>
+
+#include <algorithm>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define REALM_HAVE_IO_URING 1
+#endif
+#endif
+#endif
+
+#if REALM_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+using namespace realm;
+using namespace realm::util;
+
+#if REALM_HAVE_IO_URING
+
+namespace {
+
+int io_uring_setup(unsigned entries, io_uring_params* params)
+{
+    return int(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return int(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int io_uring_register(int fd, unsigned opcode, void* arg, unsigned nr_args)
+{
+    return int(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+[[noreturn]] void throw_error(int err, const char* msg)
+{
+    auto what = format_errno(msg, err);
+    if (err == ENOSPC || err == EDQUOT)
+        throw OutOfDiskSpace(what);
+    throw SystemError(err, what);
+}
+
+} // anonymous namespace
+
+struct IoUringWriter::Ring {
+    int fd = -1;
+    void* sq_ring = MAP_FAILED;
+    size_t sq_ring_size = 0;
+    void* cq_ring = MAP_FAILED;
+    size_t cq_ring_size = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqes_size = 0;
+
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned cq_mask;
+    io_uring_cqe* cqes;
+
+    ~Ring()
+    {
+        if (sqes != MAP_FAILED)
+            ::munmap(sqes, sqes_size);
+        if (cq_ring != MAP_FAILED && cq_ring != sq_ring)
+            ::munmap(cq_ring, cq_ring_size);
+        if (sq_ring != MAP_FAILED)
+            ::munmap(sq_ring, sq_ring_size);
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+    bool init()
+    {
+        io_uring_params params;
+        memset(&params, 0, sizeof params);
+        fd = io_uring_setup(queue_depth, &params);
+        if (fd < 0)
+            return false;
+        if (!supports(IORING_OP_WRITE) || !supports(IORING_OP_FSYNC))
+            return false;
+
+        sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap)
+            sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+        sq_ring = ::mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                         IORING_OFF_SQ_RING);
+        if (sq_ring == MAP_FAILED)
+            return false;
+        if (single_mmap) {
+            cq_ring = sq_ring;
+        }
+        else {
+            cq_ring = ::mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                             IORING_OFF_CQ_RING);
+            if (cq_ring == MAP_FAILED)
+                return false;
+        }
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* addr = ::mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                            IORING_OFF_SQES);
+        if (addr == MAP_FAILED)
+            return false;
+        sqes = static_cast<io_uring_sqe*>(addr);
+
+        char* sq = static_cast<char*>(sq_ring);
+        sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(cq_ring);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        // The completion queue is at least twice as large as the submission
+        // queue, so it cannot overflow as long as no more than queue_depth
+        // operations are in flight
+        REALM_ASSERT(params.sq_entries == queue_depth);
+        REALM_ASSERT(params.cq_entries >= 2 * queue_depth);
+        return true;
+    }
+
+    bool supports(unsigned op)
+    {
+        constexpr unsigned num_ops = 256;
+        std::vector<char> buffer(sizeof(io_uring_probe) + num_ops * sizeof(io_uring_probe_op), 0);
+        auto probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+        if (io_uring_register(fd, IORING_REGISTER_PROBE, probe, num_ops) < 0)
+            return false;
+        return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+    }
+};
+
+std::unique_ptr<IoUringWriter> IoUringWriter::create(const File& file)
+{
+    auto ring = std::make_unique<Ring>();
+    if (!ring->init())
+        return nullptr;
+    return std::unique_ptr<IoUringWriter>(new IoUringWriter(file.get_descriptor(), std::move(ring)));
+}
+
+IoUringWriter::IoUringWriter(FileDesc fd, std::unique_ptr<Ring> ring) noexcept
+    : m_fd(fd)
+    , m_ring(std::move(ring))
+{
+}
+
+IoUringWriter::~IoUringWriter() noexcept
+{
+    discard();
+}
+
+void IoUringWriter::write(uint64_t pos, const char* data, size_t size)
+{
+    // The size of a single write is limited to 32 bits
+    constexpr size_t max_size = 1UL << 30;
+    while (size > max_size) {
+        push({pos, data, max_size, false});
+        pos += max_size;
+        data += max_size;
+        size -= max_size;
+    }
+    if (size > 0)
+        push({pos, data, size, false});
+}
+
+void IoUringWriter::sync()
+{
+    push({0, nullptr, 0, true});
+}
+
+void IoUringWriter::wait()
+{
+    try {
+        submit(); // Throws
+    }
+    catch (...) {
+        discard();
+        throw;
+    }
+    wait_for_completions();
+    bool any_sync = std::any_of(m_operations.begin(), m_operations.end(), [](const Operation& op) {
+        return op.is_sync;
+    });
+    m_operations.clear();
+    if (int err = m_error) {
+        m_error = 0;
+        m_incomplete.clear();
+        throw_error(err, "io_uring write failed: %1");
+    }
+    if (!m_incomplete.empty()) {
+        std::vector<Operation> incomplete;
+        incomplete.swap(m_incomplete);
+        for (auto& op : incomplete)
+            File::write_static(m_fd, File::SizeType(op.pos), op.data, op.size); // Throws
+        // The synchronizations may have completed before the rest of the
+        // writes was written
+        if (any_sync && ::fsync(m_fd) != 0)
+            throw_error(errno, "fsync() failed: %1");
+    }
+}
+
+void IoUringWriter::discard() noexcept
+{
+    // Entries are only consumed by the kernel when they are submitted, so the
+    // ones which were not can be taken back
+    Ring& ring = *m_ring;
+    __atomic_store_n(ring.sq_tail, __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+    m_num_queued = 0;
+    // The kernel may still access the buffers of the operations in flight
+    wait_for_completions();
+    m_operations.clear();
+    m_incomplete.clear();
+    m_error = 0;
+}
+
+void IoUringWriter::push(const Operation& op)
+{
+    if (m_num_queued + m_num_in_flight == queue_depth) {
+        submit(); // Throws
+        wait_for_completions();
+    }
+    Ring& ring = *m_ring;
+    unsigned tail = *ring.sq_tail;
+    unsigned index = tail & ring.sq_mask;
+    io_uring_sqe& sqe = ring.sqes[index];
+    memset(&sqe, 0, sizeof sqe);
+    if (op.is_sync) {
+        sqe.opcode = IORING_OP_FSYNC;
+        sqe.flags = IOSQE_IO_DRAIN;
+    }
+    else {
+        sqe.opcode = IORING_OP_WRITE;
+        sqe.addr = uint64_t(reinterpret_cast<uintptr_t>(op.data));
+        sqe.len = unsigned(op.size);
+        sqe.off = op.pos;
+    }
+    sqe.fd = m_fd;
+    sqe.user_data = uint64_t(m_operations.size());
+    m_operations.push_back(op);                      // Throws
+    m_incomplete.reserve(m_operations.capacity()); // Throws
+    ring.sq_array[index] = index;
+    // Publish the entry to the kernel
+    __atomic_store_n(ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++m_num_queued;
+}
+
+void IoUringWriter::submit()
+{
+    while (m_num_queued > 0) {
+        int r = io_uring_enter(m_ring->fd, m_num_queued, 0, 0);
+        if (r < 0) {
+            int err = errno;
+            if (err == EINTR)
+                continue;
+            if ((err == EAGAIN || err == EBUSY) && m_num_in_flight > 0) {
+                // Out of resources until some of the operations in flight complete
+                io_uring_enter(m_ring->fd, 0, 1, IORING_ENTER_GETEVENTS);
+                reap();
+                continue;
+            }
+            throw_error(err, "io_uring_enter() failed: %1");
+        }
+        m_num_queued -= unsigned(r);
+        m_num_in_flight += unsigned(r);
+    }
+}
+
+void IoUringWriter::wait_for_completions() noexcept
+{
+    for (;;) {
+        reap();
+        if (m_num_in_flight == 0)
+            return;
+        if (io_uring_enter(m_ring->fd, 0, m_num_in_flight, IORING_ENTER_GETEVENTS) < 0) {
+            // Waiting can only fail if it is interrupted, as the completion
+            // queue cannot overflow
+            int err = errno;
+            REALM_ASSERT_RELEASE_EX(err == EINTR, err);
+        }
+    }
+}
+
+void IoUringWriter::reap() noexcept
+{
+    Ring& ring = *m_ring;
+    unsigned head = *ring.cq_head;
+    unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+        const io_uring_cqe& cqe = ring.cqes[head & ring.cq_mask];
+        const Operation& op = m_operations[size_t(cqe.user_data)];
+        if (cqe.res < 0) {
+            if (m_error == 0)
+                m_error = -cqe.res;
+        }
+        else if (!op.is_sync && size_t(cqe.res) < op.size) {
+            size_t done = size_t(cqe.res);
+            // m_incomplete has room for all operations (see push())
+            m_incomplete.push_back({op.pos + done, op.data + done, op.size - done, false});
+        }
+        --m_num_in_flight;
+    }
+    __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+}
+
+#else // REALM_HAVE_IO_URING
+
+struct IoUringWriter::Ring {
+};
+
+std::unique_ptr<IoUringWriter> IoUringWriter::create(const File&)
+{
+    return nullptr;
+}
+
+IoUringWriter::IoUringWriter(FileDesc fd, std::unique_ptr<Ring> ring) noexcept
+    : m_fd(fd)
+    , m_ring(std::move(ring))
+{
+}
+
+IoUringWriter::~IoUringWriter() noexcept = default;
+
+void IoUringWriter::write(uint64_t, const char*, size_t)
+{
+    REALM_UNREACHABLE();
+}
+
+void IoUringWriter::sync()
+{
+    REALM_UNREACHABLE();
+}
+
+void IoUringWriter::wait()
+{
+    REALM_UNREACHABLE();
+}
+
+void IoUringWriter::discard() noexcept
+{
+}
+
+#endif // REALM_HAVE_IO_URING
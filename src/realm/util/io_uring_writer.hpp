@@ -0,0 +1,100 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_UTIL_IO_URING_WRITER_HPP
+#define REALM_UTIL_IO_URING_WRITER_HPP
+
+#include <realm/util/file.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace realm::util {
+
+/// Writes to a file through a Linux io_uring, so that many writes and the
+/// synchronizations ordered between them are handed to the kernel with a
+/// single system call.
+///
+/// Operations are queued by write() and sync(), and submitted when wait() is
+/// called (or earlier, if the submission queue fills up). Queued writes may be
+/// performed in any order relative to each other.
+class IoUringWriter {
+public:
+    /// Returns nullptr if io_uring is not supported by the platform, the
+    /// kernel, or the process (e.g. because it is blocked by a seccomp
+    /// filter).
+    static std::unique_ptr<IoUringWriter> create(const File& file);
+
+    ~IoUringWriter() noexcept;
+
+    /// Queue a write of `size` bytes at `pos`. The data must stay valid until
+    /// wait() returns.
+    void write(uint64_t pos, const char* data, size_t size);
+
+    /// Queue a synchronization of the file to disk. It starts once all
+    /// operations queued before it have completed, and the operations queued
+    /// after it start once it has completed.
+    void sync();
+
+    /// Submit the queued operations and wait until all of them have completed.
+    /// Throws if any of them failed, in which case the state of the parts of
+    /// the file written by them is unspecified.
+    void wait();
+
+    /// Drop the queued operations which have not been submitted yet, and wait
+    /// for the others to complete, ignoring their results.
+    void discard() noexcept;
+
+    /// The number of entries of the submission queue.
+    static constexpr unsigned queue_depth = 256;
+
+private:
+    struct Ring;
+    struct Operation {
+        uint64_t pos;
+        const char* data;
+        size_t size;
+        bool is_sync;
+    };
+
+    IoUringWriter(FileDesc fd, std::unique_ptr<Ring> ring) noexcept;
+
+    FileDesc m_fd;
+    std::unique_ptr<Ring> m_ring;
+    // The operations submitted since the last call to wait(), indexed by the
+    // user data of their submission queue entries
+    std::vector<Operation> m_operations;
+    // The remaining parts of writes which were completed only partially
+    std::vector<Operation> m_incomplete;
+    unsigned m_num_queued = 0;
+    unsigned m_num_in_flight = 0;
+    int m_error = 0;
+
+    void push(const Operation&);
+    // Submit all queued operations to the kernel
+    void submit();
+    // Wait until all submitted operations have completed
+    void wait_for_completions() noexcept;
+    // Process the completion queue entries which are available
+    void reap() noexcept;
+};
+
+} // namespace realm::util
+
+#endif // REALM_UTIL_IO_URING_WRITER_HPP
@@ -0,0 +1,215 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/util/thread_pool.hpp>
+
+#include <realm/util/assert.hpp>
+
+#include <algorithm>
+#include <exception>
+
+namespace realm::util {
+
+namespace {
+// The pool (if any) the current thread is a worker of, and its index in that pool
+thread_local ThreadPool* t_current_pool = nullptr;
+thread_local size_t t_worker_ndx = 0;
+} // anonymous namespace
+
+ThreadPool::ThreadPool(size_t num_threads)
+{
+    m_workers.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i)
+        m_workers.push_back(std::make_unique<Worker>());
+    for (size_t i = 0; i < num_threads; ++i) {
+        m_workers[i]->thread = std::thread([this, i] {
+            worker_main(i);
+        }); // Throws
+    }
+}
+
+ThreadPool::~ThreadPool() noexcept
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto& worker : m_workers)
+        worker->thread.join();
+}
+
+void ThreadPool::submit(Task task)
+{
+    if (m_workers.empty()) {
+        task();
+        return;
+    }
+    Worker* target;
+    if (t_current_pool == this) {
+        target = m_workers[t_worker_ndx].get();
+    }
+    else {
+        target = m_workers[m_next_worker.fetch_add(1, std::memory_order_relaxed) % m_workers.size()].get();
+    }
+    {
+        std::lock_guard lock(target->mutex);
+        target->tasks.push_back(std::move(task)); // Throws
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        ++m_num_pending;
+    }
+    m_cv.notify_one();
+}
+
+// The calls of one run_parallel() batch are handed out from a counter. Only
+// the calling thread and the helper tasks submitted for the batch take calls
+// from it. A helper may be run after the batch has completed, so the batch is
+// kept alive by the helpers, but `fn` is only called for calls which have been
+// handed out, which all complete before run_parallel() returns.
+struct ThreadPool::Batch {
+    FunctionRef<void(size_t)> fn;
+    size_t num_tasks;
+    std::atomic<size_t> next_task{0};
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t remaining;             // Guarded by mutex
+    std::exception_ptr exception; // Guarded by mutex
+
+    Batch(FunctionRef<void(size_t)> f, size_t n)
+        : fn(f)
+        , num_tasks(n)
+        , remaining(n)
+    {
+    }
+
+    void run() noexcept
+    {
+        for (size_t ndx = next_task++; ndx < num_tasks; ndx = next_task++) {
+            std::exception_ptr e;
+            try {
+                fn(ndx);
+            }
+            catch (...) {
+                e = std::current_exception();
+            }
+            std::lock_guard lock(mutex);
+            if (e && !exception)
+                exception = e;
+            if (--remaining == 0)
+                cv.notify_all();
+        }
+    }
+};
+
+void ThreadPool::run_parallel(size_t num_tasks, FunctionRef<void(size_t)> fn)
+{
+    if (num_tasks == 0)
+        return;
+
+    auto batch = std::make_shared<Batch>(fn, num_tasks);
+    size_t num_helpers = std::min(num_tasks - 1, m_workers.size());
+    for (size_t i = 0; i < num_helpers; ++i) {
+        submit([batch] {
+            batch->run();
+        }); // Throws
+    }
+    batch->run();
+
+    // All calls have been handed out, but some may still be running on other
+    // threads
+    std::unique_lock lock(batch->mutex);
+    batch->cv.wait(lock, [&] {
+        return batch->remaining == 0;
+    });
+
+    if (batch->exception)
+        std::rethrow_exception(batch->exception);
+}
+
+ThreadPool& ThreadPool::get_default()
+{
+    // Intentionally leaked so that the workers are never joined during static
+    // destruction.
+    static ThreadPool& pool = *new ThreadPool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    return pool;
+}
+
+void ThreadPool::worker_main(size_t worker_ndx)
+{
+    t_current_pool = this;
+    t_worker_ndx = worker_ndx;
+
+    for (;;) {
+        if (try_run_task())
+            continue;
+        std::unique_lock lock(m_mutex);
+        m_cv.wait(lock, [&] {
+            return m_stop || m_num_pending > 0;
+        });
+        if (m_stop && m_num_pending == 0)
+            return;
+    }
+}
+
+bool ThreadPool::try_run_task()
+{
+    // A worker prefers the most recently added task of its own queue, as that
+    // is the one most likely to find its data in the cache. Everything else is
+    // taken from the front, i.e. the oldest task is stolen first.
+    bool is_worker = t_current_pool == this;
+    size_t num_workers = m_workers.size();
+    size_t first_ndx = is_worker ? t_worker_ndx : 0;
+
+    Task task;
+    bool found = false;
+    for (size_t i = 0; !found && i < num_workers; ++i) {
+        Worker& worker = *m_workers[(first_ndx + i) % num_workers];
+        found = try_pop(worker, is_worker && i == 0, task);
+    }
+    if (!found)
+        return false;
+
+    {
+        std::lock_guard lock(m_mutex);
+        REALM_ASSERT_DEBUG(m_num_pending > 0);
+        --m_num_pending;
+    }
+    task();
+    return true;
+}
+
+bool ThreadPool::try_pop(Worker& worker, bool from_back, Task& task)
+{
+    std::lock_guard lock(worker.mutex);
+    if (worker.tasks.empty())
+        return false;
+    if (from_back) {
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+    }
+    else {
+        task = std::move(worker.tasks.front());
+        worker.tasks.pop_front();
+    }
+    return true;
+}
+
+} // namespace realm::util
@@ -0,0 +1,140 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_UTIL_THREAD_POOL_HPP
+#define REALM_UTIL_THREAD_POOL_HPP
+
+#include <realm/util/function_ref.hpp>
+#include <realm/util/functional.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace realm::util {
+
+/// A fixed size pool of worker threads with a task queue per worker.
+///
+/// A task submitted from one of the workers is pushed onto that worker's own
+/// queue, which the worker drains in LIFO order. Idle workers steal the oldest
+/// task from the queues of the other workers. Tasks submitted from outside the
+/// pool are distributed round robin.
+///
+/// The pool is intended for splitting up CPU bound work on data which is not
+/// modified while the work is in progress, such as scanning the clusters of a
+/// table in a read transaction.
+///
+/// Tasks must never block on a DB lock such as the write mutex. The pool is
+/// used by threads which may hold those locks, and a task waiting for one of
+/// them would hold up the work of such a thread, or, with as few workers as on
+/// a small device, never run at all. Work which needs to wait for the write
+/// lock belongs on a thread of its own.
+class ThreadPool {
+public:
+    using Task = UniqueFunction<void()>;
+
+    explicit ThreadPool(size_t num_threads);
+    ~ThreadPool() noexcept;
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t num_threads() const noexcept
+    {
+        return m_workers.size();
+    }
+
+    /// Schedule a task for execution on one of the workers. The task must not
+    /// throw. If the pool has no workers, the task is run by the calling thread
+    /// before this returns.
+    void submit(Task task);
+
+    /// Call `fn(0)` ... `fn(num_tasks - 1)` concurrently and return when all
+    /// the calls have completed. The calling thread takes part in the calls,
+    /// and while it waits it only ever runs calls of this batch, never other
+    /// tasks queued on the pool, so this may be called from within a task or
+    /// while holding locks, and works even if the pool has no workers. If any
+    /// of the calls throw, the first exception is rethrown once all calls have
+    /// completed.
+    void run_parallel(size_t num_tasks, FunctionRef<void(size_t)> fn);
+
+    /// The process wide pool, created on first use with one worker less than
+    /// the number of hardware threads (but at least one), as the thread calling
+    /// `run_parallel()` participates in the work.
+    static ThreadPool& get_default();
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    struct Batch;
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    size_t m_num_pending = 0; // Guarded by m_mutex
+    bool m_stop = false;      // Guarded by m_mutex
+    std::atomic<size_t> m_next_worker{0};
+
+    void worker_main(size_t worker_ndx);
+    bool try_run_task();
+    bool try_pop(Worker& worker, bool from_back, Task& task);
+};
+
+/// Sort the elements in [begin, end) like `std::sort()`. Large ranges are
+/// split into runs of at least `min_run_size` elements, which are sorted
+/// concurrently on `pool` and then merged pairwise. `less` is called from
+/// several threads at once, so it must not modify any shared state.
+template <class Iterator, class Less>
+void parallel_sort(ThreadPool& pool, Iterator begin, Iterator end, Less less, size_t min_run_size)
+{
+    size_t size = size_t(end - begin);
+    size_t num_runs = std::min(pool.num_threads() + 1, size / std::max(min_run_size, size_t(1)));
+    if (num_runs < 2) {
+        std::sort(begin, end, less);
+        return;
+    }
+
+    auto run_begin = [&](size_t run) {
+        return begin + std::min(run, num_runs) * size / num_runs;
+    };
+    pool.run_parallel(num_runs, [&](size_t run) {
+        std::sort(run_begin(run), run_begin(run + 1), less);
+    });
+    for (size_t width = 1; width < num_runs; width *= 2) {
+        size_t num_merges = (num_runs + 2 * width - 1) / (2 * width);
+        pool.run_parallel(num_merges, [&](size_t merge) {
+            size_t first = 2 * width * merge;
+            if (first + width < num_runs)
+                std::inplace_merge(run_begin(first), run_begin(first + width), run_begin(first + 2 * width), less);
+        });
+    }
+}
+
+} // namespace realm::util
+
+#endif // REALM_UTIL_THREAD_POOL_HPP
@@ -44,23 +44,36 @@
 namespace {
 
 #ifdef REALM_COMPILER_SSE
-#if !defined __clang__ && ((defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 160040219) || defined __GNUC__)
-#if defined REALM_COMPILER_AVX && defined __GNUC__
-#define _XCR_XFEATURE_ENABLED_MASK 0
+#if (defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 160040219) || defined __GNUC__
+#define REALM_HAVE_XGETBV 1
 
-inline unsigned long long _xgetbv(unsigned index)
+// Contents of the XCR0 register, which tells the register sets the OS preserves across context switches
+inline unsigned long long get_xcr0()
 {
-#if REALM_HAVE_AT_LEAST_GCC(4, 4)
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
     unsigned int eax, edx;
-    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
     return (static_cast<unsigned long long>(edx) << 32) | eax;
-#else
-    static_cast<void>(index);
-    return 0;
 #endif
 }
 
+// The EAX, EBX, ECX and EDX registers returned by the CPUID instruction
+inline void get_cpuid(unsigned leaf, unsigned subleaf, unsigned regs[4])
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuidex(info, int(leaf), int(subleaf));
+    for (int i = 0; i < 4; ++i)
+        regs[i] = unsigned(info[i]);
+#else
+    __asm__ __volatile__("cpuid"
+                         : "=a"(regs[0]), "=b"(regs[1]), "=c"(regs[2]), "=d"(regs[3])
+                         : "a"(leaf), "c"(subleaf));
 #endif
+}
+
 #endif
 #endif
 
@@ -102,28 +115,32 @@ void cpuid_init()
         sse_support = -2;
     }
 
-    bool avxSupported = false;
+    signed char avx = -1; // No AVX supported
 
-// seems like in jenkins builds, __GNUC__ is defined for clang?! todo fixme
-#if !defined __clang__ && ((defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 160040219) || defined __GNUC__)
+#ifdef REALM_HAVE_XGETBV
     bool osUsesXSAVE_XRSTORE = cret & (1 << 27) || false;
     bool cpuAVXSuport = cret & (1 << 28) || false;
 
-    if (osUsesXSAVE_XRSTORE && cpuAVXSuport) {
-        // Check if the OS will save the YMM registers
-        unsigned long long xcrFeatureMask = _xgetbv(_XCR_XFEATURE_ENABLED_MASK);
-        avxSupported = (xcrFeatureMask & 0x6) || false;
+    // Check if the OS will save the YMM registers
+    if (osUsesXSAVE_XRSTORE && cpuAVXSuport && (get_xcr0() & 0x6) == 0x6) {
+        avx = 0; // AVX1 supported
+
+        unsigned regs[4];
+        get_cpuid(0, 0, regs);
+        if (regs[0] >= 7) {
+            get_cpuid(7, 0, regs);
+            bool cpuAVX2Support = regs[1] & (1 << 5);
+            // AVX-512 Foundation and Byte/Word instructions, and the OS must also save the opmask and ZMM registers
+            bool cpuAVX512Support = (regs[1] & (1 << 16)) && (regs[1] & (1 << 30));
+            if (cpuAVX2Support)
+                avx = 1;
+            if (cpuAVX2Support && cpuAVX512Support && (get_xcr0() & 0xe6) == 0xe6)
+                avx = 2;
+        }
     }
 #endif
 
-    if (avxSupported) {
-        avx_support = 0; // AVX1 supported
-    }
-    else {
-        avx_support = -1; // No AVX supported
-    }
-
-    // 1 is reserved for AVX2
+    avx_support = avx;
 
 #endif
 }
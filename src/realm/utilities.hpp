@@ -73,6 +73,17 @@ typedef SSIZE_T ssize_t;
 #define REALM_COMPILER_AVX
 #endif
 
+// Functions using AVX2 or AVX-512 intrinsics must be compiled for that instruction set while the rest of the library
+// is not, and may then only be called after checking sseavx<2>() or sseavx<512>() respectively. MSVC makes all
+// intrinsics available without any annotation.
+#if defined(REALM_COMPILER_AVX) && (defined(__GNUC__) || defined(__clang__))
+#define REALM_TARGET_AVX2 __attribute__((target("avx2")))
+#define REALM_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#else
+#define REALM_TARGET_AVX2
+#define REALM_TARGET_AVX512
+#endif
+
 namespace realm {
 
 using StringCompareCallback = util::UniqueFunction<bool(const char* string1, const char* string2)>;
@@ -93,7 +104,8 @@ REALM_FORCEINLINE bool sseavx()
 
     avx_support = -1: No AVX support
     avx_support = 0: AVX1 supported
-    sse_support = 1: AVX2 supported (not yet implemented for detection in our cpuid_init(), todo)
+    avx_support = 1: AVX2 supported
+    avx_support = 2: AVX-512 F and BW supported (version = 512)
 
     This lets us test very rapidly at runtime because we just need 1 compare instruction (with 0) to test both for
     SSE 3 and 4.2 by caller (compiler optimizes if calls are concecutive), and can decide branch with ja/jl/je because
@@ -102,8 +114,9 @@ REALM_FORCEINLINE bool sseavx()
     We runtime-initialize sse_support in a constructor of a static variable which is not guaranteed to be called
     prior to cpu_sse(). So we compile-time initialize sse_support to -2 as fallback.
     */
-    static_assert(version == 1 || version == 2 || version == 30 || version == 42,
-                  "Only version == 1 (AVX), 2 (AVX2), 30 (SSE 3) and 42 (SSE 4.2) are supported for detection");
+    static_assert(version == 1 || version == 2 || version == 30 || version == 42 || version == 512,
+                  "Only version == 1 (AVX), 2 (AVX2), 512 (AVX-512), 30 (SSE 3) and 42 (SSE 4.2) are supported for "
+                  "detection");
 #ifdef REALM_COMPILER_SSE
     if (version == 30)
         return (sse_support >= 0);
@@ -113,6 +126,8 @@ REALM_FORCEINLINE bool sseavx()
         return (avx_support >= 0);
     else if (version == 2) // avx2
         return (avx_support > 0);
+    else if (version == 512) // avx-512
+        return (avx_support > 1);
     else
         return false;
 #else
@@ -0,0 +1,212 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/zone_map.hpp>
+
+#include <cmath>
+#include <cstring>
+
+using namespace realm;
+
+ZoneMap::ZoneMap(Allocator& alloc)
+    : m_top(alloc)
+    , m_blocks(alloc)
+    , m_mins(alloc)
+    , m_maxs(alloc)
+    , m_flags(alloc)
+{
+    m_top.create(Array::type_HasRefs, false, 4, 0); // Throws
+    _impl::DeepArrayDestroyGuard dg(&m_top);
+    m_blocks.set_parent(&m_top, 0);
+    m_mins.set_parent(&m_top, 1);
+    m_maxs.set_parent(&m_top, 2);
+    m_flags.set_parent(&m_top, 3);
+    m_blocks.create(); // Throws
+    m_mins.create();   // Throws
+    m_maxs.create();   // Throws
+    m_flags.create();  // Throws
+    dg.release();
+}
+
+ZoneMap::ZoneMap(ref_type ref, ArrayParent* parent, size_t ndx_in_parent, Allocator& alloc)
+    : m_top(alloc)
+    , m_blocks(alloc)
+    , m_mins(alloc)
+    , m_maxs(alloc)
+    , m_flags(alloc)
+{
+    m_top.init_from_ref(ref);
+    m_top.set_parent(parent, ndx_in_parent);
+    m_blocks.set_parent(&m_top, 0);
+    m_mins.set_parent(&m_top, 1);
+    m_maxs.set_parent(&m_top, 2);
+    m_flags.set_parent(&m_top, 3);
+    init_trees();
+}
+
+void ZoneMap::init_trees()
+{
+    m_blocks.init_from_parent();
+    m_mins.init_from_parent();
+    m_maxs.init_from_parent();
+    m_flags.init_from_parent();
+}
+
+void ZoneMap::update_from_parent() noexcept
+{
+    m_top.update_from_parent();
+    init_trees();
+}
+
+void ZoneMap::refresh_accessor_tree()
+{
+    m_top.init_from_parent();
+    init_trees();
+}
+
+void ZoneMap::destroy() noexcept
+{
+    m_top.destroy_deep();
+}
+
+std::optional<int64_t> ZoneMap::encode(Mixed value, bool* exact) noexcept
+{
+    if (value.is_null())
+        return {};
+    double d;
+    switch (value.get_type()) {
+        case type_Int:
+            return value.get<Int>();
+        case type_Timestamp:
+            // Values within the same second are not told apart
+            if (exact)
+                *exact = false;
+            return value.get<Timestamp>().get_seconds();
+        case type_Float:
+            d = value.get<float>();
+            break;
+        case type_Double:
+            d = value.get<double>();
+            break;
+        default:
+            REALM_UNREACHABLE();
+    }
+    if (std::isnan(d))
+        return {};
+    if (d == 0)
+        d = 0; // -0.0 and 0.0 are equal
+    // The bits of a non-negative double order like its value. Flipping all bits but the sign bit of a negative
+    // double makes the more negative values the smaller integers.
+    int64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    return bits < 0 ? bits ^ std::numeric_limits<int64_t>::max() : bits;
+}
+
+size_t ZoneMap::lower_bound(int64_t block) const
+{
+    size_t lo = 0;
+    size_t hi = size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (m_blocks.get(mid) < block)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+void ZoneMap::insert(ObjKey key, Mixed value)
+{
+    int64_t block = key.value >> block_shift;
+    int64_t flags = 0;
+    auto v = encode(value);
+    if (value.is_null())
+        flags = has_null;
+    else if (!v)
+        flags = has_nan;
+
+    size_t ndx = lower_bound(block);
+    if (ndx == size() || m_blocks.get(ndx) != block) {
+        Bounds bounds;
+        if (v)
+            bounds.min = bounds.max = *v;
+        m_blocks.insert(ndx, block);       // Throws
+        m_mins.insert(ndx, bounds.min);    // Throws
+        m_maxs.insert(ndx, bounds.max);    // Throws
+        m_flags.insert(ndx, flags);        // Throws
+        return;
+    }
+    if (v) {
+        if (*v < m_mins.get(ndx))
+            m_mins.set(ndx, *v); // Throws
+        if (*v > m_maxs.get(ndx))
+            m_maxs.set(ndx, *v); // Throws
+    }
+    if (flags) {
+        int64_t old_flags = m_flags.get(ndx);
+        if ((old_flags | flags) != old_flags)
+            m_flags.set(ndx, old_flags | flags); // Throws
+    }
+}
+
+void ZoneMap::clear()
+{
+    m_blocks.clear();
+    m_mins.clear();
+    m_maxs.clear();
+    m_flags.clear();
+}
+
+ZoneMap::Bounds ZoneMap::get_bounds(ObjKey first, ObjKey last) const
+{
+    Bounds bounds;
+    int64_t last_block = last.value >> block_shift;
+    size_t sz = size();
+    for (size_t ndx = lower_bound(first.value >> block_shift); ndx < sz && m_blocks.get(ndx) <= last_block; ++ndx) {
+        bounds.min = std::min(bounds.min, m_mins.get(ndx));
+        bounds.max = std::max(bounds.max, m_maxs.get(ndx));
+        bounds.flags |= m_flags.get(ndx);
+    }
+    return bounds;
+}
+
+bool ZoneMap::may_match_between(ObjKey first, ObjKey last, Mixed from, Mixed to) const
+{
+    auto lower = encode(from);
+    auto upper = encode(to);
+    if (!lower || !upper)
+        return true;
+    Bounds bounds = get_bounds(first, last);
+    if (bounds.flags & has_nan)
+        return true;
+    return bounds.max >= *lower && bounds.min <= *upper;
+}
+
+void ZoneMap::verify() const
+{
+    m_blocks.verify();
+    m_mins.verify();
+    m_maxs.verify();
+    m_flags.verify();
+    size_t sz = size();
+    REALM_ASSERT(m_mins.size() == sz && m_maxs.size() == sz && m_flags.size() == sz);
+    for (size_t i = 1; i < sz; ++i) {
+        REALM_ASSERT(m_blocks.get(i - 1) < m_blocks.get(i));
+    }
+}
@@ -0,0 +1,161 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_ZONE_MAP_HPP
+#define REALM_ZONE_MAP_HPP
+
+#include <realm/column_integer.hpp>
+#include <realm/keys.hpp>
+#include <realm/mixed.hpp>
+#include <realm/query_conditions.hpp>
+
+#include <optional>
+
+/*
+A ZoneMap summarizes the values of a column for each block of 2^block_shift consecutive object keys. Objects are
+stored in the clusters in key order, so the blocks overlapping the key range of a cluster summarize all values of
+that cluster, and a query condition which cannot hold for any value in that summary need not look at the cluster.
+
+    top (HasRefs)
+     |-- 0: IntegerColumn  block numbers (object key >> block_shift), ascending
+     |-- 1: IntegerColumn  lower bound of the values in each block
+     |-- 2: IntegerColumn  upper bound of the values in each block
+     `-- 3: IntegerColumn  flags of each block (has_null, has_nan)
+
+The bounds are kept as integers: Int values as they are, Timestamp values by their seconds, and Float and Double
+values by a bit pattern of the value as a double which orders like the value itself. A block which contains NaN is
+never skipped. The bounds are conservative - they are widened when a value is written, but not narrowed again when
+a value is overwritten or an object is erased, so they may cover values which are no longer there. Rebuilding the
+zone map (Table::remove_zone_map() followed by Table::add_zone_map()) makes them tight again.
+*/
+
+namespace realm {
+
+class ZoneMap {
+public:
+    static constexpr int block_shift = 8;
+
+    static bool type_supported(DataType type)
+    {
+        return type == type_Int || type == type_Timestamp || type == type_Float || type == type_Double;
+    }
+
+    explicit ZoneMap(Allocator&);
+    ZoneMap(ref_type, ArrayParent*, size_t ndx_in_parent, Allocator&);
+
+    ref_type get_ref() const noexcept
+    {
+        return m_top.get_ref();
+    }
+    void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept
+    {
+        m_top.set_parent(parent, ndx_in_parent);
+    }
+    void update_from_parent() noexcept;
+    void refresh_accessor_tree();
+    void destroy() noexcept;
+
+    /// Widen the bounds of the block of `key` to include `value`.
+    void insert(ObjKey key, Mixed value);
+    void clear();
+
+    /// False if no object with a key in [first, last] can have a value v for which TConditionFunction()(v, value)
+    /// is true. Only Equal, NotEqual, Greater, GreaterEqual, Less and LessEqual are taken into account - any other
+    /// condition may match.
+    template <class TConditionFunction>
+    bool may_match(ObjKey first, ObjKey last, Mixed value) const;
+    /// False if no object with a key in [first, last] can have a value in [from, to].
+    bool may_match_between(ObjKey first, ObjKey last, Mixed from, Mixed to) const;
+
+    /// Number of key blocks summarized.
+    size_t size() const noexcept
+    {
+        return m_blocks.size();
+    }
+
+    void verify() const;
+
+    /// The integer a value is represented by in the bounds, or none for null and NaN. `exact` is set to false if
+    /// different values may be represented by the same integer.
+    static std::optional<int64_t> encode(Mixed value, bool* exact = nullptr) noexcept;
+
+private:
+    enum : int64_t { has_null = 1, has_nan = 2 };
+
+    struct Bounds {
+        int64_t min = std::numeric_limits<int64_t>::max();
+        int64_t max = std::numeric_limits<int64_t>::min();
+        int64_t flags = 0;
+    };
+
+    // The bounds of all blocks overlapping [first, last]
+    Bounds get_bounds(ObjKey first, ObjKey last) const;
+    // Position of the first block not less than `block`
+    size_t lower_bound(int64_t block) const;
+    void init_trees();
+
+    Array m_top;
+    IntegerColumn m_blocks;
+    IntegerColumn m_mins;
+    IntegerColumn m_maxs;
+    IntegerColumn m_flags;
+};
+
+template <class TConditionFunction>
+bool ZoneMap::may_match(ObjKey first, ObjKey last, Mixed value) const
+{
+    if constexpr (!is_any_v<TConditionFunction, Equal, NotEqual, Greater, GreaterEqual, Less, LessEqual>) {
+        return true;
+    }
+    else {
+        Bounds bounds = get_bounds(first, last);
+        if (value.is_null()) {
+            // Only Equal and NotEqual match null values, and both match null against null
+            if constexpr (std::is_same_v<TConditionFunction, Equal>)
+                return bounds.flags & has_null;
+            else
+                return true;
+        }
+        bool exact = true;
+        auto v = encode(value, &exact);
+        if (!v || (bounds.flags & has_nan))
+            return true;
+        if constexpr (std::is_same_v<TConditionFunction, Equal>) {
+            return bounds.min <= *v && *v <= bounds.max;
+        }
+        else if constexpr (std::is_same_v<TConditionFunction, NotEqual>) {
+            return !exact || (bounds.flags & has_null) || bounds.min != *v || bounds.max != *v;
+        }
+        else if constexpr (std::is_same_v<TConditionFunction, Greater>) {
+            return exact ? bounds.max > *v : bounds.max >= *v;
+        }
+        else if constexpr (std::is_same_v<TConditionFunction, GreaterEqual>) {
+            return bounds.max >= *v;
+        }
+        else if constexpr (std::is_same_v<TConditionFunction, Less>) {
+            return exact ? bounds.min < *v : bounds.min <= *v;
+        }
+        else {
+            return bounds.min <= *v;
+        }
+    }
+}
+
+} // namespace realm
+
+#endif // REALM_ZONE_MAP_HPP
@@ -3271,6 +3271,166 @@ TEST_CASE("results: notifications after move", "[notifications][results]") {
     }
 }
 
+TEST_CASE("results: notifications for small changes to large results", "[notifications][results]") {
+    // Small changes to a large table are merged into the previous results
+    // rather than running the query again, which must give the same results
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object",
+         {
+             {"value", PropertyType::Int},
+             {"name", PropertyType::String},
+         }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+    auto col_value = table->get_column_key("value");
+    auto col_name = table->get_column_key("name");
+    const char* names[] = {"a", "b", "c", "d", "e"};
+
+    r->begin_transaction();
+    for (int i = 0; i < 2000; ++i)
+        table->create_object().set_all(i % 97, StringData(names[i % 5]));
+    r->commit_transaction();
+
+    auto query = table->where().greater(col_value, 10).less(col_value, 90);
+    Results unsorted(r, query);
+    Results sorted = unsorted.sort(SortDescriptor({{col_value}, {col_name}}, {false, true}));
+
+    auto get_keys = [](Results& results) {
+        std::vector<ObjKey> keys;
+        for (size_t i = 0; i < results.size(); ++i)
+            keys.push_back(results.get(i).get_key());
+        return keys;
+    };
+    auto check_results = [&](Results& results, Results&& expected, const std::vector<ObjKey>& previous,
+                             const CollectionChangeSet& change) {
+        auto keys = get_keys(results);
+        REQUIRE(keys == get_keys(expected));
+        REQUIRE(previous.size() - change.deletions.count() + change.insertions.count() == keys.size());
+    };
+
+    CollectionChangeSet unsorted_change, sorted_change;
+    auto unsorted_token = unsorted.add_notification_callback([&](CollectionChangeSet c) {
+        unsorted_change = c;
+    });
+    auto sorted_token = sorted.add_notification_callback([&](CollectionChangeSet c) {
+        sorted_change = c;
+    });
+    advance_and_notify(*r);
+
+    for (int i = 0; i < 20; ++i) {
+        auto previous_unsorted = get_keys(unsorted);
+        auto previous_sorted = get_keys(sorted);
+        unsorted_change = {};
+        sorted_change = {};
+
+        r->begin_transaction();
+        table->create_object().set_all(i * 37 % 100, StringData(names[i % 5]));
+        table->get_object(size_t(i * 53 % table->size())).set(col_value, i * 11 % 100);
+        table->get_object(size_t(i * 71 % table->size())).set(col_name, StringData(names[(i + 2) % 5]));
+        table->get_object(size_t(i * 89 % table->size())).remove();
+        r->commit_transaction();
+        advance_and_notify(*r);
+
+        check_results(unsorted, Results(r, query), previous_unsorted, unsorted_change);
+        check_results(sorted, Results(r, query).sort(SortDescriptor({{col_value}, {col_name}}, {false, true})),
+                      previous_sorted, sorted_change);
+    }
+
+    SECTION("deleting a matching object is reported as a deletion") {
+        auto previous = get_keys(sorted);
+        r->begin_transaction();
+        table->remove_object(previous[5]);
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE_INDICES(sorted_change.deletions, 5);
+        REQUIRE(sorted_change.insertions.empty());
+    }
+
+    SECTION("modifying a matching object in place is reported as a modification") {
+        auto previous = get_keys(unsorted);
+        r->begin_transaction();
+        table->get_object(previous[3]).set(col_name, StringData("z"));
+        r->commit_transaction();
+        advance_and_notify(*r);
+        REQUIRE_INDICES(unsorted_change.modifications, 3);
+        REQUIRE(unsorted_change.deletions.empty());
+        REQUIRE(unsorted_change.insertions.empty());
+    }
+}
+
+TEST_CASE("results: notifications for large results with links to the same table", "[notifications][results]") {
+    // A change to an object can change the results through the objects linking
+    // to it, so these queries are run again rather than merged
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object",
+         {
+             {"value", PropertyType::Int},
+             {"name", PropertyType::String},
+             {"parent", PropertyType::Object | PropertyType::Nullable, "object"},
+         }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+    auto col_value = table->get_column_key("value");
+    auto col_name = table->get_column_key("name");
+    auto col_parent = table->get_column_key("parent");
+    const char* names[] = {"a", "b", "c", "d", "e"};
+
+    r->begin_transaction();
+    std::vector<ObjKey> keys;
+    for (int i = 0; i < 2000; ++i) {
+        auto obj = table->create_object().set_all(i % 97, StringData(names[i % 5]));
+        if (i > 0)
+            obj.set(col_parent, keys[(i * 37 + 11) % i]);
+        keys.push_back(obj.get_key());
+    }
+    r->commit_transaction();
+
+    auto get_keys = [](Results& results) {
+        std::vector<ObjKey> keys;
+        for (size_t i = 0; i < results.size(); ++i)
+            keys.push_back(results.get(i).get_key());
+        return keys;
+    };
+    auto by_parent_value = [&] {
+        return Results(r, table->query("parent.value > 50"));
+    };
+    auto by_child_value = [&] {
+        return Results(r, table->query("@links.object.parent.value > 50"));
+    };
+    auto sorted_by_parent_name = [&] {
+        return Results(r, table->query("value > 10")).sort(SortDescriptor({{col_parent, col_name}, {col_value}}));
+    };
+
+    Results results[] = {by_parent_value(), by_child_value(), sorted_by_parent_name()};
+    std::vector<NotificationToken> tokens;
+    for (auto& result : results)
+        tokens.push_back(result.add_notification_callback([](CollectionChangeSet) {}));
+    advance_and_notify(*r);
+
+    for (int i = 0; i < 10; ++i) {
+        r->begin_transaction();
+        auto parent = table->get_object(keys[i * 7 % 100]);
+        parent.set(col_value, parent.get<Int>(col_value) > 50 ? 0 : 100);
+        parent.set(col_name, StringData(names[(i + 3) % 5]));
+        r->commit_transaction();
+        advance_and_notify(*r);
+
+        Results expected[] = {by_parent_value(), by_child_value(), sorted_by_parent_name()};
+        for (size_t j = 0; j < 3; ++j)
+            REQUIRE(get_keys(results[j]) == get_keys(expected[j]));
+    }
+}
+
 TEST_CASE("results: notifier with no callbacks", "[notifications][results]") {
     _impl::RealmCoordinator::assert_no_open_realms();
     InMemoryTestFile config;
@@ -312,6 +312,65 @@ TEST(Alloc_Fuzzy)
     }
 }
 
+TEST(Alloc_SizeClasses)
+{
+    SlabAlloc alloc;
+    alloc.attach_empty();
+
+    auto alloc_with_capacity = [&](size_t size) {
+        MemRef r = alloc.alloc(size);
+        set_capacity(r.get_addr(), size);
+        return r;
+    };
+
+    // A freed small block is reused for the next allocation of the same size
+    MemRef a = alloc_with_capacity(64);
+    MemRef b = alloc_with_capacity(64);
+    MemRef c = alloc_with_capacity(64);
+    alloc.free_(b.get_ref(), b.get_addr());
+    MemRef d = alloc_with_capacity(64);
+    CHECK_EQUAL(d.get_ref(), b.get_ref());
+
+    // Adjacent free blocks are merged, and the merged block is reused when it fits exactly
+    MemRef x = alloc_with_capacity(2048);
+    MemRef y = alloc_with_capacity(2048);
+    MemRef z = alloc_with_capacity(2048);
+    MemRef guard = alloc_with_capacity(8);
+    alloc.free_(y.get_ref(), y.get_addr());
+    alloc.free_(x.get_ref(), x.get_addr());
+    alloc.free_(z.get_ref(), z.get_addr());
+    MemRef merged = alloc_with_capacity(z.get_ref() + 2048 - x.get_ref());
+    CHECK_EQUAL(merged.get_ref(), x.get_ref());
+
+    for (MemRef r : {a, c, d, guard, merged})
+        alloc.free_(r.get_ref(), r.get_addr());
+
+    // Allocations of all sizes never overlap
+    test_util::Random random(test_util::random_int<unsigned long>()); // Seed from slow global generator
+    std::map<ref_type, size_t> live;
+    for (int i = 0; i < 20000; ++i) {
+        if (live.empty() || random.chance(11, 20)) {
+            size_t size = random.chance(1, 10) ? random.draw_int(1, 8192) * 8 : random.draw_int(1, 128) * 8;
+            MemRef r = alloc_with_capacity(size);
+            auto next = live.lower_bound(r.get_ref());
+            CHECK(next == live.end() || r.get_ref() + size <= next->first);
+            CHECK(next == live.begin() || std::prev(next)->first + std::prev(next)->second <= r.get_ref());
+            live.emplace(r.get_ref(), size);
+        }
+        else {
+            auto it = live.begin();
+            std::advance(it, random.draw_int_mod(live.size()));
+            alloc.free_(it->first, alloc.translate(it->first));
+            live.erase(it);
+        }
+    }
+    for (auto& [ref, size] : live)
+        alloc.free_(ref, alloc.translate(ref));
+
+    // SlabAlloc destructor will verify that all is free'd
+}
+
+
 NONCONCURRENT_TEST_IF(Alloc_MapFailureRecovery, _impl::SimulatedFailure::is_enabled())
 {
     GROUP_TEST_PATH(path);
@@ -1494,6 +1494,102 @@ TEST(Array_get_sum)
     c.destroy();
 }
 
+namespace {
+
+template <class Cond>
+void check_find(TestContext& test_context, const Array& a, int64_t value, size_t start, size_t end)
+{
+    std::vector<ObjKey> expected;
+    for (size_t i = start; i < end; ++i) {
+        if (Cond()(a.get(i), value))
+            expected.push_back(ObjKey(int64_t(i)));
+    }
+
+    std::vector<ObjKey> found;
+    QueryStateFindAll<std::vector<ObjKey>> state(found);
+    ArrayWithFind(a).find<Cond>(value, start, end, 0, &state);
+    CHECK(found == expected);
+
+    // Stop after a few matches
+    found.clear();
+    QueryStateFindAll<std::vector<ObjKey>> limited_state(found, 3);
+    ArrayWithFind(a).find<Cond>(value, start, end, 0, &limited_state);
+    expected.resize(std::min<size_t>(expected.size(), 3));
+    CHECK(found == expected);
+}
+
+} // anonymous namespace
+
+// Compare the SIMD searches and aggregates with a naive evaluation, for each element width and for each instruction
+// set supported by this CPU. The ranges cover the unaligned elements before and after the vectors. NONCONCURRENT
+// because the instruction set in use is process wide.
+NONCONCURRENT_TEST(Array_FindVectorized)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Array a(Allocator::get_default());
+    a.create(Array::type_Normal);
+
+    const signed char avx_level = avx_support;
+    for (size_t width : {1, 2, 4, 8, 16, 32, 64}) {
+        // Widths below 8 are unsigned. The 64 bit values are kept small enough for the sums not to overflow.
+        const size_t bits = std::min<size_t>(width, 41);
+        const int64_t lbound = width < 8 ? 0 : -(int64_t(1) << (bits - 1));
+        const int64_t ubound = width < 8 ? (int64_t(1) << width) - 1 : (int64_t(1) << (bits - 1)) - 1;
+
+        // Draw from a few distinct values so that there are plenty of equal elements
+        std::vector<int64_t> values = {lbound, ubound};
+        for (int i = 0; i < 4; ++i)
+            values.push_back(random.draw_int<int64_t>(lbound, ubound));
+
+        a.clear();
+        for (size_t i = 0; i < 1500; ++i)
+            a.add(values[random.draw_int_mod(values.size())]);
+        a.set(700, lbound);
+        a.set(701, ubound);
+        CHECK_EQUAL(a.get_width(), width);
+
+        for (signed char level = avx_level; level >= -1; --level) {
+            if (level == 0)
+                continue; // AVX1 has no integer instructions
+            avx_support = level;
+
+            for (auto [start, end] : {std::pair<size_t, size_t>{0, 1500}, {3, 1497}, {1, 300}, {129, 1111}}) {
+                for (int64_t value : values) {
+                    check_find<Equal>(test_context, a, value, start, end);
+                    check_find<NotEqual>(test_context, a, value, start, end);
+                    check_find<Greater>(test_context, a, value, start, end);
+                    check_find<Less>(test_context, a, value, start, end);
+                }
+
+                int64_t sum = 0;
+                int64_t min = a.get(start);
+                int64_t max = a.get(start);
+                for (size_t i = start; i < end; ++i) {
+                    sum = int64_t(uint64_t(sum) + uint64_t(a.get(i)));
+                    min = std::min(min, a.get(i));
+                    max = std::max(max, a.get(i));
+                }
+                CHECK_EQUAL(a.get_sum(start, end), sum);
+
+                int64_t result;
+                size_t ndx;
+                CHECK(a.minimum(result, start, end, &ndx));
+                CHECK_EQUAL(result, min);
+                CHECK_EQUAL(ndx, a.find_first(min, start, end));
+                CHECK(a.maximum(result, start, end, &ndx));
+                CHECK_EQUAL(result, max);
+                CHECK_EQUAL(ndx, a.find_first(max, start, end));
+            }
+            int64_t result;
+            CHECK_NOT(a.minimum(result, 5, 5));
+            CHECK_NOT(a.maximum(result, 5, 5));
+        }
+        avx_support = avx_level;
+    }
+
+    a.destroy();
+}
+
 // NONCONCURRENT because if run in parallel with other tests which request large amounts of
 // memory, there may be a std::bad_alloc on low memory machines
 NONCONCURRENT_TEST(Array_count)
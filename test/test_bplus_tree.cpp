@@ -22,6 +22,7 @@
 
 #include "test.hpp"
 
+#include <algorithm>
 #include <chrono>
 // #include <valgrind/callgrind.h>
 
@@ -103,6 +104,47 @@ TEST(BPlusTree_Integer)
     tree.destroy();
 }
 
+TEST(BPlusTree_PartitionPoint)
+{
+    BPlusTree<Int> tree(Allocator::get_default());
+    tree.create();
+    auto all = [](size_t, Int) {
+        return true;
+    };
+    CHECK_EQUAL(tree.partition_point(all), 0u);
+
+    // Several leaves, in the compact and then in the general form
+    std::vector<Int> values;
+    for (int i = 0; i < 2500; i++) {
+        values.push_back(i / 3);
+        tree.add(i / 3);
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        for (Int v : {-1, 0, 1, 332, 333, 334, 500, 833, 834}) {
+            auto less = [&](size_t, Int x) {
+                return x < v;
+            };
+            auto less_equal = [&](size_t, Int x) {
+                return x <= v;
+            };
+            size_t lower = std::lower_bound(values.begin(), values.end(), v) - values.begin();
+            size_t upper = std::upper_bound(values.begin(), values.end(), v) - values.begin();
+            CHECK_EQUAL(tree.partition_point(less), lower);
+            CHECK_EQUAL(tree.partition_point(less_equal), upper);
+        }
+        // The index of each element is passed along with it
+        auto first = [](size_t ndx, Int) {
+            return ndx < 1234;
+        };
+        CHECK_EQUAL(tree.partition_point(first), 1234u);
+        CHECK_EQUAL(tree.partition_point(all), values.size());
+
+        values.insert(values.begin() + 10, 3);
+        tree.insert(10, 3);
+    }
+    tree.destroy();
+}
+
 TEST(BPlusTree_Timestamp)
 {
     BPlusTree<Timestamp> tree(Allocator::get_default());
@@ -23,6 +23,8 @@
 
 #include <iostream>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 
 // #include <valgrind/callgrind.h>
 
@@ -204,6 +206,93 @@ TEST_TYPES(Compaction_Large, std::true_type, std::false_type)
     }
 }
 
+TEST(Compaction_Async)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options;
+    options.enable_async_writes = true;
+    DBRef db = DB::create(make_in_realm_history(), path, options);
+    std::string blob(1000, 'x');
+    {
+        auto tr = db->start_write();
+        auto table = tr->add_table("garbage");
+        auto col = table->add_column(type_Binary, "bin");
+        for (int i = 0; i < 1500; ++i)
+            table->create_object().set(col, BinaryData(blob));
+        tr->commit();
+    }
+    {
+        auto tr = db->start_write();
+        auto table = tr->add_table("keep");
+        auto col = table->add_column(type_Binary, "bin");
+        for (int i = 0; i < 1000; ++i)
+            table->create_object().set(col, BinaryData(blob));
+        tr->commit();
+    }
+    {
+        // Less than twice as much free as used space, so no evacuation starts by itself
+        auto tr = db->start_write();
+        tr->get_table("garbage")->clear();
+        tr->commit();
+    }
+    CHECK(db->get_evacuation_stage() == DB::EvacStage::idle);
+    size_t size_before = size_t(File(path).get_size());
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::optional<DB::CompactionProgress> result;
+    size_t num_calls = 0;
+    db->async_compact(
+        [&](const DB::CompactionProgress& progress) {
+            std::lock_guard lock(mutex);
+            ++num_calls;
+            if (progress.done || progress.error || num_calls == 1000) {
+                result = progress;
+                cv.notify_one();
+                return false;
+            }
+            return true;
+        },
+        0x10000);
+
+    // Readers and writers are not blocked while the compaction runs
+    for (int i = 0; i < 20; ++i) {
+        auto tr = db->start_write();
+        tr->get_table("keep")->get_object(i).set("bin", BinaryData(blob.data(), 500));
+        tr->commit();
+        auto rt = db->start_read();
+        CHECK_EQUAL(rt->get_table("keep")->size(), 1000);
+    }
+
+    std::unique_lock lock(mutex);
+    cv.wait(lock, [&] {
+        return result.has_value();
+    });
+    CHECK(result->done);
+    CHECK_NOT(result->error);
+    CHECK_GREATER(result->num_commits, 1);
+    CHECK_EQUAL(result->num_commits, num_calls);
+    CHECK_LESS(result->file_size, size_before);
+    CHECK_EQUAL(size_t(File(path).get_size()), result->file_size);
+
+    auto rt = db->start_read();
+    rt->verify();
+    auto table = rt->get_table("keep");
+    CHECK_EQUAL(table->size(), 1000);
+    CHECK_EQUAL(table->get_object(0).get<Binary>("bin").size(), 500);
+    CHECK_EQUAL(table->get_object(999).get<Binary>("bin"), BinaryData(blob));
+}
+
+TEST(Compaction_AsyncRequiresAsyncWrites)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = DB::create(make_in_realm_history(), path);
+    CHECK_THROW(db->async_compact([](const DB::CompactionProgress&) {
+        return true;
+    }),
+                Exception);
+}
+
 NONCONCURRENT_TEST(Compaction_Performance)
 {
     auto old_disable_sync_to_disk = get_disable_sync_to_disk();
@@ -27,6 +27,9 @@
 
 #include "test.hpp"
 
+#include <random>
+#include <thread>
+
 // Test independence and thread-safety
 // -----------------------------------
 //
@@ -470,6 +473,61 @@ TEST(EncryptedFile_MultipleReaders)
     }
 }
 
+TEST(EncryptedFile_ConcurrentReadBarriers)
+{
+    const size_t page_size = 4096;
+    const size_t count = page_size * 64 * 3; // three metablocks of data
+    TEST_PATH(path);
+
+    auto expected = [](size_t i) {
+        return char(i * 7 + i / page_size);
+    };
+    {
+        File w(path, File::mode_Write);
+        w.set_encryption_key(test_util::crypt_key(true));
+        w.resize(count);
+        File::Map<char> map(w, File::access_ReadWrite, count);
+        util::encryption_read_barrier(map, 0, count);
+        for (size_t i = 0; i < count; ++i)
+            map.get_addr()[i] = expected(i);
+        realm::util::encryption_write_barrier(map, 0, count);
+        map.flush();
+    }
+
+    // The threads decrypt pages on first access, in runs which include some
+    // read-ahead, while the others read pages which are already decrypted
+    // without taking the mutex
+    File r(path, File::mode_Read);
+    r.set_encryption_key(test_util::crypt_key(true));
+    File::Map<char> map(r, File::access_ReadOnly, count);
+    std::atomic<size_t> mismatches{0};
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 random(t);
+            for (size_t n = 0; n < 1000; ++n) {
+                size_t pos = random() % count;
+                size_t size = std::min<size_t>(count - pos, 1 + random() % (3 * page_size));
+                util::encryption_read_barrier(map, pos, size);
+                for (size_t i = pos; i < pos + size; ++i) {
+                    if (map.get_addr()[i] != expected(i))
+                        ++mismatches;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    CHECK_EQUAL(mismatches.load(), 0u);
+
+    util::encryption_read_barrier(map, 0, count);
+    for (size_t i = 0; i < count; ++i) {
+        if (map.get_addr()[i] != expected(i))
+            ++mismatches;
+    }
+    CHECK_EQUAL(mismatches.load(), 0u);
+}
+
 TEST(EncryptedFile_IVsAreRereadOnlyWhenObserverIsPresent)
 {
     TEST_PATH(path);
@@ -507,22 +565,23 @@ TEST(EncryptedFile_IVsAreRereadOnlyWhenObserverIsPresent)
     } r3_observer;
     map_r3.get_encrypted_mapping()->set_observer(&r3_observer);
 
-    // Reads the entire IV block and first page of data
-    encryption_read_barrier(map_r1, 0, page_size);
-    encryption_read_barrier(map_r2, 0, page_size);
-    encryption_read_barrier(map_r3, 0, page_size);
+    // Reads the entire IV block and last page of data. The last page is used
+    // as there are no further pages to read ahead.
+    encryption_read_barrier(map_r1, size - page_size, page_size);
+    encryption_read_barrier(map_r2, size - page_size, page_size);
+    encryption_read_barrier(map_r3, size - page_size, page_size);
 
-    encryption_read_barrier(map_w, page_size, size - page_size);
-    encryption_write_barrier(map_w, page_size, size - page_size);
+    encryption_read_barrier(map_w, 0, size - page_size);
+    encryption_write_barrier(map_w, 0, size - page_size);
     map_w.flush();
 
     // No observer, so it uses the cached IV/hmac
-    CHECK_THROW(encryption_read_barrier(map_r1, page_size, 1), DecryptionFailed);
+    CHECK_THROW(encryption_read_barrier(map_r1, 0, 1), DecryptionFailed);
     // Observer says no concurrent writers, so it uses the cached IV/hmac
-    CHECK_THROW(encryption_read_barrier(map_r2, page_size, 1), DecryptionFailed);
+    CHECK_THROW(encryption_read_barrier(map_r2, 0, 1), DecryptionFailed);
     // Observer says there are concurrent writers, so it rereads the IV after
     // decryption fails the first time
-    encryption_read_barrier(map_r3, page_size, 1);
+    encryption_read_barrier(map_r3, 0, 1);
 }
 
 TEST(EncryptedFile_Truncation)
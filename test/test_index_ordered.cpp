@@ -0,0 +1,418 @@
+/*************************************************************************
+ *
+ * Copyright 2023 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_ORDERED
+
+#include <realm.hpp>
+#include <realm/index_ordered.hpp>
+#include <realm/history.hpp>
+
+#include <algorithm>
+
+#include "test.hpp"
+#include "util/random.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+using unit_test::TestContext;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+
+
+namespace {
+
+// Keys of the objects of `table` for which `pred(value)` holds, in table order
+template <class Pred>
+std::vector<ObjKey> brute_force(const Table& table, ColKey col, Pred pred)
+{
+    std::vector<ObjKey> result;
+    for (auto& obj : table) {
+        if (pred(obj.get_any(col)))
+            result.push_back(obj.get_key());
+    }
+    return result;
+}
+
+std::vector<ObjKey> keys_of(const TableView& tv)
+{
+    std::vector<ObjKey> result;
+    for (size_t i = 0; i < tv.size(); ++i)
+        result.push_back(tv.get_key(i));
+    return result;
+}
+
+void check_index(TestContext& test_context, const Table& table, ColKey col)
+{
+    auto index = dynamic_cast<const OrderedIndex*>(table.get_search_index(col));
+    CHECK(index);
+    if (!index)
+        return;
+    index->verify();
+    CHECK_EQUAL(index->size(), table.size());
+    for (size_t i = 0; i < index->size(); ++i) {
+        CHECK_EQUAL(table.get_object(index->get_key(i)).get_any(col), index->get(i));
+        if (i > 0)
+            CHECK_LESS_EQUAL(index->get(i - 1).compare(index->get(i)), 0);
+    }
+}
+
+} // unnamed namespace
+
+
+TEST(OrderedIndex_Types)
+{
+    Group g;
+    auto table = g.add_table("table");
+    auto col_int = table->add_column(type_Int, "int", true);
+    auto col_float = table->add_column(type_Float, "float");
+    auto col_double = table->add_column(type_Double, "double", true);
+    auto col_decimal = table->add_column(type_Decimal, "decimal");
+    auto col_ts = table->add_column(type_Timestamp, "timestamp", true);
+    auto col_oid = table->add_column(type_ObjectId, "oid");
+    auto col_string = table->add_column(type_String, "string", true);
+    std::vector<ColKey> cols = {col_int, col_float, col_double, col_decimal, col_ts, col_oid, col_string};
+
+    // Index some columns before and some after adding the objects
+    for (size_t i = 0; i < cols.size(); i += 2)
+        table->add_search_index(cols[i], IndexType::Ordered);
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    auto random_string = [&] {
+        std::string s;
+        size_t len = random.draw_int<size_t>(0, 12);
+        for (size_t i = 0; i < len; ++i)
+            s += char('a' + random.draw_int<int>(0, 3));
+        return s;
+    };
+    for (int i = 0; i < 500; ++i) {
+        Obj obj = table->create_object();
+        if (random.draw_int<int>(0, 9) > 0)
+            obj.set(col_int, random.draw_int<int64_t>(-100, 100));
+        obj.set(col_float, float(random.draw_int<int>(-50, 50)) / 4);
+        if (random.draw_int<int>(0, 9) > 0)
+            obj.set(col_double, double(random.draw_int<int>(-50, 50)) / 8);
+        obj.set(col_decimal, Decimal128(random.draw_int<int>(-1000, 1000)));
+        if (random.draw_int<int>(0, 9) > 0)
+            obj.set(col_ts, Timestamp(random.draw_int<int64_t>(0, 1000), 0));
+        obj.set(col_oid, ObjectId::gen());
+        if (random.draw_int<int>(0, 9) > 0)
+            obj.set(col_string, random_string());
+    }
+
+    for (size_t i = 1; i < cols.size(); i += 2)
+        table->add_search_index(cols[i], IndexType::Ordered);
+    for (auto col : cols) {
+        CHECK_EQUAL(table->search_index_type(col), IndexType::Ordered);
+        check_index(test_context, *table, col);
+    }
+
+    // Modify and remove objects
+    for (int i = 0; i < 300; ++i) {
+        Obj obj = table->get_object(random.draw_int<size_t>(0, table->size() - 1));
+        switch (random.draw_int<int>(0, 3)) {
+            case 0:
+                obj.set_null(col_int);
+                obj.set(col_string, random_string());
+                break;
+            case 1:
+                obj.set(col_int, random.draw_int<int64_t>(-100, 100));
+                obj.set(col_ts, Timestamp(random.draw_int<int64_t>(0, 1000), 0));
+                break;
+            case 2:
+                obj.set(col_double, double(random.draw_int<int>(-50, 50)) / 8);
+                if (!obj.is_null(col_int))
+                    obj.add_int(col_int, 1);
+                break;
+            case 3:
+                obj.remove();
+                break;
+        }
+    }
+    for (auto col : cols)
+        check_index(test_context, *table, col);
+    table->verify();
+
+    // Lookups through the SearchIndex interface
+    for (auto col : cols) {
+        auto index = table->get_search_index(col);
+        Mixed value = table->get_object(table->size() / 2).get_any(col);
+        auto expected = brute_force(*table, col, [&](Mixed v) {
+            return v.compare(value) == 0;
+        });
+        std::vector<ObjKey> found;
+        index->find_all(found, value);
+        CHECK(found == expected);
+        CHECK_EQUAL(index->count(value), expected.size());
+        CHECK_EQUAL(index->find_first(value), expected.front());
+    }
+
+    // Changing the index type rebuilds the index
+    table->add_search_index(col_int, IndexType::General);
+    CHECK_EQUAL(table->search_index_type(col_int), IndexType::General);
+    table->add_search_index(col_int, IndexType::Ordered);
+    check_index(test_context, *table, col_int);
+    table->remove_search_index(col_int);
+    CHECK_EQUAL(table->search_index_type(col_int), IndexType::None);
+
+    table->clear();
+    for (auto col : cols) {
+        if (auto index = table->get_search_index(col))
+            CHECK(index->is_empty());
+    }
+}
+
+TEST(OrderedIndex_Unsupported)
+{
+    Group g;
+    auto table = g.add_table_with_primary_key("table", type_Int, "pk");
+    auto col_bool = table->add_column(type_Bool, "bool");
+    auto col_list = table->add_column_list(type_Int, "list");
+    auto col_double = table->add_column(type_Double, "double");
+
+    CHECK_THROW(table->add_search_index(col_bool, IndexType::Ordered), IllegalOperation);
+    CHECK_THROW(table->add_search_index(col_list, IndexType::Ordered), IllegalOperation);
+    CHECK_THROW(table->add_search_index(table->get_primary_key_column(), IndexType::Ordered), InvalidColumnKey);
+    CHECK_THROW(table->add_search_index(col_double, IndexType::General), IllegalOperation);
+
+    table->add_search_index(col_double, IndexType::Ordered);
+    CHECK_THROW(table->set_primary_key_column(col_double), InvalidColumnKey);
+}
+
+TEST(OrderedIndex_RangeQueries)
+{
+    Group g;
+    auto table = g.add_table("table");
+    auto col_int = table->add_column(type_Int, "int");
+    auto col_int_null = table->add_column(type_Int, "int_null", true);
+    auto col_ts = table->add_column(type_Timestamp, "timestamp", true);
+    auto col_other = table->add_column(type_Int, "other");
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    for (int i = 0; i < 3000; ++i) {
+        Obj obj = table->create_object();
+        obj.set(col_int, random.draw_int<int64_t>(0, 999));
+        if (random.draw_int<int>(0, 4) > 0)
+            obj.set(col_int_null, random.draw_int<int64_t>(0, 999));
+        if (random.draw_int<int>(0, 4) > 0)
+            obj.set(col_ts, Timestamp(random.draw_int<int64_t>(0, 999), 0));
+        obj.set(col_other, random.draw_int<int64_t>(0, 1));
+    }
+
+    // Run every query both with and without an index, and against the brute force result
+    auto check_queries = [&](bool indexed) {
+        for (int64_t v : {-1, 0, 17, 500, 950, 998, 999, 1000}) {
+            for (ColKey col : {col_int, col_int_null}) {
+                auto cmp = [&](Mixed m) {
+                    return m.is_null() ? 2 : (m.get_int() < v ? -1 : (m.get_int() == v ? 0 : 1));
+                };
+                CHECK(keys_of(table->where().greater(col, v).find_all()) == brute_force(*table, col, [&](Mixed m) {
+                    return cmp(m) == 1;
+                }));
+                CHECK(keys_of(table->where().greater_equal(col, v).find_all()) ==
+                      brute_force(*table, col, [&](Mixed m) {
+                          return cmp(m) == 1 || cmp(m) == 0;
+                      }));
+                CHECK(keys_of(table->where().less(col, v).find_all()) == brute_force(*table, col, [&](Mixed m) {
+                    return cmp(m) == -1;
+                }));
+                CHECK(keys_of(table->where().less_equal(col, v).find_all()) ==
+                      brute_force(*table, col, [&](Mixed m) {
+                          return cmp(m) == -1 || cmp(m) == 0;
+                      }));
+                CHECK_EQUAL(table->where().between(col, v, v + 20).count(),
+                            brute_force(*table, col, [&](Mixed m) {
+                                return !m.is_null() && m.get_int() >= v && m.get_int() <= v + 20;
+                            }).size());
+                CHECK_EQUAL(table->where().greater(col, v).equal(col_other, 1).count(),
+                            brute_force(*table, col, [&](Mixed m) {
+                                return cmp(m) == 1;
+                            }).size() -
+                                table->where().greater(col, v).equal(col_other, 0).count());
+                auto sum = table->where().greater(col, v).sum(col_other);
+                CHECK(sum);
+                CHECK_EQUAL(sum->get_int(), int64_t(table->where().greater(col, v).equal(col_other, 1).count()));
+            }
+            Timestamp ts(v, 0);
+            CHECK(keys_of(table->where().greater(col_ts, ts).find_all()) == brute_force(*table, col_ts, [&](Mixed m) {
+                return !m.is_null() && m.get_timestamp() > ts;
+            }));
+            CHECK(keys_of(table->where().less_equal(col_ts, ts).find_all()) ==
+                  brute_force(*table, col_ts, [&](Mixed m) {
+                      return !m.is_null() && m.get_timestamp() <= ts;
+                  }));
+            Timestamp ts_to(v + 10, 0);
+            CHECK_EQUAL(table->where().between(col_ts, ts, ts_to).count(),
+                        brute_force(*table, col_ts, [&](Mixed m) {
+                            return !m.is_null() && m.get_timestamp() >= ts && m.get_timestamp() <= ts_to;
+                        }).size());
+        }
+        // Equality uses the ordered index too
+        CHECK_EQUAL(table->where().equal(col_int, 17).count(), brute_force(*table, col_int, [](Mixed m) {
+                                                                   return m.get_int() == 17;
+                                                               }).size());
+        CHECK_EQUAL(table->where().equal(col_ts, Timestamp(17, 0)).count(),
+                    brute_force(*table, col_ts, [](Mixed m) {
+                        return m == Mixed(Timestamp(17, 0));
+                    }).size());
+        CHECK_EQUAL(table->search_index_type(col_int), indexed ? IndexType::Ordered : IndexType::None);
+    };
+
+    check_queries(false);
+    for (auto col : {col_int, col_int_null, col_ts})
+        table->add_search_index(col, IndexType::Ordered);
+    check_queries(true);
+
+    // Results are updated as the table changes
+    auto q = table->where().greater(col_int, 990);
+    size_t before = q.count();
+    table->create_object().set(col_int, 995);
+    CHECK_EQUAL(q.count(), before + 1);
+}
+
+TEST(OrderedIndex_Sort)
+{
+    Group g;
+    auto table = g.add_table("table");
+    auto col_int = table->add_column(type_Int, "int", true);
+    auto col_string = table->add_column(type_String, "string");
+    auto col_other = table->add_column(type_Int, "other");
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    for (int i = 0; i < 2000; ++i) {
+        Obj obj = table->create_object();
+        if (random.draw_int<int>(0, 9) > 0)
+            obj.set(col_int, random.draw_int<int64_t>(0, 200));
+        obj.set(col_string, std::string(random.draw_int<size_t>(0, 3), 'a' + random.draw_int<int>(0, 2)));
+        obj.set(col_other, random.draw_int<int64_t>(0, 3));
+    }
+
+    auto run = [&](ColKey col, bool ascending, size_t limit, bool filtered) {
+        auto q = filtered ? table->where().not_equal(col_other, 0) : table->where();
+        DescriptorOrdering ordering;
+        ordering.append_sort(SortDescriptor({{col}}, {ascending}));
+        if (limit)
+            ordering.append_limit(LimitDescriptor(limit));
+        return keys_of(q.find_all(ordering));
+    };
+
+    std::vector<std::vector<ObjKey>> expected;
+    for (ColKey col : {col_int, col_string}) {
+        for (bool ascending : {true, false}) {
+            for (size_t limit : {0, 1, 100}) {
+                for (bool filtered : {false, true})
+                    expected.push_back(run(col, ascending, limit, filtered));
+            }
+        }
+    }
+
+    table->add_search_index(col_int, IndexType::Ordered);
+    table->add_search_index(col_string, IndexType::Ordered);
+    size_t i = 0;
+    for (ColKey col : {col_int, col_string}) {
+        for (bool ascending : {true, false}) {
+            for (size_t limit : {0, 1, 100}) {
+                for (bool filtered : {false, true})
+                    CHECK(run(col, ascending, limit, filtered) == expected[i++]);
+            }
+        }
+    }
+
+    // A view containing the same object twice is sorted as before
+    auto origin = g.add_table("origin");
+    auto col_link = origin->add_column_list(*table, "links");
+    auto list = origin->create_object().get_linklist(col_link);
+    std::vector<ObjKey> keys = {table->get_object(5).get_key(), table->get_object(3).get_key(),
+                                table->get_object(5).get_key(), table->get_object(1).get_key()};
+    for (auto key : keys)
+        list.add(key);
+    auto tv = list.get_sorted_view(col_int);
+    CHECK_EQUAL(tv.size(), 4);
+    for (size_t j = 1; j < tv.size(); ++j)
+        CHECK_LESS_EQUAL(tv.get_object(j - 1).get_any(col_int).compare(tv.get_object(j).get_any(col_int)), 0);
+}
+
+TEST(OrderedIndex_Transactions)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    auto db = DB::create(make_in_realm_history(), path);
+    ColKey col;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        col = table->add_column(type_Int, "int");
+        for (int64_t i = 0; i < 1000; ++i)
+            table->create_object().set(col, (i * 7919) % 1000);
+        table->add_search_index(col, IndexType::Ordered);
+        wt->commit();
+    }
+
+    auto rt = db->start_read();
+    auto reader = rt->get_table("table");
+    auto q = reader->where().less(col, 50);
+    CHECK_EQUAL(q.count(), 50);
+
+    for (int round = 0; round < 5; ++round) {
+        auto wt = db->start_write();
+        auto table = wt->get_table("table");
+        for (int64_t i = 0; i < 100; ++i)
+            table->create_object().set(col, i);
+        table->remove_object(table->begin());
+        wt->commit();
+
+        rt->advance_read();
+        check_index(test_context, *reader, col);
+        CHECK_EQUAL(q.count(), brute_force(*reader, col, [](Mixed m) {
+                                   return m.get_int() < 50;
+                               }).size());
+    }
+
+    // Rolling back restores the index
+    auto wt = db->start_write();
+    auto table = wt->get_table("table");
+    size_t count = table->where().less(col, 50).count();
+    table->clear();
+    CHECK_EQUAL(table->where().less(col, 50).count(), 0);
+    wt->rollback_and_continue_as_read();
+    check_index(test_context, *wt->get_table("table"), col);
+    CHECK_EQUAL(wt->get_table("table")->where().less(col, 50).count(), count);
+
+    // The index type survives reopening the file
+    wt = nullptr;
+    rt = nullptr;
+    db->close();
+    db = DB::create(make_in_realm_history(), path);
+    rt = db->start_read();
+    CHECK_EQUAL(rt->get_table("table")->search_index_type(col), IndexType::Ordered);
+    check_index(test_context, *rt->get_table("table"), col);
+}
+
+#endif // TEST_INDEX_ORDERED
@@ -1912,6 +1912,115 @@ TEST(StringIndex_MixedEqualBitPattern)
     CHECK_EQUAL(tv.get_object(1).get_any(col), val1);
 }
 
+TEST(StringIndex_BuildFromEntries)
+{
+    // Columns indexed before the objects are created are filled by inserting
+    // each value, while those indexed afterwards are built from all values at
+    // once. Both must give the same results.
+    Group g;
+    auto table = g.add_table("foo");
+    ColKey cols[2][3];
+    for (std::string suffix : {"_inserted", "_built"}) {
+        auto& c = cols[suffix == "_built"];
+        c[0] = table->add_column(type_String, "str" + suffix, true);
+        c[1] = table->add_column(type_Int, "int" + suffix, true);
+        c[2] = table->add_column(type_Mixed, "mixed" + suffix);
+    }
+    for (auto col : cols[0])
+        table->add_search_index(col);
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    // Strings sharing prefixes of all lengths, also longer than the depth of
+    // the index, and all sorts of duplicates
+    std::string long_prefix(StringIndex::s_max_offset + 10, 'a');
+    std::vector<std::string> strings;
+    for (size_t i = 0; i < 1000; ++i) {
+        std::string str = long_prefix.substr(0, random.draw_int_mod(long_prefix.size() + 1));
+        if (!str.empty() && random.draw_bool())
+            str[random.draw_int_mod(str.size())] = char('a' + random.draw_int_mod(3));
+        strings.push_back(str);
+    }
+    // Strings for column 0, integers for column 1 and both for column 2
+    auto random_value = [&](size_t j) -> Mixed {
+        if (random.draw_int_mod(10) == 0)
+            return Mixed();
+        if (j == 0 || (j == 2 && random.draw_bool()))
+            return StringData(strings[random.draw_int_mod(strings.size())]);
+        return Mixed(random.draw_int<int64_t>(-5000, 5000) * (random.draw_bool() ? 1 : int64_t(0x1000000000)));
+    };
+    auto set_values = [&](Obj& obj, size_t j) {
+        Mixed value = random_value(j);
+        obj.set_any(cols[0][j], value);
+        obj.set_any(cols[1][j], value);
+    };
+    for (size_t i = 0; i < 3000; ++i) {
+        Obj obj = table->create_object();
+        for (size_t j = 0; j < 3; ++j)
+            set_values(obj, j);
+    }
+    for (auto col : cols[1])
+        table->add_search_index(col);
+
+    auto check = [&] {
+        for (size_t j = 0; j < 3; ++j) {
+            SearchIndex* inserted = table->get_search_index(cols[0][j]);
+            SearchIndex* built = table->get_search_index(cols[1][j]);
+            for (auto obj : *table) {
+                Mixed value = obj.get_any(cols[1][j]);
+                std::vector<ObjKey> expected, found;
+                inserted->find_all(expected, value);
+                built->find_all(found, value);
+                CHECK(expected == found);
+                CHECK_EQUAL(built->find_first(value), expected.front());
+                CHECK_EQUAL(built->count(value), expected.size());
+            }
+        }
+    };
+    check();
+
+    // The built indexes can be modified as usual
+    for (size_t i = 0; i < 500; ++i) {
+        Obj obj = table->get_object(random.draw_int_mod(table->size()));
+        if (i % 5 == 0) {
+            obj.remove();
+            continue;
+        }
+        set_values(obj, random.draw_int_mod(3));
+    }
+    for (size_t i = 0; i < 500; ++i) {
+        Obj obj = table->create_object();
+        for (size_t j = 0; j < 3; ++j)
+            set_values(obj, j);
+    }
+    check();
+}
+
+TEST(StringIndex_BuildFromEntriesParallel)
+{
+    // Enough values for the entries to be sorted in parallel runs
+    Group g;
+    auto table = g.add_table("foo");
+    auto col = table->add_column(type_Int, "int");
+    auto col_str = table->add_column(type_String, "str");
+    constexpr int64_t num_objects = 200000;
+    for (int64_t i = 0; i < num_objects; ++i) {
+        int64_t value = (i * 7919) % (num_objects / 2) - num_objects / 4;
+        table->create_object().set(col, value).set(col_str, util::to_string(value % 1000));
+    }
+    table->add_search_index(col);
+    table->add_search_index(col_str);
+
+    for (int64_t value = -num_objects / 4; value < num_objects / 4; value += 997) {
+        std::vector<ObjKey> keys;
+        table->get_search_index(col)->find_all(keys, value);
+        CHECK_EQUAL(keys.size(), 2);
+        for (auto key : keys)
+            CHECK_EQUAL(table->get_object(key).get<Int>(col), value);
+    }
+    CHECK_EQUAL(table->count_string(col_str, "0"), num_objects / 1000);
+    CHECK_EQUAL(table->count_string(col_str, "-999"), num_objects / 2000);
+}
+
 TEST(Unicode_Casemap)
 {
     std::string inp = "±ÀÁÂÃÄÅÆÈÉÊËÌÍÎÏÑÒÓÔÕÖØÙÚÛÜÝß×÷";
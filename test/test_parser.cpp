@@ -6594,4 +6594,106 @@ TEST(Parser_Wildcard)
     CHECK_EQUAL(q.count(), 1);
 }
 
+TEST(Parser_PreparedQuery)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history());
+    auto sg = DB::create(*hist, path, DBOptions(crypt_key()));
+
+    auto wt = sg->start_write();
+    TableRef people = wt->add_table("class_Person");
+    TableRef dogs = wt->add_table("class_Dog");
+    auto col_name = people->add_column(type_String, "name");
+    auto col_age = people->add_column(type_Int, "age");
+    auto col_scores = people->add_column_list(type_Int, "scores");
+    auto col_dogs = people->add_column_list(*dogs, "dogs");
+    auto col_dog_name = dogs->add_column(type_String, "name");
+    for (int i = 0; i < 20; ++i) {
+        auto person = people->create_object().set(col_name, util::format("person %1", i)).set(col_age, i * 5);
+        auto scores = person.get_list<Int>(col_scores);
+        for (int j = 0; j < i % 4; ++j)
+            scores.add(i + j);
+        auto dog = dogs->create_object().set(col_dog_name, i % 3 ? "Fido" : "Rex");
+        person.get_linklist(col_dogs).add(dog.get_key());
+    }
+
+    using Args = std::vector<query_parser::PreparedQuery::Arg>;
+    // Binding must give the same results, in the same order, as parsing the query string with the arguments
+    auto check = [&](query_parser::PreparedQuery& prepared, ConstTableRef table, const Args& args) {
+        auto expected = table->query(prepared.get_query_string(), args).find_all();
+        auto actual = prepared.bind(table, args).find_all();
+        CHECK_EQUAL(actual.size(), expected.size());
+        for (size_t i = 0; i < std::min(actual.size(), expected.size()); ++i)
+            CHECK_EQUAL(actual.get_key(i), expected.get_key(i));
+        return actual.size();
+    };
+
+    auto q1 = people->prepare_query("age > $0 AND name BEGINSWITH $1");
+    CHECK_EQUAL(check(q1, people, {Mixed(20), Mixed("person 1")}), 10);
+    CHECK_EQUAL(check(q1, people, {Mixed(0), Mixed("person")}), 19);
+    CHECK_EQUAL(check(q1, people, {Mixed(100), Mixed("x")}), 0);
+    CHECK_EQUAL(q1.bind(people, Args{Mixed(90), Mixed("person")}).count(), 1);
+    CHECK_EQUAL(q1.bind(people, std::vector<Mixed>{50, "person 1"}).count(), 9);
+
+    auto q2 = people->prepare_query("age BETWEEN {$0, $1} SORT(age DESC) LIMIT(3)");
+    CHECK_EQUAL(check(q2, people, {Mixed(10), Mixed(40)}), 3);
+    CHECK_EQUAL(check(q2, people, {Mixed(0), Mixed(5)}), 2);
+
+    auto q3 = people->prepare_query("ANY dogs.name == $0");
+    CHECK_EQUAL(check(q3, people, {Mixed("Fido")}), 13);
+    CHECK_EQUAL(check(q3, people, {Mixed("Rex")}), 7);
+
+    auto q4 = people->prepare_query("SUBQUERY(dogs, $x, $x.name == $0).@count > 0 && scores.@size == $1");
+    CHECK_EQUAL(check(q4, people, {Mixed("Rex"), Mixed(0)}), 2);
+    CHECK_EQUAL(check(q4, people, {Mixed("Fido"), Mixed(3)}), 3);
+
+    auto q5 = people->prepare_query("scores.@sum > $0 || scores.@max == $1");
+    CHECK_EQUAL(check(q5, people, {Mixed(40), Mixed(1)}), 3);
+    CHECK_EQUAL(check(q5, people, {Mixed(1000), Mixed(19)}), 1);
+
+    auto q6 = dogs->prepare_query("@links.Person.dogs.age > $0 && @links.@count == $1");
+    CHECK_EQUAL(check(q6, dogs, {Mixed(50), Mixed(1)}), 9);
+    CHECK_EQUAL(check(q6, dogs, {Mixed(50), Mixed(0)}), 0);
+
+    // Key path arguments are resolved each time
+    auto q7 = people->prepare_query("$K0 == $1");
+    CHECK_EQUAL(check(q7, people, {Mixed("name"), Mixed("person 3")}), 1);
+    CHECK_EQUAL(check(q7, people, {Mixed("age"), Mixed(15)}), 1);
+    CHECK_EQUAL(check(q7, people, {Mixed("age"), Mixed(16)}), 0);
+
+    // List arguments
+    auto q8 = people->prepare_query("age IN $0");
+    CHECK_EQUAL(check(q8, people, {std::vector<Mixed>{5, 10, 11}}), 2);
+    CHECK_EQUAL(check(q8, people, {std::vector<Mixed>{}}), 0);
+
+    // A list index is needed by the parser, so this is parsed on every bind
+    auto q9 = people->prepare_query("scores[$0] == $1");
+    CHECK_EQUAL(check(q9, people, {Mixed(0), Mixed(5)}), 1);
+    CHECK_EQUAL(check(q9, people, {Mixed(1), Mixed(7)}), 1);
+
+    // A bind which fails does not affect the next one
+    CHECK_THROW_ANY(q1.bind(people, Args{Mixed("twenty"), Mixed("person")}));
+    CHECK_THROW_ANY(q1.bind(people, Args{Mixed(20)}));
+    CHECK_THROW_ANY(q7.bind(people, Args{Mixed("nonexistent"), Mixed(1)}));
+    CHECK_EQUAL(check(q1, people, {Mixed(20), Mixed("person 1")}), 10);
+    CHECK_EQUAL(check(q7, people, {Mixed("age"), Mixed(15)}), 1);
+
+    CHECK_THROW(people->prepare_query("age >"), query_parser::SyntaxError);
+
+    // The prepared queries can be used in later transactions
+    wt->commit();
+    auto rt = sg->start_read();
+    CHECK_EQUAL(check(q1, rt->get_table("class_Person"), {Mixed(20), Mixed("person 1")}), 10);
+    CHECK_EQUAL(check(q6, rt->get_table("class_Dog"), {Mixed(50), Mixed(1)}), 9);
+    rt->end_read();
+
+    wt = sg->start_write();
+    people = wt->get_table("class_Person");
+    for (int i = 0; i < 5; ++i)
+        people->create_object().set(col_name, "person 100").set(col_age, 100);
+    CHECK_EQUAL(check(q1, people, {Mixed(20), Mixed("person 1")}), 15);
+    CHECK_EQUAL(check(q3, people, {Mixed("Fido")}), 13);
+    CHECK_EQUAL(check(q7, people, {Mixed("age"), Mixed(100)}), 5);
+}
+
 #endif // TEST_PARSER
@@ -29,6 +29,7 @@ using namespace std::chrono;
 #include <realm.hpp>
 #include <realm/column_integer.hpp>
 #include <realm/array_bool.hpp>
+#include <realm/column_statistics.hpp>
 #include <realm/query_expression.hpp>
 #include <realm/index_string.hpp>
 #include <realm/query_expression.hpp>
@@ -4164,6 +4165,609 @@ TEST(Query_LinkChainSortErrors)
     CHECK_LOGIC_ERROR(t1->get_sorted_view(SortDescriptor({{t1_linklist_col}})), ErrorCodes::InvalidSortDescriptor);
 }
 
+TEST(Query_SortManyObjectsOverLinks)
+{
+    // Enough objects for the values to be looked up and sorted on several
+    // threads, which only looks up the values on several threads when frozen
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = DB::create(make_in_realm_history(), path);
+    auto tr = db->start_write();
+    TableRef origin = tr->add_table("origin");
+    TableRef target = tr->add_table("target");
+    auto int_col = origin->add_column(type_Int, "int");
+    auto str_col = origin->add_column(type_String, "str", true);
+    auto link_col = origin->add_column(*target, "link");
+    auto target_col = target->add_column(type_Int, "value");
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    std::vector<ObjKey> target_keys;
+    for (int i = 0; i < 100; ++i)
+        target_keys.push_back(target->create_object().set(target_col, random.draw_int_mod(10)).get_key());
+    const char* strings[] = {"", "a", "ab", "b", "B", "\xc3\xa6", "z"};
+    for (int i = 0; i < 40000; ++i) {
+        Obj obj = origin->create_object().set(int_col, random.draw_int_mod(50));
+        if (random.draw_int_mod(8))
+            obj.set(str_col, StringData(strings[random.draw_int_mod(7)]));
+        if (random.draw_int_mod(8))
+            obj.set(link_col, target_keys[random.draw_int_mod(target_keys.size())]);
+    }
+
+    // Null links last, then link.value ascending, int descending and str ascending
+    std::vector<Obj> expected;
+    for (auto obj : *origin)
+        expected.push_back(obj);
+    std::stable_sort(expected.begin(), expected.end(), [&](const Obj& a, const Obj& b) {
+        ObjKey link_a = a.get<ObjKey>(link_col);
+        ObjKey link_b = b.get<ObjKey>(link_col);
+        if (!link_a || !link_b) {
+            if (link_a || link_b)
+                return bool(link_a);
+        }
+        else {
+            Mixed value_a = target->get_object(link_a).get_any(target_col);
+            if (int c = value_a.compare(target->get_object(link_b).get_any(target_col)))
+                return c < 0;
+        }
+        if (int c = a.get_any(int_col).compare(b.get_any(int_col)))
+            return c > 0;
+        return a.get_any(str_col).compare(b.get_any(str_col)) < 0;
+    });
+    tr->commit_and_continue_as_read();
+    auto frozen = tr->freeze();
+
+    for (auto table : {tr->get_table("origin"), frozen->get_table("origin")}) {
+        TableView tv = table->where().find_all();
+        tv.sort(SortDescriptor({{link_col, target_col}, {int_col}, {str_col}}, {true, false, true}));
+        CHECK_EQUAL(tv.size(), expected.size());
+        for (size_t i = 0; i < tv.size(); ++i) {
+            if (tv.get_key(i) != expected[i].get_key()) {
+                CHECK_EQUAL(tv.get_key(i), expected[i].get_key());
+                break;
+            }
+        }
+    }
+}
+
+
+TEST(Query_SortFollowedByLimit)
+{
+    // A sort followed by a small limit only keeps the first objects while the query runs
+    Group g;
+    TableRef origin = g.add_table("origin");
+    TableRef target = g.add_table("target");
+    auto int_col = origin->add_column(type_Int, "int");
+    auto str_col = origin->add_column(type_String, "str", true);
+    auto link_col = origin->add_column(*target, "link");
+    auto target_col = target->add_column(type_Int, "value");
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    std::vector<ObjKey> target_keys;
+    for (int i = 0; i < 50; ++i)
+        target_keys.push_back(target->create_object().set(target_col, random.draw_int_mod(10)).get_key());
+    const char* strings[] = {"", "a", "ab", "b", "z"};
+    for (int i = 0; i < 5000; ++i) {
+        Obj obj = origin->create_object().set(int_col, random.draw_int_mod(100));
+        if (random.draw_int_mod(8))
+            obj.set(str_col, StringData(strings[random.draw_int_mod(5)]));
+        if (random.draw_int_mod(8))
+            obj.set(link_col, target_keys[random.draw_int_mod(target_keys.size())]);
+    }
+
+    auto check_limit = [&](SortDescriptor sort, size_t limit) {
+        Query q = origin->where().greater(int_col, 20);
+        TableView all = q.find_all();
+        all.sort(sort);
+
+        DescriptorOrdering ordering;
+        ordering.append_sort(sort);
+        ordering.append_limit(limit);
+        TableView tv = q.find_all(ordering);
+        CHECK_EQUAL(tv.size(), std::min(limit, all.size()));
+        for (size_t i = 0; i < tv.size(); ++i) {
+            if (tv.get_key(i) != all.get_key(i)) {
+                CHECK_EQUAL(tv.get_key(i), all.get_key(i));
+                break;
+            }
+        }
+    };
+
+    for (size_t limit : {0, 1, 7, 100, 400}) {
+        check_limit(SortDescriptor({{int_col}}), limit);
+        check_limit(SortDescriptor({{int_col}}, {false}), limit);
+        check_limit(SortDescriptor({{str_col}, {int_col}}, {true, false}), limit);
+        check_limit(SortDescriptor({{link_col, target_col}, {str_col}}, {true, true}), limit);
+        check_limit(SortDescriptor({{link_col, target_col}, {int_col}}, {false, true}), limit);
+    }
+
+    // Descriptors after the limit are applied to the objects kept
+    DescriptorOrdering ordering;
+    ordering.append_sort(SortDescriptor({{int_col}}, {false}));
+    ordering.append_limit(10);
+    ordering.append_sort(SortDescriptor({{int_col}}, {true}));
+    TableView tv = origin->where().find_all(ordering);
+    CHECK_EQUAL(tv.size(), 10);
+    for (size_t i = 1; i < tv.size(); ++i)
+        CHECK_LESS_EQUAL(tv[i - 1].get<Int>(int_col), tv[i].get<Int>(int_col));
+    CHECK_EQUAL(tv[9].get<Int>(int_col), 99);
+}
+
+TEST(Query_ZoneMap)
+{
+    // Skipping the clusters ruled out by a zone map must not change the results of a query, so the same queries
+    // are run on two tables with the same content, only one of which has zone maps
+    SHARED_GROUP_TEST_PATH(path);
+    auto hist = make_in_realm_history();
+    DBRef db = DB::create(*hist, path, DBOptions(crypt_key()));
+    auto wt = db->start_write();
+    TableRef with = wt->add_table("with");
+    TableRef without = wt->add_table("without");
+    for (auto& table : {with, without}) {
+        table->add_column(type_Int, "int");
+        table->add_column(type_Int, "nullable", true);
+        table->add_column(type_Timestamp, "time", true);
+        table->add_column(type_Float, "float", true);
+        table->add_column(type_Double, "double");
+        table->add_column(type_String, "str");
+    }
+    for (auto name : {"int", "nullable", "time", "float"})
+        with->add_zone_map(with->get_column_key(name));
+    CHECK(with->has_zone_map(with->get_column_key("int")));
+    CHECK_NOT(without->has_zone_map(without->get_column_key("int")));
+    CHECK_THROW(with->add_zone_map(with->get_column_key("str")), IllegalOperation);
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    auto for_both = [&](auto fn) {
+        // Both tables draw the same random numbers
+        auto seed = random.draw_int<unsigned long>();
+        for (auto& table : {with, without}) {
+            Random r(seed);
+            fn(*table, r);
+        }
+    };
+    auto add_objects = [&](int begin, int end) {
+        for_both([&](Table& table, Random& r) {
+            for (int i = begin; i < end; ++i) {
+                Obj obj = table.create_object();
+                obj.set("int", int64_t(i + r.draw_int_mod(10)));
+                if (i % 7)
+                    obj.set("nullable", int64_t(i / 3));
+                if (i % 5)
+                    obj.set("time", Timestamp(1'700'000'000 + i * 10, int32_t(r.draw_int_mod(1'000'000'000))));
+                if (i % 11)
+                    obj.set("float", i * 0.5f);
+                obj.set("double", -1.5 * i);
+            }
+        });
+    };
+    add_objects(0, 2000);
+    // The zone map of a column added to a table with objects covers them too
+    with->add_zone_map(with->get_column_key("double"));
+    add_objects(2000, 4000);
+
+    auto check_queries = [&](const Table& a, const Table& b) {
+        auto check = [&](auto make_query) {
+            Query qa = make_query(a);
+            Query qb = make_query(b);
+            CHECK_EQUAL(qa.count(), qb.count());
+            CHECK_EQUAL(qa.find(), qb.find());
+            auto va = qa.find_all();
+            auto vb = qb.find_all();
+            CHECK_EQUAL(va.size(), vb.size());
+            for (size_t i = 0; i < std::min(va.size(), vb.size()); ++i) {
+                if (va.get_key(i) != vb.get_key(i)) {
+                    CHECK_EQUAL(va.get_key(i), vb.get_key(i));
+                    break;
+                }
+            }
+            CHECK_EQUAL(*qa.sum(a.get_column_key("int")), *qb.sum(b.get_column_key("int")));
+        };
+        for (int64_t v : {-5000, 0, 17, 1000, 2500, 3999, 5000}) {
+            check([v](const Table& t) {
+                return t.where().equal(t.get_column_key("int"), v);
+            });
+            check([v](const Table& t) {
+                return t.where().greater(t.get_column_key("int"), v);
+            });
+            check([v](const Table& t) {
+                return t.where().less_equal(t.get_column_key("int"), v);
+            });
+            check([v](const Table& t) {
+                return t.where().not_equal(t.get_column_key("int"), v);
+            });
+            check([v](const Table& t) {
+                return t.where().between(t.get_column_key("int"), v, v + 300);
+            });
+            check([v](const Table& t) {
+                return t.where().greater_equal(t.get_column_key("nullable"), v / 3);
+            });
+            check([v](const Table& t) {
+                return t.where().less(t.get_column_key("nullable"), v / 3);
+            });
+            check([v](const Table& t) {
+                return t.where().between(t.get_column_key("nullable"), v / 3, v / 3 + 10);
+            });
+            check([v](const Table& t) {
+                auto col = t.get_column_key("nullable");
+                Mixed values[] = {Mixed(v), Mixed(v / 3), Mixed()};
+                return t.where().in(col, std::begin(values), std::end(values));
+            });
+            Timestamp ts(1'700'000'000 + v * 10, 0);
+            check([ts](const Table& t) {
+                return t.where().greater(t.get_column_key("time"), ts);
+            });
+            check([ts](const Table& t) {
+                return t.where().less_equal(t.get_column_key("time"), ts);
+            });
+            check([ts](const Table& t) {
+                return t.where().equal(t.get_column_key("time"), ts);
+            });
+            check([ts](const Table& t) {
+                return t.where().between(t.get_column_key("time"), ts, Timestamp(ts.get_seconds() + 500, 0));
+            });
+            check([v](const Table& t) {
+                return t.where().greater(t.get_column_key("float"), v * 0.5f);
+            });
+            check([v](const Table& t) {
+                return t.where().equal(t.get_column_key("float"), v * 0.5f);
+            });
+            check([v](const Table& t) {
+                return t.where().between(t.get_column_key("double"), -1.5 * v, -1.5 * v + 100);
+            });
+            check([v](const Table& t) {
+                return t.where()
+                    .greater(t.get_column_key("int"), v)
+                    .less(t.get_column_key("double"), -1.5 * v)
+                    .Or()
+                    .equal(t.get_column_key("nullable"), v);
+            });
+            check([v](const Table& t) {
+                return t.where().Not().less(t.get_column_key("int"), v);
+            });
+        }
+        for (auto name : {"nullable", "time", "float"}) {
+            check([name](const Table& t) {
+                return t.where().equal(t.get_column_key(name), null());
+            });
+            check([name](const Table& t) {
+                return t.where().not_equal(t.get_column_key(name), null());
+            });
+        }
+        check([](const Table& t) {
+            return t.where().equal(t.get_column_key("double"), 0.0);
+        });
+        check([](const Table& t) {
+            return t.where().equal(t.get_column_key("float"), std::numeric_limits<float>::quiet_NaN());
+        });
+        check([](const Table& t) {
+            return t.where().greater(t.get_column_key("float"), 100000.f);
+        });
+    };
+    check_queries(*with, *without);
+
+    // Values written outside of the bounds of their block widen them
+    for_both([](Table& table, Random& r) {
+        for (int i = 0; i < 200; ++i) {
+            Obj obj = table.get_object(r.draw_int_mod(table.size()));
+            switch (r.draw_int_mod(6)) {
+                case 0:
+                    obj.set("int", r.draw_int<int64_t>(-10000, 10000));
+                    break;
+                case 1:
+                    obj.add_int("int", r.draw_int<int64_t>(-3000, 3000));
+                    break;
+                case 2:
+                    obj.set_null("nullable");
+                    break;
+                case 3:
+                    obj.set("time", Timestamp(1'700'000'000 + r.draw_int<int64_t>(-10000, 50000), 0));
+                    break;
+                case 4:
+                    obj.set("float", r.draw_int_mod(2) ? -0.f : std::numeric_limits<float>::quiet_NaN());
+                    break;
+                case 5:
+                    obj.set("double", -0.0);
+                    break;
+            }
+        }
+        for (int i = 0; i < 100; ++i)
+            table.remove_object(table.get_object(r.draw_int_mod(table.size())).get_key());
+    });
+    add_objects(4000, 4500);
+    check_queries(*with, *without);
+    with->verify();
+
+    auto zone_map = with->get_zone_map(with->get_column_key("double"));
+    CHECK(zone_map);
+    CHECK_GREATER(zone_map->size(), 0);
+    CHECK_NOT(zone_map->may_match<Greater>(ObjKey(0), ObjKey(255), Mixed(1.0)));
+    CHECK(zone_map->may_match<Less>(ObjKey(0), ObjKey(255), Mixed(1.0)));
+    wt->commit_and_continue_as_read();
+
+    // The zone maps are stored in the file
+    {
+        auto rt = db->start_read();
+        check_queries(*rt->get_table("with"), *rt->get_table("without"));
+        CHECK(rt->get_table("with")->has_zone_map(rt->get_table("with")->get_column_key("time")));
+    }
+    wt->promote_to_write();
+    ColKey nullable_col = with->set_nullability(with->get_column_key("int"), true, false);
+    without->set_nullability(without->get_column_key("int"), true, false);
+    CHECK(with->has_zone_map(nullable_col));
+    check_queries(*with, *without);
+
+    with->remove_zone_map(with->get_column_key("time"));
+    CHECK_NOT(with->has_zone_map(with->get_column_key("time")));
+    with->remove_column(with->get_column_key("float"));
+    CHECK_NOT(with->has_zone_map(with->add_column(type_Float, "float", true)));
+    wt->rollback_and_continue_as_read();
+    CHECK(with->has_zone_map(with->get_column_key("time")));
+    CHECK(with->has_zone_map(with->get_column_key("float")));
+
+    wt->promote_to_write();
+    with->clear();
+    without->clear();
+    CHECK_EQUAL(with->get_zone_map(with->get_column_key("int"))->size(), 0);
+    add_objects(0, 1000);
+    check_queries(*with, *without);
+    wt->commit();
+}
+
+TEST(Query_ColumnStatistics)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    auto hist = make_in_realm_history();
+    DBRef db = DB::create(*hist, path, DBOptions(crypt_key()));
+    auto wt = db->start_write();
+    TableRef target = wt->add_table("target");
+    TableRef table = wt->add_table("table");
+    auto col_name = target->add_column(type_String, "name");
+    auto col_category = table->add_column(type_Int, "category");
+    auto col_id = table->add_column(type_Int, "id");
+    auto col_flag = table->add_column(type_Bool, "flag");
+    auto col_opt = table->add_column(type_Int, "opt", true);
+    auto col_str = table->add_column(type_String, "str");
+    auto col_time = table->add_column(type_Timestamp, "time");
+    auto col_link = table->add_column(*target, "link");
+    table->add_search_index(col_flag);
+    table->add_search_index(col_category);
+
+    std::vector<ObjKey> targets;
+    for (int i = 0; i < 10; ++i)
+        targets.push_back(target->create_object().set(col_name, util::format("target %1", i)).get_key());
+    auto add_objects = [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            Obj obj = table->create_object();
+            obj.set(col_category, i % 5);
+            obj.set(col_id, i);
+            obj.set(col_flag, i % 10 != 0);
+            if (i % 2)
+                obj.set(col_opt, int64_t(i % 100));
+            obj.set(col_str, util::format("str %1", i % 100));
+            obj.set(col_time, Timestamp(1'700'000'000 + i, 0));
+            obj.set(col_link, targets[i % 10 == 0 ? 0 : 1 + i % 9]);
+        }
+    };
+    add_objects(0, 10000);
+
+    auto near = [](std::optional<double> estimate, double expected, double tolerance) {
+        return estimate && std::abs(*estimate - expected) <= tolerance;
+    };
+
+    CHECK_NOT(table->get_column_statistics(col_id));
+    CHECK_THROW(table->collect_column_statistics(col_link), IllegalOperation);
+    for (auto col : {col_category, col_id, col_flag, col_opt, col_str, col_time})
+        table->collect_column_statistics(col);
+    target->collect_column_statistics(col_name);
+
+    auto stats = table->get_column_statistics(col_category);
+    CHECK(stats);
+    CHECK_EQUAL(stats->table_size(), 10000);
+    CHECK_EQUAL(stats->sample_size(), ColumnStatistics::max_sample_size);
+    CHECK_EQUAL(stats->distinct_count(), 5);
+    CHECK(near(stats->estimate<Equal>(Mixed(3)), 0.2, 0.05));
+    CHECK(near(stats->estimate<NotEqual>(Mixed(3)), 0.8, 0.05));
+    CHECK(near(stats->estimate<Equal>(Mixed(7)), 0.0, 0.01));
+
+    stats = table->get_column_statistics(col_id);
+    CHECK_GREATER(stats->distinct_count(), 2000);
+    CHECK(near(stats->estimate<Greater>(Mixed(7500)), 0.25, 0.05));
+    CHECK(near(stats->estimate<Less>(Mixed(1000)), 0.1, 0.05));
+    CHECK(near(stats->estimate_between(Mixed(2000), Mixed(4000)), 0.2, 0.05));
+    CHECK_LESS(*stats->estimate<Equal>(Mixed(1234)), 0.01);
+
+    stats = table->get_column_statistics(col_flag);
+    CHECK(near(stats->estimate<Equal>(Mixed(true)), 0.9, 0.035));
+    CHECK(near(stats->estimate<Equal>(Mixed(false)), 0.1, 0.035));
+
+    stats = table->get_column_statistics(col_opt);
+    CHECK(near(stats->null_fraction(), 0.5, 0.06));
+    CHECK(near(stats->estimate<Equal>(Mixed()), 0.5, 0.06));
+    CHECK(near(stats->estimate<Equal>(Mixed(41)), 0.01, 0.006));
+
+    stats = table->get_column_statistics(col_str);
+    CHECK(near(double(stats->distinct_count()), 100, 5));
+    CHECK(near(stats->estimate<Equal>(Mixed("str 17")), 0.01, 0.006));
+    // Ranges cannot be estimated from the hashes of strings
+    CHECK_NOT(stats->estimate<Greater>(Mixed("str 17")));
+
+    stats = table->get_column_statistics(col_time);
+    CHECK(near(stats->estimate<GreaterEqual>(Mixed(Timestamp(1'700'005'000, 0))), 0.5, 0.05));
+
+    // The statistics must not change the results of a query, whatever plan they lead to
+    auto check = [&](Query q, auto predicate) {
+        size_t expected = 0;
+        ObjKey first;
+        for (auto& obj : *table) {
+            if (predicate(obj)) {
+                if (!first)
+                    first = obj.get_key();
+                ++expected;
+            }
+        }
+        CHECK_EQUAL(q.count(), expected);
+        CHECK_EQUAL(q.find_all().size(), expected);
+        CHECK_EQUAL(q.find(), first);
+    };
+    auto run_queries = [&] {
+        // The search index of "flag" matches most objects, so "id" is scanned instead
+        check(table->where().equal(col_flag, true).less(col_id, 100), [&](const Obj& obj) {
+            return obj.get<bool>(col_flag) && obj.get<Int>(col_id) < 100;
+        });
+        check(table->where().equal(col_flag, false).greater(col_id, 5000), [&](const Obj& obj) {
+            return !obj.get<bool>(col_flag) && obj.get<Int>(col_id) > 5000;
+        });
+        check(table->where().equal(col_category, 2).equal(col_str, "str 42").equal(col_opt, null()),
+              [&](const Obj& obj) {
+                  return obj.get<Int>(col_category) == 2 && obj.get<String>(col_str) == "str 42" &&
+                         obj.is_null(col_opt);
+              });
+        check(table->where().between(col_id, 3000, 3100).not_equal(col_category, 1).equal(col_flag, true),
+              [&](const Obj& obj) {
+                  auto id = obj.get<Int>(col_id);
+                  return id >= 3000 && id <= 3100 && obj.get<Int>(col_category) != 1 && obj.get<bool>(col_flag);
+              });
+        check(table->where().greater_equal(col_time, Timestamp(1'700'009'990, 0)).equal(col_str, "str 95"),
+              [&](const Obj& obj) {
+                  return obj.get<Timestamp>(col_time) >= Timestamp(1'700'009'990, 0) &&
+                         obj.get<String>(col_str) == "str 95";
+              });
+        // The few objects linking to "target 0" are found from the target table backwards
+        check(table->link(col_link).column<String>(col_name) == "target 0", [&](const Obj& obj) {
+            return obj.get<ObjKey>(col_link) == targets[0];
+        });
+        check(table->where().equal(col_category, 0).and_query(table->link(col_link).column<String>(col_name) ==
+                                                               "target 3"),
+              [&](const Obj& obj) {
+                  return obj.get<Int>(col_category) == 0 && obj.get<ObjKey>(col_link) == targets[3];
+              });
+    };
+    run_queries();
+    wt->commit_and_continue_as_read();
+
+    // The statistics are stored in the file
+    {
+        auto rt = db->start_read();
+        auto t = rt->get_table("table");
+        auto s = t->get_column_statistics(t->get_column_key("category"));
+        CHECK(s);
+        CHECK_EQUAL(s->table_size(), 10000);
+        CHECK_EQUAL(s->distinct_count(), 5);
+        CHECK(near(s->estimate<Equal>(Mixed(3)), 0.2, 0.05));
+        CHECK_NOT(t->get_column_statistics(t->get_column_key("link")));
+    }
+
+    // A commit samples the columns again once the table has grown by more than a quarter
+    wt->promote_to_write();
+    add_objects(10000, 12000);
+    wt->commit_and_continue_as_read();
+    CHECK_EQUAL(table->get_column_statistics(col_id)->table_size(), 10000);
+    wt->promote_to_write();
+    add_objects(12000, 13000);
+    run_queries();
+    wt->commit_and_continue_as_read();
+    CHECK_EQUAL(table->get_column_statistics(col_id)->table_size(), 13000);
+    CHECK_EQUAL(target->get_column_statistics(col_name)->table_size(), 10);
+
+    wt->promote_to_write();
+    table->remove_column_statistics(col_str);
+    CHECK_NOT(table->get_column_statistics(col_str));
+    col_opt = table->set_nullability(col_opt, false, false);
+    CHECK(table->get_column_statistics(col_opt));
+    table->remove_column(col_time);
+    CHECK_NOT(table->get_column_statistics(table->add_column(type_Timestamp, "time")));
+    wt->rollback_and_continue_as_read();
+    CHECK(table->get_column_statistics(col_str));
+    CHECK(table->get_column_statistics(col_time));
+
+    wt->promote_to_write();
+    table->clear();
+    wt->commit_and_continue_as_read();
+    CHECK_EQUAL(table->get_column_statistics(col_id)->table_size(), 0);
+    CHECK_NOT(table->get_column_statistics(col_id)->estimate<Equal>(Mixed(1)));
+    CHECK_EQUAL(table->where().equal(col_flag, true).count(), 0);
+}
+
+TEST(Query_BatchEvaluation)
+{
+    Group g;
+    TableRef table = g.add_table("table");
+    auto col_price = table->add_column(type_Double, "price");
+    auto col_qty = table->add_column(type_Int, "qty");
+    auto col_opt = table->add_column(type_Int, "opt", true);
+    auto col_ratio = table->add_column(type_Float, "ratio", true);
+    auto col_big = table->add_column(type_Int, "big");
+
+    for (int i = 0; i < 3000; ++i) {
+        Obj obj = table->create_object();
+        obj.set(col_price, i % 50 == 7 ? std::numeric_limits<double>::quiet_NaN() : (i % 97) * 1.25);
+        obj.set(col_qty, i % 13);
+        if (i % 3)
+            obj.set(col_opt, int64_t(i % 5));
+        if (i % 7)
+            obj.set(col_ratio, float(i % 11) / 4);
+        // Integers above 2^53 cannot be compared to doubles as doubles
+        obj.set(col_big, i % 100 == 0 ? (int64_t(1) << 53) + i : int64_t(i));
+    }
+
+    // Evaluate the expressions the way the chunked evaluation does
+    auto get = [](const Obj& obj, ColKey col) {
+        return QueryValue(obj.get_any(col));
+    };
+    auto check = [&](Query q, auto predicate) {
+        size_t expected = 0;
+        ObjKey first;
+        for (auto& obj : *table) {
+            if (predicate(obj)) {
+                if (!first)
+                    first = obj.get_key();
+                ++expected;
+            }
+        }
+        CHECK_EQUAL(q.count(), expected);
+        CHECK_EQUAL(q.find_all().size(), expected);
+        CHECK_EQUAL(q.find(), first);
+    };
+    auto run_queries = [&] {
+        check(table->query("price * qty > 1000"), [&](const Obj& obj) {
+            return Greater()(get(obj, col_price) * get(obj, col_qty), QueryValue(1000));
+        });
+        check(table->query("qty + opt == 6"), [&](const Obj& obj) {
+            return Equal()(get(obj, col_qty) + get(obj, col_opt), QueryValue(6));
+        });
+        check(table->query("qty / opt >= 3"), [&](const Obj& obj) {
+            return GreaterEqual()(get(obj, col_qty) / get(obj, col_opt), QueryValue(3));
+        });
+        check(table->query("ratio - price < qty * 0.5"), [&](const Obj& obj) {
+            return Less()(QueryValue(get(obj, col_ratio) - get(obj, col_price)),
+                          QueryValue(get(obj, col_qty) * QueryValue(0.5)));
+        });
+        check(table->query("ratio * 2 != opt"), [&](const Obj& obj) {
+            return NotEqual()(get(obj, col_ratio) * QueryValue(2), get(obj, col_opt));
+        });
+        check(table->query("opt <= qty - 10"), [&](const Obj& obj) {
+            return LessEqual()(get(obj, col_opt), get(obj, col_qty) - QueryValue(10));
+        });
+        check(table->query("big >= price * 30"), [&](const Obj& obj) {
+            return GreaterEqual()(get(obj, col_big), get(obj, col_price) * QueryValue(30));
+        });
+        // The expression is asked for single rows between the matches of the other condition
+        check(table->query("qty == 5 && price * qty > 300"), [&](const Obj& obj) {
+            return obj.get<Int>(col_qty) == 5 && Greater()(get(obj, col_price) * get(obj, col_qty), QueryValue(300));
+        });
+    };
+    run_queries();
+
+    // The results of one run must not be reused by the next
+    Query q = table->query("price * qty > 1000");
+    size_t count = q.count();
+    for (auto& obj : *table) {
+        if (obj.get<Int>(col_qty) == 12)
+            obj.set(col_qty, 0);
+    }
+    CHECK_LESS(q.count(), count);
+    run_queries();
+}
+
 
 TEST(Query_EmptyDescriptors)
 {
@@ -5795,4 +6399,59 @@ TEST(Query_NestedLinkCount)
     CHECK_EQUAL(q.count(), 3);
 }
 
+TEST(Query_Parallel)
+{
+    Group g;
+    auto table = g.add_table("table");
+    auto col_int = table->add_column(type_Int, "int");
+    auto col_double = table->add_column(type_Double, "double", true);
+    auto col_str = table->add_column(type_String, "str");
+
+    const size_t num_objects = 25000;
+    std::vector<ObjKey> keys;
+    for (size_t i = 0; i < num_objects; ++i) {
+        auto obj = table->create_object().set(col_int, int64_t(i % 1000)).set(col_str, i % 3 ? "foo" : "bar");
+        if (i % 7)
+            obj.set(col_double, double(i % 501) / 2);
+        keys.push_back(obj.get_key());
+    }
+    // Leave holes in the key sequence
+    for (size_t i = 0; i < num_objects; i += 13)
+        table->remove_object(keys[i]);
+
+    std::vector<Query> queries;
+    queries.push_back(table->where().greater(col_int, 500));
+    queries.push_back(table->where().greater(col_int, 100).equal(col_str, "foo"));
+    queries.push_back(table->query("double < 50 || int == 7"));
+    queries.push_back(table->where().less(col_int, 0));
+
+    for (auto& serial : queries) {
+        Query parallel = serial;
+        parallel.set_threads(8);
+        CHECK_EQUAL(parallel.get_threads(), 8);
+
+        CHECK_EQUAL(parallel.count(), serial.count());
+        auto tv_serial = serial.find_all();
+        auto tv_parallel = parallel.find_all();
+        CHECK_EQUAL(tv_parallel.size(), tv_serial.size());
+        for (size_t i = 0; i < tv_serial.size(); ++i)
+            CHECK_EQUAL(tv_parallel.get_key(i), tv_serial.get_key(i));
+
+        for (auto col : {col_int, col_double}) {
+            CHECK_EQUAL(*parallel.sum(col), *serial.sum(col));
+            size_t count_serial = 0, count_parallel = 0;
+            CHECK_EQUAL(*parallel.avg(col, &count_parallel), *serial.avg(col, &count_serial));
+            CHECK_EQUAL(count_parallel, count_serial);
+            ObjKey key_serial, key_parallel;
+            CHECK_EQUAL(*parallel.min(col, &key_parallel), *serial.min(col, &key_serial));
+            CHECK_EQUAL(key_parallel, key_serial);
+            CHECK_EQUAL(*parallel.max(col, &key_parallel), *serial.max(col, &key_serial));
+            CHECK_EQUAL(key_parallel, key_serial);
+        }
+
+        // A limit forces serial evaluation, but must give the same result
+        CHECK_EQUAL(parallel.find_all(10).size(), serial.find_all(10).size());
+    }
+}
+
 #endif // TEST_QUERY
@@ -6337,6 +6337,20 @@ TEST(Query_FullTextMulti)
     CHECK_THROW_ANY(do_fulltext_find("object-oriented -database"));
     CHECK_THROW_ANY(do_fulltext_find("object-oriented -table-oriented"));
 
+    // phrases
+    CHECK_EQUAL(do_fulltext_find("\"one two\""), Keys({7}));
+    CHECK_EQUAL(do_fulltext_find("\"two one\""), Keys({8, 9}));
+    CHECK_EQUAL(do_fulltext_find("\"three two one\""), Keys({8}));
+    CHECK_EQUAL(do_fulltext_find("\"one\""), Keys({7, 8, 9}));
+    CHECK_EQUAL(do_fulltext_find("one \"three two\""), Keys({8}));
+    CHECK_EQUAL(do_fulltext_find("\"two one\" -three"), Keys({9}));
+    CHECK_EQUAL(do_fulltext_find("\"two one"), Keys({8, 9})); // phrase lasts until the end
+    CHECK_EQUAL(do_fulltext_find("\"database management market\""), Keys({4}));
+    CHECK_EQUAL(do_fulltext_find("\"object oriented database\""), Keys({0, 1}));
+    CHECK_EQUAL(do_fulltext_find("\"one three\""), Keys());
+    CHECK_EQUAL(do_query_find(table, "text TEXT '\"two one\"'"), Keys({8, 9}));
+    CHECK_THROW_ANY(do_fulltext_find("-\"two one\""));
+
     while (table->size() > 0) {
         table->begin()->remove();
     }
@@ -6375,4 +6389,134 @@ TEST(Query_FullTextPrefix)
     CHECK_EQUAL(q.count(), 1);
 }
 
+TEST(Query_FullTextCommonTokens)
+{
+    Group g;
+    auto table = g.add_table("table");
+    auto col = table->add_column(type_String, "text");
+    table->add_fulltext_index(col);
+
+    // Tokens of very different frequency, so that the postings of the rare ones are looked up in those of the
+    // common ones
+    for (int i = 0; i < 3000; ++i) {
+        std::string text = "common";
+        if (i % 2 == 0)
+            text += " even";
+        if (i % 3 == 0)
+            text += " third";
+        if (i % 500 == 7)
+            text += " rare";
+        if (i == 1234)
+            text += " single";
+        table->create_object().set(col, text);
+    }
+
+    auto count = [&](bool (*pred)(int)) {
+        size_t n = 0;
+        for (int i = 0; i < 3000; ++i) {
+            if (pred(i))
+                ++n;
+        }
+        return n;
+    };
+    CHECK_EQUAL(table->query("text TEXT 'common even third'").count(), count([](int i) {
+                    return i % 6 == 0;
+                }));
+    CHECK_EQUAL(table->query("text TEXT 'rare common third'").count(), count([](int i) {
+                    return i % 500 == 7 && i % 3 == 0;
+                }));
+    CHECK_EQUAL(table->query("text TEXT 'common rare -even'").count(), count([](int i) {
+                    return i % 500 == 7 && i % 2 == 1;
+                }));
+    CHECK_EQUAL(table->query("text TEXT 'even single common'").count(), 1);
+    CHECK_EQUAL(table->query("text TEXT 'third single'").count(), 0);
+    CHECK_EQUAL(table->query("text TEXT 'com* thi* ev*'").count(), 500);
+    CHECK_EQUAL(table->query("text TEXT '\"common even third\"'").count(), 500);
+    CHECK_EQUAL(table->query("text TEXT '\"common third\"'").count(), count([](int i) {
+                    return i % 3 == 0 && i % 2 == 1;
+                }));
+
+    CHECK_EQUAL(table->query("text TEXT 'rare even'").count(), 0); // 7, 507, ... are all odd
+    auto tv = table->query("text TEXT 'rare third'").find_all();
+    CHECK_EQUAL(tv.size(), 2);
+    for (size_t i = 0; i < tv.size(); ++i)
+        CHECK_EQUAL(tv.get_object(i).get<String>(col), "common third rare");
+}
+
+TEST(Query_FullTextRank)
+{
+    Group g;
+    auto table = g.add_table("table");
+    auto col = table->add_column(type_String, "text");
+    CHECK_THROW(table->rank_fulltext(col, "database"), IllegalOperation);
+    table->add_fulltext_index(col);
+
+    auto often = table->create_object().set(col, "database database database").get_key();
+    auto short_text = table->create_object().set(col, "object database").get_key();
+    auto long_text =
+        table->create_object()
+            .set(col, "an object database is a management system in which information is represented as objects")
+            .get_key();
+    auto rare = table->create_object().set(col, "embedded object store").get_key();
+    table->create_object().set(col, "nothing to see");
+    for (int i = 0; i < 20; ++i)
+        table->create_object().set(col, "object of the kind most objects are");
+
+    auto ranked = table->rank_fulltext(col, "database");
+    CHECK_EQUAL(ranked.size(), 3);
+    if (ranked.size() == 3) {
+        // More occurrences first, then the shorter of two texts with one occurrence each
+        CHECK_EQUAL(ranked[0].first, often);
+        CHECK_EQUAL(ranked[1].first, short_text);
+        CHECK_EQUAL(ranked[2].first, long_text);
+        CHECK_GREATER(ranked[0].second, ranked[1].second);
+        CHECK_GREATER(ranked[1].second, ranked[2].second);
+    }
+
+    // A rare word counts for more than a common one
+    ranked = table->rank_fulltext(col, "object embedded");
+    CHECK_EQUAL(ranked.size(), 1);
+    CHECK_EQUAL(ranked[0].first, rare);
+    CHECK_EQUAL(table->rank_fulltext(col, "object").size(), 23);
+    auto by_embedded = table->rank_fulltext(col, "embedded");
+    auto by_object = table->rank_fulltext(col, "object");
+    CHECK_GREATER(by_embedded[0].second, by_object[0].second);
+
+    // Prefixes and phrases select the objects as in queries
+    CHECK_EQUAL(table->rank_fulltext(col, "datab*").size(), 3);
+    ranked = table->rank_fulltext(col, "\"object database\"");
+    CHECK_EQUAL(ranked.size(), 2);
+    for (auto& [key, score] : ranked)
+        CHECK(key == short_text || key == long_text);
+    CHECK(table->rank_fulltext(col, "missing").empty());
+
+    // A view is ordered by relevance through a RelevanceDescriptor
+    auto tv = table->query("text TEXT 'database'").find_all();
+    tv.sort(RelevanceDescriptor(col, "database"));
+    CHECK_EQUAL(tv.size(), 3);
+    CHECK_EQUAL(tv.get_key(0), often);
+    CHECK_EQUAL(tv.get_key(1), short_text);
+    CHECK_EQUAL(tv.get_key(2), long_text);
+    // Objects which do not match keep their order after those which do
+    tv = table->where().find_all();
+    tv.sort(RelevanceDescriptor(col, "embedded"));
+    CHECK_EQUAL(tv.size(), 25);
+    CHECK_EQUAL(tv.get_key(0), rare);
+    CHECK_EQUAL(tv.get_key(1), often);
+    CHECK_EQUAL(tv.get_key(2), short_text);
+    // The view keeps its order when it is brought up to date
+    table->create_object().set(col, "embedded database");
+    tv.sync_if_needed();
+    CHECK_EQUAL(tv.size(), 26);
+    CHECK_EQUAL(tv.get_object(0).get<String>(col), "embedded database");
+    CHECK_EQUAL(tv.get_key(1), rare);
+    DescriptorOrdering ordering;
+    ordering.append_relevance(RelevanceDescriptor(col, "database"));
+    ordering.append_limit(LimitDescriptor(1));
+    CHECK(ordering.will_apply_sort());
+    tv = table->query("text TEXT 'database'").find_all(ordering);
+    CHECK_EQUAL(tv.size(), 1);
+    CHECK_EQUAL(tv.get_key(0), often);
+}
+
 #endif // TEST_QUERY
@@ -19,6 +19,8 @@
 #include "testsettings.hpp"
 #ifdef TEST_SHARED
 
+#include <algorithm>
+#include <array>
 #include <condition_variable>
 #include <fstream>
 #include <iostream>
@@ -492,6 +494,294 @@ TEST(Shared_CompactingOnTheFly)
 }
 
 
+TEST(Shared_PackIntegerColumns)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    SHARED_GROUP_TEST_PATH(path_unpacked);
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+
+    // Increasing ids, timestamps, large values with a small spread, values using all 64 bits, and a nullable
+    // column which is never packed.
+    const size_t num_objects = 2500;
+    std::vector<std::array<int64_t, 5>> values(num_objects);
+    int64_t timestamp = 1700000000000;
+    for (size_t i = 0; i < num_objects; ++i) {
+        timestamp += random.draw_int<int64_t>(0, 5000);
+        values[i] = {int64_t(i) + 1000000, timestamp, 5000000000 + random.draw_int<int64_t>(-300, 300),
+                     random.draw_int<int64_t>(), random.draw_int<int64_t>(0, 1 << 20)};
+    }
+
+    std::vector<ColKey> cols;
+    auto fill = [&](DBRef db) {
+        WriteTransaction wt(db);
+        auto table = wt.add_table("table");
+        cols = {table->add_column(type_Int, "id"), table->add_column(type_Int, "timestamp"),
+                table->add_column(type_Int, "large"), table->add_column(type_Int, "random"),
+                table->add_column(type_Int, "nullable", true)};
+        for (size_t i = 0; i < num_objects; ++i) {
+            Obj obj = table->create_object();
+            for (size_t c = 0; c < cols.size(); ++c)
+                obj.set(cols[c], values[i][c]);
+        }
+        wt.commit();
+    };
+    auto check = [&](DBRef db) {
+        ReadTransaction rt(db);
+        rt.get_group().verify();
+        auto table = rt.get_table("table");
+        CHECK_EQUAL(table->size(), values.size());
+        size_t i = 0;
+        for (auto& obj : *table) {
+            for (size_t c = 0; c < cols.size(); ++c)
+                CHECK_EQUAL(obj.get<Int>(cols[c]), values[i][c]);
+            ++i;
+        }
+        for (size_t c = 0; c < cols.size(); ++c) {
+            int64_t sum = 0, min = values[0][c], max = values[0][c];
+            for (auto& v : values) {
+                sum = int64_t(uint64_t(sum) + uint64_t(v[c]));
+                min = std::min(min, v[c]);
+                max = std::max(max, v[c]);
+            }
+            CHECK_EQUAL(table->sum(cols[c])->get_int(), sum);
+            CHECK_EQUAL(table->min(cols[c])->get_int(), min);
+            CHECK_EQUAL(table->max(cols[c])->get_int(), max);
+
+            int64_t needle = values[values.size() / 3][c];
+            size_t expected = std::count_if(values.begin(), values.end(), [&](auto& v) {
+                return v[c] == needle;
+            });
+            CHECK_EQUAL(table->where().equal(cols[c], needle).count(), expected);
+            expected = std::count_if(values.begin(), values.end(), [&](auto& v) {
+                return v[c] > needle;
+            });
+            CHECK_EQUAL(table->where().greater(cols[c], needle).count(), expected);
+            expected = std::count_if(values.begin(), values.end(), [&](auto& v) {
+                return v[c] < needle;
+            });
+            CHECK_EQUAL(table->where().less(cols[c], needle).count(), expected);
+        }
+    };
+
+    DBOptions options(crypt_key());
+    options.pack_integer_columns = true;
+    DBRef db = DB::create(make_in_realm_history(), path, options);
+    fill(db);
+    check(db);
+
+    DBRef db_unpacked = DB::create(make_in_realm_history(), path_unpacked, DBOptions(crypt_key()));
+    fill(db_unpacked);
+    check(db_unpacked);
+    size_t free_space, used_space, unpacked_used_space;
+    db->get_stats(free_space, used_space);
+    db_unpacked->get_stats(free_space, unpacked_used_space);
+    CHECK_LESS(used_space, unpacked_used_space);
+
+    // Modifying packed leaves turns them back into regular arrays, which are packed again by the next commit
+    {
+        WriteTransaction wt(db);
+        auto table = wt.get_table("table");
+        size_t i = 0;
+        for (auto& obj : *table) {
+            if (i % 97 == 0) {
+                values[i][1] += 17;
+                obj.set(cols[1], values[i][1]);
+            }
+            ++i;
+        }
+        for (size_t j = 0; j < 100; ++j) {
+            values.push_back({int64_t(j), int64_t(j) * 3, -int64_t(j), random.draw_int<int64_t>(), 0});
+            Obj obj = table->create_object();
+            for (size_t c = 0; c < cols.size(); ++c)
+                obj.set(cols[c], values.back()[c]);
+        }
+        wt.get_group().verify();
+        wt.commit();
+    }
+    check(db);
+
+    // Accessors obtained before the commit still work
+    {
+        auto rt = db->start_read();
+        auto table = rt->get_table("table");
+        Obj obj = table->get_object(0);
+        rt->promote_to_write();
+        obj.set(cols[0], values[0][0]);
+        rt->commit_and_continue_as_read();
+        CHECK_EQUAL(obj.get<Int>(cols[1]), values[0][1]);
+    }
+
+    // Compaction writes the packed leaves decoded, and the file still reads the same
+    CHECK(db->compact());
+    check(db);
+}
+
+
+TEST(Shared_EnumerateStringColumns)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    const char* countries[] = {"Denmark", "Sweden", "Norway", "Finland", "Iceland"};
+    DBOptions options(crypt_key());
+    options.enumerate_string_columns = true;
+    options.enumerate_string_columns_min_size = 100;
+    options.enumerate_string_columns_max_unique = 16;
+    DBRef db = DB::create(make_in_realm_history(), path, options);
+
+    ColKey col_country, col_name, col_nullable;
+    {
+        WriteTransaction wt(db);
+        auto table = wt.add_table("table");
+        col_country = table->add_column(type_String, "country");
+        col_name = table->add_column(type_String, "name");
+        col_nullable = table->add_column(type_String, "nullable", true);
+        for (size_t i = 0; i < 99; ++i) {
+            table->create_object().set(col_country, countries[i % 5]).set(col_name, std::to_string(i));
+        }
+        wt.commit();
+    }
+    {
+        // Too few objects
+        ReadTransaction rt(db);
+        CHECK_NOT(rt.get_table("table")->is_enumerated(col_country));
+    }
+    {
+        WriteTransaction wt(db);
+        auto table = wt.get_table("table");
+        for (size_t i = 99; i < 1000; ++i) {
+            Obj obj = table->create_object().set(col_country, countries[i % 5]).set(col_name, std::to_string(i));
+            if (i % 3 == 0)
+                obj.set(col_nullable, StringData(i % 2 ? "" : "odd"));
+        }
+        wt.commit();
+    }
+
+    auto check = [&](size_t size, size_t unique_countries) {
+        ReadTransaction rt(db);
+        rt.get_group().verify();
+        auto table = rt.get_table("table");
+        CHECK(table->is_enumerated(col_country));
+        CHECK(table->is_enumerated(col_nullable));
+        CHECK_NOT(table->is_enumerated(col_name));
+        CHECK_EQUAL(table->get_num_unique_values(col_country), unique_countries);
+        CHECK_EQUAL(table->size(), size);
+
+        CHECK_EQUAL(table->get_object(7).get<String>(col_country), "Norway");
+        CHECK_EQUAL(table->where().equal(col_country, "Norway").count(), (size + 2) / 5);
+        CHECK_EQUAL(table->where().equal(col_country, "Germany").count(), 0);
+        CHECK_EQUAL(table->where().not_equal(col_country, "Norway").count(), size - (size + 2) / 5);
+        CHECK_EQUAL(table->query("country IN {'Norway', 'Iceland', 'Germany'}").count(), (size + 2) / 5 + size / 5);
+        CHECK_EQUAL(table->query("country == 'Norway' OR country == 'Iceland'").count(), (size + 2) / 5 + size / 5);
+        size_t odd = 0, empty = 0;
+        for (size_t i = 0; i < size; ++i) {
+            if (i >= 99 && i % 3 == 0)
+                ++(i % 2 ? empty : odd);
+        }
+        CHECK_EQUAL(table->where().equal(col_nullable, "odd").count(), odd);
+        CHECK_EQUAL(table->where().equal(col_nullable, "").count(), empty);
+        CHECK_EQUAL(table->where().equal(col_nullable, StringData()).count(), size - odd - empty);
+        CHECK_EQUAL(table->query("nullable IN {NULL, ''}").count(), size - odd);
+    };
+    check(1000, 5);
+
+    // Enumerated columns can still be modified, and new strings are added to the list of unique values
+    {
+        WriteTransaction wt(db);
+        auto table = wt.get_table("table");
+        auto q = table->where().equal(col_country, "Norway");
+        CHECK_EQUAL(q.count(), 200);
+        table->get_object(7).set(col_country, "Germany");
+        CHECK_EQUAL(q.count(), 199);
+        CHECK_EQUAL(table->where().equal(col_country, "Germany").count(), 1);
+        table->get_object(7).set(col_country, "Norway");
+        wt.commit();
+    }
+    check(1000, 6);
+
+    // The column is converted back once its list of unique values outgrows the limit
+    {
+        WriteTransaction wt(db);
+        auto table = wt.get_table("table");
+        for (size_t i = 0; i < 20; ++i) {
+            // Appended in descending order, so the list of unique values is no longer sorted
+            table->get_object(5 * i).set(col_country, "Zone " + std::to_string(99 - i));
+        }
+        for (size_t i = 0; i < 20; ++i) {
+            std::string zone = "Zone " + std::to_string(99 - i);
+            CHECK_EQUAL(table->where().equal(col_country, StringData(zone)).count(), 1);
+            CHECK_EQUAL(table->get_object(5 * i).get<String>(col_country), zone);
+        }
+        CHECK_EQUAL(table->where().equal(col_country, "Denmark").count(), 180);
+        Mixed needles[] = {"Zone 99", "Zone 80", "Denmark", "Atlantis"};
+        CHECK_EQUAL(table->where().in(col_country, std::begin(needles), std::end(needles)).count(), 182);
+        // Enumerating an enumerated column leaves it as it is, whatever the limit
+        CHECK(table->enumerate_string_column(col_country, 16));
+        CHECK(table->is_enumerated(col_country));
+        wt.commit();
+    }
+    {
+        ReadTransaction rt(db);
+        rt.get_group().verify();
+        auto table = rt.get_table("table");
+        CHECK_NOT(table->is_enumerated(col_country));
+        CHECK(table->is_enumerated(col_nullable));
+        CHECK_EQUAL(table->where().equal(col_country, "Zone 90").count(), 1);
+        CHECK_EQUAL(table->where().equal(col_country, "Denmark").count(), 180);
+        CHECK_EQUAL(table->where().equal(col_country, "Norway").count(), 200);
+        CHECK_EQUAL(table->get_object(6).get<String>(col_country), "Sweden");
+    }
+}
+
+TEST(Shared_Prefetch)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options(crypt_key());
+    options.access_pattern = DBOptions::AccessPattern::Sequential;
+    options.use_huge_pages = true;
+    DBRef db = DB::create(make_in_realm_history(), path, options);
+
+    TableKey table_key;
+    ColKey col_int, col_str, col_list;
+    {
+        WriteTransaction wt(db);
+        auto table = wt.add_table("table");
+        table_key = table->get_key();
+        col_int = table->add_column(type_Int, "int");
+        col_str = table->add_column(type_String, "str");
+        col_list = table->add_column_list(type_String, "list");
+        // Enough objects for a cluster tree with inner nodes
+        for (int i = 0; i < 5000; ++i) {
+            Obj obj = table->create_object().set(col_int, i).set(col_str, std::string(i % 100, 'x'));
+            obj.get_list<String>(col_list).add(std::to_string(i));
+        }
+        wt.commit();
+    }
+
+    auto check = [&](const Transaction& tr) {
+        auto table = tr.get_table(table_key);
+        CHECK_EQUAL(table->size(), 5000);
+        CHECK_EQUAL(table->sum(col_int)->get_int(), 5000 * 4999 / 2);
+        std::string needle(42, 'x');
+        CHECK_EQUAL(table->where().equal(col_str, StringData(needle)).count(), 50);
+        CHECK_EQUAL(table->get_object(1234).get_list<String>(col_list).get(0), "1234");
+    };
+
+    auto rt = db->start_read();
+    rt->prefetch(table_key);
+    rt->prefetch(table_key, col_int);
+    rt->prefetch(table_key, col_list, util::MemoryAdvice::Sequential);
+    rt->prefetch(table_key, col_str, util::MemoryAdvice::Random);
+    check(*rt);
+
+    // Objects created in a write transaction are not in the file yet
+    auto wt = db->start_write();
+    wt->get_table(table_key)->create_object().set(col_int, 5000);
+    wt->prefetch(table_key);
+    wt->rollback();
+
+    CHECK_THROW_ANY(rt->prefetch(TableKey(4711)));
+}
+
+
 TEST(Shared_ReadAfterCompact)
 {
     SHARED_GROUP_TEST_PATH(path);
@@ -1454,6 +1744,59 @@ TEST(Many_ConcurrentReaders)
 }
 
 
+TEST(Shared_ConcurrentReadLocksWhileWriting)
+{
+    // Readers with a DB of their own do not find the read locks of other
+    // readers in their local cache, so they all take them in the VersionList
+    // while the writer frees the entries of old versions
+    SHARED_GROUP_TEST_PATH(path);
+    const int num_commits = 300;
+    DBRef db = DB::create(path);
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        auto col_a = table->add_column(type_Int, "a");
+        auto col_b = table->add_column(type_Int, "b");
+        table->create_object(ObjKey(0)).set(col_a, 0).set(col_b, 0);
+        wt->commit();
+    }
+
+    std::atomic<bool> done = false;
+    auto reader = [&] {
+        DBRef db_2 = DB::create(path);
+        TransactionRef frozen;
+        while (!done) {
+            auto rt = db_2->start_read();
+            auto table = rt->get_table("table");
+            auto obj = table->get_object(ObjKey(0));
+            // Both values are set by the same commit
+            CHECK_EQUAL(obj.get<Int>("a"), obj.get<Int>("b"));
+            frozen = rt->freeze();
+            CHECK_EQUAL(frozen->get_version(), rt->get_version());
+        }
+        auto obj = frozen->get_table("table")->get_object(ObjKey(0));
+        CHECK_EQUAL(obj.get<Int>("a"), obj.get<Int>("b"));
+    };
+    constexpr int num_readers = 4;
+    std::thread threads[num_readers];
+    for (int i = 0; i < num_readers; ++i)
+        threads[i] = std::thread(reader);
+
+    for (int i = 1; i <= num_commits; ++i) {
+        auto wt = db->start_write();
+        wt->get_table("table")->get_object(ObjKey(0)).set("a", i).set("b", i);
+        wt->commit();
+    }
+    done = true;
+    for (int i = 0; i < num_readers; ++i)
+        threads[i].join();
+
+    auto rt = db->start_read();
+    rt->verify();
+    CHECK_EQUAL(rt->get_table("table")->get_object(ObjKey(0)).get<Int>("a"), num_commits);
+}
+
+
 TEST(Shared_WritesSpecialOrder)
 {
     SHARED_GROUP_TEST_PATH(path);
@@ -2597,6 +2940,356 @@ TEST(Shared_SessionDurabilityConsistency)
 }
 
 
+TEST(Shared_GroupCommit)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options;
+    options.group_commit = true;
+    const int num_writers = 4;
+    const int num_commits = 100;
+    {
+        DBRef db = DB::create(make_in_realm_history(), path, options);
+        {
+            auto wt = db->start_write();
+            wt->add_table("log")->add_column(type_Int, "writer");
+            wt->commit();
+        }
+        // All session participants must use group commit
+        CHECK_RUNTIME_ERROR(DB::create(make_in_realm_history(), path), ErrorCodes::IncompatibleSession);
+
+        // Each writer has a DB of its own, like a writer in another process would
+        auto writer = [&](int id) {
+            DBRef db_2 = DB::create(make_in_realm_history(), path, options);
+            auto tr = db_2->start_read();
+            for (int i = 0; i < num_commits; ++i) {
+                if (id % 2) {
+                    auto wt = db_2->start_write();
+                    wt->get_table("log")->create_object().set("writer", id);
+                    wt->commit();
+                }
+                else {
+                    tr->promote_to_write();
+                    tr->get_table("log")->create_object().set("writer", id);
+                    tr->commit_and_continue_as_read();
+                }
+            }
+        };
+        std::thread threads[num_writers];
+        for (int i = 0; i < num_writers; ++i)
+            threads[i] = std::thread(writer, i);
+        for (int i = 0; i < num_writers; ++i)
+            threads[i].join();
+
+        auto rt = db->start_read();
+        rt->verify();
+        CHECK_EQUAL(rt->get_table("log")->size(), num_writers * num_commits);
+    }
+    // A new session starts from the version referenced by the file header,
+    // which must be the last one committed
+    DBRef db = DB::create(make_in_realm_history(), path);
+    auto rt = db->start_read();
+    rt->verify();
+    CHECK_EQUAL(rt->get_table("log")->size(), num_writers * num_commits);
+}
+
+
+TEST(Shared_CommitJournal)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options;
+    options.commit_journal = true;
+    options.journal_checkpoint_size = 0x4000; // Checkpoint often
+    const int num_writers = 4;
+    const int num_commits = 100;
+    {
+        DBRef db = DB::create(make_in_realm_history(), path, options);
+        {
+            auto wt = db->start_write();
+            wt->add_table("log")->add_column(type_Int, "writer");
+            wt->commit();
+        }
+        // All session participants must use the journal
+        CHECK_RUNTIME_ERROR(DB::create(make_in_realm_history(), path), ErrorCodes::IncompatibleSession);
+
+        auto writer = [&](int id) {
+            DBRef db_2 = DB::create(make_in_realm_history(), path, options);
+            auto tr = db_2->start_read();
+            for (int i = 0; i < num_commits; ++i) {
+                tr->promote_to_write();
+                tr->get_table("log")->create_object().set("writer", id);
+                tr->commit_and_continue_as_read();
+            }
+        };
+        std::thread threads[num_writers];
+        for (int i = 0; i < num_writers; ++i)
+            threads[i] = std::thread(writer, i);
+        for (int i = 0; i < num_writers; ++i)
+            threads[i].join();
+
+        auto rt = db->start_read();
+        rt->verify();
+        CHECK_EQUAL(rt->get_table("log")->size(), num_writers * num_commits);
+    }
+    // The last participant leaves the newest version in the file header
+    CHECK_EQUAL(File(std::string(path) + ".journal.0").get_size(), 0);
+    CHECK_EQUAL(File(std::string(path) + ".journal.1").get_size(), 0);
+    DBRef db = DB::create(make_in_realm_history(), path);
+    auto rt = db->start_read();
+    rt->verify();
+    CHECK_EQUAL(rt->get_table("log")->size(), num_writers * num_commits);
+}
+
+TEST(Shared_CommitJournalRecovery)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    SHARED_GROUP_TEST_PATH(copy_path);
+    SHARED_GROUP_TEST_PATH(truncated_path);
+    SHARED_GROUP_TEST_PATH(no_journal_path);
+    DBOptions options;
+    options.commit_journal = true;
+    const int num_commits = 20;
+    {
+        DBRef db = DB::create(make_in_realm_history(), path, options);
+        {
+            auto wt = db->start_write();
+            wt->add_table("table")->add_column(type_String, "str");
+            wt->commit();
+        }
+        for (int i = 0; i < num_commits; ++i) {
+            auto wt = db->start_write();
+            wt->get_table("table")->create_object().set("str", std::string(100, char('a' + i)));
+            wt->commit();
+        }
+        // Take a copy of the files as they would be found after a crash. No
+        // checkpoint has been made, so the file header still references the
+        // initial version.
+        for (auto& target : {std::string(copy_path), std::string(truncated_path), std::string(no_journal_path)}) {
+            File::copy(path, target);
+            File::copy(std::string(path) + ".journal.0", target + ".journal.0");
+            File::copy(std::string(path) + ".journal.1", target + ".journal.1");
+        }
+    }
+    {
+        // The last record was not completely written
+        File journal(std::string(truncated_path) + ".journal.0", File::mode_Update);
+        journal.resize(journal.get_size() - 8);
+    }
+
+    DBRef db = DB::create(make_in_realm_history(), copy_path, options);
+    auto rt = db->start_read();
+    rt->verify();
+    auto table = rt->get_table("table");
+    CHECK_EQUAL(table->size(), num_commits);
+    CHECK_EQUAL(table->get_object(num_commits - 1).get<String>("str"), std::string(100, char('a' + num_commits - 1)));
+
+    DBRef db_2 = DB::create(make_in_realm_history(), truncated_path, options);
+    rt = db_2->start_read();
+    rt->verify();
+    CHECK_EQUAL(rt->get_table("table")->size(), num_commits - 1);
+
+    // The file cannot be read without recovering the journal, which is done
+    // even if the journal is not used by the new session
+    CHECK_THROW_ANY(Group(std::string(no_journal_path)));
+    DBRef db_3 = DB::create(make_in_realm_history(), no_journal_path);
+    rt = db_3->start_read();
+    rt->verify();
+    CHECK_EQUAL(rt->get_table("table")->size(), num_commits);
+    rt->end_read();
+    db_3->close();
+    CHECK_NOT(File::exists(std::string(no_journal_path) + ".journal.0"));
+    Group g{std::string(no_journal_path)};
+    CHECK_EQUAL(g.get_table("table")->size(), num_commits);
+}
+
+TEST(Shared_CommitJournalCheckpointKeptIntact)
+{
+    // The version referenced by the file header is kept intact between
+    // checkpoints, even though later commits free space of it
+    SHARED_GROUP_TEST_PATH(path);
+    SHARED_GROUP_TEST_PATH(copy_path);
+    DBOptions options;
+    options.commit_journal = true;
+    options.journal_checkpoint_size = 0x4000;
+    DBRef db = DB::create(make_in_realm_history(), path, options);
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        table->add_column(type_String, "str");
+        for (int i = 0; i < 100; ++i)
+            table->create_object().set("str", std::string(50, 'x'));
+        wt->commit();
+    }
+    for (int i = 0; i < 200; ++i) {
+        auto wt = db->start_write();
+        for (auto obj : *wt->get_table("table"))
+            obj.set("str", std::string(50 + i % 7, char('a' + i % 26)));
+        wt->commit();
+        if (i % 50 == 49) {
+            // A copy without the journal, as after losing the journal files
+            File::copy(path, copy_path);
+            DBRef db_2 = DB::create(make_in_realm_history(), copy_path);
+            auto rt = db_2->start_read();
+            rt->verify();
+            CHECK_EQUAL(rt->get_table("table")->size(), 100);
+            rt->end_read();
+            db_2->close();
+            File::remove(copy_path);
+        }
+    }
+}
+
+TEST(Shared_CommitJournalCheckpointDuringParallelQuery)
+{
+    // A checkpoint scheduled by a commit waits for the write lock. Queries
+    // running on several threads while the write lock is held must not end
+    // up waiting for the checkpoint.
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options;
+    options.commit_journal = true;
+    options.journal_checkpoint_size = 0x1000;
+    DBRef db = DB::create(make_in_realm_history(), path, options);
+    ColKey col;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        col = table->add_column(type_Int, "int");
+        for (int i = 0; i < 20000; ++i)
+            table->create_object().set(col, i % 100);
+        wt->commit();
+    }
+    for (int i = 0; i < 50; ++i) {
+        auto wt = db->start_write();
+        auto table = wt->get_table("table");
+        auto q = table->where().greater(col, 49);
+        q.set_threads(8);
+        CHECK_EQUAL(q.count(), 10000);
+        table->get_object(i).set(col, i % 100);
+        wt->commit();
+    }
+}
+
+TEST(Shared_IoUring)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options;
+    options.use_io_uring = true;
+    const int num_commits = 100;
+    {
+        // Falls back to the memory mappings where io_uring is not available
+        DBRef db = DB::create(make_in_realm_history(), path, options);
+        DBRef db_2 = DB::create(make_in_realm_history(), path);
+        {
+            auto wt = db->start_write();
+            auto table = wt->add_table("table");
+            table->add_column(type_Int, "value");
+            table->add_column(type_Binary, "blob", true);
+            wt->commit();
+        }
+        auto rt = db_2->start_read();
+        for (int i = 0; i < num_commits; ++i) {
+            auto wt = db->start_write();
+            wt->get_table("table")->create_object().set("value", i);
+            wt->commit();
+            // The commit is visible through the mappings of other DBs
+            rt->advance_read();
+            CHECK_EQUAL(rt->get_table("table")->size(), i + 1);
+        }
+        {
+            // More than is buffered before the arrays are written
+            std::string blob(1024 * 1024, 'x');
+            auto wt = db->start_write();
+            auto table = wt->get_table("table");
+            for (int i = 0; i < 20; ++i)
+                table->create_object().set("blob", BinaryData(blob));
+            wt->commit();
+        }
+        rt->advance_read();
+        rt->verify();
+        CHECK_EQUAL(rt->get_table("table")->size(), num_commits + 20);
+        rt = nullptr;
+        db_2->close();
+
+        CHECK(db->compact());
+        auto wt = db->start_write();
+        wt->get_table("table")->clear();
+        wt->commit();
+    }
+    DBRef db = DB::create(make_in_realm_history(), path);
+    auto rt = db->start_read();
+    rt->verify();
+    CHECK_EQUAL(rt->get_table("table")->size(), 0);
+}
+
+
+TEST(Shared_Metrics)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    CHECK_NOT(DB::create(make_in_realm_history(), path)->get_metrics());
+
+    DBOptions options;
+    options.enable_metrics = true;
+    DBRef db = DB::create(make_in_realm_history(), path, options);
+    auto metrics = db->get_metrics();
+    CHECK(metrics);
+    const int num_commits = 10;
+    {
+        auto wt = db->start_write();
+        wt->add_table("table")->add_column(type_Int, "value");
+        wt->commit();
+    }
+    for (int i = 0; i < num_commits; ++i) {
+        auto wt = db->start_write();
+        wt->get_table("table")->create_object().set("value", i);
+        wt->commit();
+    }
+    for (auto histogram : {&metrics->commit, &metrics->free_lists, &metrics->write_arrays, &metrics->sync,
+                           &metrics->header, &metrics->notify}) {
+        CHECK_EQUAL(histogram->count(), num_commits + 1);
+        uint64_t in_buckets = 0;
+        for (size_t i = 0; i < LatencyHistogram::num_buckets; ++i)
+            in_buckets += histogram->bucket_count(i);
+        CHECK_EQUAL(in_buckets, histogram->count());
+        CHECK_LESS_EQUAL(histogram->percentile(0.5).count(), histogram->percentile(0.99).count());
+        CHECK_LESS_EQUAL(histogram->percentile(0.99).count(), histogram->max().count());
+        CHECK_LESS_EQUAL(histogram->max().count(), histogram->total().count());
+    }
+    CHECK_GREATER_EQUAL(metrics->commit.total().count(),
+                        (metrics->sync.total() + metrics->header.total()).count());
+    // Each write transaction takes a read lock, as does the final commit
+    CHECK_GREATER_EQUAL(metrics->read_lock.count(), num_commits + 1);
+
+    size_t free_space, used_space, locked_space;
+    db->get_stats(free_space, used_space, &locked_space);
+    CHECK_EQUAL(metrics->free_space, free_space);
+    CHECK_EQUAL(metrics->used_space, used_space);
+    CHECK_EQUAL(metrics->locked_space, locked_space);
+    CHECK_EQUAL(metrics->number_of_versions, db->get_number_of_versions());
+    CHECK_EQUAL(metrics->evacuation_stage, int(db->get_evacuation_stage()));
+
+    metrics->reset();
+    CHECK_EQUAL(metrics->commit.count(), 0);
+    CHECK_EQUAL(metrics->commit.percentile(0.99).count(), 0);
+    auto rt = db->start_read();
+    CHECK_EQUAL(metrics->read_lock.count(), 1);
+    CHECK_EQUAL(metrics->commit.count(), 0);
+}
+
+
+TEST(Shared_MetricsPercentiles)
+{
+    LatencyHistogram histogram;
+    for (int i = 1; i <= 100; ++i)
+        histogram.record(std::chrono::microseconds(i));
+    CHECK_EQUAL(histogram.count(), 100);
+    CHECK_EQUAL(histogram.max().count(), 100'000);
+    CHECK_EQUAL(histogram.total().count(), 5'050'000);
+    // The percentiles are the limits of the buckets they fall in
+    CHECK_GREATER_EQUAL(histogram.percentile(0.5).count(), 50'000);
+    CHECK_LESS(histogram.percentile(0.5).count(), 100'000);
+    CHECK_EQUAL(histogram.percentile(1.0).count(), 100'000);
+}
+
+
 TEST(Shared_WriteEmpty)
 {
     SHARED_GROUP_TEST_PATH(path_1);
@@ -2619,6 +3312,64 @@ TEST(Shared_CompactEmpty)
 }
 
 
+TEST(Shared_CompactManyTables)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    SHARED_GROUP_TEST_PATH(copy_path);
+    DBRef db = DB::create(make_in_realm_history(), path, DBOptions(crypt_key()));
+    {
+        WriteTransaction wt(db);
+        auto target = wt.add_table("target");
+        auto origin = wt.add_table("origin");
+        wt.add_table("empty");
+        auto mixed = wt.add_table("mixed");
+        auto col_bin = target->add_column(type_Binary, "bin");
+        auto col_long = target->add_column(type_String, "long");
+        auto col_int = origin->add_column(type_Int, "int");
+        auto col_str = origin->add_column(type_String, "str");
+        auto col_list = origin->add_column_list(type_Int, "list");
+        auto col_link = origin->add_column(*target, "link");
+        origin->add_search_index(col_str);
+        auto col_mixed = mixed->add_column(type_Mixed, "mixed", true);
+
+        std::string blob(100, 'b');
+        for (int i = 0; i < 2000; ++i) {
+            target->create_object().set(col_bin, BinaryData(blob)).set(col_long, std::string(200 + i % 50, 'l'));
+        }
+        for (int i = 0; i < 3000; ++i) {
+            Obj obj = origin->create_object();
+            obj.set(col_int, i * int64_t(1000003)).set(col_str, util::to_string(i % 77));
+            obj.set(col_link, target->get_object(i % 2000).get_key());
+            auto list = obj.get_list<Int>(col_list);
+            for (int j = 0; j < i % 5; ++j)
+                list.add(j);
+        }
+        for (int i = 0; i < 500; ++i) {
+            Mixed value = i % 3 == 0 ? Mixed(i) : i % 3 == 1 ? Mixed(util::to_string(i)) : Mixed();
+            mixed->create_object().set(col_mixed, value);
+        }
+        wt.commit();
+    }
+    {
+        ReadTransaction rt(db);
+        rt.get_group().write(copy_path);
+    }
+    CHECK(db->compact());
+
+    Group copy(copy_path);
+    copy.verify();
+    ReadTransaction rt(db);
+    rt.get_group().verify();
+    CHECK(rt.get_group() == copy);
+    auto origin = rt.get_table("origin");
+    CHECK_EQUAL(origin->size(), 3000);
+    CHECK_EQUAL(origin->where().equal(origin->get_column_key("str"), "42").count(), 39);
+    Obj obj = origin->get_object(2999);
+    CHECK_EQUAL(obj.get<Int>("int"), 2999 * int64_t(1000003));
+    CHECK_EQUAL(obj.get_list<Int>("list").size(), 4);
+    CHECK_EQUAL(obj.get_linked_object("link").get<String>("long"), std::string(200 + 999 % 50, 'l'));
+}
+
 TEST(Shared_VersionOfBoundSnapshot)
 {
     SHARED_GROUP_TEST_PATH(path);
@@ -3512,6 +3512,134 @@ TEST(Table_CreateObjectWithPrimaryKeyDidCreate)
     CHECK_NOT(did_create);
 }
 
+TEST(Table_CreateObjectsFromColumns)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = DB::create(make_in_realm_history(), path);
+    const size_t num_objects = 2500; // Several leaves
+
+    std::vector<std::string> strings;
+    std::vector<Mixed> ints, doubles, names, links;
+    for (size_t i = 0; i < num_objects; ++i) {
+        ints.emplace_back(int64_t(i));
+        doubles.emplace_back(i % 3 ? Mixed(i * 0.5) : Mixed());
+        strings.push_back("name " + util::to_string(i % 100));
+    }
+    for (auto& str : strings)
+        names.emplace_back(StringData(str));
+
+    ColKey col_int, col_double, col_string, col_link, col_list, col_origin_link;
+    std::vector<ObjKey> keys;
+    {
+        auto wt = db->start_write();
+        auto target = wt->add_table("target");
+        auto table = wt->add_table("table");
+        col_int = table->add_column(type_Int, "int");
+        col_double = table->add_column(type_Double, "double", true);
+        col_string = table->add_column(type_String, "string");
+        col_link = table->add_column(*target, "link");
+        col_list = table->add_column_list(type_Int, "list");
+        table->add_search_index(col_string);
+        col_origin_link = target->add_column(*table, "origin");
+
+        auto existing = table->create_object().set(col_int, -1);
+        auto target_obj = target->create_object();
+        for (size_t i = 0; i < num_objects; ++i)
+            links.emplace_back(i % 2 ? Mixed(target_obj.get_key()) : Mixed());
+
+        keys = table->create_objects(
+            {{col_int, ints}, {col_double, doubles}, {col_string, names}, {col_link, links}});
+        CHECK_EQUAL(keys.size(), num_objects);
+        CHECK_EQUAL(table->size(), num_objects + 1);
+        CHECK_EQUAL(target_obj.get_backlink_count(), num_objects / 2);
+        CHECK_EQUAL(existing.get<Int>(col_int), -1);
+
+        // Mismatched sizes and types are rejected
+        CHECK_THROW_ANY(table->create_objects({{col_int, ints}, {col_string, util::Span<const Mixed>(names).first(1)}}));
+        CHECK_THROW_ANY(table->create_objects({{col_int, doubles}}));
+        CHECK_THROW_ANY(table->create_objects({{col_list, ints}}));
+        CHECK_THROW_ANY(table->create_objects({{col_int, ints}}, ints));
+        CHECK_EQUAL(table->size(), num_objects + 1);
+        wt->commit();
+    }
+
+    auto rt = db->start_read();
+    rt->verify();
+    auto table = rt->get_table("table");
+    for (size_t i = 0; i < num_objects; ++i) {
+        auto obj = table->get_object(keys[i]);
+        CHECK_EQUAL(obj.get<Int>(col_int), int64_t(i));
+        CHECK_EQUAL(obj.get_any(col_double), doubles[i]);
+        CHECK_EQUAL(obj.get<String>(col_string), strings[i]);
+        CHECK_EQUAL(obj.get<ObjKey>(col_link), links[i].is_null() ? ObjKey() : links[i].get<ObjKey>());
+        CHECK_EQUAL(obj.get_list<Int>(col_list).size(), 0);
+    }
+    CHECK_EQUAL(table->where().equal(col_string, "name 7").count(), num_objects / 100);
+    CHECK_EQUAL(table->find_first(col_string, StringData("name 42")), keys[42]);
+    CHECK_EQUAL(table->where().equal(col_double, null()).count(), (num_objects + 2) / 3 + 1);
+}
+
+TEST(Table_CreateObjectsFromColumnsWithPrimaryKey)
+{
+    Group g;
+    auto table = g.add_table_with_primary_key("table", type_String, "pk");
+    auto col_pk = table->get_primary_key_column();
+    auto col_value = table->add_column(type_Int, "value");
+    auto col_indexed = table->add_column(type_Int, "indexed");
+    table->add_search_index(col_indexed);
+
+    auto existing = table->create_object_with_primary_key("b", {{col_value, 1}});
+    std::vector<Mixed> pks = {"a", "b", "c", "a"};
+    std::vector<Mixed> values = {10, 20, 30, 40};
+    auto keys = table->create_objects({{col_value, values}}, pks);
+    CHECK_EQUAL(table->size(), 3);
+    CHECK_EQUAL(keys.size(), 4);
+    CHECK_EQUAL(keys[1], existing.get_key());
+    CHECK_EQUAL(keys[0], keys[3]);
+    // The last value for each primary key wins
+    CHECK_EQUAL(table->get_object(keys[0]).get<Int>(col_value), 40);
+    CHECK_EQUAL(existing.get<Int>(col_value), 20);
+    CHECK_EQUAL(table->get_object(keys[2]).get<Int>(col_value), 30);
+    CHECK_EQUAL(table->get_object(keys[2]).get<String>(col_pk), "c");
+    CHECK_EQUAL(table->find_primary_key("c"), keys[2]);
+    CHECK_EQUAL(table->find_first_int(col_indexed, 0), existing.get_key());
+    CHECK_EQUAL(table->where().equal(col_indexed, 0).count(), 3);
+
+    std::vector<Mixed> more_pks = {"d", "c"};
+    CHECK_THROW(table->create_objects({}, more_pks, Table::UpdateMode::never), ObjectAlreadyExists);
+    std::vector<Mixed> duplicate_pks = {"e", "f", "e"};
+    CHECK_THROW(table->create_objects({}, duplicate_pks, Table::UpdateMode::never), ObjectAlreadyExists);
+    // Nothing is created when a primary key is rejected
+    CHECK_EQUAL(table->size(), 3);
+    CHECK_NOT(table->find_primary_key("d"));
+    CHECK_NOT(table->find_primary_key("e"));
+
+    // As with Obj::set(), null is rejected for a column which is not nullable,
+    // both for new and for updated objects
+    CHECK_THROW(existing.set_null(col_value), NotNullable);
+    std::vector<Mixed> null_values = {30, Mixed()};
+    std::vector<Mixed> update_pks = {"g", "c"};
+    CHECK_THROW(table->create_objects({{col_value, null_values}}, update_pks), NotNullable);
+    null_values = {Mixed(), 30};
+    CHECK_THROW(table->create_objects({{col_value, null_values}}, update_pks), NotNullable);
+    CHECK_EQUAL(table->size(), 3);
+    CHECK_NOT(table->find_primary_key("g"));
+    CHECK_EQUAL(table->get_object(keys[2]).get<Int>(col_value), 30);
+
+    // A null value of a nullable column is stored as null
+    auto col_nullable = table->add_column(type_Int, "nullable", true);
+    table->get_object(keys[2]).set(col_nullable, 5);
+    null_values = {Mixed(), Mixed()};
+    keys = table->create_objects({{col_nullable, null_values}}, update_pks);
+    CHECK_EQUAL(keys[1], table->find_primary_key("c"));
+    CHECK(table->get_object(keys[0]).is_null(col_nullable));
+    CHECK(table->get_object(keys[1]).is_null(col_nullable));
+    std::vector<Mixed> null_pk = {Mixed()};
+    CHECK_THROW_ANY(table->create_objects({}, null_pk));
+    CHECK_THROW_ANY(table->create_objects({{col_pk, pks}}, pks));
+    table->verify();
+}
+
 TEST(Table_PrimaryKeyIndexBug)
 {
     Group g;
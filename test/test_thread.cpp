@@ -38,6 +38,7 @@
 #include <realm/utilities.hpp>
 #include <realm/util/features.h>
 #include <realm/util/thread.hpp>
+#include <realm/util/thread_pool.hpp>
 #include <realm/util/interprocess_condvar.hpp>
 #include <realm/util/interprocess_mutex.hpp>
 
@@ -899,6 +900,95 @@ NONCONCURRENT_TEST(Thread_Condvar_CreateDestroyDifferentThreads)
     }).join();
 }
 
+TEST(Thread_ThreadPool)
+{
+    for (size_t num_threads : {0, 1, 4}) {
+        ThreadPool pool(num_threads);
+        CHECK_EQUAL(pool.num_threads(), num_threads);
+
+        std::vector<int> results(100);
+        pool.run_parallel(results.size(), [&](size_t i) {
+            results[i] = int(i) * 2;
+        });
+        for (size_t i = 0; i < results.size(); ++i)
+            CHECK_EQUAL(results[i], int(i) * 2);
+
+        // Nested calls must not deadlock even if all workers are busy
+        std::atomic<int> sum{0};
+        pool.run_parallel(8, [&](size_t) {
+            pool.run_parallel(8, [&](size_t j) {
+                sum += int(j);
+            });
+        });
+        CHECK_EQUAL(sum, 8 * 28);
+
+        // The first exception is rethrown once all calls have completed
+        std::atomic<int> completed{0};
+        CHECK_THROW(pool.run_parallel(10,
+                                      [&](size_t i) {
+                                          ++completed;
+                                          if (i == 3)
+                                              throw std::runtime_error("fail");
+                                      }),
+                    std::runtime_error);
+        CHECK_EQUAL(completed, 10);
+
+        if (num_threads > 0) {
+            std::mutex mutex;
+            std::condition_variable cv;
+            bool done = false;
+            pool.submit([&] {
+                std::lock_guard lock(mutex);
+                done = true;
+                cv.notify_one();
+            });
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [&] {
+                return done;
+            });
+            CHECK(done);
+            lock.unlock();
+
+            // Waiting for a batch runs only the calls of that batch, even when
+            // other tasks are queued because all workers are busy
+            std::atomic<size_t> num_blocked{0};
+            bool release = false;
+            for (size_t i = 0; i < num_threads; ++i) {
+                pool.submit([&] {
+                    ++num_blocked;
+                    std::unique_lock lock(mutex);
+                    cv.wait(lock, [&] {
+                        return release;
+                    });
+                });
+            }
+            while (num_blocked < num_threads)
+                std::this_thread::yield();
+            std::atomic<bool> ran_inline{false};
+            std::atomic<bool> ran{false};
+            auto caller = std::this_thread::get_id();
+            pool.submit([&] {
+                ran_inline = std::this_thread::get_id() == caller;
+                ran = true;
+            });
+            std::atomic<int> num_calls{0};
+            pool.run_parallel(16, [&](size_t) {
+                ++num_calls;
+            });
+            CHECK_EQUAL(num_calls, 16);
+            CHECK_NOT(ran);
+            {
+                std::lock_guard lock(mutex);
+                release = true;
+            }
+            cv.notify_all();
+            while (!ran)
+                std::this_thread::yield();
+            CHECK_NOT(ran_inline);
+        }
+    }
+}
+
 #ifdef _WIN32
 TEST(Thread_Win32InterprocessBackslashes)
 {
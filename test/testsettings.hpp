@@ -57,6 +57,7 @@
 #define TEST_GEO
 #define TEST_GROUP
 #define TEST_UPGRADE
+#define TEST_INDEX_ORDERED
 #define TEST_INDEX_STRING
 #define TEST_LANG_BIND_HELPER
 #define TEST_PARSER
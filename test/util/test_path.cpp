@@ -22,6 +22,7 @@
 #include "spawned_process.hpp"
 
 #include <realm/util/file.hpp>
+#include <realm/commit_journal.hpp>
 #include <realm/db.hpp>
 #include <realm/history.hpp>
 
@@ -305,6 +306,7 @@ void DBTestPathGuard::cleanup() const noexcept
         if (File::is_dir(m_path + ".management"))
             remove_dir(m_path + ".management");
         File::try_remove(get_lock_path());
+        CommitJournal::remove_files(m_path);
     }
     catch (...) {
         // Exception deliberately ignored